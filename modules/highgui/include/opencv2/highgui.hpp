@@ -208,13 +208,21 @@ enum { IMREAD_UNCHANGED  = -1, // 8bit, color or not
        IMREAD_GRAYSCALE  = 0,  // 8bit, gray
        IMREAD_COLOR      = 1,  // ?, color
        IMREAD_ANYDEPTH   = 2,  // any depth, ?
-       IMREAD_ANYCOLOR   = 4   // ?, any color
+       IMREAD_ANYCOLOR   = 4,  // ?, any color
+       IMREAD_REDUCED_GRAYSCALE_2 = 16, // 8bit, gray, 1/2 of the size
+       IMREAD_REDUCED_COLOR_2     = 17, // 8bit, color, 1/2 of the size
+       IMREAD_REDUCED_GRAYSCALE_4 = 32, // 8bit, gray, 1/4 of the size
+       IMREAD_REDUCED_COLOR_4     = 33, // 8bit, color, 1/4 of the size
+       IMREAD_REDUCED_GRAYSCALE_8 = 64, // 8bit, gray, 1/8 of the size
+       IMREAD_REDUCED_COLOR_8     = 65  // 8bit, color, 1/8 of the size
      };
 
 enum { IMWRITE_JPEG_QUALITY    = 1,
        IMWRITE_PNG_COMPRESSION = 16,
        IMWRITE_PNG_STRATEGY    = 17,
        IMWRITE_PNG_BILEVEL     = 18,
+       IMWRITE_PNG_FILTER      = 19,
+       IMWRITE_PNG_PARALLEL    = 20,
        IMWRITE_PXM_BINARY      = 32,
        IMWRITE_WEBP_QUALITY    = 64
      };
@@ -226,8 +234,18 @@ enum { IMWRITE_PNG_STRATEGY_DEFAULT      = 0,
        IMWRITE_PNG_STRATEGY_FIXED        = 4
      };
 
+enum { IMWRITE_PNG_FILTER_NONE  = 8,
+       IMWRITE_PNG_FILTER_SUB   = 16,
+       IMWRITE_PNG_FILTER_UP    = 32,
+       IMWRITE_PNG_FILTER_AVG   = 64,
+       IMWRITE_PNG_FILTER_PAETH = 128,
+       IMWRITE_PNG_FILTER_ALL   = 248
+     };
+
 CV_EXPORTS_W Mat imread( const String& filename, int flags = IMREAD_COLOR );
 
+CV_EXPORTS Mat imread( const String& filename, int flags, Mat* dst );
+
 CV_EXPORTS_W bool imwrite( const String& filename, InputArray img,
               const std::vector<int>& params = std::vector<int>());
 
@@ -235,10 +253,79 @@ CV_EXPORTS_W Mat imdecode( InputArray buf, int flags );
 
 CV_EXPORTS Mat imdecode( InputArray buf, int flags, Mat* dst);
 
+// decodes the buffers in parallel; returns the number of decoded images. A buffer that can not be
+// decoded gives an empty matrix and, if errors is given, a non-empty message in (*errors)[i]
+CV_EXPORTS int imdecodeBatch( const std::vector<Mat>& bufs, CV_OUT std::vector<Mat>& dst, int flags,
+                              CV_OUT std::vector<String>* errors = 0 );
+
 CV_EXPORTS_W bool imencode( const String& ext, InputArray img,
                             CV_OUT std::vector<uchar>& buf,
                             const std::vector<int>& params = std::vector<int>());
 
+// image properties, retrieved from the header without decoding the pixels
+struct CV_EXPORTS ImageInfo
+{
+    ImageInfo() : width(0), height(0), type(-1) {}
+
+    int depth() const { return CV_MAT_DEPTH(type); }
+    int channels() const { return CV_MAT_CN(type); }
+    bool empty() const { return type < 0; }
+
+    int width;
+    int height;
+    int type;   // the type imread(..., IMREAD_UNCHANGED) would return, or -1 if the image can not be read
+};
+
+CV_EXPORTS bool imreadInfo( const String& filename, CV_OUT ImageInfo& info );
+
+CV_EXPORTS void imreadInfo( const std::vector<String>& filenames, CV_OUT std::vector<ImageInfo>& infos );
+
+CV_EXPORTS bool imdecodeInfo( InputArray buf, CV_OUT ImageInfo& info );
+
+CV_EXPORTS Mat imreadRegion( const String& filename, Rect roi, int flags = IMREAD_COLOR );
+
+// reads an image by bands of rows; TIFF and PNG images are decoded band by band
+class CV_EXPORTS ImageRowReader
+{
+public:
+    virtual ~ImageRowReader() {}
+
+    // the size of the region being read and the type of the bands
+    virtual Size size() const = 0;
+    virtual int type() const = 0;
+    // the first row of the next band, relative to the region
+    virtual int nextRow() const = 0;
+    // reads the next band of at most maxRows rows; returns false after the last row or on error
+    virtual bool read( OutputArray band, int maxRows ) = 0;
+};
+
+CV_EXPORTS Ptr<ImageRowReader> createImageRowReader( const String& filename, int flags = IMREAD_COLOR,
+                                                     Rect roi = Rect() );
+
+// reads the pages of a multi-page image (TIFF) one by one; each page is decoded only when it is read.
+// Images of the other formats have a single page
+class CV_EXPORTS ImagePageReader
+{
+public:
+    virtual ~ImagePageReader() {}
+
+    // the index of the page that read() or skip() will process next
+    virtual int pageIndex() const = 0;
+    // the properties of that page; empty after the last page
+    virtual ImageInfo info() const = 0;
+    // decodes the page and moves to the next one; returns false after the last page or on error
+    virtual bool read( OutputArray page ) = 0;
+    // moves to the next page without decoding it
+    virtual bool skip() = 0;
+};
+
+CV_EXPORTS Ptr<ImagePageReader> createImagePageReader( const String& filename, int flags = IMREAD_ANYCOLOR );
+
+CV_EXPORTS bool imreadmulti( const String& filename, CV_OUT std::vector<Mat>& mats, int flags = IMREAD_ANYCOLOR );
+
+CV_EXPORTS bool imreadmulti( const String& filename, CV_OUT std::vector<Mat>& mats, int start, int count,
+                             int flags = IMREAD_ANYCOLOR );
+
 } // cv
 
 
@@ -413,6 +500,32 @@ enum { CAP_PROP_XI_DOWNSAMPLING  = 400, // Change image resolution by binning or
      };
 
 
+// FFmpeg
+enum { CAP_PROP_FFMPEG_PREFETCH      = 500, // the number of frames decoded ahead by a background thread, default is 0 (decoding in grab())
+       CAP_PROP_FFMPEG_OUTPUT_FORMAT = 501, // the layout of the retrieved frames, see CAP_FFMPEG_OUTPUT_*
+       CAP_PROP_FFMPEG_FRAME_INDEX   = 502, // set: CAP_FFMPEG_FRAME_INDEX_*, get: the number of indexed frames
+       CAP_PROP_FFMPEG_SEEK_MODE     = 503  // CAP_FFMPEG_SEEK_ACCURATE (default) or CAP_FFMPEG_SEEK_KEYFRAME
+     };
+
+// FFmpeg output formats
+enum { CAP_FFMPEG_OUTPUT_BGR  = 0, // 8UC3 BGR (default)
+       CAP_FFMPEG_OUTPUT_GRAY = 1, // 8UC1 luma plane
+       CAP_FFMPEG_OUTPUT_I420 = 2, // 8UC1 Y, U and V planes (height*3/2 rows), see COLOR_YUV2BGR_I420; even frame sizes only
+       CAP_FFMPEG_OUTPUT_NV12 = 3  // 8UC1 Y plane and interleaved UV plane (height*3/2 rows), see COLOR_YUV2BGR_NV12; even frame sizes only
+     };
+
+// FFmpeg frame index
+enum { CAP_FFMPEG_FRAME_INDEX_NONE   = 0, // seeking relies on the demuxer (default)
+       CAP_FFMPEG_FRAME_INDEX_MEMORY = 1, // scan the packets of the file once and keep the index in memory
+       CAP_FFMPEG_FRAME_INDEX_FILE   = 2  // load the index from <filename>.cvindex, or build it and write the file
+     };
+
+// FFmpeg seek modes
+enum { CAP_FFMPEG_SEEK_ACCURATE = 0, // the next frame is the requested one
+       CAP_FFMPEG_SEEK_KEYFRAME = 1  // the next frame is the keyframe preceding the requested one
+     };
+
+
 // Properties for Android cameras
 enum { CAP_PROP_ANDROID_AUTOGRAB               = 1024,
        CAP_PROP_ANDROID_PREVIEW_SIZES_STRING   = 1025, // readonly, tricky property, returns const char* indeed
@@ -218,11 +218,19 @@ enum
     CV_IMWRITE_PNG_COMPRESSION =16,
     CV_IMWRITE_PNG_STRATEGY =17,
     CV_IMWRITE_PNG_BILEVEL =18,
+    CV_IMWRITE_PNG_FILTER =19,
+    CV_IMWRITE_PNG_PARALLEL =20,
     CV_IMWRITE_PNG_STRATEGY_DEFAULT =0,
     CV_IMWRITE_PNG_STRATEGY_FILTERED =1,
     CV_IMWRITE_PNG_STRATEGY_HUFFMAN_ONLY =2,
     CV_IMWRITE_PNG_STRATEGY_RLE =3,
     CV_IMWRITE_PNG_STRATEGY_FIXED =4,
+    CV_IMWRITE_PNG_FILTER_NONE =8,
+    CV_IMWRITE_PNG_FILTER_SUB =16,
+    CV_IMWRITE_PNG_FILTER_UP =32,
+    CV_IMWRITE_PNG_FILTER_AVG =64,
+    CV_IMWRITE_PNG_FILTER_PAETH =128,
+    CV_IMWRITE_PNG_FILTER_ALL =248,
     CV_IMWRITE_PXM_BINARY =32,
     CV_IMWRITE_WEBP_QUALITY =64
 };
@@ -444,6 +452,12 @@ enum
     CV_CAP_PROP_XI_AEAG_LEVEL    = 419,       // Average intensity of output signal AEAG should achieve(in %)
     CV_CAP_PROP_XI_TIMEOUT       = 420,       // Image capture timeout in milliseconds
 
+    // Properties of video files read through FFmpeg
+    CV_CAP_PROP_FFMPEG_PREFETCH     = 500, // the number of frames decoded ahead by a background thread, 0 - decoding in grab()
+    CV_CAP_PROP_FFMPEG_OUTPUT_FORMAT = 501, // the layout of the retrieved frames, see CV_CAP_FFMPEG_OUTPUT_*
+    CV_CAP_PROP_FFMPEG_FRAME_INDEX  = 502, // set: CV_CAP_FFMPEG_FRAME_INDEX_*, get: the number of indexed frames
+    CV_CAP_PROP_FFMPEG_SEEK_MODE    = 503, // CV_CAP_FFMPEG_SEEK_ACCURATE (default) or CV_CAP_FFMPEG_SEEK_KEYFRAME
+
     // Properties for Android cameras
     CV_CAP_PROP_ANDROID_FLASH_MODE = 8001,
     CV_CAP_PROP_ANDROID_FOCUS_MODE = 8002,
@@ -485,6 +499,30 @@ enum
     CV_CAP_OPENNI_GRAY_IMAGE                = 6
 };
 
+// FFmpeg output formats
+enum
+{
+    CV_CAP_FFMPEG_OUTPUT_BGR  = 0, // 8UC3 BGR (default)
+    CV_CAP_FFMPEG_OUTPUT_GRAY = 1, // 8UC1 luma plane
+    CV_CAP_FFMPEG_OUTPUT_I420 = 2, // 8UC1 Y, U and V planes (height*3/2 rows), even frame sizes only
+    CV_CAP_FFMPEG_OUTPUT_NV12 = 3  // 8UC1 Y plane and interleaved UV plane (height*3/2 rows), even frame sizes only
+};
+
+// FFmpeg frame index
+enum
+{
+    CV_CAP_FFMPEG_FRAME_INDEX_NONE   = 0, // seeking relies on the demuxer (default)
+    CV_CAP_FFMPEG_FRAME_INDEX_MEMORY = 1, // scan the packets of the file once and keep the index in memory
+    CV_CAP_FFMPEG_FRAME_INDEX_FILE   = 2  // load the index from <filename>.cvindex, or build it and write the file
+};
+
+// FFmpeg seek modes
+enum
+{
+    CV_CAP_FFMPEG_SEEK_ACCURATE = 0, // the next frame is the requested one
+    CV_CAP_FFMPEG_SEEK_KEYFRAME = 1  // the next frame is the keyframe preceding the requested one
+};
+
 // Supported output modes of OpenNI image generator
 enum
 {
@@ -23,7 +23,32 @@ enum
     CV_FFMPEG_CAP_PROP_FRAME_HEIGHT=4,
     CV_FFMPEG_CAP_PROP_FPS=5,
     CV_FFMPEG_CAP_PROP_FOURCC=6,
-    CV_FFMPEG_CAP_PROP_FRAME_COUNT=7
+    CV_FFMPEG_CAP_PROP_FRAME_COUNT=7,
+    CV_FFMPEG_CAP_PROP_PREFETCH=500,
+    CV_FFMPEG_CAP_PROP_OUTPUT_FORMAT=501,
+    CV_FFMPEG_CAP_PROP_FRAME_INDEX=502,
+    CV_FFMPEG_CAP_PROP_SEEK_MODE=503
+};
+
+enum
+{
+    CV_FFMPEG_OUTPUT_BGR=0,
+    CV_FFMPEG_OUTPUT_GRAY=1,
+    CV_FFMPEG_OUTPUT_I420=2,
+    CV_FFMPEG_OUTPUT_NV12=3
+};
+
+enum
+{
+    CV_FFMPEG_FRAME_INDEX_NONE=0,
+    CV_FFMPEG_FRAME_INDEX_MEMORY=1,
+    CV_FFMPEG_FRAME_INDEX_FILE=2
+};
+
+enum
+{
+    CV_FFMPEG_SEEK_ACCURATE=0,
+    CV_FFMPEG_SEEK_KEYFRAME=1
 };
 
 
@@ -45,8 +45,10 @@
 # include <pthread.h>
 #endif
 #include <assert.h>
+#include <sys/stat.h>
 #include <algorithm>
 #include <limits>
+#include <vector>
 
 #define CALC_FFMPEG_VERSION(a,b,c) ( a<<16 | b<<8 | c )
 
@@ -156,6 +158,10 @@ extern "C" {
 #define AVERROR_EOF (-MKTAG( 'E','O','F',' '))
 #endif
 
+#ifndef AV_PKT_FLAG_KEY
+#define AV_PKT_FLAG_KEY PKT_FLAG_KEY
+#endif
+
 #if LIBAVCODEC_BUILD >= CALC_FFMPEG_VERSION(54,25,0)
 #  define CV_CODEC_ID AVCodecID
 #  define CV_CODEC(name) AV_##name
@@ -220,6 +226,147 @@ inline void _opencv_ffmpeg_free(void** ptr)
 }
 
 
+// the size and the modification time of the file
+static bool get_file_stamp( const char* path, int64_t stamp[2] )
+{
+#if defined WIN32 || defined _WIN32
+    struct _stati64 st;
+    if( _stati64( path, &st ) != 0 )
+        return false;
+#else
+    struct stat st;
+    if( stat( path, &st ) != 0 )
+        return false;
+#endif
+    stamp[0] = (int64_t)st.st_size;
+    stamp[1] = (int64_t)st.st_mtime;
+    return true;
+}
+
+// The timestamps of all the frames of the video stream, collected from the packets without decoding them.
+// It gives the exact frame numbers and the keyframe to start decoding from for any frame.
+struct CvCapture_FFMPEG_Index
+{
+    struct Packet
+    {
+        int64_t pts, dts;
+        bool key;
+        bool operator < ( const Packet& p ) const { return pts < p.pts; }
+    };
+
+    // the presentation timestamps in the presentation order, so a frame number is a position in pts
+    std::vector<int64_t> pts;
+    // the numbers of the keyframes and their decoding timestamps, which av_seek_frame() looks for
+    std::vector<int64_t> key_frames;
+    std::vector<int64_t> key_dts;
+
+    void build( std::vector<Packet>& packets );
+    int64_t frameNumber( int64_t timestamp ) const;
+    // the last keyframe at or before the frame (the first keyframe for the frames before it)
+    int keyframe( int64_t frame ) const;
+
+    // the sidecar file is valid as long as the size and the modification time of the video file do not change
+    bool load( const char* path, const int64_t source_stamp[2] );
+    bool save( const char* path, const int64_t source_stamp[2] ) const;
+};
+
+static const char CV_FFMPEG_INDEX_SIGNATURE[8] = { 'C', 'V', 'F', 'F', 'I', 'D', 'X', '2' };
+
+void CvCapture_FFMPEG_Index::build( std::vector<Packet>& packets )
+{
+    std::sort( packets.begin(), packets.end() );
+    pts.resize( packets.size() );
+    key_frames.clear();
+    key_dts.clear();
+    for( size_t i = 0; i < packets.size(); i++ )
+    {
+        pts[i] = packets[i].pts;
+        if( packets[i].key )
+        {
+            key_frames.push_back( (int64_t)i );
+            key_dts.push_back( packets[i].dts );
+        }
+    }
+}
+
+int64_t CvCapture_FFMPEG_Index::frameNumber( int64_t timestamp ) const
+{
+    return (int64_t)(std::lower_bound( pts.begin(), pts.end(), timestamp ) - pts.begin());
+}
+
+int CvCapture_FFMPEG_Index::keyframe( int64_t frame ) const
+{
+    int k = (int)(std::upper_bound( key_frames.begin(), key_frames.end(), frame ) - key_frames.begin()) - 1;
+    return std::max(k, 0);
+}
+
+bool CvCapture_FFMPEG_Index::load( const char* path, const int64_t source_stamp[2] )
+{
+    FILE* f = fopen( path, "rb" );
+    if( !f )
+        return false;
+
+    char signature[sizeof(CV_FFMPEG_INDEX_SIGNATURE)];
+    // the size and the modification time of the video file, the number of frames and keyframes
+    int64_t header[4] = { 0, 0, 0, 0 };
+    int64_t sidecar_stamp[2] = { 0, 0 };
+    bool ok = fread( signature, 1, sizeof(signature), f ) == sizeof(signature) &&
+              memcmp( signature, CV_FFMPEG_INDEX_SIGNATURE, sizeof(signature) ) == 0 &&
+              fread( header, sizeof(header[0]), 4, f ) == 4 &&
+              header[0] == source_stamp[0] && header[1] == source_stamp[1] &&
+              header[2] > 0 && header[3] >= 0 && header[3] <= header[2] &&
+              get_file_stamp( path, sidecar_stamp );
+    // a damaged file must not make the vectors below allocate more than the file holds
+    if( ok )
+    {
+        int64_t payload = sidecar_stamp[0] - (int64_t)(sizeof(signature) + sizeof(header));
+        ok = header[2] <= payload / (int64_t)sizeof(int64_t) &&
+             header[2]*(int64_t)sizeof(int64_t) + header[3]*(int64_t)(2*sizeof(int64_t)) == payload;
+    }
+    if( ok )
+    {
+        pts.resize( (size_t)header[2] );
+        key_frames.resize( (size_t)header[3] );
+        key_dts.resize( (size_t)header[3] );
+        ok = fread( &pts[0], sizeof(pts[0]), pts.size(), f ) == pts.size() &&
+             (key_frames.empty() ||
+              (fread( &key_frames[0], sizeof(key_frames[0]), key_frames.size(), f ) == key_frames.size() &&
+               fread( &key_dts[0], sizeof(key_dts[0]), key_dts.size(), f ) == key_dts.size()));
+    }
+    fclose( f );
+
+    if( !ok )
+    {
+        pts.clear();
+        key_frames.clear();
+        key_dts.clear();
+    }
+    return ok;
+}
+
+bool CvCapture_FFMPEG_Index::save( const char* path, const int64_t source_stamp[2] ) const
+{
+    if( pts.empty() )
+        return false;
+    FILE* f = fopen( path, "wb" );
+    if( !f )
+        return false;
+
+    int64_t header[4] = { source_stamp[0], source_stamp[1], (int64_t)pts.size(), (int64_t)key_frames.size() };
+    bool ok = fwrite( CV_FFMPEG_INDEX_SIGNATURE, 1, sizeof(CV_FFMPEG_INDEX_SIGNATURE), f ) == sizeof(CV_FFMPEG_INDEX_SIGNATURE) &&
+              fwrite( header, sizeof(header[0]), 4, f ) == 4 &&
+              fwrite( &pts[0], sizeof(pts[0]), pts.size(), f ) == pts.size() &&
+              (key_frames.empty() ||
+               (fwrite( &key_frames[0], sizeof(key_frames[0]), key_frames.size(), f ) == key_frames.size() &&
+                fwrite( &key_dts[0], sizeof(key_dts[0]), key_dts.size(), f ) == key_dts.size()));
+    fclose( f );
+
+    if( !ok )
+        remove( path );
+    return ok;
+}
+
+
 struct CvCapture_FFMPEG
 {
     bool open( const char* filename );
@@ -232,9 +379,19 @@ struct CvCapture_FFMPEG
 
     void init();
 
+    bool    decodeFrame();
+    bool    convertFrame(AVFrame* dst, Image_FFMPEG* image, bool zero_copy);
+    int     get_output_format();
+    bool    startPrefetch(int size);
+    void    stopPrefetch(bool restore_position);
+
     void    seek(int64_t frame_number);
     void    seek(double sec);
+    void    seekKeyframe(int64_t frame_number);
     bool    slowSeek( int framenumber );
+    bool    setFrameIndex(int mode);
+    bool    scanFrameIndex(CvCapture_FFMPEG_Index* index);
+    int64_t picture_frame_number();
 
     int64_t get_total_frames();
     double  get_duration_sec();
@@ -256,9 +413,20 @@ struct CvCapture_FFMPEG
     AVPacket          packet;
     Image_FFMPEG      frame;
     struct SwsContext *img_convert_ctx;
+    struct SwsContext *yuv_convert_ctx;
+    int               output_format;
 
     int64_t frame_number, first_frame_number;
 
+    // the frames decoded ahead by a background thread, 0 if the frames are decoded in grabFrame()
+    struct CvCapture_FFMPEG_Prefetch* prefetch;
+
+    CvCapture_FFMPEG_Index* frame_index;
+    int               seek_mode;
+    // the keyframe seeking has decoded the picture that the next grabFrame() returns
+    bool              picture_pending;
+    char            * source_path;
+
     double eps_zero;
 /*
    'filename' contains the filename of the videosource,
@@ -284,21 +452,36 @@ void CvCapture_FFMPEG::init()
     memset(&packet, 0, sizeof(packet));
     av_init_packet(&packet);
     img_convert_ctx = 0;
+    yuv_convert_ctx = 0;
+    output_format = CV_FFMPEG_OUTPUT_BGR;
 
     avcodec = 0;
     frame_number = 0;
+    prefetch = 0;
+    frame_index = 0;
+    seek_mode = CV_FFMPEG_SEEK_ACCURATE;
+    picture_pending = false;
+    source_path = 0;
     eps_zero = 0.000025;
 }
 
 
 void CvCapture_FFMPEG::close()
 {
+    stopPrefetch(false);
+
     if( img_convert_ctx )
     {
         sws_freeContext(img_convert_ctx);
         img_convert_ctx = 0;
     }
 
+    if( yuv_convert_ctx )
+    {
+        sws_freeContext(yuv_convert_ctx);
+        yuv_convert_ctx = 0;
+    }
+
     if( picture )
         av_free(picture);
 
@@ -337,6 +520,9 @@ void CvCapture_FFMPEG::close()
         packet.data = NULL;
     }
 
+    delete frame_index;
+    free( source_path );
+
     init();
 }
 
@@ -468,6 +654,187 @@ void ImplMutex::lock() { impl->lock(); }
 void ImplMutex::unlock() { impl->unlock(); }
 bool ImplMutex::trylock() { return impl->trylock(); }
 
+#if !(defined WIN32 || defined _WIN32 || defined WINCE) || _WIN32_WINNT >= 0x0600
+#define CV_FFMPEG_PREFETCH 1
+#endif
+
+#ifdef CV_FFMPEG_PREFETCH
+
+// A bounded queue of the frames decoded and converted to BGR ahead of grabFrame() by a background thread.
+// It keeps size + 1 pictures: the thread fills at most size of them, the extra one is the picture
+// returned by the last grabFrame(), which stays valid until the next call.
+struct CvCapture_FFMPEG_Prefetch
+{
+    struct Slot
+    {
+        AVFrame picture;
+        Image_FFMPEG image;
+        int64_t frame_number;
+    };
+
+    CvCapture_FFMPEG_Prefetch( CvCapture_FFMPEG* _capture, int size );
+    ~CvCapture_FFMPEG_Prefetch();
+
+    bool pop();
+    const Slot* current() const { return cur >= 0 ? &slots[cur] : 0; }
+    // the number of the frames returned by pop(), the same as CvCapture_FFMPEG::frame_number in the synchronous mode
+    int64_t position() const { return cur >= 0 ? slots[cur].frame_number : start_frame_number; }
+    int size() const { return (int)slots.size() - 1; }
+
+    void run();
+    void lock();
+    void unlock();
+    void wait();
+    void notify();
+
+    CvCapture_FFMPEG* capture;
+    std::vector<Slot> slots;
+    int first, count, cur;
+    int64_t start_frame_number;
+    bool stop, eof, running;
+
+#if defined WIN32 || defined _WIN32 || defined WINCE
+    CRITICAL_SECTION cs;
+    CONDITION_VARIABLE cond;
+    HANDLE thread;
+
+    static DWORD WINAPI threadFunc( LPVOID arg )
+    {
+        ((CvCapture_FFMPEG_Prefetch*)arg)->run();
+        return 0;
+    }
+#else
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    pthread_t thread;
+
+    static void* threadFunc( void* arg )
+    {
+        ((CvCapture_FFMPEG_Prefetch*)arg)->run();
+        return 0;
+    }
+#endif
+};
+
+#if defined WIN32 || defined _WIN32 || defined WINCE
+void CvCapture_FFMPEG_Prefetch::lock() { EnterCriticalSection(&cs); }
+void CvCapture_FFMPEG_Prefetch::unlock() { LeaveCriticalSection(&cs); }
+void CvCapture_FFMPEG_Prefetch::wait() { SleepConditionVariableCS(&cond, &cs, INFINITE); }
+void CvCapture_FFMPEG_Prefetch::notify() { WakeAllConditionVariable(&cond); }
+#else
+void CvCapture_FFMPEG_Prefetch::lock() { pthread_mutex_lock(&mutex); }
+void CvCapture_FFMPEG_Prefetch::unlock() { pthread_mutex_unlock(&mutex); }
+void CvCapture_FFMPEG_Prefetch::wait() { pthread_cond_wait(&cond, &mutex); }
+void CvCapture_FFMPEG_Prefetch::notify() { pthread_cond_broadcast(&cond); }
+#endif
+
+CvCapture_FFMPEG_Prefetch::CvCapture_FFMPEG_Prefetch( CvCapture_FFMPEG* _capture, int size ) :
+    capture(_capture), slots(size + 1), first(0), count(0), cur(-1),
+    start_frame_number(_capture->frame_number), stop(false), eof(false), running(false)
+{
+    int width = capture->video_st->codec->width, height = capture->video_st->codec->height;
+    for( size_t i = 0; i < slots.size(); i++ )
+    {
+        Slot& slot = slots[i];
+        memset( &slot.picture, 0, sizeof(slot.picture) );
+        slot.picture.data[0] = (uint8_t*)malloc( avpicture_get_size( PIX_FMT_BGR24, width, height ) );
+        avpicture_fill( (AVPicture*)&slot.picture, slot.picture.data[0], PIX_FMT_BGR24, width, height );
+        memset( &slot.image, 0, sizeof(slot.image) );
+        slot.frame_number = 0;
+    }
+
+#if defined WIN32 || defined _WIN32 || defined WINCE
+    InitializeCriticalSection(&cs);
+    InitializeConditionVariable(&cond);
+    thread = CreateThread( NULL, 0, threadFunc, this, 0, NULL );
+    running = thread != NULL;
+#else
+    pthread_mutex_init(&mutex, 0);
+    pthread_cond_init(&cond, 0);
+    running = pthread_create( &thread, 0, threadFunc, this ) == 0;
+#endif
+}
+
+CvCapture_FFMPEG_Prefetch::~CvCapture_FFMPEG_Prefetch()
+{
+    lock();
+    stop = true;
+    notify();
+    unlock();
+
+#if defined WIN32 || defined _WIN32 || defined WINCE
+    if( running )
+    {
+        WaitForSingleObject( thread, INFINITE );
+        CloseHandle( thread );
+    }
+    DeleteCriticalSection(&cs);
+#else
+    if( running )
+        pthread_join( thread, 0 );
+    pthread_cond_destroy(&cond);
+    pthread_mutex_destroy(&mutex);
+#endif
+
+    for( size_t i = 0; i < slots.size(); i++ )
+        free( slots[i].picture.data[0] );
+}
+
+void CvCapture_FFMPEG_Prefetch::run()
+{
+    int n = (int)slots.size();
+    for(;;)
+    {
+        lock();
+        while( !stop && count >= n - 1 )
+            wait();
+        if( stop )
+        {
+            unlock();
+            break;
+        }
+        // neither the queued pictures nor the current one are touched by the caller's thread
+        Slot& slot = slots[(first + count) % n];
+        unlock();
+
+        // the decoder reuses its picture for the next frame, so the planes are always copied
+        bool ok = capture->decodeFrame() && capture->convertFrame( &slot.picture, &slot.image, false );
+
+        lock();
+        if( ok )
+        {
+            slot.frame_number = capture->frame_number;
+            count++;
+        }
+        else
+            eof = true;
+        notify();
+        unlock();
+
+        if( !ok )
+            break;
+    }
+}
+
+bool CvCapture_FFMPEG_Prefetch::pop()
+{
+    lock();
+    while( count == 0 && !eof )
+        wait();
+    bool ok = count > 0;
+    if( ok )
+    {
+        cur = first;
+        first = (first + 1) % (int)slots.size();
+        count--;
+        notify();
+    }
+    unlock();
+    return ok;
+}
+
+#endif
+
 static int LockCallBack(void **mutex, AVLockOp op)
 {
     ImplMutex* localMutex = reinterpret_cast<ImplMutex*>(*mutex);
@@ -577,6 +944,10 @@ bool CvCapture_FFMPEG::open( const char* _filename )
 //#else
         enc->thread_count = get_number_of_cpus();
 //#endif
+#ifdef FF_THREAD_FRAME
+        // decode several frames at once, and the slices of a frame in parallel when the codec supports it
+        enc->thread_type = FF_THREAD_FRAME | FF_THREAD_SLICE;
+#endif
 
 #if LIBAVFORMAT_BUILD < CALC_FFMPEG_VERSION(53, 2, 0)
 #define AVMEDIA_TYPE_VIDEO CODEC_TYPE_VIDEO
@@ -621,7 +992,13 @@ bool CvCapture_FFMPEG::open( const char* _filename )
         }
     }
 
-    if(video_stream >= 0) valid = true;
+    if(video_stream >= 0)
+    {
+        valid = true;
+        // kept for the sidecar file of the frame index
+        source_path = (char*)malloc( strlen(_filename) + 1 );
+        strcpy( source_path, _filename );
+    }
 
 exit_func:
 
@@ -632,7 +1009,49 @@ exit_func:
 }
 
 
+bool CvCapture_FFMPEG::startPrefetch( int size )
+{
+    stopPrefetch(true);
+    if( size <= 0 )
+        return true;
+#ifdef CV_FFMPEG_PREFETCH
+    prefetch = new CvCapture_FFMPEG_Prefetch(this, size);
+    if( !prefetch->running )
+    {
+        delete prefetch;
+        prefetch = 0;
+    }
+#endif
+    return prefetch != 0;
+}
+
+// stops the background thread; the frames it decoded ahead are dropped, so with restore_position
+// the stream is sought back to the frame that grabFrame() returned last
+void CvCapture_FFMPEG::stopPrefetch( bool restore_position )
+{
+#ifdef CV_FFMPEG_PREFETCH
+    if( !prefetch )
+        return;
+    int64_t position = prefetch->position();
+    delete prefetch;
+    prefetch = 0;
+    if( restore_position && position != frame_number )
+        seek(position);
+#else
+    (void)restore_position;
+#endif
+}
+
 bool CvCapture_FFMPEG::grabFrame()
+{
+#ifdef CV_FFMPEG_PREFETCH
+    if( prefetch )
+        return prefetch->pop();
+#endif
+    return decodeFrame();
+}
+
+bool CvCapture_FFMPEG::decodeFrame()
 {
     bool valid = false;
     int got_picture;
@@ -642,6 +1061,13 @@ bool CvCapture_FFMPEG::grabFrame()
 
     if( !ic || !video_st )  return false;
 
+    if( picture_pending )
+    {
+        picture_pending = false;
+        frame_number++;
+        return true;
+    }
+
     if( ic->streams[video_stream]->nb_frames > 0 &&
         frame_number > ic->streams[video_stream]->nb_frames )
         return false;
@@ -650,13 +1076,23 @@ bool CvCapture_FFMPEG::grabFrame()
 
     picture_pts = AV_NOPTS_VALUE_;
 
+    bool draining = false;
+
     // get the next frame
     while (!valid)
     {
-        int ret = av_read_frame(ic, &packet);
+        int ret = draining ? 0 : av_read_frame(ic, &packet);
         if (ret == AVERROR(EAGAIN)) continue;
 
-        /* else if (ret < 0) break; */
+        if (ret < 0)
+        {
+            // the end of the file: empty packets flush the frames still held by the decoder threads
+            av_init_packet(&packet);
+            packet.data = NULL;
+            packet.size = 0;
+            packet.stream_index = video_stream;
+            draining = true;
+        }
 
         if( packet.stream_index != video_stream )
         {
@@ -684,6 +1120,11 @@ bool CvCapture_FFMPEG::grabFrame()
         if(got_picture)
         {
             //picture_pts = picture->best_effort_timestamp;
+#if LIBAVFORMAT_BUILD >= CALC_FFMPEG_VERSION(53, 2, 0)
+            // with frame threads the picture comes from an earlier packet than the last one read
+            if( picture_pts == AV_NOPTS_VALUE_ )
+                picture_pts = picture->pkt_pts != AV_NOPTS_VALUE_ && picture->pkt_pts != 0 ? picture->pkt_pts : picture->pkt_dts;
+#endif
             if( picture_pts == AV_NOPTS_VALUE_ )
                 picture_pts = packet.pts != AV_NOPTS_VALUE_ && packet.pts != 0 ? packet.pts : packet.dts;
             frame_number++;
@@ -691,6 +1132,8 @@ bool CvCapture_FFMPEG::grabFrame()
         }
         else
         {
+            if (draining)
+                break;
             count_errs++;
             if (count_errs > max_number_of_attempts)
                 break;
@@ -709,10 +1152,147 @@ bool CvCapture_FFMPEG::grabFrame()
 
 bool CvCapture_FFMPEG::retrieveFrame(int, unsigned char** data, int* step, int* width, int* height, int* cn)
 {
-    if( !video_st || !picture->data[0] )
+#ifdef CV_FFMPEG_PREFETCH
+    if( prefetch )
+    {
+        // the frame has been converted by the background thread already
+        const CvCapture_FFMPEG_Prefetch::Slot* slot = prefetch->current();
+        if( !slot )
+            return false;
+        *data = slot->image.data;
+        *step = slot->image.step;
+        *width = slot->image.width;
+        *height = slot->image.height;
+        *cn = slot->image.cn;
+        return true;
+    }
+#endif
+
+    Image_FFMPEG image;
+    if( !video_st || !picture->data[0] || !convertFrame(&rgb_picture, &image, true) )
+        return false;
+
+    *data = image.data;
+    *step = image.step;
+    *width = image.width;
+    *height = image.height;
+    *cn = image.cn;
+
+    return true;
+}
+
+// 8-bit planar formats with the full resolution luma plane in data[0]
+static bool hasLumaPlane( int pix_fmt )
+{
+    switch( pix_fmt )
+    {
+    case PIX_FMT_GRAY8:
+    case PIX_FMT_YUV420P:
+    case PIX_FMT_YUVJ420P:
+    case PIX_FMT_YUV422P:
+    case PIX_FMT_YUVJ422P:
+    case PIX_FMT_YUV444P:
+    case PIX_FMT_YUVJ444P:
+    case PIX_FMT_YUV410P:
+    case PIX_FMT_YUV411P:
+    case PIX_FMT_NV12:
+    case PIX_FMT_NV21:
+        return true;
+    default:
         return false;
+    }
+}
+
+// copies the rows of a plane one after another, returns the end of the copied data
+static unsigned char* copyPlane( unsigned char* dst, const uint8_t* src, int src_step, int width, int height )
+{
+    for( int y = 0; y < height; y++, dst += width )
+        memcpy( dst, src + (size_t)src_step*y, width );
+    return dst;
+}
+
+// the layout of the frames retrieveFrame() returns for the requested output format:
+// YUV frames are NV12 if the stream is decoded to NV12, I420 otherwise
+int CvCapture_FFMPEG::get_output_format()
+{
+    if( output_format == CV_FFMPEG_OUTPUT_BGR || output_format == CV_FFMPEG_OUTPUT_GRAY )
+        return output_format;
+    return video_st->codec->pix_fmt == PIX_FMT_NV12 ? CV_FFMPEG_OUTPUT_NV12 : CV_FFMPEG_OUTPUT_I420;
+}
+
+// gives the last decoded picture in the output format. The BGR frames are converted into dst.
+// The GRAY and YUV frames wrap the decoded planes if zero_copy is set and their layout allows it,
+// otherwise the planes are copied into dst; the formats without such planes are converted with sws_scale
+bool CvCapture_FFMPEG::convertFrame( AVFrame* dst, Image_FFMPEG* image, bool zero_copy )
+{
+    int width = video_st->codec->width, height = video_st->codec->height;
+    int pix_fmt = video_st->codec->pix_fmt;
+    int format = get_output_format();
+    unsigned char* buf = dst->data[0];
+
+    if( format == CV_FFMPEG_OUTPUT_GRAY || format == CV_FFMPEG_OUTPUT_I420 || format == CV_FFMPEG_OUTPUT_NV12 )
+    {
+        bool gray = format == CV_FFMPEG_OUTPUT_GRAY;
+        bool nv12 = format == CV_FFMPEG_OUTPUT_NV12;
+        bool i420 = format == CV_FFMPEG_OUTPUT_I420 &&
+                    (pix_fmt == PIX_FMT_YUV420P || pix_fmt == PIX_FMT_YUVJ420P);
+        int step0 = picture->linesize[0];
+
+        image->width = width;
+        image->height = gray ? height : height*3/2;
+        image->cn = 1;
+
+        if( (gray && hasLumaPlane(pix_fmt)) || nv12 || i420 )
+        {
+            // OpenCV keeps the I420 chroma rows packed two per row, so they can be wrapped only without padding
+            bool wrap = zero_copy &&
+                (gray ||
+                 (nv12 && picture->data[1] == picture->data[0] + (size_t)step0*height &&
+                  picture->linesize[1] == step0) ||
+                 (i420 && step0 == width && picture->linesize[1] == width/2 && picture->linesize[2] == width/2 &&
+                  picture->data[1] == picture->data[0] + (size_t)width*height &&
+                  picture->data[2] == picture->data[1] + (size_t)width*height/4));
+
+            if( wrap )
+            {
+                image->data = picture->data[0];
+                image->step = step0;
+                return true;
+            }
+
+            unsigned char* ptr = copyPlane( buf, picture->data[0], step0, width, height );
+            if( nv12 )
+                copyPlane( ptr, picture->data[1], picture->linesize[1], width, height/2 );
+            else if( i420 )
+            {
+                ptr = copyPlane( ptr, picture->data[1], picture->linesize[1], width/2, height/2 );
+                copyPlane( ptr, picture->data[2], picture->linesize[2], width/2, height/2 );
+            }
+            image->data = buf;
+            image->step = width;
+            return true;
+        }
+
+        // the frames without a luma plane (e.g. RGB codecs) are converted to the packed GRAY or I420 layout
+        yuv_convert_ctx = sws_getCachedContext(
+                yuv_convert_ctx,
+                width, height, video_st->codec->pix_fmt,
+                width, height, gray ? PIX_FMT_GRAY8 : PIX_FMT_YUV420P,
+                SWS_BICUBIC,
+                NULL, NULL, NULL
+                );
+        if( yuv_convert_ctx == NULL )
+            return false;
 
-    avpicture_fill((AVPicture*)&rgb_picture, rgb_picture.data[0], PIX_FMT_RGB24,
+        uint8_t* planes[4] = { buf, buf + width*height, buf + width*height*5/4, 0 };
+        int steps[4] = { width, width/2, width/2, 0 };
+        sws_scale( yuv_convert_ctx, picture->data, picture->linesize, 0, height, planes, steps );
+        image->data = buf;
+        image->step = width;
+        return true;
+    }
+
+    avpicture_fill((AVPicture*)dst, dst->data[0], PIX_FMT_RGB24,
                    video_st->codec->width, video_st->codec->height);
 
     if( img_convert_ctx == NULL ||
@@ -744,16 +1324,15 @@ bool CvCapture_FFMPEG::retrieveFrame(int, unsigned char** data, int* step, int*
             picture->data,
             picture->linesize,
             0, video_st->codec->height,
-            rgb_picture.data,
-            rgb_picture.linesize
+            dst->data,
+            dst->linesize
             );
 
-    *data = frame.data;
-    *step = frame.step;
-    *width = frame.width;
-    *height = frame.height;
-    *cn = frame.cn;
-
+    image->data = dst->data[0];
+    image->step = dst->linesize[0];
+    image->width = frame.width;
+    image->height = frame.height;
+    image->cn = 3;
     return true;
 }
 
@@ -762,12 +1341,19 @@ double CvCapture_FFMPEG::getProperty( int property_id )
 {
     if( !video_st ) return 0;
 
+    // with the prefetching, the decoder runs ahead of the frames returned by grabFrame()
+    int64_t position = frame_number;
+#ifdef CV_FFMPEG_PREFETCH
+    if( prefetch )
+        position = prefetch->position();
+#endif
+
     switch( property_id )
     {
     case CV_FFMPEG_CAP_PROP_POS_MSEC:
-        return 1000.0*(double)frame_number/get_fps();
+        return 1000.0*(double)position/get_fps();
     case CV_FFMPEG_CAP_PROP_POS_FRAMES:
-        return (double)frame_number;
+        return (double)position;
     case CV_FFMPEG_CAP_PROP_POS_AVI_RATIO:
         return r2d(ic->streams[video_stream]->time_base);
     case CV_FFMPEG_CAP_PROP_FRAME_COUNT:
@@ -789,6 +1375,18 @@ double CvCapture_FFMPEG::getProperty( int property_id )
 #else
         return (double)video_st->codec.codec_tag;
 #endif
+    case CV_FFMPEG_CAP_PROP_PREFETCH:
+#ifdef CV_FFMPEG_PREFETCH
+        return prefetch ? (double)prefetch->size() : 0;
+#else
+        return 0;
+#endif
+    case CV_FFMPEG_CAP_PROP_OUTPUT_FORMAT:
+        return (double)get_output_format();
+    case CV_FFMPEG_CAP_PROP_FRAME_INDEX:
+        return frame_index ? (double)frame_index->pts.size() : 0;
+    case CV_FFMPEG_CAP_PROP_SEEK_MODE:
+        return (double)seek_mode;
     default:
         break;
     }
@@ -844,6 +1442,9 @@ double CvCapture_FFMPEG::get_fps()
 
 int64_t CvCapture_FFMPEG::get_total_frames()
 {
+    if( frame_index )
+        return (int64_t)frame_index->pts.size();
+
     int64_t nbf = ic->streams[video_stream]->nb_frames;
 
     if (nbf == 0)
@@ -867,13 +1468,20 @@ double CvCapture_FFMPEG::dts_to_sec(int64_t dts)
 
 void CvCapture_FFMPEG::seek(int64_t _frame_number)
 {
+    if( frame_index || seek_mode == CV_FFMPEG_SEEK_KEYFRAME )
+    {
+        seekKeyframe(_frame_number);
+        return;
+    }
+
+    picture_pending = false;
     _frame_number = std::min(_frame_number, get_total_frames());
     int delta = 16;
 
     // if we have not grabbed a single frame before first seek, let's read the first frame
     // and get some valuable information during the process
     if( first_frame_number < 0 && get_total_frames() > 1 )
-        grabFrame();
+        decodeFrame();
 
     for(;;)
     {
@@ -886,7 +1494,7 @@ void CvCapture_FFMPEG::seek(int64_t _frame_number)
         avcodec_flush_buffers(ic->streams[video_stream]->codec);
         if( _frame_number > 0 )
         {
-            grabFrame();
+            decodeFrame();
 
             if( _frame_number > 1 )
             {
@@ -903,7 +1511,7 @@ void CvCapture_FFMPEG::seek(int64_t _frame_number)
                 }
                 while( frame_number < _frame_number-1 )
                 {
-                    if(!grabFrame())
+                    if(!decodeFrame())
                         break;
                 }
                 frame_number++;
@@ -923,6 +1531,168 @@ void CvCapture_FFMPEG::seek(int64_t _frame_number)
     }
 }
 
+// the number of the last decoded frame, exact with the frame index
+int64_t CvCapture_FFMPEG::picture_frame_number()
+{
+    if( frame_index )
+    {
+        int64_t pts = picture_pts;
+#if LIBAVFORMAT_BUILD >= CALC_FFMPEG_VERSION(53, 2, 0)
+        // with B-frames the picture comes from an earlier packet than the last one read
+        if( picture->pkt_pts != AV_NOPTS_VALUE_ )
+            pts = picture->pkt_pts;
+#endif
+        return frame_index->frameNumber(pts);
+    }
+    return dts_to_frame_number(picture_pts) - first_frame_number;
+}
+
+// Jumps to the keyframe preceding the frame, found in the frame index or by av_seek_frame() itself.
+// In the accurate mode the frames are then decoded up to the requested one, which only needs
+// the frame index to know where the decoder is. In the keyframe mode the next grabFrame()
+// returns the keyframe, and CAP_PROP_POS_FRAMES gives its number.
+void CvCapture_FFMPEG::seekKeyframe(int64_t _frame_number)
+{
+    _frame_number = std::max(std::min(_frame_number, get_total_frames()), (int64_t)0);
+    picture_pending = false;
+
+    // the frame numbers are counted from the first frame without the index
+    if( !frame_index && first_frame_number < 0 && get_total_frames() > 1 )
+        decodeFrame();
+
+    int64_t time_stamp, key_frame = -1;
+    if( frame_index )
+    {
+        int k = frame_index->keyframe(_frame_number);
+        if( !frame_index->key_frames.empty() )
+        {
+            key_frame = frame_index->key_frames[k];
+            time_stamp = frame_index->key_dts[k];
+        }
+        else
+            time_stamp = frame_index->pts[0];
+    }
+    else
+    {
+        double sec = (double)_frame_number / get_fps();
+        time_stamp = ic->streams[video_stream]->start_time;
+        time_stamp += (int64_t)(sec / r2d(ic->streams[video_stream]->time_base) + 0.5);
+    }
+
+    av_seek_frame(ic, video_stream, time_stamp, AVSEEK_FLAG_BACKWARD);
+    avcodec_flush_buffers(ic->streams[video_stream]->codec);
+    // decodeFrame() stops past the last frame, so the position before the seek must not be kept
+    frame_number = std::max(key_frame, (int64_t)0);
+
+    if( seek_mode == CV_FFMPEG_SEEK_ACCURATE )
+    {
+        // the next grabFrame() must return the requested frame, so the decoding stops at the one before it
+        if( key_frame < 0 || key_frame < _frame_number )
+        {
+            while( decodeFrame() )
+            {
+                if( picture_frame_number() >= _frame_number - 1 )
+                    break;
+            }
+        }
+        frame_number = _frame_number;
+        return;
+    }
+
+    // the number of the keyframe is known only after it is decoded; grabFrame() returns this picture next
+    if( !decodeFrame() )
+    {
+        frame_number = _frame_number;
+        return;
+    }
+    frame_number = picture_frame_number();
+    picture_pending = true;
+}
+
+// collects the timestamps of all the packets of the video stream; the packets are not decoded
+bool CvCapture_FFMPEG::scanFrameIndex( CvCapture_FFMPEG_Index* index )
+{
+    std::vector<CvCapture_FFMPEG_Index::Packet> packets;
+    int64_t start_time = ic->streams[video_stream]->start_time;
+
+    av_free_packet (&packet);
+    if( av_seek_frame(ic, video_stream, start_time != AV_NOPTS_VALUE_ ? start_time : 0, AVSEEK_FLAG_BACKWARD) < 0 )
+        return false;
+
+    for(;;)
+    {
+        int ret = av_read_frame(ic, &packet);
+        if (ret == AVERROR(EAGAIN)) continue;
+        if (ret < 0) break;
+
+        if( packet.stream_index == video_stream &&
+            (packet.pts != AV_NOPTS_VALUE_ || packet.dts != AV_NOPTS_VALUE_) )
+        {
+            CvCapture_FFMPEG_Index::Packet p;
+            p.pts = packet.pts != AV_NOPTS_VALUE_ ? packet.pts : packet.dts;
+            p.dts = packet.dts != AV_NOPTS_VALUE_ ? packet.dts : packet.pts;
+            p.key = (packet.flags & AV_PKT_FLAG_KEY) != 0;
+            packets.push_back(p);
+        }
+        av_free_packet (&packet);
+    }
+
+    index->build(packets);
+    return !index->pts.empty();
+}
+
+// 0 - drops the frame index, 1 - builds it, 2 - loads it from the sidecar file next to the video,
+// or builds it and writes the file
+bool CvCapture_FFMPEG::setFrameIndex( int mode )
+{
+    // the background thread reads the same demuxer
+    int prefetch_size = (int)getProperty(CV_FFMPEG_CAP_PROP_PREFETCH);
+    stopPrefetch(true);
+
+    int64_t position = frame_number;
+    bool ok = true, scanned = false;
+    delete frame_index;
+    frame_index = 0;
+
+    if( mode > 0 )
+    {
+        CvCapture_FFMPEG_Index* index = new CvCapture_FFMPEG_Index;
+        const char ext[] = ".cvindex";
+        char* sidecar_path = 0;
+        int64_t source_stamp[2] = { -1, -1 };
+        bool stamped = false;
+        if( mode == CV_FFMPEG_FRAME_INDEX_FILE && source_path )
+        {
+            sidecar_path = (char*)malloc( strlen(source_path) + sizeof(ext) );
+            strcpy( sidecar_path, source_path );
+            strcat( sidecar_path, ext );
+            stamped = get_file_stamp( source_path, source_stamp );
+        }
+
+        ok = sidecar_path && stamped && index->load( sidecar_path, source_stamp );
+        if( !ok )
+        {
+            scanned = true;
+            ok = scanFrameIndex( index );
+            // the index is still usable when the file can not be written, e.g. in a read-only directory
+            if( ok && sidecar_path && stamped )
+                index->save( sidecar_path, source_stamp );
+        }
+        free( sidecar_path );
+
+        if( ok )
+            frame_index = index;
+        else
+            delete index;
+    }
+
+    if( scanned )
+        seek(position);
+    if( prefetch_size > 0 )
+        startPrefetch(prefetch_size);
+    return ok;
+}
+
 void CvCapture_FFMPEG::seek(double sec)
 {
     seek((int64_t)(sec * get_fps() + 0.5));
@@ -938,6 +1708,10 @@ bool CvCapture_FFMPEG::setProperty( int property_id, double value )
     case CV_FFMPEG_CAP_PROP_POS_FRAMES:
     case CV_FFMPEG_CAP_PROP_POS_AVI_RATIO:
         {
+            // the queued frames are dropped and decoded again from the new position
+            int prefetch_size = (int)getProperty(CV_FFMPEG_CAP_PROP_PREFETCH);
+            stopPrefetch(false);
+
             switch( property_id )
             {
             case CV_FFMPEG_CAP_PROP_POS_FRAMES:
@@ -954,8 +1728,37 @@ bool CvCapture_FFMPEG::setProperty( int property_id, double value )
             }
 
             picture_pts=(int64_t)value;
+
+            if( prefetch_size > 0 )
+                startPrefetch(prefetch_size);
+        }
+        break;
+    case CV_FFMPEG_CAP_PROP_PREFETCH:
+        return startPrefetch((int)value);
+    case CV_FFMPEG_CAP_PROP_OUTPUT_FORMAT:
+        {
+            int format = (int)value;
+            if( format < CV_FFMPEG_OUTPUT_BGR || format > CV_FFMPEG_OUTPUT_NV12 )
+                return false;
+            // the chroma planes of the odd sizes do not fit the single matrix layout
+            if( (format == CV_FFMPEG_OUTPUT_I420 || format == CV_FFMPEG_OUTPUT_NV12) &&
+                (video_st->codec->width % 2 != 0 || video_st->codec->height % 2 != 0) )
+                return false;
+            // the queued frames have been converted to the previous format
+            int prefetch_size = (int)getProperty(CV_FFMPEG_CAP_PROP_PREFETCH);
+            stopPrefetch(true);
+            output_format = format;
+            if( prefetch_size > 0 )
+                startPrefetch(prefetch_size);
         }
         break;
+    case CV_FFMPEG_CAP_PROP_FRAME_INDEX:
+        return setFrameIndex((int)value);
+    case CV_FFMPEG_CAP_PROP_SEEK_MODE:
+        if( (int)value != CV_FFMPEG_SEEK_ACCURATE && (int)value != CV_FFMPEG_SEEK_KEYFRAME )
+            return false;
+        seek_mode = (int)value;
+        break;
     default:
         return false;
     }
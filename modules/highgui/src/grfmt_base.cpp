@@ -51,6 +51,7 @@ BaseImageDecoder::BaseImageDecoder()
 {
     m_width = m_height = 0;
     m_type = -1;
+    m_scale_denom = 1;
     m_buf_supported = false;
 }
 
@@ -58,6 +59,7 @@ bool BaseImageDecoder::setSource( const String& filename )
 {
     m_filename = filename;
     m_buf.release();
+    m_region_cache.release();
     return true;
 }
 
@@ -67,9 +69,36 @@ bool BaseImageDecoder::setSource( const Mat& buf )
         return false;
     m_filename = String();
     m_buf = buf;
+    m_region_cache.release();
     return true;
 }
 
+bool BaseImageDecoder::setScale( int scale_denom )
+{
+    return scale_denom == 1;
+}
+
+bool BaseImageDecoder::readRegion( Mat& img, Rect roi )
+{
+    CV_Assert( (roi & Rect(0, 0, m_width, m_height)) == roi && img.size() == roi.size() );
+    if( m_region_cache.type() != img.type() || m_region_cache.empty() )
+    {
+        m_region_cache.create( m_height, m_width, img.type() );
+        if( !readData( m_region_cache ) )
+        {
+            m_region_cache.release();
+            return false;
+        }
+    }
+    m_region_cache(roi).copyTo( img );
+    return true;
+}
+
+bool BaseImageDecoder::nextPage()
+{
+    return false;
+}
+
 size_t BaseImageDecoder::signatureLength() const
 {
     return m_signature.size();
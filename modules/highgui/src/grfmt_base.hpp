@@ -67,8 +67,18 @@ public:
 
     virtual bool setSource( const String& filename );
     virtual bool setSource( const Mat& buf );
+    // asks to decode the image reduced scale_denom times; must be called before readHeader().
+    // returns false if the decoder can not do it, then the image is decoded at the full size
+    virtual bool setScale( int scale_denom );
     virtual bool readHeader() = 0;
     virtual bool readData( Mat& img ) = 0;
+    // decodes the rectangle roi of the image into img, which has the size of roi and the requested type;
+    // can be called several times after readHeader(). The decoders that stream the image are fastest when
+    // the regions go from top to bottom; the default implementation decodes the whole image once
+    virtual bool readRegion( Mat& img, Rect roi );
+    // moves to the next page of a multi-page image after readData(); width(), height() and type()
+    // then describe the new page. Returns false if there are no more pages (the default)
+    virtual bool nextPage();
 
     virtual size_t signatureLength() const;
     virtual bool checkSignature( const String& signature ) const;
@@ -78,10 +88,12 @@ protected:
     int  m_width;  // width  of the image ( filled by readHeader )
     int  m_height; // height of the image ( filled by readHeader )
     int  m_type;
+    int  m_scale_denom;
     String m_filename;
     String m_signature;
     Mat m_buf;
     bool m_buf_supported;
+    Mat m_region_cache; // the whole image decoded by the default readRegion()
 };
 
 
@@ -58,6 +58,7 @@
 #include <ImfChannelList.h>
 #include <ImfStandardAttributes.h>
 #include <half.h>
+#include <Iex.h>
 #include "grfmt_exr.hpp"
 
 #if defined _WIN32
@@ -76,10 +77,58 @@ namespace cv
 
 /////////////////////// ExrDecoder ///////////////////
 
+// reads the image from a memory buffer; the buffer is exposed as memory-mapped,
+// so OpenEXR takes the pixel data from it in place
+class ExrMemIStream : public Imf::IStream
+{
+public:
+    ExrMemIStream( const Mat& buf ) : Imf::IStream( "" ),
+        m_data( (char*)buf.data ), m_size( (Imf::Int64)(buf.cols*buf.rows*buf.elemSize()) ), m_pos( 0 )
+    {
+    }
+
+    bool read( char c[], int n )
+    {
+        memcpy( c, readMemoryMapped( n ), n );
+        return m_pos < m_size;
+    }
+
+    bool isMemoryMapped() const
+    {
+        return true;
+    }
+
+    char* readMemoryMapped( int n )
+    {
+        if( n < 0 || m_pos + n > m_size )
+            throw Iex::InputExc( "Unexpected end of file." );
+        char* ptr = m_data + m_pos;
+        m_pos += n;
+        return ptr;
+    }
+
+    Imf::Int64 tellg()
+    {
+        return m_pos;
+    }
+
+    void seekg( Imf::Int64 pos )
+    {
+        m_pos = pos;
+    }
+
+private:
+    char* m_data;
+    Imf::Int64 m_size;
+    Imf::Int64 m_pos;
+};
+
 ExrDecoder::ExrDecoder()
 {
     m_signature = "\x76\x2f\x31\x01";
     m_file = 0;
+    m_stream = 0;
+    m_buf_supported = true;
     m_red = m_green = m_blue = 0;
 }
 
@@ -97,6 +146,8 @@ void  ExrDecoder::close()
         delete m_file;
         m_file = 0;
     }
+    delete m_stream;
+    m_stream = 0;
 }
 
 
@@ -110,7 +161,14 @@ bool  ExrDecoder::readHeader()
 {
     bool result = false;
 
-    m_file = new InputFile( m_filename.c_str() );
+    close();
+    if( !m_buf.empty() )
+    {
+        m_stream = new ExrMemIStream( m_buf );
+        m_file = new InputFile( *m_stream );
+    }
+    else
+        m_file = new InputFile( m_filename.c_str() );
 
     if( !m_file ) // probably paranoid
         return false;
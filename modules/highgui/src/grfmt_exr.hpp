@@ -51,6 +51,7 @@
 
 #include <ImfChromaticities.h>
 #include <ImfInputFile.h>
+#include <ImfIO.h>
 #include <ImfChannelList.h>
 #include <ImathBox.h>
 #include "grfmt_base.hpp"
@@ -85,6 +86,7 @@ protected:
     void  RGBToGray( float *in, float *out );
 
     InputFile      *m_file;
+    Imf::IStream   *m_stream;
     Imf::PixelType  m_type;
     Box2i           m_datawindow;
     bool            m_ischroma;
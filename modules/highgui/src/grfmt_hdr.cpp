@@ -52,11 +52,16 @@ HdrDecoder::HdrDecoder()
     m_signature = "#?RGBE";
     m_signature_alt = "#?RADIANCE";
     file = NULL;
+    m_buf_pos = 0;
     m_type = CV_32FC3;
+    m_buf_supported = true;
 }
 
 HdrDecoder::~HdrDecoder()
 {
+    if(file) {
+        fclose(file);
+    }
 }
 
 size_t HdrDecoder::signatureLength() const
@@ -67,14 +72,26 @@ size_t HdrDecoder::signatureLength() const
 
 bool  HdrDecoder::readHeader()
 {
-    file = fopen(m_filename.c_str(), "rb");
-    if(!file) {
-        return false;
-    }
-    RGBE_ReadHeader(file, &m_width, &m_height, NULL);
-    if(m_width <= 0 || m_height <= 0) {
+    if(file) {
         fclose(file);
         file = NULL;
+    }
+    m_buf_pos = 0;
+    if(m_buf.empty()) {
+        file = fopen(m_filename.c_str(), "rb");
+        if(!file) {
+            return false;
+        }
+    }
+    rgbe_source src = { file, m_buf.data, m_buf.empty() ? 0 : m_buf.cols*m_buf.rows*m_buf.elemSize(), 0 };
+    RGBE_ReadHeader(&src, &m_width, &m_height, NULL);
+    m_buf_pos = src.pos;
+    if(m_width <= 0 || m_height <= 0) {
+        if(file) {
+            fclose(file);
+            file = NULL;
+        }
+        m_buf_pos = 0;
         return false;
     }
     return true;
@@ -82,15 +99,27 @@ bool  HdrDecoder::readHeader()
 
 bool HdrDecoder::readData(Mat& _img)
 {
-    Mat img(m_height, m_width, CV_32FC3);
-    if(!file) {
+    if(!file && m_buf_pos == 0) {
         if(!readHeader()) {
             return false;
         }
     }
-    RGBE_ReadPixels_RLE(file, const_cast<float*>(img.ptr<float>()), img.cols, img.rows);
-    fclose(file); file = NULL;
+    // decode straight into the destination when it has the native type
+    bool direct = _img.type() == CV_32FC3 && _img.isContinuous() &&
+                  _img.cols == m_width && _img.rows == m_height;
+    Mat img = direct ? _img : Mat(m_height, m_width, CV_32FC3);
+
+    rgbe_source src = { file, m_buf.data, m_buf.empty() ? 0 : m_buf.cols*m_buf.rows*m_buf.elemSize(), m_buf_pos };
+    RGBE_ReadPixels_RLE(&src, const_cast<float*>(img.ptr<float>()), img.cols, img.rows);
+    if(file) {
+        fclose(file);
+        file = NULL;
+    }
+    m_buf_pos = 0;
 
+    if(direct) {
+        return true;
+    }
     if(_img.depth() == img.depth()) {
         img.convertTo(_img, _img.type());
     } else {
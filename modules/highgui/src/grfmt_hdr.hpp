@@ -68,6 +68,7 @@ public:
 protected:
     String m_signature_alt;
     FILE *file;
+    size_t m_buf_pos;
 };
 
 // ... writer
@@ -206,6 +206,15 @@ void  JpegDecoder::close()
     m_type = -1;
 }
 
+bool JpegDecoder::setScale( int scale_denom )
+{
+    // libjpeg scales the image in IDCT, which is almost free
+    if( scale_denom != 1 && scale_denom != 2 && scale_denom != 4 && scale_denom != 8 )
+        return false;
+    m_scale_denom = scale_denom;
+    return true;
+}
+
 ImageDecoder JpegDecoder::newDecoder() const
 {
     return makePtr<JpegDecoder>();
@@ -242,8 +251,12 @@ bool  JpegDecoder::readHeader()
         {
             jpeg_read_header( &state->cinfo, TRUE );
 
-            m_width = state->cinfo.image_width;
-            m_height = state->cinfo.image_height;
+            state->cinfo.scale_num = 1;
+            state->cinfo.scale_denom = m_scale_denom;
+            jpeg_calc_output_dimensions( &state->cinfo );
+
+            m_width = state->cinfo.output_width;
+            m_height = state->cinfo.output_height;
             m_type = state->cinfo.num_components > 1 ? CV_8UC3 : CV_8UC1;
             result = true;
         }
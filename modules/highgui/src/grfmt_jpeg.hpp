@@ -64,6 +64,7 @@ public:
     bool  readHeader();
     void  close();
 
+    bool  setScale( int scale_denom );
     ImageDecoder newDecoder() const;
 
 protected:
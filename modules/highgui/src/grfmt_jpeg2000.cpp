@@ -79,6 +79,7 @@ Jpeg2KDecoder::Jpeg2KDecoder()
     m_signature = '\0' + String() + '\0' + String() + '\0' + String("\x0cjP  \r\n\x87\n");
     m_stream = 0;
     m_image = 0;
+    m_buf_supported = true;
 }
 
 
@@ -112,7 +113,14 @@ bool  Jpeg2KDecoder::readHeader()
     bool result = false;
 
     close();
-    jas_stream_t* stream = jas_stream_fopen( m_filename.c_str(), "rb" );
+    jas_stream_t* stream = 0;
+    if( !m_buf.empty() )
+    {
+        // jasper reads the buffer in place, it does not take the ownership
+        stream = jas_stream_memopen( (char*)m_buf.data, (int)(m_buf.cols*m_buf.rows*m_buf.elemSize()) );
+    }
+    else
+        stream = jas_stream_fopen( m_filename.c_str(), "rb" );
     m_stream = stream;
 
     if( stream )
@@ -91,6 +91,8 @@ PngDecoder::PngDecoder()
     m_f = 0;
     m_buf_supported = true;
     m_buf_pos = 0;
+    m_row = -1;
+    m_region_type = -1;
 }
 
 
@@ -120,6 +122,7 @@ void  PngDecoder::close()
         png_destroy_read_struct( &png_ptr, &info_ptr, &end_info );
         m_png_ptr = m_info_ptr = m_end_info = 0;
     }
+    m_row = -1;
 }
 
 
@@ -222,63 +225,73 @@ bool  PngDecoder::readHeader()
 }
 
 
+// sets up the libpng transformations that convert the image to the given type;
+// must be called inside the setjmp() block of the caller
+void  PngDecoder::setReadTransforms( int type )
+{
+    png_structp png_ptr = (png_structp)m_png_ptr;
+    png_infop info_ptr = (png_infop)m_info_ptr;
+    int color = CV_MAT_CN(type) > 1;
+
+    if( CV_MAT_DEPTH(type) == CV_8U && m_bit_depth == 16 )
+        png_set_strip_16( png_ptr );
+    else if( !isBigEndian() )
+        png_set_swap( png_ptr );
+
+    if(CV_MAT_CN(type) < 4)
+    {
+        /* observation: png_read_image() writes 400 bytes beyond
+         * end of data when reading a 400x118 color png
+         * "mpplus_sand.png".  OpenCV crashes even with demo
+         * programs.  Looking at the loaded image I'd say we get 4
+         * bytes per pixel instead of 3 bytes per pixel.  Test
+         * indicate that it is a good idea to always ask for
+         * stripping alpha..  18.11.2004 Axel Walthelm
+         */
+         png_set_strip_alpha( png_ptr );
+    }
+
+    if( m_color_type == PNG_COLOR_TYPE_PALETTE )
+        png_set_palette_to_rgb( png_ptr );
+
+    if( m_color_type == PNG_COLOR_TYPE_GRAY && m_bit_depth < 8 )
+#if (PNG_LIBPNG_VER_MAJOR*10000 + PNG_LIBPNG_VER_MINOR*100 + PNG_LIBPNG_VER_RELEASE >= 10209) || \
+    (PNG_LIBPNG_VER_MAJOR == 1 && PNG_LIBPNG_VER_MINOR == 0 && PNG_LIBPNG_VER_RELEASE >= 18)
+        png_set_expand_gray_1_2_4_to_8( png_ptr );
+#else
+        png_set_gray_1_2_4_to_8( png_ptr );
+#endif
+
+    if( CV_MAT_CN(m_type) > 1 && color )
+        png_set_bgr( png_ptr ); // convert RGB to BGR
+    else if( color )
+        png_set_gray_to_rgb( png_ptr ); // Gray->RGB
+    else
+        png_set_rgb_to_gray( png_ptr, 1, 0.299, 0.587 ); // RGB->Gray
+
+    png_set_interlace_handling( png_ptr );
+    png_read_update_info( png_ptr, info_ptr );
+}
+
+
 bool  PngDecoder::readData( Mat& img )
 {
     bool result = false;
     AutoBuffer<uchar*> _buffer(m_height);
     uchar** buffer = _buffer;
-    int color = img.channels() > 1;
     uchar* data = img.data;
     int step = (int)img.step;
 
     if( m_png_ptr && m_info_ptr && m_end_info && m_width && m_height )
     {
         png_structp png_ptr = (png_structp)m_png_ptr;
-        png_infop info_ptr = (png_infop)m_info_ptr;
         png_infop end_info = (png_infop)m_end_info;
 
         if( setjmp( png_jmpbuf ( png_ptr ) ) == 0 )
         {
             int y;
 
-            if( img.depth() == CV_8U && m_bit_depth == 16 )
-                png_set_strip_16( png_ptr );
-            else if( !isBigEndian() )
-                png_set_swap( png_ptr );
-
-            if(img.channels() < 4)
-            {
-                /* observation: png_read_image() writes 400 bytes beyond
-                 * end of data when reading a 400x118 color png
-                 * "mpplus_sand.png".  OpenCV crashes even with demo
-                 * programs.  Looking at the loaded image I'd say we get 4
-                 * bytes per pixel instead of 3 bytes per pixel.  Test
-                 * indicate that it is a good idea to always ask for
-                 * stripping alpha..  18.11.2004 Axel Walthelm
-                 */
-                 png_set_strip_alpha( png_ptr );
-            }
-
-            if( m_color_type == PNG_COLOR_TYPE_PALETTE )
-                png_set_palette_to_rgb( png_ptr );
-
-            if( m_color_type == PNG_COLOR_TYPE_GRAY && m_bit_depth < 8 )
-#if (PNG_LIBPNG_VER_MAJOR*10000 + PNG_LIBPNG_VER_MINOR*100 + PNG_LIBPNG_VER_RELEASE >= 10209) || \
-    (PNG_LIBPNG_VER_MAJOR == 1 && PNG_LIBPNG_VER_MINOR == 0 && PNG_LIBPNG_VER_RELEASE >= 18)
-                png_set_expand_gray_1_2_4_to_8( png_ptr );
-#else
-                png_set_gray_1_2_4_to_8( png_ptr );
-#endif
-
-            if( CV_MAT_CN(m_type) > 1 && color )
-                png_set_bgr( png_ptr ); // convert RGB to BGR
-            else if( color )
-                png_set_gray_to_rgb( png_ptr ); // Gray->RGB
-            else
-                png_set_rgb_to_gray( png_ptr, 1, 0.299, 0.587 ); // RGB->Gray
-
-            png_set_interlace_handling( png_ptr );
-            png_read_update_info( png_ptr, info_ptr );
+            setReadTransforms( img.type() );
 
             for( y = 0; y < m_height; y++ )
                 buffer[y] = data + y*step;
@@ -295,6 +308,307 @@ bool  PngDecoder::readData( Mat& img )
 }
 
 
+bool  PngDecoder::readRegion( Mat& img, Rect roi )
+{
+    CV_Assert( (roi & Rect(0, 0, m_width, m_height)) == roi && img.size() == roi.size() );
+
+    // the rows of interlaced images come in several passes, so they can not be streamed
+    if( m_png_ptr && m_info_ptr &&
+        png_get_interlace_type( (png_structp)m_png_ptr, (png_infop)m_info_ptr ) != PNG_INTERLACE_NONE )
+        return BaseImageDecoder::readRegion( img, roi );
+
+    // the rows are decoded sequentially; going back (or changing the type) restarts the decoding
+    if( m_row >= 0 && (roi.y < m_row || img.type() != m_region_type) && !readHeader() )
+        return false;
+
+    bool result = false;
+
+    if( m_png_ptr && m_info_ptr && m_width && m_height )
+    {
+        // the members are used directly: a local copy of the pointer could be clobbered by longjmp()
+        if( setjmp( png_jmpbuf ( (png_structp)m_png_ptr ) ) == 0 )
+        {
+            size_t esz = img.elemSize();
+
+            if( m_row < 0 )
+            {
+                setReadTransforms( img.type() );
+                m_row_buf.allocate( std::max((size_t)png_get_rowbytes( (png_structp)m_png_ptr, (png_infop)m_info_ptr ), m_width*esz) );
+                m_region_type = img.type();
+                m_row = 0;
+            }
+
+            uchar* row_buf = m_row_buf;
+            for( ; m_row < roi.y; m_row++ )
+                png_read_row( (png_structp)m_png_ptr, row_buf, 0 );
+
+            for( int y = 0; y < roi.height; y++, m_row++ )
+            {
+                png_read_row( (png_structp)m_png_ptr, row_buf, 0 );
+                memcpy( img.ptr(y), row_buf + roi.x*esz, roi.width*esz );
+            }
+
+            result = true;
+        }
+    }
+
+    if( !result )
+        close();
+    return result;
+}
+
+
+/////////////////////// parallel PNG compression ///////////////////
+
+// The image data are compressed pigz-style: the filtered rows are split into chunks of a fixed size,
+// every chunk is compressed by its own raw deflate stream, primed with the last 32K of the previous
+// chunk, and the streams (all but the last ended by Z_SYNC_FLUSH) are concatenated into one zlib stream.
+// The chunk size does not depend on the number of threads, so neither does the output.
+enum { PNG_PARALLEL_CHUNK_SIZE = 1 << 18, PNG_DEFLATE_WINDOW = 1 << 15 };
+
+static inline int pngPaeth( int a, int b, int c )
+{
+    int p = a + b - c;
+    int pa = std::abs(p - a), pb = std::abs(p - b), pc = std::abs(p - c);
+    return pa <= pb && pa <= pc ? a : pb <= pc ? b : c;
+}
+
+// applies one PNG filter to the row; prev is the previous row or 0 for the first one
+static void pngFilterRow( int filter, const uchar* row, const uchar* prev, int len, int bpp, uchar* dst )
+{
+    int i;
+    switch( filter )
+    {
+    case PNG_FILTER_VALUE_SUB:
+        for( i = 0; i < bpp; i++ )
+            dst[i] = row[i];
+        for( ; i < len; i++ )
+            dst[i] = (uchar)(row[i] - row[i - bpp]);
+        break;
+    case PNG_FILTER_VALUE_UP:
+        for( i = 0; i < len; i++ )
+            dst[i] = (uchar)(row[i] - (prev ? prev[i] : 0));
+        break;
+    case PNG_FILTER_VALUE_AVG:
+        for( i = 0; i < len; i++ )
+        {
+            int a = i >= bpp ? row[i - bpp] : 0, b = prev ? prev[i] : 0;
+            dst[i] = (uchar)(row[i] - ((a + b) >> 1));
+        }
+        break;
+    case PNG_FILTER_VALUE_PAETH:
+        for( i = 0; i < len; i++ )
+        {
+            int a = i >= bpp ? row[i - bpp] : 0, b = prev ? prev[i] : 0;
+            int c = i >= bpp && prev ? prev[i - bpp] : 0;
+            dst[i] = (uchar)(row[i] - pngPaeth(a, b, c));
+        }
+        break;
+    default:
+        memcpy( dst, row, len );
+    }
+}
+
+// converts an image row to the byte order of the PNG file: RGB(A), big-endian samples
+static void pngConvertRow( const Mat& img, int y, uchar* dst )
+{
+    int width = img.cols, cn = img.channels();
+    const uchar* src = img.ptr(y);
+    if( img.depth() == CV_8U )
+    {
+        if( cn == 1 )
+            memcpy( dst, src, width );
+        else if( cn == 3 )
+            icvCvt_BGR2RGB_8u_C3R( src, 0, dst, 0, cvSize(width, 1) );
+        else
+            icvCvt_BGRA2RGBA_8u_C4R( src, 0, dst, 0, cvSize(width, 1) );
+    }
+    else
+    {
+        const ushort* src16 = (const ushort*)src;
+        for( int x = 0; x < width*cn; x += cn )
+            for( int c = 0; c < cn; c++ )
+            {
+                // swap B and R
+                int v = src16[x + (cn >= 3 && c < 3 ? 2 - c : c)];
+                dst[(x + c)*2] = (uchar)(v >> 8);
+                dst[(x + c)*2 + 1] = (uchar)v;
+            }
+    }
+}
+
+class PngFilterRows_Invoker : public ParallelLoopBody
+{
+public:
+    PngFilterRows_Invoker( const Mat& _img, int _filters, uchar* _dst ) :
+        img(&_img), filters(_filters), dst(_dst)
+    {
+    }
+
+    void operator()( const Range& range ) const
+    {
+        int bpp = (int)img->elemSize();
+        int len = img->cols*bpp;
+        size_t dststep = len + 1;
+        static const int filter_values[] = { PNG_FILTER_VALUE_NONE, PNG_FILTER_VALUE_SUB, PNG_FILTER_VALUE_UP,
+                                             PNG_FILTER_VALUE_AVG, PNG_FILTER_VALUE_PAETH };
+        static const int filter_flags[] = { PNG_FILTER_NONE, PNG_FILTER_SUB, PNG_FILTER_UP,
+                                            PNG_FILTER_AVG, PNG_FILTER_PAETH };
+        AutoBuffer<uchar> _buf(len*4);
+        uchar* row = _buf;
+        uchar* prev = row + len;
+        uchar* best = prev + len;
+        uchar* trial = best + len;
+
+        if( range.start > 0 )
+            pngConvertRow( *img, range.start - 1, prev );
+
+        for( int y = range.start; y < range.end; y++ )
+        {
+            pngConvertRow( *img, y, row );
+            const uchar* prow = y > 0 ? prev : 0;
+            uchar* out = dst + dststep*y;
+            int best_filter = -1;
+            size_t best_sum = 0;
+
+            // the adaptive heuristic of libpng: the filter with the minimum sum of absolute signed bytes
+            for( int k = 0; k < 5; k++ )
+            {
+                if( !(filters & filter_flags[k]) )
+                    continue;
+                pngFilterRow( filter_values[k], row, prow, len, bpp, trial );
+                size_t sum = 0;
+                if( filters != filter_flags[k] )
+                    for( int i = 0; i < len; i++ )
+                        sum += std::abs((int)(schar)trial[i]);
+                if( best_filter < 0 || sum < best_sum )
+                {
+                    best_filter = filter_values[k];
+                    best_sum = sum;
+                    std::swap( best, trial );
+                }
+            }
+            if( best_filter < 0 )
+            {
+                best_filter = PNG_FILTER_VALUE_NONE;
+                memcpy( best, row, len );
+            }
+
+            out[0] = (uchar)best_filter;
+            memcpy( out + 1, best, len );
+            std::swap( row, prev );
+        }
+    }
+
+private:
+    const Mat* img;
+    int filters;
+    uchar* dst;
+};
+
+class PngDeflateChunks_Invoker : public ParallelLoopBody
+{
+public:
+    PngDeflateChunks_Invoker( const uchar* _data, size_t _size, int _level, int _strategy,
+                              std::vector<std::vector<uchar> >& _chunks, std::vector<uLong>& _adlers,
+                              volatile bool* _ok ) :
+        data(_data), size(_size), level(_level), strategy(_strategy),
+        chunks(&_chunks), adlers(&_adlers), ok(_ok)
+    {
+    }
+
+    void operator()( const Range& range ) const
+    {
+        for( int k = range.start; k < range.end; k++ )
+        {
+            size_t start = (size_t)k*PNG_PARALLEL_CHUNK_SIZE;
+            size_t len = std::min((size_t)PNG_PARALLEL_CHUNK_SIZE, size - start);
+            bool last = start + len == size;
+            std::vector<uchar>& out = (*chunks)[k];
+            (*adlers)[k] = adler32( adler32(0, 0, 0), data + start, (uInt)len );
+
+            z_stream strm;
+            memset( &strm, 0, sizeof(strm) );
+            if( deflateInit2( &strm, level, Z_DEFLATED, -15, 8, strategy ) != Z_OK )
+            {
+                *ok = false;
+                continue;
+            }
+            if( start > 0 )
+            {
+                size_t dictlen = std::min(start, (size_t)PNG_DEFLATE_WINDOW);
+                deflateSetDictionary( &strm, data + start - dictlen, (uInt)dictlen );
+            }
+
+            out.resize( deflateBound( &strm, (uLong)len ) + 16 );
+            strm.next_in = (Bytef*)(data + start);
+            strm.avail_in = (uInt)len;
+            size_t produced = 0;
+            int code;
+            do
+            {
+                // deflate() may ask for more output space when it flushes
+                if( out.size() - produced < 64 )
+                    out.resize( out.size()*2 );
+                strm.next_out = &out[produced];
+                strm.avail_out = (uInt)(out.size() - produced);
+                code = deflate( &strm, last ? Z_FINISH : Z_SYNC_FLUSH );
+                produced = out.size() - strm.avail_out;
+            }
+            while( code == Z_OK && strm.avail_out == 0 );
+
+            if( code != (last ? Z_STREAM_END : Z_OK) || strm.avail_in != 0 )
+                *ok = false;
+            out.resize( produced );
+            deflateEnd( &strm );
+        }
+    }
+
+private:
+    const uchar* data;
+    size_t size;
+    int level, strategy;
+    std::vector<std::vector<uchar> >* chunks;
+    std::vector<uLong>* adlers;
+    volatile bool* ok;
+};
+
+// filters and compresses the image into the zlib streams for the IDAT chunks
+static bool pngCompressParallel( const Mat& img, int level, int strategy, int filters,
+                                 std::vector<std::vector<uchar> >& idat )
+{
+    size_t rowsize = img.cols*img.elemSize() + 1;
+    size_t size = rowsize*img.rows;
+    std::vector<uchar> filtered(size);
+
+    int nstripes = std::max(1, (int)(size / PNG_PARALLEL_CHUNK_SIZE));
+    parallel_for_( Range(0, img.rows), PngFilterRows_Invoker(img, filters, &filtered[0]), nstripes );
+
+    int nchunks = (int)((size + PNG_PARALLEL_CHUNK_SIZE - 1) / PNG_PARALLEL_CHUNK_SIZE);
+    std::vector<uLong> adlers(nchunks);
+    idat.assign( nchunks, std::vector<uchar>() );
+    volatile bool ok = true;
+    parallel_for_( Range(0, nchunks), PngDeflateChunks_Invoker(&filtered[0], size, level, strategy,
+                                                               idat, adlers, &ok) );
+    if( !ok )
+        return false;
+
+    // the zlib header goes to the first chunk and the adler-32 of the whole data to the last one
+    static const uchar zlib_flags[] = { 0x01, 0x01, 0x5e, 0x5e, 0x5e, 0x5e, 0x9c, 0xda, 0xda, 0xda };
+    uchar header[] = { 0x78, zlib_flags[level < 0 ? 6 : level] };
+    idat[0].insert( idat[0].begin(), header, header + 2 );
+
+    uLong adler = adlers[0];
+    for( int k = 1; k < nchunks; k++ )
+    {
+        size_t len = std::min((size_t)PNG_PARALLEL_CHUNK_SIZE, size - (size_t)k*PNG_PARALLEL_CHUNK_SIZE);
+        adler = adler32_combine( adler, adlers[k], (z_off_t)len );
+    }
+    for( int i = 3; i >= 0; i-- )
+        idat.back().push_back( (uchar)(adler >> (i*8)) );
+    return true;
+}
+
 /////////////////////// PngEncoder ///////////////////
 
 
@@ -347,6 +661,7 @@ bool  PngEncoder::write( const Mat& img, const std::vector<int>& params )
     int depth = img.depth(), channels = img.channels();
     bool result = false;
     AutoBuffer<uchar*> buffer;
+    std::vector<std::vector<uchar> > idat;
 
     if( depth != CV_8U && depth != CV_16U )
         return false;
@@ -373,7 +688,9 @@ bool  PngEncoder::write( const Mat& img, const std::vector<int>& params )
 
                 int compression_level = -1; // Invalid value to allow setting 0-9 as valid
                 int compression_strategy = Z_RLE; // Default strategy
+                int filters = -1;
                 bool isBilevel = false;
+                bool isParallel = false;
 
                 for( size_t i = 0; i < params.size(); i += 2 )
                 {
@@ -391,7 +708,19 @@ bool  PngEncoder::write( const Mat& img, const std::vector<int>& params )
                     {
                         isBilevel = params[i+1] != 0;
                     }
+                    if( params[i] == CV_IMWRITE_PNG_FILTER )
+                    {
+                        filters = params[i+1] & PNG_ALL_FILTERS;
+                        if( filters == 0 )
+                            filters = -1;
+                    }
+                    if( params[i] == CV_IMWRITE_PNG_PARALLEL )
+                    {
+                        isParallel = params[i+1] != 0;
+                    }
                 }
+                // bilevel images are packed by libpng, they are not worth the parallel compression
+                isParallel = isParallel && !isBilevel;
 
                 if( m_buf || f )
                 {
@@ -403,9 +732,13 @@ bool  PngEncoder::write( const Mat& img, const std::vector<int>& params )
                     {
                         // tune parameters for speed
                         // (see http://wiki.linuxquestions.org/wiki/Libpng)
-                        png_set_filter(png_ptr, PNG_FILTER_TYPE_BASE, PNG_FILTER_SUB);
-                        png_set_compression_level(png_ptr, Z_BEST_SPEED);
+                        if( filters < 0 )
+                            filters = PNG_FILTER_SUB;
+                        compression_level = Z_BEST_SPEED;
+                        png_set_compression_level(png_ptr, compression_level);
                     }
+                    if( filters >= 0 )
+                        png_set_filter(png_ptr, PNG_FILTER_TYPE_BASE, filters);
                     png_set_compression_strategy(png_ptr, compression_strategy);
 
                     png_set_IHDR( png_ptr, info_ptr, width, height, depth == CV_8U ? isBilevel?1:8 : 16,
@@ -416,21 +749,36 @@ bool  PngEncoder::write( const Mat& img, const std::vector<int>& params )
 
                     png_write_info( png_ptr, info_ptr );
 
-                    if (isBilevel)
-                        png_set_packing(png_ptr);
+                    if( isParallel )
+                    {
+                        // libpng default: all the filters, chosen adaptively
+                        if( pngCompressParallel( img, compression_level, compression_strategy,
+                                                 filters < 0 ? PNG_ALL_FILTERS : filters, idat ) )
+                        {
+                            for( size_t k = 0; k < idat.size(); k++ )
+                                png_write_chunk( png_ptr, (png_bytep)"IDAT", &idat[k][0], idat[k].size() );
+                            png_write_chunk( png_ptr, (png_bytep)"IEND", 0, 0 );
+                            result = true;
+                        }
+                    }
+                    else
+                    {
+                        if (isBilevel)
+                            png_set_packing(png_ptr);
 
-                    png_set_bgr( png_ptr );
-                    if( !isBigEndian() )
-                        png_set_swap( png_ptr );
+                        png_set_bgr( png_ptr );
+                        if( !isBigEndian() )
+                            png_set_swap( png_ptr );
 
-                    buffer.allocate(height);
-                    for( y = 0; y < height; y++ )
-                        buffer[y] = img.data + y*img.step;
+                        buffer.allocate(height);
+                        for( y = 0; y < height; y++ )
+                            buffer[y] = img.data + y*img.step;
 
-                    png_write_image( png_ptr, buffer );
-                    png_write_end( png_ptr, info_ptr );
+                        png_write_image( png_ptr, buffer );
+                        png_write_end( png_ptr, info_ptr );
 
-                    result = true;
+                        result = true;
+                    }
                 }
             }
         }
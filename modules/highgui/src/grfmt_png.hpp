@@ -59,6 +59,7 @@ public:
     virtual ~PngDecoder();
 
     bool  readData( Mat& img );
+    bool  readRegion( Mat& img, Rect roi );
     bool  readHeader();
     void  close();
 
@@ -67,6 +68,7 @@ public:
 protected:
 
     static void readDataFromBuf(void* png_ptr, uchar* dst, size_t size);
+    void  setReadTransforms( int type );
 
     int   m_bit_depth;
     void* m_png_ptr;  // pointer to decompression structure
@@ -75,6 +77,9 @@ protected:
     FILE* m_f;
     int   m_color_type;
     size_t m_buf_pos;
+    int   m_row;          // the next row to be read by readRegion(), -1 if the decoding is not started
+    int   m_region_type;  // the type the rows are converted to by readRegion()
+    AutoBuffer<uchar> m_row_buf;
 };
 
 
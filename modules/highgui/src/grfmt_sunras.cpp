@@ -54,6 +54,7 @@ SunRasterDecoder::SunRasterDecoder()
 {
     m_offset = -1;
     m_signature = fmtSignSunRas;
+    m_buf_supported = true;
 }
 
 
@@ -76,7 +77,12 @@ bool  SunRasterDecoder::readHeader()
 {
     bool result = false;
 
-    if( !m_strm.open( m_filename )) return false;
+    if( !m_buf.empty() )
+    {
+        if( !m_strm.open( m_buf ) )
+            return false;
+    }
+    else if( !m_strm.open( m_filename )) return false;
 
     try
     {
@@ -58,13 +58,101 @@ static const char fmtSignTiffMM[] = "MM\x00\x2a";
 
 #include "tiff.h"
 #include "tiffio.h"
+#include <zlib.h>
 
 static int grfmt_tiff_err_handler_init = 0;
 static void GrFmtSilentTIFFErrorHandler( const char*, const char*, va_list ) {}
 
+// TIFFClientOpen callbacks reading the image from a memory buffer.
+// The buffer is also "mapped", so libtiff reads the strips and tiles in place, without copying.
+class TiffDecoderBufHelper
+{
+public:
+    TiffDecoderBufHelper( const Mat& buf, size_t& buf_pos ) :
+        m_buf(buf), m_buf_pos(buf_pos)
+    {
+    }
+
+    static tsize_t read( thandle_t handle, tdata_t buffer, tsize_t n )
+    {
+        TiffDecoderBufHelper* helper = reinterpret_cast<TiffDecoderBufHelper*>(handle);
+        const Mat& buf = helper->m_buf;
+        const size_t size = buf.cols*buf.rows*buf.elemSize();
+        size_t pos = helper->m_buf_pos;
+        if( n <= 0 || pos >= size )
+            return 0;
+        size_t count = std::min((size_t)n, size - pos);
+        memcpy( buffer, buf.data + pos, count );
+        helper->m_buf_pos += count;
+        return (tsize_t)count;
+    }
+
+    static tsize_t write( thandle_t, tdata_t, tsize_t )
+    {
+        // the memory source is read-only
+        return 0;
+    }
+
+    static toff_t seek( thandle_t handle, toff_t offset, int whence )
+    {
+        TiffDecoderBufHelper* helper = reinterpret_cast<TiffDecoderBufHelper*>(handle);
+        const Mat& buf = helper->m_buf;
+        const toff_t size = (toff_t)(buf.cols*buf.rows*buf.elemSize());
+        toff_t new_pos = helper->m_buf_pos;
+        switch( whence )
+        {
+            case SEEK_SET:
+                new_pos = offset;
+                break;
+            case SEEK_CUR:
+                new_pos += offset;
+                break;
+            case SEEK_END:
+                new_pos = size + offset;
+                break;
+        }
+        new_pos = std::min(new_pos, size);
+        helper->m_buf_pos = (size_t)new_pos;
+        return new_pos;
+    }
+
+    static int map( thandle_t handle, tdata_t* base, toff_t* size )
+    {
+        TiffDecoderBufHelper* helper = reinterpret_cast<TiffDecoderBufHelper*>(handle);
+        const Mat& buf = helper->m_buf;
+        *base = (tdata_t)buf.data;
+        *size = (toff_t)(buf.cols*buf.rows*buf.elemSize());
+        return 1;
+    }
+
+    static void unmap( thandle_t, tdata_t, toff_t )
+    {
+    }
+
+    static toff_t size( thandle_t handle )
+    {
+        TiffDecoderBufHelper* helper = reinterpret_cast<TiffDecoderBufHelper*>(handle);
+        const Mat& buf = helper->m_buf;
+        return (toff_t)(buf.cols*buf.rows*buf.elemSize());
+    }
+
+    static int close( thandle_t handle )
+    {
+        TiffDecoderBufHelper* helper = reinterpret_cast<TiffDecoderBufHelper*>(handle);
+        delete helper;
+        return 0;
+    }
+
+private:
+    const Mat& m_buf;
+    size_t& m_buf_pos;
+};
+
 TiffDecoder::TiffDecoder()
 {
     m_tif = 0;
+    m_buf_pos = 0;
+    m_buf_supported = true;
     if( !grfmt_tiff_err_handler_init )
     {
         grfmt_tiff_err_handler_init = 1;
@@ -115,15 +203,42 @@ ImageDecoder TiffDecoder::newDecoder() const
 
 bool TiffDecoder::readHeader()
 {
-    bool result = false;
-
     close();
-    TIFF* tif = TIFFOpen( m_filename.c_str(), "rb" );
+    TIFF* tif = 0;
+    if( !m_buf.empty() )
+    {
+        m_buf_pos = 0;
+        TiffDecoderBufHelper* buf_helper = new TiffDecoderBufHelper(m_buf, m_buf_pos);
+        tif = TIFFClientOpen( "", "r", reinterpret_cast<thandle_t>(buf_helper),
+                              &TiffDecoderBufHelper::read, &TiffDecoderBufHelper::write,
+                              &TiffDecoderBufHelper::seek, &TiffDecoderBufHelper::close,
+                              &TiffDecoderBufHelper::size,
+                              &TiffDecoderBufHelper::map, &TiffDecoderBufHelper::unmap );
+        // the helper is freed by TiffDecoderBufHelper::close() from TIFFClose()
+        if( !tif )
+            delete buf_helper;
+    }
+    else
+        tif = TIFFOpen( m_filename.c_str(), "rb" );
+
+    m_tif = tif;
+    bool result = readPageHeader();
+
+    if( !result )
+        close();
+
+    return result;
+}
+
+// reads the properties of the current page (TIFF directory)
+bool TiffDecoder::readPageHeader()
+{
+    bool result = false;
+    TIFF* tif = (TIFF*)m_tif;
 
     if( tif )
     {
         int wdth = 0, hght = 0, photometric = 0;
-        m_tif = tif;
 
         if( TIFFGetField( tif, TIFFTAG_IMAGEWIDTH, &wdth ) &&
             TIFFGetField( tif, TIFFTAG_IMAGELENGTH, &hght ) &&
@@ -172,22 +287,48 @@ bool TiffDecoder::readHeader()
         }
     }
 
-    if( !result )
-        close();
-
     return result;
 }
 
 
 bool  TiffDecoder::readData( Mat& img )
 {
+    // the file stays open for the next page, it is closed by close() or the destructor
     if(m_hdr && img.type() == CV_32FC3)
     {
         return readHdrData(img);
     }
+    return readTiles( img, Rect(0, 0, m_width, m_height) );
+}
+
+bool  TiffDecoder::nextPage()
+{
+    // only the directory of the next page is parsed, the file is not read again from the start
+    m_region_cache.release();
+    if( !m_tif || !TIFFReadDirectory( (TIFF*)m_tif ) || !readPageHeader() )
+    {
+        close();
+        return false;
+    }
+    return true;
+}
+
+bool  TiffDecoder::readRegion( Mat& img, Rect roi )
+{
+    if(m_hdr && img.type() == CV_32FC3)
+    {
+        return BaseImageDecoder::readRegion( img, roi );
+    }
+    CV_Assert( (roi & Rect(0, 0, m_width, m_height)) == roi && img.size() == roi.size() );
+    // the strips/tiles are read at random, so the file stays open for the next region
+    return readTiles( img, roi );
+}
+
+// decodes only the strips or tiles intersecting roi
+bool  TiffDecoder::readTiles( Mat& img, Rect roi )
+{
     bool result = false;
     bool color = img.channels() > 1;
-    uchar* data = img.data;
 
     if( img.depth() != CV_8U && img.depth() != CV_16U && img.depth() != CV_32F && img.depth() != CV_64F )
         return false;
@@ -206,6 +347,7 @@ bool  TiffDecoder::readData( Mat& img )
         const int bitsPerByte = 8;
         int dst_bpp = (int)(img.elemSize1() * bitsPerByte);
         int wanted_channels = normalizeChannelsNumber(img.channels());
+        size_t dst_esz = img.elemSize();
 
         if(dst_bpp == 8)
         {
@@ -236,22 +378,37 @@ bool  TiffDecoder::readData( Mat& img )
             ushort* buffer16 = (ushort*)buffer;
             float* buffer32 = (float*)buffer;
             double* buffer64 = (double*)buffer;
-            int tileidx = 0;
 
-            for( y = 0; y < m_height; y += tile_height0, data += img.step*tile_height0 )
+            for( y = roi.y - roi.y % tile_height0; y < roi.y + roi.height; y += tile_height0 )
             {
                 int tile_height = tile_height0;
 
                 if( y + tile_height > m_height )
                     tile_height = m_height - y;
 
-                for( x = 0; x < m_width; x += tile_width0, tileidx++ )
+                // the rows of the tile that fall into roi
+                int i0 = std::max(roi.y - y, 0);
+                int i1 = std::min(roi.y + roi.height - y, tile_height);
+
+                for( x = roi.x - roi.x % tile_width0; x < roi.x + roi.width; x += tile_width0 )
                 {
                     int tile_width = tile_width0, ok;
 
                     if( x + tile_width > m_width )
                         tile_width = m_width - x;
 
+                    // the columns of the tile that fall into roi
+                    int j0 = std::max(roi.x - x, 0);
+                    int j1 = std::min(roi.x + roi.width - x, tile_width);
+                    CvSize dst_size = cvSize(j1 - j0, 1);
+                    // the destination of the tile row i0; the tile may start above roi
+                    uchar* data = img.data + (y + i0 - roi.y)*img.step + (x + j0 - roi.x)*dst_esz;
+
+                    // tiles are always stored at the full size, strips have the image width
+                    int bufwidth = is_tiled ? tile_width0 : tile_width;
+                    int tileidx = is_tiled ? (int)TIFFComputeTile( tif, x, y, 0, 0 ) :
+                                             (int)TIFFComputeStrip( tif, y, 0 );
+
                     switch(dst_bpp)
                     {
                         case 8:
@@ -267,26 +424,25 @@ bool  TiffDecoder::readData( Mat& img )
                                 return false;
                             }
 
-                            for( i = 0; i < tile_height; i++ )
+                            // the RGBA raster is bottom-up
+                            int bufheight = is_tiled ? tile_height0 : tile_height;
+                            for( i = i0; i < i1; i++ )
+                            {
+                                const uchar* src = buffer + ((bufheight - i - 1)*bufwidth + j0)*4;
                                 if( color )
                                 {
                                     if (wanted_channels == 4)
                                     {
-                                        icvCvt_BGRA2RGBA_8u_C4R( buffer + i*tile_width*4, 0,
-                                                             data + x*4 + img.step*(tile_height - i - 1), 0,
-                                                             cvSize(tile_width,1) );
+                                        icvCvt_BGRA2RGBA_8u_C4R( src, 0, data + img.step*(i - i0), 0, dst_size );
                                     }
                                     else
                                     {
-                                        icvCvt_BGRA2BGR_8u_C4C3R( buffer + i*tile_width*4, 0,
-                                                             data + x*3 + img.step*(tile_height - i - 1), 0,
-                                                             cvSize(tile_width,1), 2 );
+                                        icvCvt_BGRA2BGR_8u_C4C3R( src, 0, data + img.step*(i - i0), 0, dst_size, 2 );
                                     }
                                 }
                                 else
-                                    icvCvt_BGRA2Gray_8u_C4C1R( buffer + i*tile_width*4, 0,
-                                                              data + x + img.step*(tile_height - i - 1), 0,
-                                                              cvSize(tile_width,1), 2 );
+                                    icvCvt_BGRA2Gray_8u_C4C1R( src, 0, data + img.step*(i - i0), 0, dst_size, 2 );
+                            }
                             break;
                         }
 
@@ -303,42 +459,34 @@ bool  TiffDecoder::readData( Mat& img )
                                 return false;
                             }
 
-                            for( i = 0; i < tile_height; i++ )
+                            for( i = i0; i < i1; i++ )
                             {
+                                const ushort* src = buffer16 + (i*bufwidth + j0)*ncn;
+                                ushort* dst = (ushort*)(data + img.step*(i - i0));
                                 if( color )
                                 {
                                     if( ncn == 1 )
                                     {
-                                        icvCvt_Gray2BGR_16u_C1C3R(buffer16 + i*tile_width*ncn, 0,
-                                                                  (ushort*)(data + img.step*i) + x*3, 0,
-                                                                  cvSize(tile_width,1) );
+                                        icvCvt_Gray2BGR_16u_C1C3R(src, 0, dst, 0, dst_size );
                                     }
                                     else if( ncn == 3 )
                                     {
-                                        icvCvt_RGB2BGR_16u_C3R(buffer16 + i*tile_width*ncn, 0,
-                                                               (ushort*)(data + img.step*i) + x*3, 0,
-                                                               cvSize(tile_width,1) );
+                                        icvCvt_RGB2BGR_16u_C3R(src, 0, dst, 0, dst_size );
                                     }
                                     else
                                     {
-                                        icvCvt_BGRA2BGR_16u_C4C3R(buffer16 + i*tile_width*ncn, 0,
-                                                               (ushort*)(data + img.step*i) + x*3, 0,
-                                                               cvSize(tile_width,1), 2 );
+                                        icvCvt_BGRA2BGR_16u_C4C3R(src, 0, dst, 0, dst_size, 2 );
                                     }
                                 }
                                 else
                                 {
                                     if( ncn == 1 )
                                     {
-                                        memcpy((ushort*)(data + img.step*i)+x,
-                                               buffer16 + i*tile_width*ncn,
-                                               tile_width*sizeof(buffer16[0]));
+                                        memcpy(dst, src, dst_size.width*sizeof(buffer16[0]));
                                     }
                                     else
                                     {
-                                        icvCvt_BGRA2Gray_16u_CnC1R(buffer16 + i*tile_width*ncn, 0,
-                                                               (ushort*)(data + img.step*i) + x, 0,
-                                                               cvSize(tile_width,1), ncn, 2 );
+                                        icvCvt_BGRA2Gray_16u_CnC1R(src, 0, dst, 0, dst_size, ncn, 2 );
                                     }
                                 }
                             }
@@ -359,19 +507,19 @@ bool  TiffDecoder::readData( Mat& img )
                                 return false;
                             }
 
-                            for( i = 0; i < tile_height; i++ )
+                            for( i = i0; i < i1; i++ )
                             {
                                 if(dst_bpp == 32)
                                 {
-                                    memcpy((float*)(data + img.step*i)+x,
-                                           buffer32 + i*tile_width*ncn,
-                                           tile_width*sizeof(buffer32[0]));
+                                    memcpy(data + img.step*(i - i0),
+                                           buffer32 + i*bufwidth + j0,
+                                           dst_size.width*sizeof(buffer32[0]));
                                 }
                                 else
                                 {
-                                    memcpy((double*)(data + img.step*i)+x,
-                                         buffer64 + i*tile_width*ncn,
-                                         tile_width*sizeof(buffer64[0]));
+                                    memcpy(data + img.step*(i - i0),
+                                           buffer64 + i*bufwidth + j0,
+                                           dst_size.width*sizeof(buffer64[0]));
                                 }
                             }
 
@@ -390,7 +538,6 @@ bool  TiffDecoder::readData( Mat& img )
         }
     }
 
-    close();
     return result;
 }
 
@@ -413,7 +560,6 @@ bool TiffDecoder::readHdrData(Mat& img)
         TIFFReadEncodedStrip(tif, i, ptr, size);
         size -= strip_size * sizeof(float);
     }
-    close();
     if(photometric == PHOTOMETRIC_LOGLUV)
     {
         cvtColor(img, img, COLOR_XYZ2BGR);
@@ -479,6 +625,106 @@ static void readParam(const std::vector<int>& params, int key, int& value)
         }
 }
 
+// converts an image row to the sample order of the TIFF file (RGB, RGBA)
+static bool convertRow(const Mat& img, int y, uchar* buffer)
+{
+    int width = img.cols, depth = img.depth();
+    switch(img.channels())
+    {
+        case 1:
+        {
+            memcpy(buffer, img.data + img.step * y, width * img.elemSize());
+            break;
+        }
+
+        case 3:
+        {
+            if (depth == CV_8U)
+                icvCvt_BGR2RGB_8u_C3R( img.data + img.step*y, 0, buffer, 0, cvSize(width,1) );
+            else
+                icvCvt_BGR2RGB_16u_C3R( (const ushort*)(img.data + img.step*y), 0, (ushort*)buffer, 0, cvSize(width,1) );
+            break;
+        }
+
+        case 4:
+        {
+            if (depth == CV_8U)
+                icvCvt_BGRA2RGBA_8u_C4R( img.data + img.step*y, 0, buffer, 0, cvSize(width,1) );
+            else
+                icvCvt_BGRA2RGBA_16u_C4R( (const ushort*)(img.data + img.step*y), 0, (ushort*)buffer, 0, cvSize(width,1) );
+            break;
+        }
+
+        default:
+            return false;
+    }
+    return true;
+}
+
+// horizontal differencing of PREDICTOR_HORIZONTAL, the same as libtiff does before the compression
+template<typename T> static void predictRow(T* row, int width, int cn)
+{
+    for (int i = width*cn - 1; i >= cn; i--)
+        row[i] = (T)(row[i] - row[i - cn]);
+}
+
+// compresses the deflate strips in parallel; libtiff then only writes the raw strips out in order
+class TiffDeflateStrips_Invoker : public ParallelLoopBody
+{
+public:
+    TiffDeflateStrips_Invoker(const Mat& _img, int _rowsPerStrip, int _predictor, int _level,
+                              std::vector<std::vector<uchar> >& _strips, volatile bool* _ok) :
+        img(&_img), rowsPerStrip(_rowsPerStrip), predictor(_predictor), level(_level),
+        strips(&_strips), ok(_ok)
+    {
+    }
+
+    void operator()(const Range& range) const
+    {
+        size_t rowSize = img->cols * img->elemSize();
+        AutoBuffer<uchar> _buffer(rowSize * rowsPerStrip + 32);
+        uchar* buffer = _buffer;
+
+        for (int s = range.start; s < range.end; s++)
+        {
+            int y0 = s * rowsPerStrip, y1 = std::min(y0 + rowsPerStrip, img->rows);
+            for (int y = y0; y < y1; y++)
+            {
+                uchar* row = buffer + rowSize * (y - y0);
+                if (!convertRow(*img, y, row))
+                {
+                    *ok = false;
+                    return;
+                }
+                if (predictor == PREDICTOR_HORIZONTAL)
+                {
+                    if (img->depth() == CV_8U)
+                        predictRow(row, img->cols, img->channels());
+                    else
+                        predictRow((ushort*)row, img->cols, img->channels());
+                }
+            }
+
+            uLong srcSize = (uLong)(rowSize * (y1 - y0));
+            uLongf dstSize = compressBound(srcSize);
+            std::vector<uchar>& strip = (*strips)[s];
+            strip.resize(dstSize);
+            if (compress2(&strip[0], &dstSize, buffer, srcSize, level) != Z_OK)
+            {
+                *ok = false;
+                return;
+            }
+            strip.resize(dstSize);
+        }
+    }
+
+private:
+    const Mat* img;
+    int rowsPerStrip, predictor, level;
+    std::vector<std::vector<uchar> >* strips;
+    volatile bool* ok;
+};
+
 bool  TiffEncoder::writeLibTiff( const Mat& img, const std::vector<int>& params)
 {
     int channels = img.channels();
@@ -549,6 +795,31 @@ bool  TiffEncoder::writeLibTiff( const Mat& img, const std::vector<int>& params)
         return false;
     }
 
+    int zipQuality = Z_DEFAULT_COMPRESSION;
+    readParam(params, TIFFTAG_ZIPQUALITY, zipQuality);
+    bool isDeflate = compression == COMPRESSION_ADOBE_DEFLATE || compression == COMPRESSION_DEFLATE;
+    if (isDeflate && zipQuality != Z_DEFAULT_COMPRESSION &&
+        !TIFFSetField(pTiffHandle, TIFFTAG_ZIPQUALITY, zipQuality))
+    {
+        TIFFClose(pTiffHandle);
+        return false;
+    }
+
+    // the strips are compressed independently, so with deflate they are compressed in parallel
+    if (isDeflate && rowsPerStrip < height &&
+        (predictor == PREDICTOR_NONE || predictor == PREDICTOR_HORIZONTAL))
+    {
+        int nstrips = (height + rowsPerStrip - 1) / rowsPerStrip;
+        std::vector<std::vector<uchar> > strips(nstrips);
+        volatile bool ok = true;
+        parallel_for_(Range(0, nstrips), TiffDeflateStrips_Invoker(img, rowsPerStrip, predictor, zipQuality,
+                                                                   strips, &ok));
+        for (int s = 0; ok && s < nstrips; s++)
+            ok = TIFFWriteRawStrip(pTiffHandle, s, &strips[s][0], (tsize_t)strips[s].size()) != (tsize_t)-1;
+        TIFFClose(pTiffHandle);
+        return ok;
+    }
+
     // row buffer, because TIFFWriteScanline modifies the original data!
     size_t scanlineSize = TIFFScanlineSize(pTiffHandle);
     AutoBuffer<uchar> _buffer(scanlineSize+32);
@@ -561,37 +832,10 @@ bool  TiffEncoder::writeLibTiff( const Mat& img, const std::vector<int>& params)
 
     for (int y = 0; y < height; ++y)
     {
-        switch(channels)
+        if (!convertRow(img, y, buffer))
         {
-            case 1:
-            {
-                memcpy(buffer, img.data + img.step * y, scanlineSize);
-                break;
-            }
-
-            case 3:
-            {
-                if (depth == CV_8U)
-                    icvCvt_BGR2RGB_8u_C3R( img.data + img.step*y, 0, buffer, 0, cvSize(width,1) );
-                else
-                    icvCvt_BGR2RGB_16u_C3R( (const ushort*)(img.data + img.step*y), 0, (ushort*)buffer, 0, cvSize(width,1) );
-                break;
-            }
-
-            case 4:
-            {
-                if (depth == CV_8U)
-                    icvCvt_BGRA2RGBA_8u_C4R( img.data + img.step*y, 0, buffer, 0, cvSize(width,1) );
-                else
-                    icvCvt_BGRA2RGBA_16u_C4R( (const ushort*)(img.data + img.step*y), 0, (ushort*)buffer, 0, cvSize(width,1) );
-                break;
-            }
-
-            default:
-            {
-                TIFFClose(pTiffHandle);
-                return false;
-            }
+            TIFFClose(pTiffHandle);
+            return false;
         }
 
         int writeResult = TIFFWriteScanline(pTiffHandle, buffer, y, 0);
@@ -99,6 +99,8 @@ public:
 
     bool  readHeader();
     bool  readData( Mat& img );
+    bool  readRegion( Mat& img, Rect roi );
+    bool  nextPage();
     void  close();
 
     size_t signatureLength() const;
@@ -108,8 +110,11 @@ public:
 protected:
     void* m_tif;
     int normalizeChannelsNumber(int channels) const;
+    bool readPageHeader();
+    bool readTiles( Mat& img, Rect roi );
     bool readHdrData(Mat& img);
     bool m_hdr;
+    size_t m_buf_pos;
 };
 
 #endif
@@ -45,10 +45,22 @@
 
 #include "precomp.hpp"
 #include "grfmts.hpp"
+#include "opencv2/imgproc.hpp"
 #undef min
 #undef max
 #include <iostream>
 
+#if (defined WIN32 || defined _WIN32) && !defined WINCE && !defined HAVE_WINRT
+  #define HIGHGUI_MMAP_WIN32 1
+#elif defined __unix__ || defined __APPLE__
+  #define HIGHGUI_MMAP_POSIX 1
+  #include <sys/types.h>
+  #include <sys/stat.h>
+  #include <sys/mman.h>
+  #include <fcntl.h>
+  #include <unistd.h>
+#endif
+
 /****************************************************************************************\
 *                                      Image Codecs                                      *
 \****************************************************************************************/
@@ -125,12 +137,13 @@ static ImageDecoder findDecoder( const String& filename )
     return ImageDecoder();
 }
 
-static ImageDecoder findDecoder( const Mat& buf )
+// returns the index of the decoder in codecs.decoders that recognizes the buffer, or -1
+static int findDecoderIndex( const Mat& buf )
 {
     size_t i, maxlen = 0;
 
     if( buf.rows*buf.cols < 1 || !buf.isContinuous() )
-        return ImageDecoder();
+        return -1;
 
     for( i = 0; i < codecs.decoders.size(); i++ )
     {
@@ -146,10 +159,16 @@ static ImageDecoder findDecoder( const Mat& buf )
     for( i = 0; i < codecs.decoders.size(); i++ )
     {
         if( codecs.decoders[i]->checkSignature(signature) )
-            return codecs.decoders[i]->newDecoder();
+            return (int)i;
     }
 
-    return ImageDecoder();
+    return -1;
+}
+
+static ImageDecoder findDecoder( const Mat& buf )
+{
+    int idx = findDecoderIndex(buf);
+    return idx >= 0 ? codecs.decoders[idx]->newDecoder() : ImageDecoder();
 }
 
 static ImageEncoder findEncoder( const String& _ext )
@@ -193,6 +212,121 @@ static ImageEncoder findEncoder( const String& _ext )
 
 enum { LOAD_CVMAT=0, LOAD_IMAGE=1, LOAD_MAT=2 };
 
+// read-only memory mapping of a whole file; imread decodes straight from the mapped pages,
+// without reading the file through stdio buffers
+class MappedFile
+{
+public:
+    MappedFile() : data(0), size(0) {}
+    ~MappedFile() { close(); }
+
+    bool open( const String& filename )
+    {
+        close();
+#if defined HIGHGUI_MMAP_WIN32
+        HANDLE file = CreateFileA( filename.c_str(), GENERIC_READ, FILE_SHARE_READ, 0,
+                                   OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, 0 );
+        if( file == INVALID_HANDLE_VALUE )
+            return false;
+        LARGE_INTEGER fsize;
+        HANDLE mapping = 0;
+        if( GetFileSizeEx( file, &fsize ) && fsize.QuadPart > 0 && fsize.QuadPart <= INT_MAX )
+        {
+            mapping = CreateFileMapping( file, 0, PAGE_READONLY, 0, 0, 0 );
+            if( mapping )
+            {
+                data = (uchar*)MapViewOfFile( mapping, FILE_MAP_READ, 0, 0, 0 );
+                size = data ? (size_t)fsize.QuadPart : 0;
+                CloseHandle( mapping );
+            }
+        }
+        CloseHandle( file );
+#elif defined HIGHGUI_MMAP_POSIX
+        int fd = ::open( filename.c_str(), O_RDONLY );
+        if( fd < 0 )
+            return false;
+        struct stat st;
+        if( fstat( fd, &st ) == 0 && S_ISREG(st.st_mode) && st.st_size > 0 && st.st_size <= INT_MAX )
+        {
+            void* ptr = mmap( 0, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0 );
+            if( ptr != MAP_FAILED )
+            {
+                data = (uchar*)ptr;
+                size = (size_t)st.st_size;
+            }
+        }
+        ::close( fd );
+#else
+        (void)filename;
+#endif
+        return data != 0;
+    }
+
+    void close()
+    {
+        if( !data )
+            return;
+#if defined HIGHGUI_MMAP_WIN32
+        UnmapViewOfFile( data );
+#elif defined HIGHGUI_MMAP_POSIX
+        munmap( data, size );
+#endif
+        data = 0;
+        size = 0;
+    }
+
+    // the header of the mapped bytes; valid until close()
+    Mat buf() const { return Mat( 1, (int)size, CV_8U, data ); }
+
+private:
+    MappedFile( const MappedFile& );
+    MappedFile& operator = ( const MappedFile& );
+
+    uchar* data;
+    size_t size;
+};
+
+// returns the reduction factor requested by IMREAD_REDUCED_* flags
+static int imreadScaleDenom( int flags )
+{
+    if( flags < 0 )
+        return 1;
+    return (flags & IMREAD_REDUCED_GRAYSCALE_8) ? 8 :
+           (flags & IMREAD_REDUCED_GRAYSCALE_4) ? 4 :
+           (flags & IMREAD_REDUCED_GRAYSCALE_2) ? 2 : 1;
+}
+
+// returns the type of the matrix imread() produces from an image of the given type
+static int imreadType( int type, int flags )
+{
+    if( flags != -1 )
+    {
+        if( (flags & CV_LOAD_IMAGE_ANYDEPTH) == 0 )
+            type = CV_MAKETYPE(CV_8U, CV_MAT_CN(type));
+
+        if( (flags & CV_LOAD_IMAGE_COLOR) != 0 ||
+           ((flags & CV_LOAD_IMAGE_ANYCOLOR) != 0 && CV_MAT_CN(type) > 1) )
+            type = CV_MAKETYPE(CV_MAT_DEPTH(type), 3);
+        else
+            type = CV_MAKETYPE(CV_MAT_DEPTH(type), 1);
+    }
+    return type;
+}
+
+// reads the image data into the preallocated dst; when the decoder could not reduce the image
+// itself (scaled == false), decodes it at the full size and shrinks it with area interpolation
+static bool readDecoderData( const ImageDecoder& decoder, Mat& dst, bool scaled )
+{
+    if( scaled )
+        return decoder->readData( dst );
+
+    Mat full( decoder->height(), decoder->width(), dst.type() );
+    if( !decoder->readData( full ) )
+        return false;
+    resize( full, dst, dst.size(), 0, 0, INTER_AREA );
+    return true;
+}
+
 static void*
 imread_( const String& filename, int flags, int hdrtype, Mat* mat=0 )
 {
@@ -200,29 +334,42 @@ imread_( const String& filename, int flags, int hdrtype, Mat* mat=0 )
     CvMat *matrix = 0;
     Mat temp, *data = &temp;
 
-    ImageDecoder decoder = findDecoder(filename);
+    // the decoder may refer to the mapped memory, so it is declared after (and destroyed before) the mapping.
+    // Without the optimizations the file is read through the decoder's file source, as before
+    MappedFile mapped;
+    ImageDecoder decoder;
+    if( useOptimized() && mapped.open(filename) )
+    {
+        Mat buf = mapped.buf();
+        decoder = findDecoder(buf);
+        if( decoder && !decoder->setSource(buf) )
+            decoder->setSource(filename);
+    }
+    else
+    {
+        decoder = findDecoder(filename);
+        if( decoder )
+            decoder->setSource(filename);
+    }
     if( !decoder )
         return 0;
-    decoder->setSource(filename);
+
+    int scale_denom = imreadScaleDenom(flags);
+    bool scaled = decoder->setScale(scale_denom);
+
     if( !decoder->readHeader() )
         return 0;
     CvSize size;
     size.width = decoder->width();
     size.height = decoder->height();
-
-    int type = decoder->type();
-    if( flags != -1 )
+    if( !scaled )
     {
-        if( (flags & CV_LOAD_IMAGE_ANYDEPTH) == 0 )
-            type = CV_MAKETYPE(CV_8U, CV_MAT_CN(type));
-
-        if( (flags & CV_LOAD_IMAGE_COLOR) != 0 ||
-           ((flags & CV_LOAD_IMAGE_ANYCOLOR) != 0 && CV_MAT_CN(type) > 1) )
-            type = CV_MAKETYPE(CV_MAT_DEPTH(type), 3);
-        else
-            type = CV_MAKETYPE(CV_MAT_DEPTH(type), 1);
+        size.width = (size.width + scale_denom - 1)/scale_denom;
+        size.height = (size.height + scale_denom - 1)/scale_denom;
     }
 
+    int type = imreadType( decoder->type(), flags );
+
     if( hdrtype == LOAD_CVMAT || hdrtype == LOAD_MAT )
     {
         if( hdrtype == LOAD_CVMAT )
@@ -242,7 +389,7 @@ imread_( const String& filename, int flags, int hdrtype, Mat* mat=0 )
         temp = cvarrToMat(image);
     }
 
-    if( !decoder->readData( *data ))
+    if( !readDecoderData( decoder, *data, scaled ))
     {
         cvReleaseImage( &image );
         cvReleaseMat( &matrix );
@@ -262,6 +409,189 @@ Mat imread( const String& filename, int flags )
     return img;
 }
 
+Mat imread( const String& filename, int flags, Mat* dst )
+{
+    Mat img;
+    dst = dst ? dst : &img;
+    imread_( filename, flags, LOAD_MAT, dst );
+    return *dst;
+}
+
+// opens the decoder for region reading; roi is clipped by the image, the empty roi means the whole image
+static ImageDecoder openRegionDecoder( const String& filename, int flags, Rect& roi, int& type )
+{
+    CV_Assert( imreadScaleDenom(flags) == 1 );
+
+    ImageDecoder decoder = findDecoder(filename);
+    if( !decoder || !decoder->setSource(filename) || !decoder->readHeader() )
+        return ImageDecoder();
+
+    Rect whole(0, 0, decoder->width(), decoder->height());
+    roi = roi.area() == 0 ? whole : roi & whole;
+    if( roi.area() == 0 )
+        return ImageDecoder();
+    type = imreadType( decoder->type(), flags );
+    return decoder;
+}
+
+Mat imreadRegion( const String& filename, Rect roi, int flags )
+{
+    int type = -1;
+    ImageDecoder decoder = openRegionDecoder( filename, flags, roi, type );
+    Mat img;
+    if( !decoder )
+        return img;
+
+    img.create( roi.size(), type );
+    if( !decoder->readRegion( img, roi ) )
+        img.release();
+    return img;
+}
+
+class ImageRowReaderImpl : public ImageRowReader
+{
+public:
+    ImageRowReaderImpl( const ImageDecoder& _decoder, Rect _roi, int _type ) :
+        decoder(_decoder), roi(_roi), type_(_type), row(0)
+    {
+    }
+
+    Size size() const { return roi.size(); }
+    int type() const { return type_; }
+    int nextRow() const { return row; }
+
+    bool read( OutputArray _band, int maxRows )
+    {
+        CV_Assert( maxRows > 0 );
+        if( row >= roi.height )
+            return false;
+
+        int nrows = std::min(maxRows, roi.height - row);
+        _band.create( nrows, roi.width, type_ );
+        Mat band = _band.getMat();
+        if( !decoder->readRegion( band, Rect(roi.x, roi.y + row, roi.width, nrows) ) )
+        {
+            row = roi.height;
+            return false;
+        }
+        row += nrows;
+        return true;
+    }
+
+protected:
+    ImageDecoder decoder;
+    Rect roi;
+    int type_;
+    int row;
+};
+
+Ptr<ImageRowReader> createImageRowReader( const String& filename, int flags, Rect roi )
+{
+    int type = -1;
+    ImageDecoder decoder = openRegionDecoder( filename, flags, roi, type );
+    if( !decoder )
+        return Ptr<ImageRowReader>();
+    return makePtr<ImageRowReaderImpl>( decoder, roi, type );
+}
+
+class ImagePageReaderImpl : public ImagePageReader
+{
+public:
+    ImagePageReaderImpl( const ImageDecoder& _decoder, int _flags, bool _scaled ) :
+        decoder(_decoder), flags(_flags), scaled(_scaled), page(0), valid(true)
+    {
+    }
+
+    int pageIndex() const { return page; }
+
+    ImageInfo info() const
+    {
+        ImageInfo pageInfo;
+        if( valid )
+        {
+            pageInfo.width = decoder->width();
+            pageInfo.height = decoder->height();
+            pageInfo.type = decoder->type();
+        }
+        return pageInfo;
+    }
+
+    bool read( OutputArray _page )
+    {
+        if( !valid )
+            return false;
+
+        int scale_denom = imreadScaleDenom(flags);
+        Size size(decoder->width(), decoder->height());
+        if( !scaled )
+            size = Size((size.width + scale_denom - 1)/scale_denom,
+                        (size.height + scale_denom - 1)/scale_denom);
+        _page.create( size, imreadType(decoder->type(), flags) );
+        Mat pageMat = _page.getMat();
+        if( !readDecoderData( decoder, pageMat, scaled ) )
+        {
+            valid = false;
+            _page.release();
+            return false;
+        }
+        return skip();
+    }
+
+    bool skip()
+    {
+        if( !valid )
+            return false;
+        page++;
+        valid = decoder->nextPage();
+        return true;
+    }
+
+protected:
+    ImageDecoder decoder;
+    int flags;
+    bool scaled;
+    int page;
+    bool valid;
+};
+
+Ptr<ImagePageReader> createImagePageReader( const String& filename, int flags )
+{
+    ImageDecoder decoder = findDecoder(filename);
+    if( !decoder || !decoder->setSource(filename) )
+        return Ptr<ImagePageReader>();
+
+    bool scaled = decoder->setScale( imreadScaleDenom(flags) );
+    if( !decoder->readHeader() )
+        return Ptr<ImagePageReader>();
+    return makePtr<ImagePageReaderImpl>( decoder, flags, scaled );
+}
+
+bool imreadmulti( const String& filename, std::vector<Mat>& mats, int start, int count, int flags )
+{
+    CV_Assert( start >= 0 );
+    mats.clear();
+    Ptr<ImagePageReader> reader = createImagePageReader( filename, flags );
+    if( !reader )
+        return false;
+
+    while( reader->pageIndex() < start )
+        if( !reader->skip() )
+            return false;
+
+    Mat page;
+    while( (count < 0 || (int)mats.size() < count) && reader->read(page) )
+    {
+        mats.push_back(page);
+        page.release();
+    }
+    return !mats.empty();
+}
+
+bool imreadmulti( const String& filename, std::vector<Mat>& mats, int flags )
+{
+    return imreadmulti( filename, mats, 0, -1, flags );
+}
+
 static bool imwrite_( const String& filename, const Mat& image,
                       const std::vector<int>& params, bool flipv )
 {
@@ -325,6 +655,9 @@ imdecode_( const Mat& buf, int flags, int hdrtype, Mat* mat=0 )
         decoder->setSource(filename);
     }
 
+    int scale_denom = imreadScaleDenom(flags);
+    bool scaled = decoder->setScale(scale_denom);
+
     if( !decoder->readHeader() )
     {
         if( !filename.empty() )
@@ -335,20 +668,14 @@ imdecode_( const Mat& buf, int flags, int hdrtype, Mat* mat=0 )
     CvSize size;
     size.width = decoder->width();
     size.height = decoder->height();
-
-    int type = decoder->type();
-    if( flags != -1 )
+    if( !scaled )
     {
-        if( (flags & CV_LOAD_IMAGE_ANYDEPTH) == 0 )
-            type = CV_MAKETYPE(CV_8U, CV_MAT_CN(type));
-
-        if( (flags & CV_LOAD_IMAGE_COLOR) != 0 ||
-           ((flags & CV_LOAD_IMAGE_ANYCOLOR) != 0 && CV_MAT_CN(type) > 1) )
-            type = CV_MAKETYPE(CV_MAT_DEPTH(type), 3);
-        else
-            type = CV_MAKETYPE(CV_MAT_DEPTH(type), 1);
+        size.width = (size.width + scale_denom - 1)/scale_denom;
+        size.height = (size.height + scale_denom - 1)/scale_denom;
     }
 
+    int type = imreadType( decoder->type(), flags );
+
     if( hdrtype == LOAD_CVMAT || hdrtype == LOAD_MAT )
     {
         if( hdrtype == LOAD_CVMAT )
@@ -368,7 +695,7 @@ imdecode_( const Mat& buf, int flags, int hdrtype, Mat* mat=0 )
         temp = cvarrToMat(image);
     }
 
-    bool code = decoder->readData( *data );
+    bool code = readDecoderData( decoder, *data, scaled );
     if( !filename.empty() )
         remove(filename.c_str());
 
@@ -451,6 +778,187 @@ bool imencode( const String& ext, InputArray _image,
     return code;
 }
 
+// decodes a part of the batch; the decoders are created once per stripe and reused for
+// all the buffers of the same format, the output matrices are reused when they fit
+class ImdecodeBatch_Invoker : public ParallelLoopBody
+{
+public:
+    ImdecodeBatch_Invoker( const std::vector<Mat>& _bufs, std::vector<Mat>& _dst, int _flags,
+                           std::vector<String>& _errors ) :
+        bufs(&_bufs), dst(&_dst), flags(_flags), errors(&_errors)
+    {
+    }
+
+    void operator()( const Range& range ) const
+    {
+        std::vector<ImageDecoder> decoders(codecs.decoders.size());
+        int scale_denom = imreadScaleDenom(flags);
+
+        for( int i = range.start; i < range.end; i++ )
+        {
+            const Mat& buf = (*bufs)[i];
+            Mat& img = (*dst)[i];
+            String& error = (*errors)[i];
+            try
+            {
+                int idx = findDecoderIndex(buf);
+                if( idx < 0 )
+                {
+                    error = "unknown image format";
+                    img.release();
+                    continue;
+                }
+
+                ImageDecoder& decoder = decoders[idx];
+                if( !decoder )
+                    decoder = codecs.decoders[idx]->newDecoder();
+                if( !decoder->setSource(buf) )
+                {
+                    // the decoder reads only files; imdecode() goes through a temporary one
+                    imdecode(buf, flags, &img);
+                    if( img.empty() )
+                        error = "could not decode the image";
+                    continue;
+                }
+
+                bool scaled = decoder->setScale(scale_denom);
+                if( !decoder->readHeader() )
+                {
+                    error = "could not read the image header";
+                    img.release();
+                    continue;
+                }
+
+                Size size(decoder->width(), decoder->height());
+                if( !scaled )
+                    size = Size((size.width + scale_denom - 1)/scale_denom,
+                                (size.height + scale_denom - 1)/scale_denom);
+                img.create(size, imreadType(decoder->type(), flags));
+
+                if( !readDecoderData(decoder, img, scaled) )
+                {
+                    error = "could not decode the image data";
+                    img.release();
+                }
+            }
+            catch( const cv::Exception& e )
+            {
+                // a broken buffer must not abort the whole batch
+                error = e.err;
+                img.release();
+            }
+        }
+    }
+
+private:
+    const std::vector<Mat>* bufs;
+    std::vector<Mat>* dst;
+    int flags;
+    std::vector<String>* errors;
+};
+
+int imdecodeBatch( const std::vector<Mat>& bufs, std::vector<Mat>& dst, int flags,
+                   std::vector<String>* _errors )
+{
+    int i, n = (int)bufs.size();
+    std::vector<String> temp_errors;
+    std::vector<String>& errors = _errors ? *_errors : temp_errors;
+    errors.assign(n, String());
+    dst.resize(n);
+
+    // a few stripes per thread rather than one per buffer, so the decoders are actually reused
+    double nstripes = std::min(n, std::max(getNumThreads(), 1)*4);
+    parallel_for_(Range(0, n), ImdecodeBatch_Invoker(bufs, dst, flags, errors), nstripes);
+
+    int count = 0;
+    for( i = 0; i < n; i++ )
+        count += errors[i].empty();
+    return count;
+}
+
+// only the signature and the header are read; the decoder is destroyed before it touches the pixels
+static bool readImageInfo( const ImageDecoder& decoder, ImageInfo& info )
+{
+    if( !decoder->readHeader() )
+        return false;
+    info.width = decoder->width();
+    info.height = decoder->height();
+    info.type = decoder->type();
+    return true;
+}
+
+bool imreadInfo( const String& filename, ImageInfo& info )
+{
+    info = ImageInfo();
+    ImageDecoder decoder = findDecoder(filename);
+    if( !decoder || !decoder->setSource(filename) )
+        return false;
+    return readImageInfo(decoder, info);
+}
+
+class ImreadInfo_Invoker : public ParallelLoopBody
+{
+public:
+    ImreadInfo_Invoker( const std::vector<String>& _filenames, std::vector<ImageInfo>& _infos ) :
+        filenames(&_filenames), infos(&_infos)
+    {
+    }
+
+    void operator()( const Range& range ) const
+    {
+        for( int i = range.start; i < range.end; i++ )
+        {
+            ImageInfo& info = (*infos)[i];
+            try
+            {
+                imreadInfo((*filenames)[i], info);
+            }
+            catch( const cv::Exception& )
+            {
+                // a broken file must not abort the whole batch
+                info = ImageInfo();
+            }
+        }
+    }
+
+private:
+    const std::vector<String>* filenames;
+    std::vector<ImageInfo>* infos;
+};
+
+void imreadInfo( const std::vector<String>& filenames, std::vector<ImageInfo>& infos )
+{
+    infos.assign(filenames.size(), ImageInfo());
+    parallel_for_(Range(0, (int)filenames.size()), ImreadInfo_Invoker(filenames, infos));
+}
+
+bool imdecodeInfo( InputArray _buf, ImageInfo& info )
+{
+    Mat buf = _buf.getMat();
+    info = ImageInfo();
+    CV_Assert(buf.data && buf.isContinuous());
+
+    ImageDecoder decoder = findDecoder(buf);
+    if( !decoder )
+        return false;
+
+    if( decoder->setSource(buf) )
+        return readImageInfo(decoder, info);
+
+    String filename = tempfile();
+    FILE* f = fopen( filename.c_str(), "wb" );
+    if( !f )
+        return false;
+    size_t bufSize = buf.cols*buf.rows*buf.elemSize();
+    fwrite( &buf.data[0], 1, bufSize, f );
+    fclose(f);
+
+    bool code = decoder->setSource(filename) && readImageInfo(decoder, info);
+    decoder.release();
+    remove(filename.c_str());
+    return code;
+}
+
 }
 
 /****************************************************************************************\
@@ -104,6 +104,36 @@ static int rgbe_error(int rgbe_error_code, const char *msg)
   return RGBE_RETURN_FAILURE;
 }
 
+/* fgets() for rgbe_source */
+static char *rgbe_gets(char *buf, int n, rgbe_source *src)
+{
+  int i = 0;
+  if (src->fp)
+    return fgets(buf,n,src->fp);
+  if (n <= 0 || src->pos >= src->size)
+    return NULL;
+  while (i < n-1 && src->pos < src->size) {
+    char c = (char)src->data[src->pos++];
+    buf[i++] = c;
+    if (c == '\n')
+      break;
+  }
+  buf[i] = 0;
+  return buf;
+}
+
+/* fread() of a single item for rgbe_source; returns the number of items read */
+static size_t rgbe_read(void *ptr, size_t size, rgbe_source *src)
+{
+  if (src->fp)
+    return fread(ptr,size,1,src->fp);
+  if (src->size - src->pos < size)
+    return 0;
+  memcpy(ptr,src->data + src->pos,size);
+  src->pos += size;
+  return 1;
+}
+
 /* standard conversion from float pixels to rgbe pixels */
 /* note: you can remove the "inline"s if your compiler complains about it */
 static INLINE void
@@ -171,7 +201,7 @@ int RGBE_WriteHeader(FILE *fp, int width, int height, rgbe_header_info *info)
 }
 
 /* minimal header reading.  modify if you want to parse more information */
-int RGBE_ReadHeader(FILE *fp, int *width, int *height, rgbe_header_info *info)
+int RGBE_ReadHeader(rgbe_source *src, int *width, int *height, rgbe_header_info *info)
 {
   char buf[128];
   float tempf;
@@ -182,7 +212,7 @@ int RGBE_ReadHeader(FILE *fp, int *width, int *height, rgbe_header_info *info)
     info->programtype[0] = 0;
     info->gamma = info->exposure = 1.0;
   }
-  if (fgets(buf,sizeof(buf)/sizeof(buf[0]),fp) == NULL)
+  if (rgbe_gets(buf,sizeof(buf)/sizeof(buf[0]),src) == NULL)
     return rgbe_error(rgbe_read_error,NULL);
   if ((buf[0] != '#')||(buf[1] != '?')) {
     /* if you want to require the magic token then uncomment the next line */
@@ -196,7 +226,7 @@ int RGBE_ReadHeader(FILE *fp, int *width, int *height, rgbe_header_info *info)
       info->programtype[i] = buf[i+2];
     }
     info->programtype[i] = 0;
-    if (fgets(buf,sizeof(buf)/sizeof(buf[0]),fp) == 0)
+    if (rgbe_gets(buf,sizeof(buf)/sizeof(buf[0]),src) == 0)
       return rgbe_error(rgbe_read_error,NULL);
   }
   for(;;) {
@@ -212,15 +242,15 @@ int RGBE_ReadHeader(FILE *fp, int *width, int *height, rgbe_header_info *info)
       info->exposure = tempf;
       info->valid |= RGBE_VALID_EXPOSURE;
     }
-    if (fgets(buf,sizeof(buf)/sizeof(buf[0]),fp) == 0)
+    if (rgbe_gets(buf,sizeof(buf)/sizeof(buf[0]),src) == 0)
       return rgbe_error(rgbe_read_error,NULL);
   }
-  if (fgets(buf,sizeof(buf)/sizeof(buf[0]),fp) == 0)
+  if (rgbe_gets(buf,sizeof(buf)/sizeof(buf[0]),src) == 0)
     return rgbe_error(rgbe_read_error,NULL);
   if (strcmp(buf,"\n") != 0)
     return rgbe_error(rgbe_format_error,
           "missing blank line after FORMAT specifier");
-  if (fgets(buf,sizeof(buf)/sizeof(buf[0]),fp) == 0)
+  if (rgbe_gets(buf,sizeof(buf)/sizeof(buf[0]),src) == 0)
     return rgbe_error(rgbe_read_error,NULL);
   if (sscanf(buf,"-Y %d +X %d",height,width) < 2)
     return rgbe_error(rgbe_format_error,"missing image size specifier");
@@ -245,12 +275,12 @@ int RGBE_WritePixels(FILE *fp, float *data, int numpixels)
 }
 
 /* simple read routine.  will not correctly handle run length encoding */
-int RGBE_ReadPixels(FILE *fp, float *data, int numpixels)
+int RGBE_ReadPixels(rgbe_source *src, float *data, int numpixels)
 {
   unsigned char rgbe[4];
 
   while(numpixels-- > 0) {
-    if (fread(rgbe, sizeof(rgbe), 1, fp) < 1)
+    if (rgbe_read(rgbe, sizeof(rgbe), src) < 1)
       return rgbe_error(rgbe_read_error,NULL);
     rgbe2float(&data[RGBE_DATA_RED],&data[RGBE_DATA_GREEN],
          &data[RGBE_DATA_BLUE],rgbe);
@@ -362,7 +392,7 @@ int RGBE_WritePixels_RLE(FILE *fp, float *data, int scanline_width,
   return RGBE_RETURN_SUCCESS;
 }
 
-int RGBE_ReadPixels_RLE(FILE *fp, float *data, int scanline_width,
+int RGBE_ReadPixels_RLE(rgbe_source *src, float *data, int scanline_width,
       int num_scanlines)
 {
   unsigned char rgbe[4], *scanline_buffer, *ptr, *ptr_end;
@@ -371,11 +401,11 @@ int RGBE_ReadPixels_RLE(FILE *fp, float *data, int scanline_width,
 
   if ((scanline_width < 8)||(scanline_width > 0x7fff))
     /* run length encoding is not allowed so read flat*/
-    return RGBE_ReadPixels(fp,data,scanline_width*num_scanlines);
+    return RGBE_ReadPixels(src,data,scanline_width*num_scanlines);
   scanline_buffer = NULL;
   /* read in each successive scanline */
   while(num_scanlines > 0) {
-    if (fread(rgbe,sizeof(rgbe),1,fp) < 1) {
+    if (rgbe_read(rgbe,sizeof(rgbe),src) < 1) {
       free(scanline_buffer);
       return rgbe_error(rgbe_read_error,NULL);
     }
@@ -384,7 +414,7 @@ int RGBE_ReadPixels_RLE(FILE *fp, float *data, int scanline_width,
       rgbe2float(&data[RGBE_DATA_RED],&data[RGBE_DATA_GREEN],&data[RGBE_DATA_BLUE],rgbe);
       data += RGBE_DATA_SIZE;
       free(scanline_buffer);
-      return RGBE_ReadPixels(fp,data,scanline_width*num_scanlines-1);
+      return RGBE_ReadPixels(src,data,scanline_width*num_scanlines-1);
     }
     if ((((int)rgbe[2])<<8 | rgbe[3]) != scanline_width) {
       free(scanline_buffer);
@@ -401,7 +431,7 @@ int RGBE_ReadPixels_RLE(FILE *fp, float *data, int scanline_width,
     for(i=0;i<4;i++) {
       ptr_end = &scanline_buffer[(i+1)*scanline_width];
       while(ptr < ptr_end) {
-  if (fread(buf,sizeof(buf[0])*2,1,fp) < 1) {
+  if (rgbe_read(buf,sizeof(buf[0])*2,src) < 1) {
     free(scanline_buffer);
     return rgbe_error(rgbe_read_error,NULL);
   }
@@ -424,7 +454,7 @@ int RGBE_ReadPixels_RLE(FILE *fp, float *data, int scanline_width,
     }
     *ptr++ = buf[1];
     if (--count > 0) {
-      if (fread(ptr,sizeof(*ptr)*count,1,fp) < 1) {
+      if (rgbe_read(ptr,sizeof(*ptr)*count,src) < 1) {
         free(scanline_buffer);
         return rgbe_error(rgbe_read_error,NULL);
       }
@@ -60,6 +60,14 @@ typedef struct {
        * defaults to 1.0 */
 } rgbe_header_info;
 
+/* source of the data for the reading routines: a file or, if fp is NULL, a memory buffer */
+typedef struct {
+  FILE *fp;
+  const unsigned char *data;
+  size_t size;
+  size_t pos;            /* current position in the memory buffer */
+} rgbe_source;
+
 /* flags indicating which fields in an rgbe_header_info are valid */
 #define RGBE_VALID_PROGRAMTYPE 0x01
 #define RGBE_VALID_GAMMA       0x02
@@ -72,18 +80,18 @@ typedef struct {
 /* read or write headers */
 /* you may set rgbe_header_info to null if you want to */
 int RGBE_WriteHeader(FILE *fp, int width, int height, rgbe_header_info *info);
-int RGBE_ReadHeader(FILE *fp, int *width, int *height, rgbe_header_info *info);
+int RGBE_ReadHeader(rgbe_source *src, int *width, int *height, rgbe_header_info *info);
 
 /* read or write pixels */
 /* can read or write pixels in chunks of any size including single pixels*/
 int RGBE_WritePixels(FILE *fp, float *data, int numpixels);
-int RGBE_ReadPixels(FILE *fp, float *data, int numpixels);
+int RGBE_ReadPixels(rgbe_source *src, float *data, int numpixels);
 
 /* read or write run length encoded files */
 /* must be called to read or write whole scanlines */
 int RGBE_WritePixels_RLE(FILE *fp, float *data, int scanline_width,
        int num_scanlines);
-int RGBE_ReadPixels_RLE(FILE *fp, float *data, int scanline_width,
+int RGBE_ReadPixels_RLE(rgbe_source *src, float *data, int scanline_width,
       int num_scanlines);
 
 #endif/*_RGBE_HDR_H_*/
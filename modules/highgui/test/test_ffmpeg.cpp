@@ -396,3 +396,288 @@ TEST(Highgui_Video_parallel_writers_and_readers, accuracy)
 }
 
 #endif
+
+#if defined(HAVE_FFMPEG)
+
+//////////////////////////////// Reading synthetic videos ////////////////////////////////////
+
+static Mat drawNumberedFrame(Size size, int i)
+{
+    Mat frame(size, CV_8UC3, Scalar(fabs(cos(i*0.08)*255), fabs(sin(i*0.05)*255), i*3 % 256));
+    putText(frame, format("%03d", i), Point(10, size.height*3/4), FONT_HERSHEY_SIMPLEX, size.height/60., Scalar(128, 255, 255), 5);
+    return frame;
+}
+
+static std::string writeNumberedVideo(const char* ext, int fourcc, Size size, int count)
+{
+    std::string filename = tempfile(ext);
+    VideoWriter writer(filename, fourcc, 25, size);
+    CV_Assert(writer.isOpened());
+    for (int i = 0; i < count; i++)
+        writer << drawNumberedFrame(size, i);
+    return filename;
+}
+
+// grabs the frames [first, last) from both captures and checks they are the same
+static void expectSameFrames(VideoCapture& expected, VideoCapture& actual, int first, int last)
+{
+    for (int i = first; i < last; i++)
+    {
+        Mat frame0, frame1;
+        ASSERT_TRUE(expected.grab()) << "frame " << i;
+        ASSERT_TRUE(actual.grab()) << "frame " << i;
+        EXPECT_EQ(i + 1, (int)expected.get(CAP_PROP_POS_FRAMES));
+        EXPECT_EQ(i + 1, (int)actual.get(CAP_PROP_POS_FRAMES));
+        ASSERT_TRUE(expected.retrieve(frame0));
+        ASSERT_TRUE(actual.retrieve(frame1));
+        ASSERT_EQ(frame0.size(), frame1.size());
+        EXPECT_EQ(0, norm(frame0, frame1, NORM_INF)) << "frame " << i;
+    }
+}
+
+TEST(Highgui_Video, ffmpeg_prefetch)
+{
+    const int count = 60;
+    std::string filename = writeNumberedVideo(".avi", VideoWriter::fourcc('X','V','I','D'), Size(320, 240), count);
+
+    VideoCapture plain(filename), prefetched(filename);
+    ASSERT_TRUE(plain.isOpened());
+    ASSERT_TRUE(prefetched.isOpened());
+    ASSERT_TRUE(prefetched.set(CAP_PROP_FFMPEG_PREFETCH, 4));
+    EXPECT_EQ(4, (int)prefetched.get(CAP_PROP_FFMPEG_PREFETCH));
+
+    expectSameFrames(plain, prefetched, 0, 20);
+
+    // seeking restarts the background decoding, and all the frames are read up to the end of the file
+    ASSERT_TRUE(plain.set(CAP_PROP_POS_FRAMES, 45));
+    ASSERT_TRUE(prefetched.set(CAP_PROP_POS_FRAMES, 45));
+    expectSameFrames(plain, prefetched, 45, count);
+    EXPECT_FALSE(plain.grab());
+    EXPECT_FALSE(prefetched.grab());
+
+    ASSERT_TRUE(plain.set(CAP_PROP_POS_FRAMES, 10));
+    ASSERT_TRUE(prefetched.set(CAP_PROP_POS_FRAMES, 10));
+    expectSameFrames(plain, prefetched, 10, 15);
+
+    // switching the prefetching off continues after the last grabbed frame
+    ASSERT_TRUE(prefetched.set(CAP_PROP_FFMPEG_PREFETCH, 0));
+    EXPECT_EQ(15, (int)prefetched.get(CAP_PROP_POS_FRAMES));
+    expectSameFrames(plain, prefetched, 15, count);
+    EXPECT_FALSE(plain.grab());
+    EXPECT_FALSE(prefetched.grab());
+
+    plain.release();
+    prefetched.release();
+    remove(filename.c_str());
+}
+
+TEST(Highgui_Video, ffmpeg_output_gray)
+{
+    const int count = 10;
+    // MJPG is decoded to the full range YUV, where the luma is the gray value of cvtColor
+    std::string filename = writeNumberedVideo(".avi", VideoWriter::fourcc('M','J','P','G'), Size(320, 240), count);
+
+    VideoCapture bgr(filename), gray(filename), prefetched(filename), yuv(filename);
+    ASSERT_TRUE(bgr.isOpened() && gray.isOpened() && prefetched.isOpened() && yuv.isOpened());
+    ASSERT_TRUE(gray.set(CAP_PROP_FFMPEG_OUTPUT_FORMAT, CAP_FFMPEG_OUTPUT_GRAY));
+    EXPECT_EQ(CAP_FFMPEG_OUTPUT_GRAY, (int)gray.get(CAP_PROP_FFMPEG_OUTPUT_FORMAT));
+    ASSERT_TRUE(prefetched.set(CAP_PROP_FFMPEG_OUTPUT_FORMAT, CAP_FFMPEG_OUTPUT_GRAY));
+    ASSERT_TRUE(prefetched.set(CAP_PROP_FFMPEG_PREFETCH, 2));
+    ASSERT_TRUE(yuv.set(CAP_PROP_FFMPEG_OUTPUT_FORMAT, CAP_FFMPEG_OUTPUT_I420));
+    EXPECT_FALSE(gray.set(CAP_PROP_FFMPEG_OUTPUT_FORMAT, 4));
+    EXPECT_EQ(CAP_FFMPEG_OUTPUT_GRAY, (int)gray.get(CAP_PROP_FFMPEG_OUTPUT_FORMAT));
+
+    for (int i = 0; i < count; i++)
+    {
+        Mat frame, luma, luma_prefetched, planes, expected;
+        bgr >> frame;
+        gray >> luma;
+        prefetched >> luma_prefetched;
+        yuv >> planes;
+        ASSERT_FALSE(frame.empty() || luma.empty() || luma_prefetched.empty() || planes.empty()) << "frame " << i;
+        ASSERT_EQ(CV_8UC1, luma.type());
+        ASSERT_EQ(frame.size(), luma.size());
+
+        cvtColor(frame, expected, COLOR_BGR2GRAY);
+        EXPECT_GE(PSNR(luma, expected), 40) << "frame " << i;
+
+        // the copied planes of the background thread and the Y plane of the YUV layout are the same luma
+        EXPECT_EQ(0, norm(luma, luma_prefetched, NORM_INF)) << "frame " << i;
+        EXPECT_EQ(0, norm(luma, planes.rowRange(0, luma.rows), NORM_INF)) << "frame " << i;
+    }
+
+    bgr.release();
+    gray.release();
+    prefetched.release();
+    yuv.release();
+    remove(filename.c_str());
+}
+
+TEST(Highgui_Video, ffmpeg_output_yuv)
+{
+    const int count = 10;
+    // XVID is decoded to the limited range YUV that cvtColor expects
+    std::string filename = writeNumberedVideo(".avi", VideoWriter::fourcc('X','V','I','D'), Size(320, 240), count);
+
+    const int formats[] = { CAP_FFMPEG_OUTPUT_I420, CAP_FFMPEG_OUTPUT_NV12 };
+    for (int f = 0; f < 2; f++)
+    {
+        VideoCapture bgr(filename), yuv(filename);
+        ASSERT_TRUE(bgr.isOpened() && yuv.isOpened());
+        ASSERT_TRUE(yuv.set(CAP_PROP_FFMPEG_OUTPUT_FORMAT, formats[f]));
+
+        // the planes keep the layout of the decoder, get() tells which one it is
+        int layout = (int)yuv.get(CAP_PROP_FFMPEG_OUTPUT_FORMAT);
+        ASSERT_TRUE(layout == CAP_FFMPEG_OUTPUT_I420 || layout == CAP_FFMPEG_OUTPUT_NV12);
+        int code = layout == CAP_FFMPEG_OUTPUT_NV12 ? COLOR_YUV2BGR_NV12 : COLOR_YUV2BGR_I420;
+
+        for (int i = 0; i < count; i++)
+        {
+            Mat frame, planes, converted;
+            bgr >> frame;
+            yuv >> planes;
+            ASSERT_FALSE(frame.empty() || planes.empty()) << "frame " << i;
+            ASSERT_EQ(CV_8UC1, planes.type());
+            ASSERT_EQ(frame.cols, planes.cols);
+            ASSERT_EQ(frame.rows*3/2, planes.rows);
+
+            cvtColor(planes, converted, code);
+            EXPECT_GE(PSNR(converted, frame), 30) << "frame " << i;
+        }
+    }
+
+    remove(filename.c_str());
+}
+
+TEST(Highgui_Video, ffmpeg_frame_index)
+{
+    const int count = 60;
+    const Size size(320, 240);
+    std::string filename = writeNumberedVideo(".avi", VideoWriter::fourcc('X','V','I','D'), size, count);
+    const int positions[] = { 0, 5, 12, 13, 30, 47, 59, 3, 24, 23 };
+    const int npositions = (int)(sizeof(positions)/sizeof(positions[0]));
+
+    VideoCapture plain(filename), indexed(filename);
+    ASSERT_TRUE(plain.isOpened() && indexed.isOpened());
+    ASSERT_TRUE(indexed.set(CAP_PROP_FFMPEG_FRAME_INDEX, CAP_FFMPEG_FRAME_INDEX_MEMORY));
+    EXPECT_EQ(count, (int)indexed.get(CAP_PROP_FFMPEG_FRAME_INDEX));
+    EXPECT_EQ(count, (int)indexed.get(CAP_PROP_FRAME_COUNT));
+
+    // the accurate seeking gives the same frames with and without the index
+    for (int k = 0; k < npositions; k++)
+    {
+        int n = positions[k];
+        ASSERT_TRUE(plain.set(CAP_PROP_POS_FRAMES, n));
+        ASSERT_TRUE(indexed.set(CAP_PROP_POS_FRAMES, n));
+        EXPECT_EQ(n, (int)plain.get(CAP_PROP_POS_FRAMES));
+        EXPECT_EQ(n, (int)indexed.get(CAP_PROP_POS_FRAMES));
+
+        Mat frame0, frame1;
+        plain >> frame0;
+        indexed >> frame1;
+        ASSERT_FALSE(frame0.empty() || frame1.empty()) << "frame " << n;
+        EXPECT_EQ(0, norm(frame0, frame1, NORM_INF)) << "frame " << n;
+        EXPECT_GE(PSNR(frame1, drawNumberedFrame(size, n)), 20) << "frame " << n;
+    }
+
+    // the keyframe seeking stops at a keyframe at or before the requested frame and reports its number
+    for (int with_index = 0; with_index < 2; with_index++)
+    {
+        VideoCapture& cap = with_index ? indexed : plain;
+        ASSERT_TRUE(cap.set(CAP_PROP_FFMPEG_SEEK_MODE, CAP_FFMPEG_SEEK_KEYFRAME));
+        EXPECT_EQ(CAP_FFMPEG_SEEK_KEYFRAME, (int)cap.get(CAP_PROP_FFMPEG_SEEK_MODE));
+        for (int k = 0; k < npositions; k++)
+        {
+            int n = positions[k];
+            ASSERT_TRUE(cap.set(CAP_PROP_POS_FRAMES, n));
+            int pos = (int)cap.get(CAP_PROP_POS_FRAMES);
+            EXPECT_LE(0, pos);
+            EXPECT_LE(pos, n);
+
+            Mat frame;
+            cap >> frame;
+            ASSERT_FALSE(frame.empty()) << "frame " << n;
+            EXPECT_EQ(pos + 1, (int)cap.get(CAP_PROP_POS_FRAMES));
+            EXPECT_GE(PSNR(frame, drawNumberedFrame(size, pos)), 20) << "frame " << n << ", keyframe " << pos;
+        }
+    }
+
+    plain.release();
+    indexed.release();
+    remove(filename.c_str());
+}
+
+TEST(Highgui_Video, ffmpeg_frame_index_file)
+{
+    const Size size(320, 240);
+    std::string filename = writeNumberedVideo(".avi", VideoWriter::fourcc('X','V','I','D'), size, 60);
+    std::string sidecar = filename + ".cvindex";
+
+    {
+        VideoCapture cap(filename);
+        ASSERT_TRUE(cap.isOpened());
+        ASSERT_TRUE(cap.set(CAP_PROP_FFMPEG_FRAME_INDEX, CAP_FFMPEG_FRAME_INDEX_FILE));
+        EXPECT_EQ(60, (int)cap.get(CAP_PROP_FFMPEG_FRAME_INDEX));
+    }
+    FILE* f = fopen(sidecar.c_str(), "rb");
+    ASSERT_TRUE(f != NULL);
+    fclose(f);
+
+    // the saved index is loaded by the next capture and seeks to the same frames as the built one
+    {
+        VideoCapture loaded(filename), built(filename);
+        ASSERT_TRUE(loaded.isOpened() && built.isOpened());
+        ASSERT_TRUE(loaded.set(CAP_PROP_FFMPEG_FRAME_INDEX, CAP_FFMPEG_FRAME_INDEX_FILE));
+        ASSERT_TRUE(built.set(CAP_PROP_FFMPEG_FRAME_INDEX, CAP_FFMPEG_FRAME_INDEX_MEMORY));
+        EXPECT_EQ(60, (int)loaded.get(CAP_PROP_FFMPEG_FRAME_INDEX));
+        EXPECT_EQ(60, (int)loaded.get(CAP_PROP_FRAME_COUNT));
+
+        const int positions[] = { 37, 11, 50 };
+        for (int k = 0; k < 3; k++)
+        {
+            ASSERT_TRUE(loaded.set(CAP_PROP_POS_FRAMES, positions[k]));
+            ASSERT_TRUE(built.set(CAP_PROP_POS_FRAMES, positions[k]));
+            Mat frame0, frame1;
+            built >> frame0;
+            loaded >> frame1;
+            ASSERT_FALSE(frame0.empty() || frame1.empty());
+            EXPECT_EQ(0, norm(frame0, frame1, NORM_INF)) << "frame " << positions[k];
+        }
+    }
+
+    // a damaged index with a huge frame count is built again rather than allocated
+    {
+        f = fopen(sidecar.c_str(), "rb");
+        ASSERT_TRUE(f != NULL);
+        char header[40]; // the signature, the size and the time of the video, the numbers of frames and keyframes
+        ASSERT_EQ(sizeof(header), fread(header, 1, sizeof(header), f));
+        fclose(f);
+        int64 frames = (int64)1 << 40;
+        memcpy(header + 24, &frames, sizeof(frames));
+        f = fopen(sidecar.c_str(), "wb");
+        ASSERT_TRUE(f != NULL);
+        fwrite(header, 1, sizeof(header), f);
+        fclose(f);
+
+        VideoCapture cap(filename);
+        ASSERT_TRUE(cap.isOpened());
+        ASSERT_TRUE(cap.set(CAP_PROP_FFMPEG_FRAME_INDEX, CAP_FFMPEG_FRAME_INDEX_FILE));
+        EXPECT_EQ(60, (int)cap.get(CAP_PROP_FFMPEG_FRAME_INDEX));
+    }
+
+    // a different video under the same name does not use the old index
+    std::string other = writeNumberedVideo(".avi", VideoWriter::fourcc('X','V','I','D'), size, 30);
+    remove(filename.c_str());
+    ASSERT_EQ(0, rename(other.c_str(), filename.c_str()));
+    {
+        VideoCapture cap(filename);
+        ASSERT_TRUE(cap.isOpened());
+        ASSERT_TRUE(cap.set(CAP_PROP_FFMPEG_FRAME_INDEX, CAP_FFMPEG_FRAME_INDEX_FILE));
+        EXPECT_EQ(30, (int)cap.get(CAP_PROP_FFMPEG_FRAME_INDEX));
+    }
+
+    remove(sidecar.c_str());
+    remove(filename.c_str());
+}
+
+#endif
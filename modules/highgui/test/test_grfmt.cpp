@@ -378,6 +378,166 @@ public:
 TEST(Highgui_Image, read_png_color_palette_with_alpha) { CV_GrfmtReadPNGColorPaletteWithAlphaTest test; test.safe_run(); }
 #endif
 
+static std::vector<uchar> readFileBytes( const string& filename )
+{
+    std::vector<uchar> buf;
+    FILE* f = fopen(filename.c_str(), "rb");
+    if( !f )
+        return buf;
+    fseek(f, 0, SEEK_END);
+    buf.resize((size_t)ftell(f));
+    fseek(f, 0, SEEK_SET);
+    buf.resize(fread(&buf[0], 1, buf.size(), f));
+    fclose(f);
+    return buf;
+}
+
+TEST(Highgui_Image, decode_from_memory)
+{
+    const char* exts[] = { ".bmp", ".ras", ".pgm", ".hdr"
+#ifdef HAVE_TIFF
+        , ".tiff"
+#endif
+#ifdef HAVE_PNG
+        , ".png"
+#endif
+#ifdef HAVE_JPEG
+        , ".jpg"
+#endif
+    };
+
+    // a smooth image, so that the lossy formats can be checked against it too
+    cv::Mat small(8, 11, CV_8UC3), img;
+    theRNG().fill(small, RNG::UNIFORM, 0, 256);
+    cv::resize(small, img, Size(81, 63), 0, 0, INTER_LINEAR);
+
+    bool useOptimized = cv::useOptimized();
+    for( size_t i = 0; i < sizeof(exts)/sizeof(exts[0]); i++ )
+    {
+        string ext = exts[i];
+        string filename = cv::tempfile(exts[i]);
+        cv::Mat src = img;
+        if( ext == ".pgm" )
+            cv::cvtColor(img, src, COLOR_BGR2GRAY);
+        ASSERT_TRUE(cv::imwrite(filename, src)) << ext;
+
+        std::vector<uchar> buf = readFileBytes(filename);
+        ASSERT_FALSE(buf.empty());
+
+        // imread maps the file into memory; without the optimizations it reads the file itself
+        cv::Mat decoded[3];
+        decoded[0] = cv::imdecode(buf, IMREAD_UNCHANGED);
+        cv::setUseOptimized(true);
+        decoded[1] = cv::imread(filename, IMREAD_UNCHANGED);
+        cv::setUseOptimized(false);
+        decoded[2] = cv::imread(filename, IMREAD_UNCHANGED);
+        cv::setUseOptimized(useOptimized);
+        remove(filename.c_str());
+
+        // RGBE keeps 8 bits of the largest component, JPEG is lossy, the others are exact
+        cv::Mat expected = src;
+        double maxDiff = 0;
+        if( ext == ".hdr" )
+        {
+            src.convertTo(expected, CV_32FC3, 1/255.);
+            maxDiff = 1/128.;
+        }
+
+        for( int k = 0; k < 3; k++ )
+        {
+            ASSERT_FALSE(decoded[k].empty()) << ext << ", source " << k;
+            ASSERT_EQ(expected.size(), decoded[k].size()) << ext << ", source " << k;
+            ASSERT_EQ(expected.type(), decoded[k].type()) << ext << ", source " << k;
+            if( ext == ".jpg" )
+                EXPECT_GE(cv::PSNR(expected, decoded[k]), 32) << ext << ", source " << k;
+            else
+                EXPECT_LE(cvtest::norm(expected, decoded[k], NORM_INF), maxDiff) << ext << ", source " << k;
+        }
+    }
+}
+
+TEST(Highgui_Image, decode_into_roi)
+{
+    cv::Mat img(45, 67, CV_8UC3);
+    theRNG().fill(img, RNG::UNIFORM, 0, 256);
+    std::vector<uchar> buf;
+    ASSERT_TRUE(cv::imencode(".bmp", img, buf));
+    string filename = cv::tempfile(".bmp");
+    ASSERT_TRUE(cv::imwrite(filename, img));
+
+    for( int k = 0; k < 2; k++ )
+    {
+        cv::Mat canvas(100, 120, CV_8UC3, Scalar::all(7));
+        cv::Mat roi = canvas(Rect(30, 20, img.cols, img.rows));
+        const uchar* roi_data = roi.data;
+
+        cv::Mat result = k == 0 ? cv::imdecode(buf, IMREAD_COLOR, &roi) : cv::imread(filename, IMREAD_COLOR, &roi);
+        EXPECT_EQ(roi_data, roi.data);
+        EXPECT_EQ(roi_data, result.data);
+        EXPECT_EQ(0, cvtest::norm(img, roi, NORM_INF));
+
+        roi.setTo(Scalar::all(7));
+        EXPECT_EQ(0, cvtest::norm(canvas, Mat(canvas.size(), canvas.type(), Scalar::all(7)), NORM_INF));
+    }
+    remove(filename.c_str());
+}
+
+TEST(Highgui_Image, decode_batch)
+{
+    const char* exts[] = { ".bmp", ".pgm"
+#ifdef HAVE_PNG
+        , ".png"
+#endif
+#ifdef HAVE_JPEG
+        , ".jpg"
+#endif
+    };
+    const int next = (int)(sizeof(exts)/sizeof(exts[0]));
+    const int n = 40, broken = 7;
+
+    std::vector<Mat> bufs(n);
+    for( int i = 0; i < n; i++ )
+    {
+        cv::Mat img(20 + i, 30 + i % 5, CV_8UC3);
+        theRNG().fill(img, RNG::UNIFORM, 0, 256);
+        std::vector<uchar> buf;
+        ASSERT_TRUE(cv::imencode(exts[i % next], img, buf));
+        if( i == broken )
+            buf.resize(16, 0);
+        cv::Mat(buf).copyTo(bufs[i]);
+    }
+
+    for( int flags = IMREAD_UNCHANGED; flags <= IMREAD_COLOR; flags++ )
+    {
+        std::vector<Mat> dst;
+        std::vector<String> errors;
+        EXPECT_EQ(n - 1, cv::imdecodeBatch(bufs, dst, flags, &errors));
+        ASSERT_EQ((size_t)n, dst.size());
+        ASSERT_EQ((size_t)n, errors.size());
+
+        // the second batch decodes into the same matrices
+        std::vector<const uchar*> data(n);
+        for( int i = 0; i < n; i++ )
+            data[i] = dst[i].data;
+        EXPECT_EQ(n - 1, cv::imdecodeBatch(bufs, dst, flags));
+
+        for( int i = 0; i < n; i++ )
+        {
+            cv::Mat expected = cv::imdecode(bufs[i], flags);
+            if( i == broken )
+            {
+                EXPECT_TRUE(dst[i].empty());
+                EXPECT_FALSE(errors[i].empty());
+                continue;
+            }
+            EXPECT_TRUE(errors[i].empty()) << i << " " << errors[i];
+            ASSERT_EQ(expected.type(), dst[i].type()) << i;
+            EXPECT_EQ(data[i], dst[i].data) << i;
+            EXPECT_EQ(0, cvtest::norm(expected, dst[i], NORM_INF)) << i;
+        }
+    }
+}
+
 #ifdef HAVE_JPEG
 TEST(Highgui_Jpeg, encode_empty)
 {
@@ -388,6 +548,133 @@ TEST(Highgui_Jpeg, encode_empty)
 }
 #endif
 
+TEST(Highgui_Image, read_info)
+{
+    const char* exts[] = { ".bmp", ".pgm"
+#ifdef HAVE_JPEG
+        , ".jpg"
+#endif
+#ifdef HAVE_PNG
+        , ".png"
+#endif
+    };
+    const int types[] = { CV_8UC3, CV_8UC1
+#ifdef HAVE_JPEG
+        , CV_8UC3
+#endif
+#ifdef HAVE_PNG
+        , CV_16UC1
+#endif
+    };
+    std::vector<String> filenames;
+    for( size_t i = 0; i < sizeof(exts)/sizeof(exts[0]); i++ )
+    {
+        cv::Mat img(37 + (int)i, 53, types[i], Scalar::all(100));
+        std::vector<uchar> buf;
+        ASSERT_TRUE(cv::imencode(exts[i], img, buf));
+
+        ImageInfo info;
+        ASSERT_TRUE(cv::imdecodeInfo(buf, info)) << exts[i];
+        EXPECT_EQ(img.cols, info.width);
+        EXPECT_EQ(img.rows, info.height);
+        EXPECT_EQ(img.type(), info.type) << exts[i];
+
+        filenames.push_back(cv::tempfile(exts[i]));
+        ASSERT_TRUE(cv::imwrite(filenames.back(), img));
+    }
+    filenames.push_back(cv::tempfile(".bmp")); // does not exist
+
+    std::vector<ImageInfo> infos;
+    cv::imreadInfo(filenames, infos);
+    ASSERT_EQ(filenames.size(), infos.size());
+    for( size_t i = 0; i < filenames.size(); i++ )
+    {
+        ImageInfo info;
+        bool ok = cv::imreadInfo(filenames[i], info);
+        EXPECT_EQ(i + 1 < filenames.size(), ok);
+        EXPECT_EQ(info.width, infos[i].width);
+        EXPECT_EQ(info.height, infos[i].height);
+        EXPECT_EQ(info.type, infos[i].type);
+        if( ok )
+        {
+            cv::Mat img = cv::imread(filenames[i], IMREAD_UNCHANGED);
+            EXPECT_EQ(img.size(), Size(info.width, info.height));
+            EXPECT_EQ(img.type(), info.type);
+        }
+        remove(filenames[i].c_str());
+    }
+    EXPECT_TRUE(infos.back().empty());
+}
+
+#if defined HAVE_JPEG || defined HAVE_PNG
+TEST(Highgui_Image, imdecode_reduced)
+{
+    cv::Mat img(301, 403, CV_8UC3);
+    cv::RNG& rng = theRNG();
+    rng.fill(img, RNG::UNIFORM, 0, 64);
+    cv::GaussianBlur(img, img, Size(0, 0), 5);
+    img *= 4;
+
+    const char* exts[] = {
+#ifdef HAVE_JPEG
+        ".jpg",
+#endif
+#ifdef HAVE_PNG
+        ".png",
+#endif
+    };
+    const int flags[] = { IMREAD_REDUCED_COLOR_2, IMREAD_REDUCED_COLOR_4, IMREAD_REDUCED_COLOR_8,
+                          IMREAD_REDUCED_GRAYSCALE_2, IMREAD_REDUCED_GRAYSCALE_4, IMREAD_REDUCED_GRAYSCALE_8 };
+    for( size_t i = 0; i < sizeof(exts)/sizeof(exts[0]); i++ )
+    {
+        std::vector<uchar> buf;
+        ASSERT_TRUE(cv::imencode(exts[i], img, buf));
+        cv::Mat full_color = cv::imdecode(buf, IMREAD_COLOR);
+        cv::Mat full_gray = cv::imdecode(buf, IMREAD_GRAYSCALE);
+        ASSERT_EQ(img.size(), full_color.size());
+
+        for( size_t j = 0; j < sizeof(flags)/sizeof(flags[0]); j++ )
+        {
+            int denom = flags[j] & IMREAD_REDUCED_GRAYSCALE_8 ? 8 : flags[j] & IMREAD_REDUCED_GRAYSCALE_4 ? 4 : 2;
+            bool color = (flags[j] & IMREAD_COLOR) != 0;
+            cv::Mat reduced = cv::imdecode(buf, flags[j]);
+            ASSERT_EQ((img.cols + denom - 1)/denom, reduced.cols) << exts[i] << " " << flags[j];
+            ASSERT_EQ((img.rows + denom - 1)/denom, reduced.rows) << exts[i] << " " << flags[j];
+            ASSERT_EQ(color ? CV_8UC3 : CV_8UC1, reduced.type());
+
+            cv::Mat expected;
+            cv::resize(color ? full_color : full_gray, expected, reduced.size(), 0, 0, INTER_AREA);
+            EXPECT_LE(cv::norm(reduced, expected, NORM_L1)/reduced.total()/reduced.channels(), 4.)
+                << exts[i] << " " << flags[j];
+        }
+    }
+}
+#endif
+
+
+// checks imreadRegion and createImageRowReader against the same regions of the whole image
+static void checkReadRegion( const string& filename, int flags, const Rect* rois, int nrois )
+{
+    cv::Mat full = cv::imread(filename, flags);
+    ASSERT_FALSE(full.empty());
+
+    for( int k = 0; k < nrois; k++ )
+    {
+        cv::Mat region = cv::imreadRegion(filename, rois[k], flags);
+        ASSERT_EQ(rois[k].size(), region.size()) << rois[k];
+        ASSERT_EQ(full.type(), region.type()) << rois[k];
+        EXPECT_EQ(0, cvtest::norm(full(rois[k]), region, NORM_INF)) << rois[k];
+
+        Ptr<ImageRowReader> reader = cv::createImageRowReader(filename, flags, rois[k]);
+        ASSERT_FALSE(reader.empty());
+        ASSERT_EQ(rois[k].size(), reader->size());
+        cv::Mat band, bands;
+        while( reader->read(band, 6) )
+            bands.push_back(band);
+        EXPECT_EQ(rois[k].height, reader->nextRow());
+        EXPECT_EQ(0, cvtest::norm(full(rois[k]), bands, NORM_INF)) << rois[k];
+    }
+}
 
 #ifdef HAVE_TIFF
 
@@ -423,6 +710,353 @@ TEST(Highgui_Tiff, decode_tile16384x16384)
     remove(file3.c_str());
     remove(file4.c_str());
 }
+
+static void putLittleEndian( std::vector<uchar>& buf, size_t pos, int value, int nbytes )
+{
+    for( int i = 0; i < nbytes; i++ )
+        buf[pos + i] = (uchar)(value >> (i*8));
+}
+
+// writes the 8-bit grayscale pages as an uncompressed little-endian multi-page TIFF
+static void writeMultiPageTiff( const string& filename, const std::vector<Mat>& pages )
+{
+    std::vector<uchar> buf(8, 0);
+    buf[0] = buf[1] = 'I';
+    buf[2] = 42;
+    size_t link = 4; // where the offset of the next directory goes
+
+    for( size_t k = 0; k < pages.size(); k++ )
+    {
+        const Mat& page = pages[k];
+        CV_Assert( page.type() == CV_8UC1 );
+        int dataOffset = (int)buf.size();
+        for( int y = 0; y < page.rows; y++ )
+            buf.insert(buf.end(), page.ptr(y), page.ptr(y) + page.cols);
+        if( buf.size() % 2 )
+            buf.push_back(0);
+
+        putLittleEndian(buf, link, (int)buf.size(), 4);
+        const int entries[][3] = { { TIFFTAG_IMAGEWIDTH, 4, page.cols }, { TIFFTAG_IMAGELENGTH, 4, page.rows },
+                                   { TIFFTAG_BITSPERSAMPLE, 3, 8 }, { TIFFTAG_COMPRESSION, 3, COMPRESSION_NONE },
+                                   { TIFFTAG_PHOTOMETRIC, 3, PHOTOMETRIC_MINISBLACK },
+                                   { TIFFTAG_STRIPOFFSETS, 4, dataOffset }, { TIFFTAG_SAMPLESPERPIXEL, 3, 1 },
+                                   { TIFFTAG_ROWSPERSTRIP, 4, page.rows },
+                                   { TIFFTAG_STRIPBYTECOUNTS, 4, page.rows*page.cols } };
+        const int nentries = (int)(sizeof(entries)/sizeof(entries[0]));
+        size_t pos = buf.size();
+        buf.resize(pos + 2 + nentries*12 + 4, 0);
+        putLittleEndian(buf, pos, nentries, 2);
+        for( int i = 0; i < nentries; i++, pos += 12 )
+        {
+            // tag, type (3 - SHORT, 4 - LONG), count, value
+            putLittleEndian(buf, pos + 2, entries[i][0], 2);
+            putLittleEndian(buf, pos + 4, entries[i][1], 2);
+            putLittleEndian(buf, pos + 6, 1, 4);
+            putLittleEndian(buf, pos + 10, entries[i][2], entries[i][1] == 3 ? 2 : 4);
+        }
+        link = pos + 2;
+    }
+
+    FILE* f = fopen(filename.c_str(), "wb");
+    ASSERT_TRUE(f != 0);
+    fwrite(&buf[0], 1, buf.size(), f);
+    fclose(f);
+}
+
+TEST(Highgui_Tiff, read_multipage)
+{
+    std::vector<Mat> pages;
+    for( int k = 0; k < 4; k++ )
+    {
+        pages.push_back(Mat(20 + k*7, 31 - k*3, CV_8UC1));
+        theRNG().fill(pages.back(), RNG::UNIFORM, 0, 256);
+    }
+    string filename = cv::tempfile(".tiff");
+    writeMultiPageTiff(filename, pages);
+
+    // imread reads the first page only
+    EXPECT_EQ(0, cvtest::norm(pages[0], cv::imread(filename, IMREAD_UNCHANGED), NORM_INF));
+
+    std::vector<Mat> mats;
+    ASSERT_TRUE(cv::imreadmulti(filename, mats, IMREAD_UNCHANGED));
+    ASSERT_EQ(pages.size(), mats.size());
+    for( size_t k = 0; k < pages.size(); k++ )
+        EXPECT_EQ(0, cvtest::norm(pages[k], mats[k], NORM_INF)) << k;
+
+    ASSERT_TRUE(cv::imreadmulti(filename, mats, 1, 2, IMREAD_COLOR));
+    ASSERT_EQ(2u, mats.size());
+    for( size_t k = 0; k < mats.size(); k++ )
+    {
+        cv::Mat expected;
+        cv::cvtColor(pages[k + 1], expected, COLOR_GRAY2BGR);
+        EXPECT_EQ(0, cvtest::norm(expected, mats[k], NORM_INF)) << k;
+    }
+    EXPECT_FALSE(cv::imreadmulti(filename, mats, 4, 1, IMREAD_UNCHANGED));
+
+    Ptr<ImagePageReader> reader = cv::createImagePageReader(filename, IMREAD_UNCHANGED);
+    ASSERT_FALSE(reader.empty());
+    ASSERT_TRUE(reader->skip());
+    ASSERT_TRUE(reader->skip());
+    EXPECT_EQ(2, reader->pageIndex());
+    EXPECT_EQ(pages[2].size(), Size(reader->info().width, reader->info().height));
+    cv::Mat page;
+    ASSERT_TRUE(reader->read(page));
+    EXPECT_EQ(0, cvtest::norm(pages[2], page, NORM_INF));
+    ASSERT_TRUE(reader->read(page));
+    EXPECT_EQ(0, cvtest::norm(pages[3], page, NORM_INF));
+    EXPECT_TRUE(reader->info().empty());
+    EXPECT_FALSE(reader->read(page));
+    EXPECT_FALSE(reader->skip());
+    remove(filename.c_str());
+}
+
+// writes an 8- or 16-bit gray or BGR image as an uncompressed little-endian tiled TIFF;
+// the tiles on the right and bottom edges are padded to the full tile size
+static void writeTiledTiff( const string& filename, const Mat& img, int tileWidth, int tileHeight )
+{
+    CV_Assert( (img.depth() == CV_8U || img.depth() == CV_16U) && (img.channels() == 1 || img.channels() == 3) );
+    int cn = img.channels(), esz1 = (int)img.elemSize1(), bits = esz1*8;
+    int tilesAcross = (img.cols + tileWidth - 1)/tileWidth, tilesDown = (img.rows + tileHeight - 1)/tileHeight;
+    int tileSize = tileWidth*tileHeight*cn*esz1;
+
+    std::vector<uchar> buf(8, 0);
+    buf[0] = buf[1] = 'I';
+    buf[2] = 42;
+
+    std::vector<int> offsets, counts;
+    for( int ty = 0; ty < tilesDown; ty++ )
+        for( int tx = 0; tx < tilesAcross; tx++ )
+        {
+            size_t pos = buf.size();
+            offsets.push_back((int)pos);
+            counts.push_back(tileSize);
+            buf.resize(pos + tileSize, 0);
+            for( int y = ty*tileHeight; y < std::min((ty + 1)*tileHeight, img.rows); y++ )
+                for( int x = tx*tileWidth; x < std::min((tx + 1)*tileWidth, img.cols); x++ )
+                    for( int c = 0; c < cn; c++ )
+                    {
+                        // TIFF keeps the RGB order
+                        int value = esz1 == 1 ? img.ptr<uchar>(y)[x*cn + cn - 1 - c] : img.ptr<ushort>(y)[x*cn + cn - 1 - c];
+                        size_t dst = pos + (((y - ty*tileHeight)*tileWidth + x - tx*tileWidth)*cn + c)*esz1;
+                        putLittleEndian(buf, dst, value, esz1);
+                    }
+        }
+
+    // tag, type (3 - SHORT, 4 - LONG) and the values, in the ascending order of the tags
+    std::vector<int> bitsPerSample(cn, bits);
+    struct Entry { int tag, type; std::vector<int> values; };
+    std::vector<Entry> entries;
+    const int scalars[][3] = { { TIFFTAG_IMAGEWIDTH, 4, img.cols }, { TIFFTAG_IMAGELENGTH, 4, img.rows },
+                               { TIFFTAG_BITSPERSAMPLE, 3, 0 }, { TIFFTAG_COMPRESSION, 3, COMPRESSION_NONE },
+                               { TIFFTAG_PHOTOMETRIC, 3, cn == 1 ? PHOTOMETRIC_MINISBLACK : PHOTOMETRIC_RGB },
+                               { TIFFTAG_SAMPLESPERPIXEL, 3, cn }, { TIFFTAG_PLANARCONFIG, 3, PLANARCONFIG_CONTIG },
+                               { TIFFTAG_TILEWIDTH, 4, tileWidth }, { TIFFTAG_TILELENGTH, 4, tileHeight },
+                               { TIFFTAG_TILEOFFSETS, 4, 0 }, { TIFFTAG_TILEBYTECOUNTS, 4, 0 } };
+    const int nentries = (int)(sizeof(scalars)/sizeof(scalars[0]));
+    for( int i = 0; i < nentries; i++ )
+    {
+        Entry e;
+        e.tag = scalars[i][0];
+        e.type = scalars[i][1];
+        e.values = e.tag == TIFFTAG_BITSPERSAMPLE ? bitsPerSample :
+                   e.tag == TIFFTAG_TILEOFFSETS ? offsets :
+                   e.tag == TIFFTAG_TILEBYTECOUNTS ? counts : std::vector<int>(1, scalars[i][2]);
+        entries.push_back(e);
+    }
+
+    // the values that do not fit into 4 bytes go before the directory
+    std::vector<int> valueOffsets(nentries, 0);
+    for( int i = 0; i < nentries; i++ )
+    {
+        int size = (int)entries[i].values.size()*(entries[i].type == 3 ? 2 : 4);
+        if( size <= 4 )
+            continue;
+        if( buf.size() % 2 )
+            buf.push_back(0);
+        valueOffsets[i] = (int)buf.size();
+        buf.resize(buf.size() + size, 0);
+    }
+    if( buf.size() % 2 )
+        buf.push_back(0);
+
+    putLittleEndian(buf, 4, (int)buf.size(), 4);
+    size_t pos = buf.size();
+    buf.resize(pos + 2 + nentries*12 + 4, 0);
+    putLittleEndian(buf, pos, nentries, 2);
+    for( int i = 0; i < nentries; i++, pos += 12 )
+    {
+        const Entry& e = entries[i];
+        int vsize = e.type == 3 ? 2 : 4;
+        putLittleEndian(buf, pos + 2, e.tag, 2);
+        putLittleEndian(buf, pos + 4, e.type, 2);
+        putLittleEndian(buf, pos + 6, (int)e.values.size(), 4);
+        size_t dst = valueOffsets[i] ? (size_t)valueOffsets[i] : pos + 10;
+        if( valueOffsets[i] )
+            putLittleEndian(buf, pos + 10, valueOffsets[i], 4);
+        for( size_t j = 0; j < e.values.size(); j++ )
+            putLittleEndian(buf, dst + j*vsize, e.values[j], vsize);
+    }
+
+    FILE* f = fopen(filename.c_str(), "wb");
+    ASSERT_TRUE(f != 0);
+    fwrite(&buf[0], 1, buf.size(), f);
+    fclose(f);
+}
+
+TEST(Highgui_Tiff, read_region_tiled)
+{
+    // 3x3 tiles of 16x16, the right and the bottom ones are partial
+    const Size size(45, 37);
+    const int flags[] = { IMREAD_UNCHANGED, IMREAD_COLOR, IMREAD_GRAYSCALE };
+    const Rect rois[] = { Rect(0, 0, size.width, size.height), Rect(5, 7, 30, 20), Rect(33, 33, 12, 4),
+                          Rect(16, 0, 16, size.height), Rect(40, 3, 5, 30) };
+
+    for( int depth = CV_8U; depth <= CV_16U; depth += CV_16U - CV_8U )
+        for( int cn = 1; cn <= 3; cn += 2 )
+        {
+            cv::Mat img(size, CV_MAKETYPE(depth, cn));
+            theRNG().fill(img, RNG::UNIFORM, 0, depth == CV_8U ? 256 : 65536);
+            string filename = cv::tempfile(".tiff");
+            writeTiledTiff(filename, img, 16, 16);
+
+            EXPECT_EQ(0, cvtest::norm(img, cv::imread(filename, IMREAD_UNCHANGED), NORM_INF)) << depth << " " << cn;
+            for( size_t j = 0; j < sizeof(flags)/sizeof(flags[0]); j++ )
+            {
+                SCOPED_TRACE(cv::format("depth %d, channels %d, flags %d", depth, cn, flags[j]));
+                checkReadRegion(filename, flags[j], rois, (int)(sizeof(rois)/sizeof(rois[0])));
+            }
+            remove(filename.c_str());
+        }
+}
+#endif
+
+TEST(Highgui_Image, read_region)
+{
+    const char* exts[] = { ".bmp"
+#ifdef HAVE_TIFF
+        , ".tiff"
+#endif
+#ifdef HAVE_PNG
+        , ".png"
+#endif
+    };
+    const int flags[] = { IMREAD_UNCHANGED, IMREAD_COLOR, IMREAD_GRAYSCALE };
+    const Rect rois[] = { Rect(0, 0, 101, 77), Rect(13, 20, 40, 31), Rect(60, 70, 41, 7) };
+
+    for( size_t i = 0; i < sizeof(exts)/sizeof(exts[0]); i++ )
+    {
+        for( int depth = CV_8U; depth <= CV_16U; depth += CV_16U - CV_8U )
+        {
+            if( depth == CV_16U && string(exts[i]) == ".bmp" )
+                continue;
+            cv::Mat img(77, 101, CV_MAKETYPE(depth, 3));
+            theRNG().fill(img, RNG::UNIFORM, 0, depth == CV_8U ? 256 : 65536);
+
+            string filename = cv::tempfile(exts[i]);
+            std::vector<int> params;
+#ifdef HAVE_TIFF
+            if( string(exts[i]) == ".tiff" )
+            {
+                // several strips per region
+                params.push_back(TIFFTAG_ROWSPERSTRIP);
+                params.push_back(8);
+            }
+#endif
+            ASSERT_TRUE(cv::imwrite(filename, img, params));
+
+            for( size_t j = 0; j < sizeof(flags)/sizeof(flags[0]); j++ )
+            {
+                SCOPED_TRACE(cv::format("%s, depth %d, flags %d", exts[i], depth, flags[j]));
+                checkReadRegion(filename, flags[j], rois, (int)(sizeof(rois)/sizeof(rois[0])));
+            }
+            remove(filename.c_str());
+        }
+    }
+}
+
+#ifdef HAVE_PNG
+TEST(Highgui_Png, write_parallel)
+{
+    const int filters[] = { -1, IMWRITE_PNG_FILTER_NONE, IMWRITE_PNG_FILTER_SUB, IMWRITE_PNG_FILTER_UP,
+                            IMWRITE_PNG_FILTER_AVG, IMWRITE_PNG_FILTER_PAETH, IMWRITE_PNG_FILTER_ALL };
+
+    for( int cn = 1; cn <= 4; cn++ )
+    {
+        if( cn == 2 )
+            continue;
+        for( int depth = CV_8U; depth <= CV_16U; depth += CV_16U - CV_8U )
+        {
+            // large enough to be split into several deflate chunks, half smooth and half noise
+            cv::Mat img(600, 500, CV_MAKETYPE(depth, cn));
+            theRNG().fill(img, RNG::UNIFORM, 0, depth == CV_8U ? 256 : 65536);
+            cv::Mat smooth = img.rowRange(0, img.rows/2);
+            cv::blur(smooth, smooth, Size(15, 15));
+
+            for( size_t i = 0; i < sizeof(filters)/sizeof(filters[0]); i++ )
+            {
+                std::vector<int> params;
+                params.push_back(IMWRITE_PNG_PARALLEL);
+                params.push_back(1);
+                if( filters[i] >= 0 )
+                {
+                    params.push_back(IMWRITE_PNG_FILTER);
+                    params.push_back(filters[i]);
+                    params.push_back(IMWRITE_PNG_COMPRESSION);
+                    params.push_back(6);
+                }
+
+                std::vector<uchar> buf;
+                ASSERT_TRUE(cv::imencode(".png", img, buf, params));
+                cv::Mat decoded = cv::imdecode(buf, IMREAD_UNCHANGED);
+                ASSERT_EQ(img.type(), decoded.type()) << cn << " " << filters[i];
+                EXPECT_EQ(0, cvtest::norm(img, decoded, NORM_INF)) << cn << " " << filters[i];
+            }
+        }
+    }
+}
+#endif
+
+#ifdef HAVE_TIFF
+TEST(Highgui_Tiff, write_deflate)
+{
+    for( int cn = 1; cn <= 4; cn++ )
+    {
+        if( cn == 2 )
+            continue;
+        for( int depth = CV_8U; depth <= CV_16U; depth += CV_16U - CV_8U )
+        {
+            cv::Mat img(301, 203, CV_MAKETYPE(depth, cn));
+            theRNG().fill(img, RNG::UNIFORM, 0, depth == CV_8U ? 256 : 65536);
+
+            // the strips written by the default (LZW) path decode to the reference
+            string ref_filename = cv::tempfile(".tiff");
+            ASSERT_TRUE(cv::imwrite(ref_filename, img));
+            cv::Mat ref = cv::imread(ref_filename, IMREAD_UNCHANGED);
+            remove(ref_filename.c_str());
+            ASSERT_FALSE(ref.empty());
+
+            for( int predictor = PREDICTOR_NONE; predictor <= PREDICTOR_HORIZONTAL; predictor++ )
+            {
+                string filename = cv::tempfile(".tiff");
+                std::vector<int> params;
+                params.push_back(TIFFTAG_COMPRESSION);
+                params.push_back(COMPRESSION_ADOBE_DEFLATE);
+                params.push_back(TIFFTAG_PREDICTOR);
+                params.push_back(predictor);
+                params.push_back(TIFFTAG_ROWSPERSTRIP);
+                params.push_back(16);
+                params.push_back(TIFFTAG_ZIPQUALITY);
+                params.push_back(predictor == PREDICTOR_NONE ? 1 : 9);
+                ASSERT_TRUE(cv::imwrite(filename, img, params));
+
+                cv::Mat decoded = cv::imread(filename, IMREAD_UNCHANGED);
+                remove(filename.c_str());
+                ASSERT_EQ(ref.type(), decoded.type()) << cn << " " << predictor;
+                EXPECT_EQ(0, cvtest::norm(ref, decoded, NORM_INF)) << cn << " " << predictor;
+            }
+        }
+    }
+}
 #endif
 
 #ifdef HAVE_WEBP
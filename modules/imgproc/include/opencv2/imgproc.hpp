@@ -184,6 +184,17 @@ enum { CHAIN_APPROX_NONE      = 1,
        CHAIN_APPROX_TC89_KCOS = 4
      };
 
+//! contour descriptors computed by computeContourDescriptors
+enum { CONTOUR_AREA          = 1,
+       CONTOUR_ARC_LENGTH    = 2,
+       CONTOUR_BOUNDING_RECT = 4,
+       CONTOUR_MIN_AREA_RECT = 8,
+       CONTOUR_FIT_ELLIPSE   = 16,
+       CONTOUR_CONVEX_HULL   = 32,
+       CONTOUR_APPROX_POLY   = 64,
+       CONTOUR_ALL           = 127
+     };
+
 //! Variants of a Hough transform
 enum { HOUGH_STANDARD      = 0,
        HOUGH_PROBABILISTIC = 1,
@@ -420,6 +431,16 @@ enum { COLOR_BGR2BGRA     = 0,
        COLOR_RGBA2YUV_YV12 = 133,
        COLOR_BGRA2YUV_YV12 = 134,
 
+       // RGB to YUV 4:2:0 semi-planar family
+       COLOR_RGB2YUV_NV12  = 139,
+       COLOR_BGR2YUV_NV12  = 140,
+       COLOR_RGB2YUV_NV21  = 141,
+       COLOR_BGR2YUV_NV21  = 142,
+       COLOR_RGBA2YUV_NV12 = 143,
+       COLOR_BGRA2YUV_NV12 = 144,
+       COLOR_RGBA2YUV_NV21 = 145,
+       COLOR_BGRA2YUV_NV21 = 146,
+
        // Demosaicing
        COLOR_BayerBG2BGR = 46,
        COLOR_BayerGB2BGR = 47,
@@ -459,7 +480,7 @@ enum { COLOR_BGR2BGRA     = 0,
        COLOR_BayerGR2RGB_EA  = COLOR_BayerGB2BGR_EA,
 
 
-       COLOR_COLORCVT_MAX  = 139
+       COLOR_COLORCVT_MAX  = 147
 };
 
 //! types of intersection between rectangles
@@ -814,6 +835,22 @@ public:
 };
 
 
+//! corrects lens distortion of many images from the same camera, see createUndistorter()
+class CV_EXPORTS_W Undistorter : public Algorithm
+{
+public:
+    //! remaps the image using the map computed once at creation
+    CV_WRAP virtual void apply(InputArray src, OutputArray dst) = 0;
+
+    //! maps the points of the source image to the corrected image, using the tabulated inverse distortion
+    CV_WRAP virtual void undistortPoints(InputArray src, OutputArray dst) = 0;
+
+    //! returns the cached CV_16SC2 + CV_16UC1 maps for cv::remap()
+    CV_WRAP virtual void getMaps(OutputArray map1, OutputArray map2) const = 0;
+    CV_WRAP virtual Size getImageSize() const = 0;
+};
+
+
 class CV_EXPORTS_W Subdiv2D
 {
 public:
@@ -870,6 +907,7 @@ protected:
     void calcVoronoi();
     void clearVoronoi();
     void checkSubdiv() const;
+    int insertPoint(Point2f pt, bool* isNew);
 
     struct CV_EXPORTS Vertex
     {
@@ -958,7 +996,7 @@ public:
 CV_EXPORTS_W Ptr<LineSegmentDetector> createLineSegmentDetector(
     int _refine = LSD_REFINE_STD, double _scale = 0.8,
     double _sigma_scale = 0.6, double _quant = 2.0, double _ang_th = 22.5,
-    double _log_eps = 0, double _density_th = 0.7, int _n_bins = 1024);
+    double _log_eps = 0, double _density_th = 0.7, int _n_bins = 1024, int _tile_size = 0);
 
 //! returns type (one of KERNEL_*) of 1D or 2D kernel specified by its coefficients.
 CV_EXPORTS int getKernelType(InputArray kernel, Point anchor);
@@ -1182,6 +1220,18 @@ CV_EXPORTS_W void resize( InputArray src, OutputArray dst,
                           Size dsize, double fx = 0, double fy = 0,
                           int interpolation = INTER_LINEAR );
 
+//! resizes the image, swaps R and B, subtracts the mean and scales it into a 4D float blob in one pass
+CV_EXPORTS_W void blobFromImage( InputArray image, OutputArray blob, Size size = Size(),
+                                 const Scalar& mean = Scalar(), double scale = 1.0,
+                                 bool swapRB = false, bool planar = true,
+                                 int interpolation = INTER_LINEAR );
+
+//! the same as blobFromImage, but processes a batch of images into one contiguous blob
+CV_EXPORTS_W void blobFromImages( InputArrayOfArrays images, OutputArray blob, Size size = Size(),
+                                  const Scalar& mean = Scalar(), double scale = 1.0,
+                                  bool swapRB = false, bool planar = true,
+                                  int interpolation = INTER_LINEAR );
+
 //! warps the image using affine transformation
 CV_EXPORTS_W void warpAffine( InputArray src, OutputArray dst,
                               InputArray M, Size dsize,
@@ -1307,6 +1357,12 @@ CV_EXPORTS_W void undistortPoints( InputArray src, OutputArray dst,
                                    InputArray cameraMatrix, InputArray distCoeffs,
                                    InputArray R = noArray(), InputArray P = noArray());
 
+//! creates the object that corrects lens distortion of many images of the given size
+CV_EXPORTS_W Ptr<Undistorter> createUndistorter( InputArray cameraMatrix, InputArray distCoeffs, Size imageSize,
+                                                 InputArray R = noArray(), InputArray newCameraMatrix = noArray(),
+                                                 int interpolation = INTER_LINEAR, int borderMode = BORDER_CONSTANT,
+                                                 const Scalar& borderValue = Scalar() );
+
 //! computes the joint dense histogram for a set of images.
 CV_EXPORTS void calcHist( const Mat* images, int nimages,
                           const int* channels, InputArray mask,
@@ -1357,6 +1413,10 @@ CV_EXPORTS float EMD( InputArray signature1, InputArray signature2,
                       int distType, InputArray cost=noArray(),
                       float* lowerBound = 0, OutputArray flow = noArray() );
 
+//! computes EMD between signature1 and each of signatures2 in parallel, optionally with the ground distance clipped at maxGroundDist
+CV_EXPORTS void EMD( InputArray signature1, InputArrayOfArrays signatures2, int distType,
+                     CV_OUT std::vector<float>& distances, float maxGroundDist = 0 );
+
 //! segments the image using watershed algorithm
 CV_EXPORTS_W void watershed( InputArray image, InputOutputArray markers );
 
@@ -1393,6 +1453,13 @@ CV_EXPORTS_W int floodFill( InputOutputArray image, InputOutputArray mask,
                             Scalar loDiff = Scalar(), Scalar upDiff = Scalar(),
                             int flags = 4 );
 
+//! fills the semi-uniform image regions and/or the mask starting from each of the seed points
+CV_EXPORTS void floodFill( InputOutputArray image, InputOutputArray mask,
+                           const std::vector<Point>& seedPoints, Scalar newVal,
+                           CV_OUT std::vector<int>& areas, CV_OUT std::vector<Rect>& rects,
+                           Scalar loDiff = Scalar(), Scalar upDiff = Scalar(),
+                           int flags = 4 );
+
 //! converts image from one color space to another
 CV_EXPORTS_W void cvtColor( InputArray src, OutputArray dst, int code, int dstCn = 0 );
 
@@ -1402,6 +1469,13 @@ CV_EXPORTS_W void demosaicing(InputArray _src, OutputArray _dst, int code, int d
 //! computes moments of the rasterized shape or a vector of points
 CV_EXPORTS_W Moments moments( InputArray array, bool binaryImage = false );
 
+//! computes moments of each contour from the vector, in parallel
+CV_EXPORTS void moments( InputArrayOfArrays contours, CV_OUT std::vector<Moments>& mu );
+
+//! computes moments of the regions 0..nlabels-1 of the label image, optionally weighted by the image
+CV_EXPORTS void moments( InputArray labels, int nlabels, CV_OUT std::vector<Moments>& mu,
+                         InputArray image = noArray() );
+
 //! computes 7 Hu invariants from the moments
 CV_EXPORTS void HuMoments( const Moments& moments, double hu[7] );
 
@@ -1483,6 +1557,24 @@ CV_EXPORTS_W float intersectConvexConvex( InputArray _p1, InputArray _p2,
 //! fits ellipse to the set of 2D points
 CV_EXPORTS_W RotatedRect fitEllipse( InputArray points );
 
+//! the descriptors of a set of contours, one element of each computed vector per contour
+class CV_EXPORTS ContourDescriptors
+{
+public:
+    std::vector<double> area;
+    std::vector<double> arcLength;
+    std::vector<Rect> boundingRect;
+    std::vector<RotatedRect> minAreaRect;
+    std::vector<RotatedRect> ellipse;
+    // the hulls and the curves of all the contours are parts of one shared buffer
+    std::vector<Mat> convexHull;
+    std::vector<Mat> approxCurve;
+};
+
+//! computes the descriptors selected by flags (CONTOUR_AREA | CONTOUR_ARC_LENGTH ...) for all the contours in parallel
+CV_EXPORTS void computeContourDescriptors( InputArrayOfArrays contours, CV_OUT ContourDescriptors& desc,
+                                           int flags, double approxEpsilon = 0, bool closed = true );
+
 //! fits line to the set of 2D points using M-estimator algorithm
 CV_EXPORTS_W void fitLine( InputArray points, OutputArray line, int distType,
                            double param, double reps, double aeps );
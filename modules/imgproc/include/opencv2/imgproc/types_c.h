@@ -324,6 +324,15 @@ enum
     CV_RGBA2YUV_YV12 = 133,
     CV_BGRA2YUV_YV12 = 134,
 
+    CV_RGB2YUV_NV12  = 139,
+    CV_BGR2YUV_NV12  = 140,
+    CV_RGB2YUV_NV21  = 141,
+    CV_BGR2YUV_NV21  = 142,
+    CV_RGBA2YUV_NV12 = 143,
+    CV_BGRA2YUV_NV12 = 144,
+    CV_RGBA2YUV_NV21 = 145,
+    CV_BGRA2YUV_NV21 = 146,
+
     // Edge-Aware Demosaicing
     CV_BayerBG2BGR_EA = 135,
     CV_BayerGB2BGR_EA = 136,
@@ -335,7 +344,7 @@ enum
     CV_BayerRG2RGB_EA = CV_BayerBG2BGR_EA,
     CV_BayerGR2RGB_EA = CV_BayerGB2BGR_EA,
 
-    CV_COLORCVT_MAX  = 139
+    CV_COLORCVT_MAX  = 147
 };
 
 
@@ -0,0 +1,67 @@
+#include "perf_precomp.hpp"
+
+using namespace std;
+using namespace cv;
+using namespace perf;
+using std::tr1::make_tuple;
+using std::tr1::get;
+
+typedef perf::TestBaseWithParam<int> ContoursCount;
+
+static void makeContours(int n, vector<vector<Point> >& contours)
+{
+    RNG& rng = theRNG();
+    contours.resize(n);
+
+    // small star-shaped polygons, similar to the contours of the blobs found in a frame
+    for( int i = 0; i < n; i++ )
+    {
+        Point c(rng.uniform(0, 1920), rng.uniform(0, 1080));
+        int npoints = rng.uniform(8, 64);
+        contours[i].resize(npoints);
+        for( int j = 0; j < npoints; j++ )
+        {
+            double a = CV_PI*2*j/npoints, r = rng.uniform(5., 20.);
+            contours[i][j] = c + Point(cvRound(r*cos(a)), cvRound(r*sin(a)));
+        }
+    }
+}
+
+static const int CONTOUR_PERF_FLAGS = CONTOUR_AREA | CONTOUR_ARC_LENGTH | CONTOUR_BOUNDING_RECT | CONTOUR_MIN_AREA_RECT;
+
+PERF_TEST_P(ContoursCount, contourDescriptors_sequential, testing::Values(1000, 50000))
+{
+    int n = GetParam();
+    vector<vector<Point> > contours;
+    makeContours(n, contours);
+    vector<double> area(n), perimeter(n);
+    vector<Rect> rects(n);
+    vector<RotatedRect> boxes(n);
+
+    TEST_CYCLE()
+    {
+        for( int i = 0; i < n; i++ )
+        {
+            area[i] = contourArea(contours[i]);
+            perimeter[i] = arcLength(contours[i], true);
+            rects[i] = boundingRect(contours[i]);
+            boxes[i] = minAreaRect(contours[i]);
+        }
+    }
+
+    Mat a(area);
+    SANITY_CHECK(a, 1e-6, ERROR_RELATIVE);
+}
+
+PERF_TEST_P(ContoursCount, contourDescriptors, testing::Values(1000, 50000))
+{
+    int n = GetParam();
+    vector<vector<Point> > contours;
+    makeContours(n, contours);
+    ContourDescriptors desc;
+
+    TEST_CYCLE() computeContourDescriptors(contours, desc, CONTOUR_PERF_FLAGS);
+
+    Mat a(desc.area);
+    SANITY_CHECK(a, 1e-6, ERROR_RELATIVE);
+}
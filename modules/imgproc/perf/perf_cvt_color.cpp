@@ -116,7 +116,9 @@ CV_ENUM(CvtMode2, COLOR_YUV2BGR_NV12, COLOR_YUV2BGRA_NV12, COLOR_YUV2RGB_NV12, C
                   COLOR_YUV2BGR_YVYU, COLOR_YUV2RGBA_YUY2, COLOR_YUV2BGRA_YUY2, COLOR_YUV2RGBA_YVYU, COLOR_YUV2BGRA_YVYU)
 
 CV_ENUM(CvtMode3, COLOR_RGB2YUV_IYUV, COLOR_BGR2YUV_IYUV, COLOR_RGBA2YUV_IYUV, COLOR_BGRA2YUV_IYUV,
-                  COLOR_RGB2YUV_YV12, COLOR_BGR2YUV_YV12, COLOR_RGBA2YUV_YV12, COLOR_BGRA2YUV_YV12)
+                  COLOR_RGB2YUV_YV12, COLOR_BGR2YUV_YV12, COLOR_RGBA2YUV_YV12, COLOR_BGRA2YUV_YV12,
+                  COLOR_RGB2YUV_NV12, COLOR_BGR2YUV_NV12, COLOR_RGBA2YUV_NV12, COLOR_BGRA2YUV_NV12,
+                  COLOR_RGB2YUV_NV21, COLOR_BGR2YUV_NV21, COLOR_RGBA2YUV_NV21, COLOR_BGRA2YUV_NV21)
 
 struct ChPair
 {
@@ -167,6 +169,8 @@ ChPair getConversionInfo(int cvtMode)
     case COLOR_BGR2GRAY: case COLOR_RGB2GRAY:
     case COLOR_RGB2YUV_IYUV: case COLOR_RGB2YUV_YV12:
     case COLOR_BGR2YUV_IYUV: case COLOR_BGR2YUV_YV12:
+    case COLOR_RGB2YUV_NV12: case COLOR_RGB2YUV_NV21:
+    case COLOR_BGR2YUV_NV12: case COLOR_BGR2YUV_NV21:
         return ChPair(3,1);
     case COLOR_BGR2BGR555: case COLOR_BGR2BGR565:
     case COLOR_RGB2BGR555: case COLOR_RGB2BGR565:
@@ -211,6 +215,8 @@ ChPair getConversionInfo(int cvtMode)
     case COLOR_BGRA2GRAY: case COLOR_RGBA2GRAY:
     case COLOR_RGBA2YUV_IYUV: case COLOR_RGBA2YUV_YV12:
     case COLOR_BGRA2YUV_IYUV: case COLOR_BGRA2YUV_YV12:
+    case COLOR_RGBA2YUV_NV12: case COLOR_RGBA2YUV_NV21:
+    case COLOR_BGRA2YUV_NV12: case COLOR_BGRA2YUV_NV21:
         return ChPair(4,1);
     case COLOR_BGRA2BGR555: case COLOR_BGRA2BGR565:
     case COLOR_RGBA2BGR555: case COLOR_RGBA2BGR565:
@@ -0,0 +1,81 @@
+#include "perf_precomp.hpp"
+
+using namespace std;
+using namespace cv;
+using namespace perf;
+using std::tr1::make_tuple;
+using std::tr1::get;
+
+typedef std::tr1::tuple<Size, int> Size_SeedsCount_t;
+typedef perf::TestBaseWithParam<Size_SeedsCount_t> Size_SeedsCount;
+
+static void makeFloodFillInput(Size sz, int nseeds, Mat& img, vector<Point>& seeds)
+{
+    RNG& rng = theRNG();
+
+    // piecewise constant image made of small blocks, so that the seeds hit many distinct regions
+    Mat blocks(sz.height/16 + 1, sz.width/16 + 1, CV_8UC1);
+    rng.fill(blocks, RNG::UNIFORM, 0, 255);
+    resize(blocks, img, sz, 0, 0, INTER_NEAREST);
+
+    seeds.resize(nseeds);
+    for( int i = 0; i < nseeds; i++ )
+        seeds[i] = Point(rng.uniform(0, sz.width), rng.uniform(0, sz.height));
+}
+
+PERF_TEST_P(Size_SeedsCount, floodFill_sequential,
+            testing::Combine(
+                testing::Values(sz720p, sz1080p),
+                testing::Values(16, 256, 4096)
+                )
+            )
+{
+    Size sz = get<0>(GetParam());
+    int nseeds = get<1>(GetParam());
+
+    Mat src;
+    vector<Point> seeds;
+    makeFloodFillInput(sz, nseeds, src, seeds);
+
+    Mat img(sz, CV_8UC1), mask(sz.height + 2, sz.width + 2, CV_8UC1);
+    declare.in(src).out(img, mask);
+
+    TEST_CYCLE()
+    {
+        src.copyTo(img);
+        mask.setTo(Scalar::all(0));
+        for( int i = 0; i < nseeds; i++ )
+            floodFill(img, mask, seeds[i], Scalar::all(255), 0, Scalar::all(2), Scalar::all(2), 8);
+    }
+
+    SANITY_CHECK(img);
+}
+
+PERF_TEST_P(Size_SeedsCount, floodFill_seeds,
+            testing::Combine(
+                testing::Values(sz720p, sz1080p),
+                testing::Values(16, 256, 4096)
+                )
+            )
+{
+    Size sz = get<0>(GetParam());
+    int nseeds = get<1>(GetParam());
+
+    Mat src;
+    vector<Point> seeds;
+    makeFloodFillInput(sz, nseeds, src, seeds);
+
+    Mat img(sz, CV_8UC1), mask(sz.height + 2, sz.width + 2, CV_8UC1);
+    vector<int> areas;
+    vector<Rect> rects;
+    declare.in(src).out(img, mask);
+
+    TEST_CYCLE()
+    {
+        src.copyTo(img);
+        mask.setTo(Scalar::all(0));
+        floodFill(img, mask, seeds, Scalar::all(255), areas, rects, Scalar::all(2), Scalar::all(2), 8);
+    }
+
+    SANITY_CHECK(img);
+}
@@ -0,0 +1,79 @@
+#include "perf_precomp.hpp"
+
+using namespace std;
+using namespace cv;
+using namespace perf;
+
+typedef perf::TestBaseWithParam<Size> Size_Only;
+
+static Mat makeTemplate()
+{
+    Mat templ(64, 64, CV_8UC1, Scalar::all(0));
+    rectangle(templ, Point(10, 12), Point(50, 40), Scalar::all(255), -1);
+    circle(templ, Point(40, 44), 12, Scalar::all(160), -1);
+    return templ;
+}
+
+static void makeScene(Size size, const Mat& templ, Mat& edges, Mat& dx, Mat& dy)
+{
+    Mat image(size, CV_8UC1, Scalar::all(0));
+
+    RNG rng(123456789);
+    for (int i = 0; i < 10; ++i)
+    {
+        const double scale = rng.uniform(0.8, 1.2);
+        const double angle = 90.0 * rng.uniform(0, 4);
+
+        Mat obj;
+        warpAffine(templ, obj, getRotationMatrix2D(Point2f(templ.cols * 0.5f, templ.rows * 0.5f), angle, scale), templ.size());
+
+        Mat roi = image(Rect(Point(rng.uniform(0, size.width - obj.cols), rng.uniform(0, size.height - obj.rows)), obj.size()));
+        max(roi, obj, roi);
+    }
+
+    Canny(image, edges, 50, 100);
+    Sobel(image, dx, CV_32F, 1, 0);
+    Sobel(image, dy, CV_32F, 0, 1);
+}
+
+PERF_TEST_P(Size_Only, GeneralizedHoughBallard, testing::Values(szVGA, sz720p))
+{
+    const Mat templ = makeTemplate();
+
+    Mat edges, dx, dy;
+    makeScene(GetParam(), templ, edges, dx, dy);
+
+    Ptr<GeneralizedHoughBallard> alg = createGeneralizedHoughBallard();
+    alg->setVotesThreshold(30);
+    alg->setTemplate(templ);
+
+    Mat positions;
+
+    TEST_CYCLE() alg->detect(edges, dx, dy, positions);
+
+    SANITY_CHECK(positions, 1e-6, ERROR_RELATIVE);
+}
+
+PERF_TEST_P(Size_Only, GeneralizedHoughGuil, testing::Values(szVGA, sz720p))
+{
+    declare.time(30);
+
+    const Mat templ = makeTemplate();
+
+    Mat edges, dx, dy;
+    makeScene(GetParam(), templ, edges, dx, dy);
+
+    Ptr<GeneralizedHoughGuil> alg = createGeneralizedHoughGuil();
+    alg->setMinDist(20);
+    alg->setAngleStep(2);
+    alg->setAngleThresh(1500);
+    alg->setScaleThresh(300);
+    alg->setPosThresh(30);
+    alg->setTemplate(templ);
+
+    Mat positions;
+
+    TEST_CYCLE() alg->detect(edges, dx, dy, positions);
+
+    SANITY_CHECK(positions, 1e-6, ERROR_RELATIVE);
+}
@@ -0,0 +1,105 @@
+#include "perf_precomp.hpp"
+
+using namespace std;
+using namespace cv;
+using namespace perf;
+using std::tr1::make_tuple;
+using std::tr1::get;
+
+CV_ENUM(MomentsDepth, CV_8U, CV_16U, CV_32F)
+
+typedef std::tr1::tuple<Size, MomentsDepth, bool> Size_Depth_Binary_t;
+typedef perf::TestBaseWithParam<Size_Depth_Binary_t> Size_Depth_Binary;
+
+PERF_TEST_P(Size_Depth_Binary, moments,
+            testing::Combine(
+                testing::Values(sz720p, sz1080p),
+                MomentsDepth::all(),
+                testing::Bool()
+                )
+            )
+{
+    Size sz = get<0>(GetParam());
+    int depth = get<1>(GetParam());
+    bool binary = get<2>(GetParam());
+
+    Mat src(sz, depth), hu(7, 1, CV_64F);
+    Moments m;
+
+    declare.in(src, WARMUP_RNG).out(hu);
+
+    TEST_CYCLE() m = moments(src, binary);
+
+    HuMoments(m, hu);
+    SANITY_CHECK(hu, 1e-6, ERROR_RELATIVE);
+}
+
+typedef std::tr1::tuple<Size, int> Size_LabelsCount_t;
+typedef perf::TestBaseWithParam<Size_LabelsCount_t> Size_LabelsCount;
+
+static Mat centroids(const vector<Moments>& mu)
+{
+    Mat c((int)mu.size(), 2, CV_64F);
+    for( size_t i = 0; i < mu.size(); i++ )
+    {
+        c.at<double>((int)i, 0) = mu[i].m10/mu[i].m00;
+        c.at<double>((int)i, 1) = mu[i].m01/mu[i].m00;
+    }
+    return c;
+}
+
+static void makeLabels(Size sz, int nlabels, Mat& labels)
+{
+    // piecewise constant label image made of small blocks
+    Mat blocks(sz.height/16 + 1, sz.width/16 + 1, CV_32SC1);
+    theRNG().fill(blocks, RNG::UNIFORM, 0, nlabels);
+    resize(blocks, labels, sz, 0, 0, INTER_NEAREST);
+}
+
+PERF_TEST_P(Size_LabelsCount, moments_labels_sequential,
+            testing::Combine(
+                testing::Values(sz720p),
+                testing::Values(16, 256)
+                )
+            )
+{
+    Size sz = get<0>(GetParam());
+    int nlabels = get<1>(GetParam());
+
+    Mat labels;
+    makeLabels(sz, nlabels, labels);
+    vector<Moments> mu(nlabels);
+
+    declare.in(labels);
+
+    TEST_CYCLE()
+    {
+        for( int l = 0; l < nlabels; l++ )
+            mu[l] = moments(labels == l, true);
+    }
+
+    Mat c = centroids(mu);
+    SANITY_CHECK(c, 1e-6, ERROR_RELATIVE);
+}
+
+PERF_TEST_P(Size_LabelsCount, moments_labels,
+            testing::Combine(
+                testing::Values(sz720p),
+                testing::Values(16, 256)
+                )
+            )
+{
+    Size sz = get<0>(GetParam());
+    int nlabels = get<1>(GetParam());
+
+    Mat labels;
+    makeLabels(sz, nlabels, labels);
+    vector<Moments> mu;
+
+    declare.in(labels);
+
+    TEST_CYCLE() moments(labels, nlabels, mu);
+
+    Mat c = centroids(mu);
+    SANITY_CHECK(c, 1e-6, ERROR_RELATIVE);
+}
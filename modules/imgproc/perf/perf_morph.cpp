@@ -39,3 +39,28 @@ PERF_TEST_P(Size_MatType, dilate, TYPICAL_MATS_MORPH)
 
     SANITY_CHECK(dst);
 }
+
+CV_ENUM(MorphShape, MORPH_RECT, MORPH_CROSS, MORPH_ELLIPSE)
+
+typedef std::tr1::tuple<Size, MatType, MorphShape> Size_MatType_Shape_t;
+typedef perf::TestBaseWithParam<Size_MatType_Shape_t> Size_MatType_Shape;
+
+PERF_TEST_P(Size_MatType_Shape, erode_largeKernel,
+            testing::Combine(testing::Values(szVGA, sz1080p),
+                             testing::Values(CV_8UC1, CV_16UC1, CV_32FC1),
+                             MorphShape::all()))
+{
+    Size sz = get<0>(GetParam());
+    int type = get<1>(GetParam());
+    int shape = get<2>(GetParam());
+
+    Mat src(sz, type);
+    Mat dst(sz, type);
+    Mat kernel = getStructuringElement(shape, Size(51, 51));
+
+    declare.in(src, WARMUP_RNG).out(dst);
+
+    TEST_CYCLE() erode(src, dst, kernel);
+
+    SANITY_CHECK(dst);
+}
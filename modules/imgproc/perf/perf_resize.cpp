@@ -120,3 +120,29 @@ PERF_TEST_P(MatInfo_Size_Scale_Area, ResizeArea,
     //difference equal to 1 is allowed because of different possible rounding modes: round-to-nearest vs bankers' rounding
     SANITY_CHECK(dst, 1);
 }
+
+typedef tr1::tuple<MatType, Size, bool> MatInfo_Size_Planar_t;
+typedef TestBaseWithParam<MatInfo_Size_Planar_t> MatInfo_Size_Planar;
+
+PERF_TEST_P(MatInfo_Size_Planar, blobFromImage,
+            testing::Combine(
+                testing::Values(CV_8UC3, CV_8UC4),
+                testing::Values(szVGA, sz1080p),
+                testing::Bool()
+                )
+            )
+{
+    int matType = get<0>(GetParam());
+    Size from = get<1>(GetParam());
+    bool planar = get<2>(GetParam());
+    int cn = CV_MAT_CN(matType);
+    int sz[] = { 1, cn, 224, 224 };
+
+    cv::Mat src(from, matType), blob(4, sz, CV_32F);
+    cvtest::fillGradient(src);
+    declare.in(src).out(blob);
+
+    TEST_CYCLE() blobFromImage(src, blob, Size(224, 224), Scalar(104, 117, 123), 1./255, true, planar);
+
+    SANITY_CHECK(blob, 1e-5);
+}
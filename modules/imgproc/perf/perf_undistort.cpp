@@ -0,0 +1,75 @@
+#include "perf_precomp.hpp"
+
+using namespace std;
+using namespace cv;
+using namespace perf;
+
+typedef perf::TestBaseWithParam<Size> Size_Only;
+
+static void getCameraParams(Size sz, Mat& A, Mat& D)
+{
+    A = (Mat_<double>(3, 3) << sz.width*0.7, 0, sz.width*0.5, 0, sz.width*0.7, sz.height*0.5, 0, 0, 1);
+    D = (Mat_<double>(1, 5) << -0.28, 0.09, 0.001, -0.0005, -0.01);
+}
+
+PERF_TEST_P(Size_Only, undistort, testing::Values(szVGA, sz720p, sz1080p))
+{
+    Size sz = GetParam();
+    Mat A, D;
+    getCameraParams(sz, A, D);
+
+    Mat src(sz, CV_8UC3), dst(sz, CV_8UC3);
+    declare.in(src, WARMUP_RNG).out(dst);
+
+    TEST_CYCLE() undistort(src, dst, A, D);
+
+    SANITY_CHECK(dst, 1);
+}
+
+PERF_TEST_P(Size_Only, Undistorter_apply, testing::Values(szVGA, sz720p, sz1080p))
+{
+    Size sz = GetParam();
+    Mat A, D;
+    getCameraParams(sz, A, D);
+
+    Mat src(sz, CV_8UC3), dst(sz, CV_8UC3);
+    declare.in(src, WARMUP_RNG).out(dst);
+
+    Ptr<Undistorter> undistorter = createUndistorter(A, D, sz);
+
+    TEST_CYCLE() undistorter->apply(src, dst);
+
+    SANITY_CHECK(dst, 1);
+}
+
+typedef perf::TestBaseWithParam<int> PointsCount;
+
+PERF_TEST_P(PointsCount, undistortPoints, testing::Values(10000, 1000000))
+{
+    Size sz = sz720p;
+    Mat A, D;
+    getCameraParams(sz, A, D);
+
+    Mat pts(1, GetParam(), CV_32FC2), dst;
+    theRNG().fill(pts, RNG::UNIFORM, Scalar::all(0), Scalar(sz.width, sz.height));
+
+    TEST_CYCLE() undistortPoints(pts, dst, A, D, noArray(), A);
+
+    SANITY_CHECK(dst, 1e-3);
+}
+
+PERF_TEST_P(PointsCount, Undistorter_undistortPoints, testing::Values(10000, 1000000))
+{
+    Size sz = sz720p;
+    Mat A, D;
+    getCameraParams(sz, A, D);
+
+    Mat pts(1, GetParam(), CV_32FC2), dst;
+    theRNG().fill(pts, RNG::UNIFORM, Scalar::all(0), Scalar(sz.width, sz.height));
+
+    Ptr<Undistorter> undistorter = createUndistorter(A, D, sz);
+
+    TEST_CYCLE() undistorter->undistortPoints(pts, dst);
+
+    SANITY_CHECK(dst, 1e-3);
+}
@@ -671,6 +671,18 @@ approxPolyDP_( const Point_<T>* src_contour, int count0, Point_<T>* dst_contour,
 
 }
 
+int cv::approxPolyDPToBuffer( const Mat& curve, void* dst, double epsilon, bool closed,
+                              AutoBuffer<Range>* stack )
+{
+    int npoints = curve.checkVector(2), depth = curve.depth();
+    if( depth == CV_32S )
+        return approxPolyDP_(curve.ptr<Point>(), npoints, (Point*)dst, closed, epsilon, stack);
+    if( depth == CV_32F )
+        return approxPolyDP_(curve.ptr<Point2f>(), npoints, (Point2f*)dst, closed, epsilon, stack);
+    CV_Error( CV_StsUnsupportedFormat, "" );
+    return 0;
+}
+
 void cv::approxPolyDP( InputArray _curve, OutputArray _approxCurve,
                       double epsilon, bool closed )
 {
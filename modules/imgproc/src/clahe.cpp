@@ -46,6 +46,7 @@
 
 namespace
 {
+    template <class T, int histSize>
     class CLAHE_CalcLut_Body : public cv::ParallelLoopBody
     {
     public:
@@ -67,12 +68,14 @@ namespace
         float lutScale_;
     };
 
-    void CLAHE_CalcLut_Body::operator ()(const cv::Range& range) const
+    template <class T, int histSize>
+    void CLAHE_CalcLut_Body<T, histSize>::operator ()(const cv::Range& range) const
     {
-        const int histSize = 256;
+        cv::AutoBuffer<int> _tileHist(histSize);
+        int* tileHist = _tileHist;
 
-        uchar* tileLut = lut_.ptr(range.start);
-        const size_t lut_step = lut_.step;
+        T* tileLut = lut_.ptr<T>(range.start);
+        const size_t lut_step = lut_.step / sizeof(T);
 
         for (int k = range.start; k < range.end; ++k, tileLut += lut_step)
         {
@@ -91,11 +94,11 @@ namespace
 
             // calc histogram
 
-            int tileHist[histSize] = {0, };
+            memset(tileHist, 0, histSize * sizeof(tileHist[0]));
 
             int height = tileROI.height;
-            const size_t sstep = tile.step;
-            for (const uchar* ptr = tile.ptr<uchar>(0); height--; ptr += sstep)
+            const size_t sstep = tile.step / sizeof(T);
+            for (const T* ptr = tile.ptr<T>(0); height--; ptr += sstep)
             {
                 int x = 0;
                 for (; x <= tileROI.width - 4; x += 4)
@@ -142,17 +145,43 @@ namespace
             for (int i = 0; i < histSize; ++i)
             {
                 sum += tileHist[i];
-                tileLut[i] = cv::saturate_cast<uchar>(sum * lutScale_);
+                tileLut[i] = cv::saturate_cast<T>(sum * lutScale_);
             }
         }
     }
 
+    template <class T>
     class CLAHE_Interpolation_Body : public cv::ParallelLoopBody
     {
     public:
         CLAHE_Interpolation_Body(const cv::Mat& src, cv::Mat& dst, const cv::Mat& lut, cv::Size tileSize, int tilesX, int tilesY) :
             src_(src), dst_(dst), lut_(lut), tileSize_(tileSize), tilesX_(tilesX), tilesY_(tilesY)
         {
+            // the horizontal interpolation coefficients are the same for all the rows
+            ibuf_.allocate(src.cols * 2);
+            fbuf_.allocate(src.cols * 2);
+            ind1_p = ibuf_;
+            ind2_p = ind1_p + src.cols;
+            xa_p = fbuf_;
+            xa1_p = xa_p + src.cols;
+
+            const int lut_step = static_cast<int>(lut_.step / sizeof(T));
+            for (int x = 0; x < src.cols; ++x)
+            {
+                const float txf = (static_cast<float>(x) / tileSize_.width) - 0.5f;
+
+                int tx1 = cvFloor(txf);
+                int tx2 = tx1 + 1;
+
+                xa_p[x] = txf - tx1;
+                xa1_p[x] = 1.0f - xa_p[x];
+
+                tx1 = std::max(tx1, 0);
+                tx2 = std::min(tx2, tilesX_ - 1);
+
+                ind1_p[x] = tx1 * lut_step;
+                ind2_p[x] = tx2 * lut_step;
+            }
         }
 
         void operator ()(const cv::Range& range) const;
@@ -165,55 +194,104 @@ namespace
         cv::Size tileSize_;
         int tilesX_;
         int tilesY_;
+
+        cv::AutoBuffer<int> ibuf_;
+        cv::AutoBuffer<float> fbuf_;
+        int * ind1_p, * ind2_p;
+        float * xa_p, * xa1_p;
     };
 
-    void CLAHE_Interpolation_Body::operator ()(const cv::Range& range) const
+#if CV_SSE2
+    static inline void CLAHE_storeRes(uchar* dst, __m128i v)
     {
-        const size_t lut_step = lut_.step;
+        v = _mm_packs_epi32(v, v);
+        *(int*)dst = _mm_cvtsi128_si32(_mm_packus_epi16(v, v));
+    }
+
+    static inline void CLAHE_storeRes(ushort* dst, __m128i v)
+    {
+        // saturating pack of signed 32-bit values to unsigned 16-bit ones with SSE2 only
+        const __m128i delta = _mm_set1_epi32(32768);
+        v = _mm_packs_epi32(_mm_sub_epi32(v, delta), _mm_sub_epi32(v, delta));
+        v = _mm_add_epi16(v, _mm_set1_epi16((short)-32768));
+        _mm_storel_epi64((__m128i*)dst, v);
+    }
+#endif
+
+    template <class T>
+    void CLAHE_Interpolation_Body<T>::operator ()(const cv::Range& range) const
+    {
+#if CV_SSE2
+        volatile bool useSIMD = cv::checkHardwareSupport(CV_CPU_SSE2);
+#endif
 
         for (int y = range.start; y < range.end; ++y)
         {
-            const uchar* srcRow = src_.ptr<uchar>(y);
-            uchar* dstRow = dst_.ptr<uchar>(y);
+            const T* srcRow = src_.ptr<T>(y);
+            T* dstRow = dst_.ptr<T>(y);
 
             const float tyf = (static_cast<float>(y) / tileSize_.height) - 0.5f;
 
             int ty1 = cvFloor(tyf);
             int ty2 = ty1 + 1;
 
-            const float ya = tyf - ty1;
+            const float ya = tyf - ty1, ya1 = 1.0f - ya;
 
             ty1 = std::max(ty1, 0);
             ty2 = std::min(ty2, tilesY_ - 1);
 
-            const uchar* lutPlane1 = lut_.ptr(ty1 * tilesX_);
-            const uchar* lutPlane2 = lut_.ptr(ty2 * tilesX_);
+            const T* lutPlane1 = lut_.ptr<T>(ty1 * tilesX_);
+            const T* lutPlane2 = lut_.ptr<T>(ty2 * tilesX_);
+
+            int x = 0;
 
-            for (int x = 0; x < src_.cols; ++x)
+#if CV_SSE2
+            if (useSIMD)
             {
-                const float txf = (static_cast<float>(x) / tileSize_.width) - 0.5f;
+                const __m128 v_ya = _mm_set1_ps(ya), v_ya1 = _mm_set1_ps(ya1);
 
-                int tx1 = cvFloor(txf);
-                int tx2 = tx1 + 1;
+                for (; x <= src_.cols - 4; x += 4)
+                {
+                    const int srcVal0 = srcRow[x], srcVal1 = srcRow[x + 1];
+                    const int srcVal2 = srcRow[x + 2], srcVal3 = srcRow[x + 3];
 
-                const float xa = txf - tx1;
+                    const int i10 = ind1_p[x] + srcVal0, i11 = ind1_p[x + 1] + srcVal1;
+                    const int i12 = ind1_p[x + 2] + srcVal2, i13 = ind1_p[x + 3] + srcVal3;
+                    const int i20 = ind2_p[x] + srcVal0, i21 = ind2_p[x + 1] + srcVal1;
+                    const int i22 = ind2_p[x + 2] + srcVal2, i23 = ind2_p[x + 3] + srcVal3;
 
-                tx1 = std::max(tx1, 0);
-                tx2 = std::min(tx2, tilesX_ - 1);
+                    __m128 v_lut11 = _mm_setr_ps(lutPlane1[i10], lutPlane1[i11], lutPlane1[i12], lutPlane1[i13]);
+                    __m128 v_lut12 = _mm_setr_ps(lutPlane1[i20], lutPlane1[i21], lutPlane1[i22], lutPlane1[i23]);
+                    __m128 v_lut21 = _mm_setr_ps(lutPlane2[i10], lutPlane2[i11], lutPlane2[i12], lutPlane2[i13]);
+                    __m128 v_lut22 = _mm_setr_ps(lutPlane2[i20], lutPlane2[i21], lutPlane2[i22], lutPlane2[i23]);
+
+                    __m128 v_xa = _mm_loadu_ps(xa_p + x), v_xa1 = _mm_loadu_ps(xa1_p + x);
+
+                    __m128 v_res = _mm_mul_ps(v_lut11, _mm_mul_ps(v_xa1, v_ya1));
+                    v_res = _mm_add_ps(v_res, _mm_mul_ps(v_lut12, _mm_mul_ps(v_xa, v_ya1)));
+                    v_res = _mm_add_ps(v_res, _mm_mul_ps(v_lut21, _mm_mul_ps(v_xa1, v_ya)));
+                    v_res = _mm_add_ps(v_res, _mm_mul_ps(v_lut22, _mm_mul_ps(v_xa, v_ya)));
+
+                    CLAHE_storeRes(dstRow + x, _mm_cvtps_epi32(v_res));
+                }
+            }
+#endif
 
+            for (; x < src_.cols; ++x)
+            {
                 const int srcVal = srcRow[x];
 
-                const size_t ind1 = tx1 * lut_step + srcVal;
-                const size_t ind2 = tx2 * lut_step + srcVal;
+                const int ind1 = ind1_p[x] + srcVal;
+                const int ind2 = ind2_p[x] + srcVal;
 
                 float res = 0;
 
-                res += lutPlane1[ind1] * ((1.0f - xa) * (1.0f - ya));
-                res += lutPlane1[ind2] * ((xa) * (1.0f - ya));
-                res += lutPlane2[ind1] * ((1.0f - xa) * (ya));
-                res += lutPlane2[ind2] * ((xa) * (ya));
+                res += lutPlane1[ind1] * (xa1_p[x] * ya1);
+                res += lutPlane1[ind2] * (xa_p[x] * ya1);
+                res += lutPlane2[ind1] * (xa1_p[x] * ya);
+                res += lutPlane2[ind2] * (xa_p[x] * ya);
 
-                dstRow[x] = cv::saturate_cast<uchar>(res);
+                dstRow[x] = cv::saturate_cast<T>(res);
             }
         }
     }
@@ -258,14 +336,14 @@ namespace
     {
         cv::Mat src = _src.getMat();
 
-        CV_Assert( src.type() == CV_8UC1 );
+        CV_Assert( src.type() == CV_8UC1 || src.type() == CV_16UC1 );
 
         _dst.create( src.size(), src.type() );
         cv::Mat dst = _dst.getMat();
 
-        const int histSize = 256;
+        const int histSize = src.type() == CV_8UC1 ? 256 : 65536;
 
-        lut_.create(tilesX_ * tilesY_, histSize, CV_8UC1);
+        lut_.create(tilesX_ * tilesY_, histSize, src.type());
 
         cv::Size tileSize;
         cv::Mat srcForLut;
@@ -293,11 +371,22 @@ namespace
             clipLimit = std::max(clipLimit, 1);
         }
 
-        CLAHE_CalcLut_Body calcLutBody(srcForLut, lut_, tileSize, tilesX_, tilesY_, clipLimit, lutScale);
-        cv::parallel_for_(cv::Range(0, tilesX_ * tilesY_), calcLutBody);
+        if (src.type() == CV_8UC1)
+        {
+            CLAHE_CalcLut_Body<uchar, 256> calcLutBody(srcForLut, lut_, tileSize, tilesX_, tilesY_, clipLimit, lutScale);
+            cv::parallel_for_(cv::Range(0, tilesX_ * tilesY_), calcLutBody);
 
-        CLAHE_Interpolation_Body interpolationBody(src, dst, lut_, tileSize, tilesX_, tilesY_);
-        cv::parallel_for_(cv::Range(0, src.rows), interpolationBody);
+            CLAHE_Interpolation_Body<uchar> interpolationBody(src, dst, lut_, tileSize, tilesX_, tilesY_);
+            cv::parallel_for_(cv::Range(0, src.rows), interpolationBody);
+        }
+        else
+        {
+            CLAHE_CalcLut_Body<ushort, 65536> calcLutBody(srcForLut, lut_, tileSize, tilesX_, tilesY_, clipLimit, lutScale);
+            cv::parallel_for_(cv::Range(0, tilesX_ * tilesY_), calcLutBody);
+
+            CLAHE_Interpolation_Body<ushort> interpolationBody(src, dst, lut_, tileSize, tilesX_, tilesY_);
+            cv::parallel_for_(cv::Range(0, src.rows), interpolationBody);
+        }
     }
 
     void CLAHE_Impl::setClipLimit(double clipLimit)
@@ -139,6 +139,25 @@ template<typename _Tp> static inline _Tp splineInterpolate(_Tp x, const _Tp* tab
     return ((tab[3]*x + tab[2])*x + tab[1])*x + tab[0];
 }
 
+#if CV_SSE2
+// the same as splineInterpolate for 4 values at once
+static inline __m128 splineInterpolate_SSE2(__m128 x, const float* tab, int n)
+{
+    __m128i ix = _mm_cvttps_epi32(x);
+    ix = _mm_and_si128(ix, _mm_cmpgt_epi32(ix, _mm_setzero_si128()));
+    __m128i nmask = _mm_cmpgt_epi32(ix, _mm_set1_epi32(n - 1));
+    ix = _mm_or_si128(_mm_and_si128(nmask, _mm_set1_epi32(n - 1)), _mm_andnot_si128(nmask, ix));
+    x = _mm_sub_ps(x, _mm_cvtepi32_ps(ix));
+
+    int CV_DECL_ALIGNED(16) idx[4];
+    _mm_store_si128((__m128i*)idx, ix);
+    __m128 t0 = _mm_loadu_ps(tab + idx[0]*4), t1 = _mm_loadu_ps(tab + idx[1]*4);
+    __m128 t2 = _mm_loadu_ps(tab + idx[2]*4), t3 = _mm_loadu_ps(tab + idx[3]*4);
+    _MM_TRANSPOSE4_PS(t0, t1, t2, t3);
+    return _mm_add_ps(_mm_mul_ps(_mm_add_ps(_mm_mul_ps(_mm_add_ps(_mm_mul_ps(t3, x), t2), x), t1), x), t0);
+}
+#endif
+
 
 template<typename _Tp> struct ColorChannel
 {
@@ -161,6 +180,94 @@ template<> struct ColorChannel<float>
     static double half() { return 0.5; }
 };*/
 
+#if CV_SSE2
+
+// 4 pixels of 4 bytes with zero alpha -> 12 bytes (the last 4 bytes are zero)
+static inline __m128i packPixels3_SSE2(__m128i p)
+{
+    const __m128i even32 = _mm_set_epi32(0, -1, 0, -1), lo64 = _mm_set_epi32(0, 0, -1, -1);
+    __m128i t = _mm_or_si128(_mm_and_si128(p, even32), _mm_srli_epi64(_mm_andnot_si128(even32, p), 8));
+    return _mm_or_si128(_mm_and_si128(t, lo64), _mm_srli_si128(_mm_andnot_si128(lo64, t), 2));
+}
+
+// 12 bytes of 4 pixels -> 4 pixels of 4 bytes with zero alpha
+static inline __m128i unpackPixels3_SSE2(__m128i p)
+{
+    const __m128i lo48 = _mm_set_epi32(0, 0, 0xffff, -1), lo24 = _mm_set_epi32(0, 0xffffff, 0, 0xffffff);
+    __m128i t = _mm_or_si128(_mm_and_si128(p, lo48), _mm_and_si128(_mm_slli_si128(p, 2), _mm_slli_si128(lo48, 8)));
+    return _mm_or_si128(_mm_and_si128(t, lo24), _mm_and_si128(_mm_slli_epi64(t, 8), _mm_slli_epi64(lo24, 32)));
+}
+
+// loads 16 pixels of scn (3 or 4) bytes, 4 pixels per register; the 4th byte of a 3-channel pixel is zero
+static inline void loadPixels16_SSE2(const uchar* src, int scn, __m128i* p)
+{
+    if( scn == 4 )
+    {
+        for( int j = 0; j < 4; j++ )
+            p[j] = _mm_loadu_si128((const __m128i*)(src + j*16));
+    }
+    else
+    {
+        __m128i v0 = _mm_loadu_si128((const __m128i*)src);
+        __m128i v1 = _mm_loadu_si128((const __m128i*)(src + 16));
+        __m128i v2 = _mm_loadu_si128((const __m128i*)(src + 32));
+        p[0] = unpackPixels3_SSE2(v0);
+        p[1] = unpackPixels3_SSE2(_mm_or_si128(_mm_srli_si128(v0, 12), _mm_slli_si128(v1, 4)));
+        p[2] = unpackPixels3_SSE2(_mm_or_si128(_mm_srli_si128(v1, 8), _mm_slli_si128(v2, 8)));
+        p[3] = unpackPixels3_SSE2(_mm_srli_si128(v2, 4));
+    }
+}
+
+// stores 16 pixels of 4 bytes (4 per register, the 4th byte must be zero) as 48 bytes of 3-channel pixels
+static inline void storePixels16x3_SSE2(uchar* dst, const __m128i* p)
+{
+    __m128i p0 = packPixels3_SSE2(p[0]), p1 = packPixels3_SSE2(p[1]);
+    __m128i p2 = packPixels3_SSE2(p[2]), p3 = packPixels3_SSE2(p[3]);
+    _mm_storeu_si128((__m128i*)dst, _mm_or_si128(p0, _mm_slli_si128(p1, 12)));
+    _mm_storeu_si128((__m128i*)(dst + 16), _mm_or_si128(_mm_srli_si128(p1, 4), _mm_slli_si128(p2, 8)));
+    _mm_storeu_si128((__m128i*)(dst + 32), _mm_or_si128(_mm_srli_si128(p2, 8), _mm_slli_si128(p3, 4)));
+}
+
+// loads 4 pixels of scn (3 or 4) floats and returns their first 3 channels
+static inline void loadPixels4f_SSE2(const float* src, int scn, __m128& c0, __m128& c1, __m128& c2)
+{
+    __m128 p0, p1, p2, p3;
+    if( scn == 4 )
+    {
+        p0 = _mm_loadu_ps(src); p1 = _mm_loadu_ps(src + 4);
+        p2 = _mm_loadu_ps(src + 8); p3 = _mm_loadu_ps(src + 12);
+    }
+    else
+    {
+        p0 = _mm_loadu_ps(src); p1 = _mm_loadu_ps(src + 3);
+        p2 = _mm_loadu_ps(src + 6); p3 = _mm_loadu_ps(src + 8);
+        p3 = _mm_shuffle_ps(p3, p3, _MM_SHUFFLE(0, 3, 2, 1));
+    }
+    _MM_TRANSPOSE4_PS(p0, p1, p2, p3);
+    c0 = p0; c1 = p1; c2 = p2;
+}
+
+// stores 4 pixels of 3 floats; exactly 12 floats are written
+static inline void storePixels4x3f_SSE2(float* dst, __m128 c0, __m128 c1, __m128 c2)
+{
+    __m128 c3 = _mm_setzero_ps();
+    _MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+    _mm_storeu_ps(dst, c0);
+    _mm_storeu_ps(dst + 3, c1);
+    _mm_storeu_ps(dst + 6, c2);
+    _mm_storel_pi((__m64*)(dst + 9), c3);
+    _mm_store_ss(dst + 11, _mm_movehl_ps(c3, c3));
+}
+
+// low 32 bits of the products of signed or unsigned 32-bit integers
+static inline __m128i mul32_SSE2(__m128i a, __m128i b)
+{
+    __m128i e = _mm_mul_epu32(a, b), o = _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+    return _mm_unpacklo_epi32(_mm_shuffle_epi32(e, _MM_SHUFFLE(0, 0, 2, 0)), _mm_shuffle_epi32(o, _MM_SHUFFLE(0, 0, 2, 0)));
+}
+
+#endif
+
 
 ///////////////////////////// Top-level template function ////////////////////////////////
 
@@ -1109,7 +1216,49 @@ struct RGB2HSV_b
     : srccn(_srccn), blueIdx(_blueIdx), hrange(_hrange)
     {
         CV_Assert( hrange == 180 || hrange == 256 );
+#if CV_SSE2
+        haveSIMD = checkHardwareSupport(CV_CPU_SSE2);
+#endif
+    }
+
+#if CV_SSE2
+    // 4 pixels in 32-bit lanes -> 4 HSV pixels in 32-bit lanes with zero 4th byte.
+    // The divisions of the scalar tables are recomputed in single precision, which gives the same values.
+    void process(__m128i p, __m128i& res) const
+    {
+        const int hsv_shift = 12;
+        const __m128i lo8 = _mm_set1_epi32(0xff), zero = _mm_setzero_si128();
+        const __m128i half = _mm_set1_epi32(1 << (hsv_shift - 1));
+        int hr = hrange;
+
+        __m128i c0 = _mm_and_si128(p, lo8);
+        __m128i g = _mm_and_si128(_mm_srli_epi32(p, 8), lo8);
+        __m128i c2 = _mm_and_si128(_mm_srli_epi32(p, 16), lo8);
+        __m128i b = blueIdx == 0 ? c0 : c2, r = blueIdx == 0 ? c2 : c0;
+
+        __m128i v = _mm_max_epi16(_mm_max_epi16(b, g), r);
+        __m128i diff = _mm_sub_epi32(v, _mm_min_epi16(_mm_min_epi16(b, g), r));
+        __m128i vr = _mm_cmpeq_epi32(v, r), vg = _mm_cmpeq_epi32(v, g);
+
+        __m128i sdiv = _mm_cvtps_epi32(_mm_div_ps(_mm_set1_ps((float)(255 << hsv_shift)), _mm_cvtepi32_ps(v)));
+        sdiv = _mm_andnot_si128(_mm_cmpeq_epi32(v, zero), sdiv);
+        __m128i s = _mm_srai_epi32(_mm_add_epi32(mul32_SSE2(diff, sdiv), half), hsv_shift);
+
+        __m128i diff2 = _mm_add_epi32(diff, diff);
+        __m128i h = _mm_or_si128(_mm_and_si128(vg, _mm_add_epi32(_mm_sub_epi32(b, r), diff2)),
+                                 _mm_andnot_si128(vg, _mm_add_epi32(_mm_sub_epi32(r, g), _mm_add_epi32(diff2, diff2))));
+        h = _mm_or_si128(_mm_and_si128(vr, _mm_sub_epi32(g, b)), _mm_andnot_si128(vr, h));
+
+        __m128i hdiv = _mm_cvtps_epi32(_mm_div_ps(_mm_set1_ps((float)(hr << hsv_shift)),
+                                                  _mm_mul_ps(_mm_set1_ps(6.f), _mm_cvtepi32_ps(diff))));
+        hdiv = _mm_andnot_si128(_mm_cmpeq_epi32(diff, zero), hdiv);
+        h = _mm_srai_epi32(_mm_add_epi32(mul32_SSE2(h, hdiv), half), hsv_shift);
+        h = _mm_add_epi32(h, _mm_and_si128(_mm_cmplt_epi32(h, zero), _mm_set1_epi32(hr)));
+        h = _mm_min_epi16(h, _mm_set1_epi32(255));
+
+        res = _mm_or_si128(h, _mm_or_si128(_mm_slli_epi32(s, 8), _mm_slli_epi32(v, 16)));
     }
+#endif
 
     void operator()(const uchar* src, uchar* dst, int n) const
     {
@@ -1137,7 +1286,22 @@ struct RGB2HSV_b
             initialized = true;
         }
 
-        for( i = 0; i < n; i += 3, src += scn )
+        i = 0;
+#if CV_SSE2
+        if( haveSIMD )
+        {
+            for( ; i <= n - 48; i += 48, src += scn*16 )
+            {
+                __m128i p[4];
+                loadPixels16_SSE2(src, scn, p);
+                for( int j = 0; j < 4; j++ )
+                    process(p[j], p[j]);
+                storePixels16x3_SSE2(dst + i, p);
+            }
+        }
+#endif
+
+        for( ; i < n; i += 3, src += scn )
         {
             int b = src[bidx], g = src[1], r = src[bidx^2];
             int h, s, v = b;
@@ -1166,6 +1330,9 @@ struct RGB2HSV_b
     }
 
     int srccn, blueIdx, hrange;
+#if CV_SSE2
+    bool haveSIMD;
+#endif
 };
 
 
@@ -1174,7 +1341,40 @@ struct RGB2HSV_f
     typedef float channel_type;
 
     RGB2HSV_f(int _srccn, int _blueIdx, float _hrange)
-    : srccn(_srccn), blueIdx(_blueIdx), hrange(_hrange) {}
+    : srccn(_srccn), blueIdx(_blueIdx), hrange(_hrange)
+    {
+#if CV_SSE2
+        haveSIMD = checkHardwareSupport(CV_CPU_SSE2);
+#endif
+    }
+
+#if CV_SSE2
+    // 4 pixels; the comparisons and the rounding are the same as in the scalar code
+    void process(__m128 b, __m128 g, __m128 r, __m128& h, __m128& s, __m128& v) const
+    {
+        const __m128 eps = _mm_set1_ps(FLT_EPSILON), zero = _mm_setzero_ps();
+
+        v = _mm_max_ps(b, _mm_max_ps(g, r));
+        __m128 diff = _mm_sub_ps(v, _mm_min_ps(b, _mm_min_ps(g, r)));
+        __m128 absv = _mm_andnot_ps(_mm_set1_ps(-0.f), v);
+        s = _mm_div_ps(diff, _mm_add_ps(absv, eps));
+
+        // 60/diff is computed in double precision as in the scalar code
+        __m128 d = _mm_add_ps(diff, eps);
+        __m128d sixty = _mm_set1_pd(60.);
+        diff = _mm_movelh_ps(_mm_cvtpd_ps(_mm_div_pd(sixty, _mm_cvtps_pd(d))),
+                             _mm_cvtpd_ps(_mm_div_pd(sixty, _mm_cvtps_pd(_mm_movehl_ps(d, d)))));
+
+        __m128 vr = _mm_cmpeq_ps(v, r), vg = _mm_cmpeq_ps(v, g);
+        __m128 h0 = _mm_mul_ps(_mm_sub_ps(g, b), diff);
+        __m128 h1 = _mm_add_ps(_mm_mul_ps(_mm_sub_ps(b, r), diff), _mm_set1_ps(120.f));
+        __m128 h2 = _mm_add_ps(_mm_mul_ps(_mm_sub_ps(r, g), diff), _mm_set1_ps(240.f));
+        h = _mm_or_ps(_mm_and_ps(vg, h1), _mm_andnot_ps(vg, h2));
+        h = _mm_or_ps(_mm_and_ps(vr, h0), _mm_andnot_ps(vr, h));
+        h = _mm_add_ps(h, _mm_and_ps(_mm_cmplt_ps(h, zero), _mm_set1_ps(360.f)));
+        h = _mm_mul_ps(h, _mm_set1_ps(hrange*(1.f/360.f)));
+    }
+#endif
 
     void operator()(const float* src, float* dst, int n) const
     {
@@ -1182,7 +1382,21 @@ struct RGB2HSV_f
         float hscale = hrange*(1.f/360.f);
         n *= 3;
 
-        for( i = 0; i < n; i += 3, src += scn )
+        i = 0;
+#if CV_SSE2
+        if( haveSIMD )
+        {
+            for( ; i <= n - 12; i += 12, src += scn*4 )
+            {
+                __m128 c0, c1, c2, h, s, v;
+                loadPixels4f_SSE2(src, scn, c0, c1, c2);
+                process(bidx == 0 ? c0 : c2, c1, bidx == 0 ? c2 : c0, h, s, v);
+                storePixels4x3f_SSE2(dst + i, h, s, v);
+            }
+        }
+#endif
+
+        for( ; i < n; i += 3, src += scn )
         {
             float b = src[bidx], g = src[1], r = src[bidx^2];
             float h, s, v;
@@ -1215,6 +1429,9 @@ struct RGB2HSV_f
 
     int srccn, blueIdx;
     float hrange;
+#if CV_SSE2
+    bool haveSIMD;
+#endif
 };
 
 
@@ -1898,7 +2115,40 @@ struct RGB2Luv_f
         vn = 9*whitept[1]*d;
 
         CV_Assert(whitept[1] == 1.f);
+#if CV_SSE2
+        haveSIMD = checkHardwareSupport(CV_CPU_SSE2);
+#endif
+    }
+
+#if CV_SSE2
+    // 4 pixels; performs exactly the same floating-point operations as the scalar code
+    void process(__m128& R, __m128& G, __m128& B) const
+    {
+        if( srgb )
+        {
+            __m128 gscale = _mm_set1_ps(GammaTabScale);
+            R = splineInterpolate_SSE2(_mm_mul_ps(R, gscale), sRGBGammaTab, GAMMA_TAB_SIZE);
+            G = splineInterpolate_SSE2(_mm_mul_ps(G, gscale), sRGBGammaTab, GAMMA_TAB_SIZE);
+            B = splineInterpolate_SSE2(_mm_mul_ps(B, gscale), sRGBGammaTab, GAMMA_TAB_SIZE);
+        }
+
+        __m128 X = _mm_add_ps(_mm_add_ps(_mm_mul_ps(R, _mm_set1_ps(coeffs[0])), _mm_mul_ps(G, _mm_set1_ps(coeffs[1]))),
+                              _mm_mul_ps(B, _mm_set1_ps(coeffs[2])));
+        __m128 Y = _mm_add_ps(_mm_add_ps(_mm_mul_ps(R, _mm_set1_ps(coeffs[3])), _mm_mul_ps(G, _mm_set1_ps(coeffs[4]))),
+                              _mm_mul_ps(B, _mm_set1_ps(coeffs[5])));
+        __m128 Z = _mm_add_ps(_mm_add_ps(_mm_mul_ps(R, _mm_set1_ps(coeffs[6])), _mm_mul_ps(G, _mm_set1_ps(coeffs[7]))),
+                              _mm_mul_ps(B, _mm_set1_ps(coeffs[8])));
+
+        __m128 L = splineInterpolate_SSE2(_mm_mul_ps(Y, _mm_set1_ps(LabCbrtTabScale)), LabCbrtTab, LAB_CBRT_TAB_SIZE);
+        L = _mm_sub_ps(_mm_mul_ps(L, _mm_set1_ps(116.f)), _mm_set1_ps(16.f));
+
+        __m128 d = _mm_add_ps(_mm_add_ps(X, _mm_mul_ps(Y, _mm_set1_ps(15.f))), _mm_mul_ps(Z, _mm_set1_ps(3.f)));
+        d = _mm_div_ps(_mm_set1_ps(4*13), _mm_max_ps(_mm_set1_ps(FLT_EPSILON), d));
+        R = L;
+        G = _mm_mul_ps(L, _mm_sub_ps(_mm_mul_ps(X, d), _mm_set1_ps(13*un)));
+        B = _mm_mul_ps(L, _mm_sub_ps(_mm_mul_ps(_mm_mul_ps(_mm_set1_ps(9*0.25f), Y), d), _mm_set1_ps(13*vn)));
     }
+#endif
 
     void operator()(const float* src, float* dst, int n) const
     {
@@ -1911,7 +2161,22 @@ struct RGB2Luv_f
         float _un = 13*un, _vn = 13*vn;
         n *= 3;
 
-        for( i = 0; i < n; i += 3, src += scn )
+        i = 0;
+#if CV_SSE2
+        if( haveSIMD )
+        {
+            // all 4 source pixels are loaded before the results are stored, so src may be equal to dst
+            for( ; i <= n - 12; i += 12, src += scn*4 )
+            {
+                __m128 R, G, B;
+                loadPixels4f_SSE2(src, scn, R, G, B);
+                process(R, G, B);
+                storePixels4x3f_SSE2(dst + i, R, G, B);
+            }
+        }
+#endif
+
+        for( ; i < n; i += 3, src += scn )
         {
             float R = src[0], G = src[1], B = src[2];
             if( gammaTab )
@@ -1939,6 +2204,9 @@ struct RGB2Luv_f
     int srccn;
     float coeffs[9], un, vn;
     bool srgb;
+#if CV_SSE2
+    bool haveSIMD;
+#endif
 };
 
 
@@ -2022,26 +2290,109 @@ struct RGB2Luv_b
 
     RGB2Luv_b( int _srccn, int blueIdx, const float* _coeffs,
                const float* _whitept, bool _srgb )
-    : srccn(_srccn), cvt(3, blueIdx, _coeffs, _whitept, _srgb) {}
+    : srccn(_srccn), cvt(3, blueIdx, _coeffs, _whitept, _srgb)
+    {
+#if CV_SSE2
+        haveSIMD = checkHardwareSupport(CV_CPU_SSE2);
+#endif
+    }
+
+#if CV_SSE2
+    // 16 bytes -> 16 floats scaled to [0, 1]
+    static inline void load16(const uchar* src, float* buf)
+    {
+        const __m128i zero = _mm_setzero_si128();
+        const __m128 scale = _mm_set1_ps(1.f/255.f);
+        __m128i v = _mm_loadu_si128((const __m128i*)src);
+        __m128i lo = _mm_unpacklo_epi8(v, zero), hi = _mm_unpackhi_epi8(v, zero);
+        _mm_storeu_ps(buf, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(lo, zero)), scale));
+        _mm_storeu_ps(buf + 4, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(lo, zero)), scale));
+        _mm_storeu_ps(buf + 8, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(hi, zero)), scale));
+        _mm_storeu_ps(buf + 12, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(hi, zero)), scale));
+    }
+#endif
 
     void operator()(const uchar* src, uchar* dst, int n) const
     {
         int i, j, scn = srccn;
-        float buf[3*BLOCK_SIZE];
+        float CV_DECL_ALIGNED(16) buf[3*BLOCK_SIZE];
+#if CV_SSE2
+        // output scale and shift of the channels 0, 1, 2, 0, 1, 2, ...
+        static const float oscale[] =
+        {
+            2.55f, 0.72033898305084743f, 0.99609375f, 2.55f, 0.72033898305084743f, 0.99609375f
+        };
+        static const float oshift[] =
+        {
+            0.f, 96.525423728813564f, 139.453125f, 0.f, 96.525423728813564f, 139.453125f
+        };
+#endif
 
         for( i = 0; i < n; i += BLOCK_SIZE, dst += BLOCK_SIZE*3 )
         {
             int dn = std::min(n - i, (int)BLOCK_SIZE);
+            j = 0;
 
-            for( j = 0; j < dn*3; j += 3, src += scn )
+#if CV_SSE2
+            if( haveSIMD )
+            {
+                if( scn == 3 )
+                {
+                    for( ; j <= dn*3 - 48; j += 48, src += 48 )
+                    {
+                        load16(src, buf + j);
+                        load16(src + 16, buf + j + 16);
+                        load16(src + 32, buf + j + 32);
+                    }
+                }
+                else
+                {
+                    // every pixel is stored as 4 floats, the 4th one is overwritten by the next pixel
+                    for( ; j <= dn*3 - 13; j += 12, src += 16 )
+                    {
+                        float CV_DECL_ALIGNED(16) t[16];
+                        load16(src, t);
+                        _mm_storeu_ps(buf + j, _mm_load_ps(t));
+                        _mm_storeu_ps(buf + j + 3, _mm_load_ps(t + 4));
+                        _mm_storeu_ps(buf + j + 6, _mm_load_ps(t + 8));
+                        _mm_storeu_ps(buf + j + 9, _mm_load_ps(t + 12));
+                    }
+                }
+            }
+#endif
+
+            for( ; j < dn*3; j += 3, src += scn )
             {
                 buf[j] = src[0]*(1.f/255.f);
                 buf[j+1] = (float)(src[1]*(1.f/255.f));
                 buf[j+2] = (float)(src[2]*(1.f/255.f));
             }
             cvt(buf, buf, dn);
+            j = 0;
 
-            for( j = 0; j < dn*3; j += 3 )
+#if CV_SSE2
+            if( haveSIMD )
+            {
+                for( ; j <= dn*3 - 48; j += 48 )
+                {
+                    for( int k = 0; k < 3; k++ )
+                    {
+                        __m128i r[4];
+                        for( int l = 0; l < 4; l++ )
+                        {
+                            int c = (k*16 + l*4) % 3;
+                            __m128 v = _mm_load_ps(buf + j + k*16 + l*4);
+                            r[l] = _mm_cvtps_epi32(_mm_add_ps(_mm_mul_ps(v, _mm_loadu_ps(oscale + c)),
+                                                              _mm_loadu_ps(oshift + c)));
+                        }
+                        _mm_storeu_si128((__m128i*)(dst + j + k*16),
+                                         _mm_packus_epi16(_mm_packs_epi32(r[0], r[1]), _mm_packs_epi32(r[2], r[3])));
+                    }
+                }
+            }
+#endif
+
+            for( ; j < dn*3; j += 3 )
             {
                 dst[j] = saturate_cast<uchar>(buf[j]*2.55f);
                 dst[j+1] = saturate_cast<uchar>(buf[j+1]*0.72033898305084743f + 96.525423728813564f);
@@ -2052,6 +2403,9 @@ struct RGB2Luv_b
 
     int srccn;
     RGB2Luv_f cvt;
+#if CV_SSE2
+    bool haveSIMD;
+#endif
 };
 
 
@@ -2116,6 +2470,275 @@ const int ITUR_BT_601_CBU =  460324;
 const int ITUR_BT_601_CGV = -385875;
 const int ITUR_BT_601_CBV = -74448;
 
+#if CV_SSE2
+
+// The fixed-point products x*c with the 20-bit coefficients above do not fit into 16-bit
+// multiplies, so every coefficient is split as c = (c >> 7)*128 + (c & 127) and applied with
+// a single _mm_madd_epi16 to (x, x << 7) pairs. This gives exactly x*c for |x| < 256.
+static inline __m128i yuvCoeffs_SSE2(int c)
+{
+    return _mm_set1_epi32((int)(((unsigned)(c >> 7) << 16) | (unsigned)(c & 127)));
+}
+
+// (x, x << 7) pairs for four non-negative 32-bit values less than 256
+static inline __m128i yuvPairs_SSE2(__m128i x)
+{
+    return _mm_or_si128(x, _mm_slli_epi32(x, 23));
+}
+
+// (x, x << 7) pairs for the low and the high half of eight 16-bit values
+static inline __m128i yuvPairsLo_SSE2(__m128i x)
+{
+    return _mm_unpacklo_epi16(x, _mm_slli_epi16(x, 7));
+}
+
+static inline __m128i yuvPairsHi_SSE2(__m128i x)
+{
+    return _mm_unpackhi_epi16(x, _mm_slli_epi16(x, 7));
+}
+
+// packs 16 fixed-point results (4 per vector) into 16 saturated bytes
+static inline __m128i yuvPackRes_SSE2(__m128i a0, __m128i a1, __m128i a2, __m128i a3)
+{
+    return _mm_packus_epi16(
+        _mm_packs_epi32(_mm_srai_epi32(a0, ITUR_BT_601_SHIFT), _mm_srai_epi32(a1, ITUR_BT_601_SHIFT)),
+        _mm_packs_epi32(_mm_srai_epi32(a2, ITUR_BT_601_SHIFT), _mm_srai_epi32(a3, ITUR_BT_601_SHIFT)));
+}
+
+// chroma terms (with rounding) of 8 consecutive u/v samples, duplicated for the 16 pixels they cover
+struct YUV2RGBChroma_SSE2
+{
+    __m128i r[4], g[4], b[4];
+};
+
+// u, v: 8 signed 16-bit values (u - 128, v - 128)
+static inline void yuv2rgbChroma_SSE2(__m128i u, __m128i v, YUV2RGBChroma_SSE2& c)
+{
+    const __m128i half = _mm_set1_epi32(1 << (ITUR_BT_601_SHIFT - 1));
+    const __m128i cvr = yuvCoeffs_SSE2(ITUR_BT_601_CVR), cvg = yuvCoeffs_SSE2(ITUR_BT_601_CVG);
+    const __m128i cug = yuvCoeffs_SSE2(ITUR_BT_601_CUG), cub = yuvCoeffs_SSE2(ITUR_BT_601_CUB);
+
+    for( int k = 0; k < 2; k++ )
+    {
+        __m128i up = k == 0 ? yuvPairsLo_SSE2(u) : yuvPairsHi_SSE2(u);
+        __m128i vp = k == 0 ? yuvPairsLo_SSE2(v) : yuvPairsHi_SSE2(v);
+
+        __m128i r = _mm_add_epi32(_mm_madd_epi16(vp, cvr), half);
+        __m128i g = _mm_add_epi32(_mm_add_epi32(_mm_madd_epi16(vp, cvg), _mm_madd_epi16(up, cug)), half);
+        __m128i b = _mm_add_epi32(_mm_madd_epi16(up, cub), half);
+
+        c.r[k*2] = _mm_unpacklo_epi32(r, r); c.r[k*2+1] = _mm_unpackhi_epi32(r, r);
+        c.g[k*2] = _mm_unpacklo_epi32(g, g); c.g[k*2+1] = _mm_unpackhi_epi32(g, g);
+        c.b[k*2] = _mm_unpacklo_epi32(b, b); c.b[k*2+1] = _mm_unpackhi_epi32(b, b);
+    }
+}
+
+template<int bIdx, int dcn>
+static inline void yuvStoreRGB_SSE2(uchar* dst, __m128i r, __m128i g, __m128i b)
+{
+    __m128i c0 = bIdx == 0 ? b : r, c2 = bIdx == 0 ? r : b;
+    __m128i a = dcn == 4 ? _mm_set1_epi8(-1) : _mm_setzero_si128();
+    __m128i c01l = _mm_unpacklo_epi8(c0, g), c01h = _mm_unpackhi_epi8(c0, g);
+    __m128i c23l = _mm_unpacklo_epi8(c2, a), c23h = _mm_unpackhi_epi8(c2, a);
+    __m128i p0 = _mm_unpacklo_epi16(c01l, c23l), p1 = _mm_unpackhi_epi16(c01l, c23l);
+    __m128i p2 = _mm_unpacklo_epi16(c01h, c23h), p3 = _mm_unpackhi_epi16(c01h, c23h);
+
+    if( dcn == 4 )
+    {
+        _mm_storeu_si128((__m128i*)dst, p0);
+        _mm_storeu_si128((__m128i*)(dst + 16), p1);
+        _mm_storeu_si128((__m128i*)(dst + 32), p2);
+        _mm_storeu_si128((__m128i*)(dst + 48), p3);
+    }
+    else
+    {
+        __m128i p[] = { p0, p1, p2, p3 };
+        storePixels16x3_SSE2(dst, p);
+    }
+}
+
+// converts 16 luma values of one row with the given chroma terms and stores 16 pixels
+template<int bIdx, int dcn>
+static inline void yuv2rgbRow16_SSE2(__m128i y8, const YUV2RGBChroma_SSE2& c, uchar* dst)
+{
+    const __m128i zero = _mm_setzero_si128(), delta = _mm_set1_epi16(16);
+    const __m128i cy = yuvCoeffs_SSE2(ITUR_BT_601_CY);
+
+    __m128i yl = _mm_max_epi16(_mm_sub_epi16(_mm_unpacklo_epi8(y8, zero), delta), zero);
+    __m128i yh = _mm_max_epi16(_mm_sub_epi16(_mm_unpackhi_epi8(y8, zero), delta), zero);
+    __m128i y0 = _mm_madd_epi16(yuvPairsLo_SSE2(yl), cy), y1 = _mm_madd_epi16(yuvPairsHi_SSE2(yl), cy);
+    __m128i y2 = _mm_madd_epi16(yuvPairsLo_SSE2(yh), cy), y3 = _mm_madd_epi16(yuvPairsHi_SSE2(yh), cy);
+
+    __m128i r = yuvPackRes_SSE2(_mm_add_epi32(y0, c.r[0]), _mm_add_epi32(y1, c.r[1]),
+                                _mm_add_epi32(y2, c.r[2]), _mm_add_epi32(y3, c.r[3]));
+    __m128i g = yuvPackRes_SSE2(_mm_add_epi32(y0, c.g[0]), _mm_add_epi32(y1, c.g[1]),
+                                _mm_add_epi32(y2, c.g[2]), _mm_add_epi32(y3, c.g[3]));
+    __m128i b = yuvPackRes_SSE2(_mm_add_epi32(y0, c.b[0]), _mm_add_epi32(y1, c.b[1]),
+                                _mm_add_epi32(y2, c.b[2]), _mm_add_epi32(y3, c.b[3]));
+    yuvStoreRGB_SSE2<bIdx, dcn>(dst, r, g, b);
+}
+
+// splits 16 bytes of interleaved chroma into the first and the second component minus 128
+static inline void yuvSplitChroma_SSE2(__m128i uv, int uIdx, __m128i& u, __m128i& v)
+{
+    const __m128i delta = _mm_set1_epi16(128);
+    __m128i c0 = _mm_sub_epi16(_mm_and_si128(uv, _mm_set1_epi16(0xff)), delta);
+    __m128i c1 = _mm_sub_epi16(_mm_srli_epi16(uv, 8), delta);
+    u = uIdx == 0 ? c0 : c1;
+    v = uIdx == 0 ? c1 : c0;
+}
+
+#endif
+
+// Row-level SIMD kernels. Each returns the number of pixels it has processed (a multiple of 16),
+// the caller finishes the rest of the row with the scalar code.
+
+template<int bIdx, int uIdx, int dcn>
+static inline int cvtYUV420sp2RGBRow_SIMD(const uchar* y1, const uchar* y2, const uchar* uv,
+                                          uchar* row1, uchar* row2, int width)
+{
+    int i = 0;
+#if CV_SSE2
+    if( checkHardwareSupport(CV_CPU_SSE2) )
+    {
+        YUV2RGBChroma_SSE2 c;
+        for( ; i <= width - 16; i += 16 )
+        {
+            __m128i u, v;
+            yuvSplitChroma_SSE2(_mm_loadu_si128((const __m128i*)(uv + i)), uIdx, u, v);
+            yuv2rgbChroma_SSE2(u, v, c);
+            yuv2rgbRow16_SSE2<bIdx, dcn>(_mm_loadu_si128((const __m128i*)(y1 + i)), c, row1 + i*dcn);
+            yuv2rgbRow16_SSE2<bIdx, dcn>(_mm_loadu_si128((const __m128i*)(y2 + i)), c, row2 + i*dcn);
+        }
+    }
+#else
+    (void)y1; (void)y2; (void)uv; (void)row1; (void)row2; (void)width;
+#endif
+    return i;
+}
+
+template<int bIdx, int dcn>
+static inline int cvtYUV420p2RGBRow_SIMD(const uchar* y1, const uchar* y2, const uchar* u1, const uchar* v1,
+                                         uchar* row1, uchar* row2, int width)
+{
+    int i = 0;
+#if CV_SSE2
+    if( checkHardwareSupport(CV_CPU_SSE2) )
+    {
+        const __m128i zero = _mm_setzero_si128(), delta = _mm_set1_epi16(128);
+        YUV2RGBChroma_SSE2 c;
+        for( ; i <= width - 16; i += 16 )
+        {
+            __m128i u = _mm_sub_epi16(_mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)(u1 + i/2)), zero), delta);
+            __m128i v = _mm_sub_epi16(_mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)(v1 + i/2)), zero), delta);
+            yuv2rgbChroma_SSE2(u, v, c);
+            yuv2rgbRow16_SSE2<bIdx, dcn>(_mm_loadu_si128((const __m128i*)(y1 + i)), c, row1 + i*dcn);
+            yuv2rgbRow16_SSE2<bIdx, dcn>(_mm_loadu_si128((const __m128i*)(y2 + i)), c, row2 + i*dcn);
+        }
+    }
+#else
+    (void)y1; (void)y2; (void)u1; (void)v1; (void)row1; (void)row2; (void)width;
+#endif
+    return i;
+}
+
+template<int bIdx, int uIdx, int yIdx, int dcn>
+static inline int cvtYUV422toRGBRow_SIMD(const uchar* yuv, uchar* row, int width)
+{
+    int i = 0;
+#if CV_SSE2
+    if( checkHardwareSupport(CV_CPU_SSE2) )
+    {
+        const __m128i lo8 = _mm_set1_epi16(0xff);
+        YUV2RGBChroma_SSE2 c;
+        for( ; i <= width - 16; i += 16 )
+        {
+            __m128i a = _mm_loadu_si128((const __m128i*)(yuv + i*2));
+            __m128i b = _mm_loadu_si128((const __m128i*)(yuv + i*2 + 16));
+            __m128i e = _mm_packus_epi16(_mm_and_si128(a, lo8), _mm_and_si128(b, lo8));
+            __m128i o = _mm_packus_epi16(_mm_srli_epi16(a, 8), _mm_srli_epi16(b, 8));
+            __m128i u, v;
+            yuvSplitChroma_SSE2(yIdx == 0 ? o : e, uIdx, u, v);
+            yuv2rgbChroma_SSE2(u, v, c);
+            yuv2rgbRow16_SSE2<bIdx, dcn>(yIdx == 0 ? e : o, c, row + i*dcn);
+        }
+    }
+#else
+    (void)yuv; (void)row; (void)width;
+#endif
+    return i;
+}
+
+// Converts 16 pixels of two rows to luma and the chroma of the even pixels of the first row.
+// u and v are written either to separate planes (uvStep == 1) or interleaved (uvStep == 2).
+template<int bIdx, int scn>
+static inline int cvtRGBtoYUV420Row_SIMD(const uchar* row0, const uchar* row1, uchar* y0, uchar* y1,
+                                         uchar* u, uchar* v, int uvStep, int width)
+{
+    int i = 0;
+#if CV_SSE2
+    if( checkHardwareSupport(CV_CPU_SSE2) )
+    {
+        const __m128i cry = yuvCoeffs_SSE2(ITUR_BT_601_CRY), cgy = yuvCoeffs_SSE2(ITUR_BT_601_CGY);
+        const __m128i cby = yuvCoeffs_SSE2(ITUR_BT_601_CBY), cru = yuvCoeffs_SSE2(ITUR_BT_601_CRU);
+        const __m128i cgu = yuvCoeffs_SSE2(ITUR_BT_601_CGU), cbu = yuvCoeffs_SSE2(ITUR_BT_601_CBU);
+        const __m128i cgv = yuvCoeffs_SSE2(ITUR_BT_601_CGV), cbv = yuvCoeffs_SSE2(ITUR_BT_601_CBV);
+        const __m128i ydelta = _mm_set1_epi32((16 << ITUR_BT_601_SHIFT) + (1 << (ITUR_BT_601_SHIFT - 1)));
+        const __m128i uvdelta = _mm_set1_epi32((128 << ITUR_BT_601_SHIFT) + (1 << (ITUR_BT_601_SHIFT - 1)));
+        const __m128i lo8 = _mm_set1_epi32(0xff);
+
+        for( ; i <= width - 16; i += 16 )
+        {
+            __m128i p[2][4], ys[4];
+            for( int k = 0; k < 2; k++ )
+            {
+                loadPixels16_SSE2((k == 0 ? row0 : row1) + i*scn, scn, p[k]);
+
+                for( int j = 0; j < 4; j++ )
+                {
+                    __m128i c0 = _mm_and_si128(p[k][j], lo8);
+                    __m128i c1 = _mm_and_si128(_mm_srli_epi32(p[k][j], 8), lo8);
+                    __m128i c2 = _mm_and_si128(_mm_srli_epi32(p[k][j], 16), lo8);
+                    __m128i r = yuvPairs_SSE2(bIdx == 0 ? c2 : c0), b = yuvPairs_SSE2(bIdx == 0 ? c0 : c2);
+                    ys[j] = _mm_add_epi32(_mm_add_epi32(_mm_madd_epi16(r, cry), _mm_madd_epi16(yuvPairs_SSE2(c1), cgy)),
+                                          _mm_add_epi32(_mm_madd_epi16(b, cby), ydelta));
+                }
+                _mm_storeu_si128((__m128i*)((k == 0 ? y0 : y1) + i), yuvPackRes_SSE2(ys[0], ys[1], ys[2], ys[3]));
+            }
+
+            // the chroma is taken from the even pixels of the first row
+            __m128i us[2], vs[2];
+            for( int j = 0; j < 2; j++ )
+            {
+                __m128i e = _mm_unpacklo_epi64(_mm_shuffle_epi32(p[0][j*2], _MM_SHUFFLE(3,1,2,0)),
+                                               _mm_shuffle_epi32(p[0][j*2+1], _MM_SHUFFLE(3,1,2,0)));
+                __m128i c0 = _mm_and_si128(e, lo8);
+                __m128i g = yuvPairs_SSE2(_mm_and_si128(_mm_srli_epi32(e, 8), lo8));
+                __m128i c2 = _mm_and_si128(_mm_srli_epi32(e, 16), lo8);
+                __m128i r = yuvPairs_SSE2(bIdx == 0 ? c2 : c0), b = yuvPairs_SSE2(bIdx == 0 ? c0 : c2);
+                us[j] = _mm_add_epi32(_mm_add_epi32(_mm_madd_epi16(r, cru), _mm_madd_epi16(g, cgu)),
+                                      _mm_add_epi32(_mm_madd_epi16(b, cbu), uvdelta));
+                vs[j] = _mm_add_epi32(_mm_add_epi32(_mm_madd_epi16(r, cbu), _mm_madd_epi16(g, cgv)),
+                                      _mm_add_epi32(_mm_madd_epi16(b, cbv), uvdelta));
+            }
+            __m128i uv = yuvPackRes_SSE2(us[0], us[1], vs[0], vs[1]);
+            if( uvStep == 1 )
+            {
+                _mm_storel_epi64((__m128i*)(u + i/2), uv);
+                _mm_storel_epi64((__m128i*)(v + i/2), _mm_srli_si128(uv, 8));
+            }
+            else if( u < v )
+                _mm_storeu_si128((__m128i*)(u + i), _mm_unpacklo_epi8(uv, _mm_srli_si128(uv, 8)));
+            else
+                _mm_storeu_si128((__m128i*)(v + i), _mm_unpacklo_epi8(_mm_srli_si128(uv, 8), uv));
+        }
+    }
+#else
+    (void)row0; (void)row1; (void)y0; (void)y1; (void)u; (void)v; (void)uvStep; (void)width;
+#endif
+    return i;
+}
+
 template<int bIdx, int uIdx>
 struct YUV420sp2RGB888Invoker : ParallelLoopBody
 {
@@ -2152,7 +2775,10 @@ struct YUV420sp2RGB888Invoker : ParallelLoopBody
             uchar* row2 = dst->ptr<uchar>(j + 1);
             const uchar* y2 = y1 + stride;
 
-            for (int i = 0; i < width; i += 2, row1 += 6, row2 += 6)
+            int i = cvtYUV420sp2RGBRow_SIMD<bIdx, uIdx, 3>(y1, y2, uv, row1, row2, width);
+            row1 += i*3; row2 += i*3;
+
+            for ( ; i < width; i += 2, row1 += 6, row2 += 6)
             {
                 int u = int(uv[i + 0 + uIdx]) - 128;
                 int v = int(uv[i + 1 - uIdx]) - 128;
@@ -2221,7 +2847,10 @@ struct YUV420sp2RGBA8888Invoker : ParallelLoopBody
             uchar* row2 = dst->ptr<uchar>(j + 1);
             const uchar* y2 = y1 + stride;
 
-            for (int i = 0; i < width; i += 2, row1 += 8, row2 += 8)
+            int i = cvtYUV420sp2RGBRow_SIMD<bIdx, uIdx, 4>(y1, y2, uv, row1, row2, width);
+            row1 += i*4; row2 += i*4;
+
+            for ( ; i < width; i += 2, row1 += 8, row2 += 8)
             {
                 int u = int(uv[i + 0 + uIdx]) - 128;
                 int v = int(uv[i + 1 - uIdx]) - 128;
@@ -2293,7 +2922,10 @@ struct YUV420p2RGB888Invoker : ParallelLoopBody
             uchar* row2 = dst->ptr<uchar>(j + 1);
             const uchar* y2 = y1 + stride;
 
-            for (int i = 0; i < width / 2; i += 1, row1 += 6, row2 += 6)
+            int i = cvtYUV420p2RGBRow_SIMD<bIdx, 3>(y1, y2, u1, v1, row1, row2, width);
+            row1 += i*3; row2 += i*3;
+
+            for ( i /= 2; i < width / 2; i += 1, row1 += 6, row2 += 6)
             {
                 int u = int(u1[i]) - 128;
                 int v = int(v1[i]) - 128;
@@ -2361,7 +2993,10 @@ struct YUV420p2RGBA8888Invoker : ParallelLoopBody
             uchar* row2 = dst->ptr<uchar>(j + 1);
             const uchar* y2 = y1 + stride;
 
-            for (int i = 0; i < width / 2; i += 1, row1 += 8, row2 += 8)
+            int i = cvtYUV420p2RGBRow_SIMD<bIdx, 4>(y1, y2, u1, v1, row1, row2, width);
+            row1 += i*4; row2 += i*4;
+
+            for ( i /= 2; i < width / 2; i += 1, row1 += 8, row2 += 8)
             {
                 int u = int(u1[i]) - 128;
                 int v = int(v1[i]) - 128;
@@ -2466,7 +3101,10 @@ struct RGB888toYUV420pInvoker: public ParallelLoopBody
             uchar* v = dst_->ptr<uchar>(h + (i + h/2)/2) + ((i + h/2) % 2) * (w/2);
             if( uIdx_ == 2 ) std::swap(u, v);
 
-            for( int j = 0, k = 0; j < w * cn; j += 2 * cn, k++ )
+            int n = cn == 3 ? cvtRGBtoYUV420Row_SIMD<bIdx, 3>(row0, row1, y, y + dst_->step, u, v, 1, w) :
+                              cvtRGBtoYUV420Row_SIMD<bIdx, 4>(row0, row1, y, y + dst_->step, u, v, 1, w);
+
+            for( int j = n * cn, k = n / 2; j < w * cn; j += 2 * cn, k++ )
             {
                 int r00 = row0[2-bIdx + j];      int g00 = row0[1 + j];      int b00 = row0[bIdx + j];
                 int r01 = row0[2-bIdx + cn + j]; int g01 = row0[1 + cn + j]; int b01 = row0[bIdx + cn + j];
@@ -2518,6 +3156,79 @@ static void cvtRGBtoYUV420p(const Mat& src, Mat& dst)
         colorConverter(Range(0, src.rows/2));
 }
 
+///////////////////////////////////// RGB -> YUV420sp /////////////////////////////////////
+
+template<int bIdx, int uIdx>
+struct RGB888toYUV420spInvoker: public ParallelLoopBody
+{
+    RGB888toYUV420spInvoker( const Mat& src, Mat* dst )
+        : src_(src),
+          dst_(dst) { }
+
+    void operator()(const Range& rowRange) const
+    {
+        const int w = src_.cols;
+        const int h = src_.rows;
+
+        const int cn = src_.channels();
+        for( int i = rowRange.start; i < rowRange.end; i++ )
+        {
+            const uchar* row0 = src_.ptr<uchar>(2 * i);
+            const uchar* row1 = src_.ptr<uchar>(2 * i + 1);
+
+            uchar* y = dst_->ptr<uchar>(2*i);
+            uchar* u = dst_->ptr<uchar>(h + i) + uIdx;
+            uchar* v = dst_->ptr<uchar>(h + i) + 1 - uIdx;
+
+            int n = cn == 3 ? cvtRGBtoYUV420Row_SIMD<bIdx, 3>(row0, row1, y, y + dst_->step, u, v, 2, w) :
+                              cvtRGBtoYUV420Row_SIMD<bIdx, 4>(row0, row1, y, y + dst_->step, u, v, 2, w);
+
+            for( int j = n * cn, k = n; j < w * cn; j += 2 * cn, k += 2 )
+            {
+                int r00 = row0[2-bIdx + j];      int g00 = row0[1 + j];      int b00 = row0[bIdx + j];
+                int r01 = row0[2-bIdx + cn + j]; int g01 = row0[1 + cn + j]; int b01 = row0[bIdx + cn + j];
+                int r10 = row1[2-bIdx + j];      int g10 = row1[1 + j];      int b10 = row1[bIdx + j];
+                int r11 = row1[2-bIdx + cn + j]; int g11 = row1[1 + cn + j]; int b11 = row1[bIdx + cn + j];
+
+                const int shifted16 = (16 << ITUR_BT_601_SHIFT);
+                const int halfShift = (1 << (ITUR_BT_601_SHIFT - 1));
+                int y00 = ITUR_BT_601_CRY * r00 + ITUR_BT_601_CGY * g00 + ITUR_BT_601_CBY * b00 + halfShift + shifted16;
+                int y01 = ITUR_BT_601_CRY * r01 + ITUR_BT_601_CGY * g01 + ITUR_BT_601_CBY * b01 + halfShift + shifted16;
+                int y10 = ITUR_BT_601_CRY * r10 + ITUR_BT_601_CGY * g10 + ITUR_BT_601_CBY * b10 + halfShift + shifted16;
+                int y11 = ITUR_BT_601_CRY * r11 + ITUR_BT_601_CGY * g11 + ITUR_BT_601_CBY * b11 + halfShift + shifted16;
+
+                y[k + 0]            = saturate_cast<uchar>(y00 >> ITUR_BT_601_SHIFT);
+                y[k + 1]            = saturate_cast<uchar>(y01 >> ITUR_BT_601_SHIFT);
+                y[k + dst_->step + 0] = saturate_cast<uchar>(y10 >> ITUR_BT_601_SHIFT);
+                y[k + dst_->step + 1] = saturate_cast<uchar>(y11 >> ITUR_BT_601_SHIFT);
+
+                const int shifted128 = (128 << ITUR_BT_601_SHIFT);
+                int u00 = ITUR_BT_601_CRU * r00 + ITUR_BT_601_CGU * g00 + ITUR_BT_601_CBU * b00 + halfShift + shifted128;
+                int v00 = ITUR_BT_601_CBU * r00 + ITUR_BT_601_CGV * g00 + ITUR_BT_601_CBV * b00 + halfShift + shifted128;
+
+                u[k] = saturate_cast<uchar>(u00 >> ITUR_BT_601_SHIFT);
+                v[k] = saturate_cast<uchar>(v00 >> ITUR_BT_601_SHIFT);
+            }
+        }
+    }
+
+private:
+    RGB888toYUV420spInvoker& operator=(const RGB888toYUV420spInvoker&);
+
+    const Mat& src_;
+    Mat* const dst_;
+};
+
+template<int bIdx, int uIdx>
+static void cvtRGBtoYUV420sp(const Mat& src, Mat& dst)
+{
+    RGB888toYUV420spInvoker<bIdx, uIdx> colorConverter(src, &dst);
+    if( src.total() >= 320*240 )
+        parallel_for_(Range(0, src.rows/2), colorConverter);
+    else
+        colorConverter(Range(0, src.rows/2));
+}
+
 ///////////////////////////////////// YUV422 -> RGB /////////////////////////////////////
 
 template<int bIdx, int uIdx, int yIdx>
@@ -2543,7 +3254,10 @@ struct YUV422toRGB888Invoker : ParallelLoopBody
         {
             uchar* row = dst->ptr<uchar>(j);
 
-            for (int i = 0; i < 2 * width; i += 4, row += 6)
+            int i = cvtYUV422toRGBRow_SIMD<bIdx, uIdx, yIdx, 3>(yuv_src, row, width);
+            row += i*3;
+
+            for ( i *= 2; i < 2 * width; i += 4, row += 6)
             {
                 int u = int(yuv_src[i + uidx]) - 128;
                 int v = int(yuv_src[i + vidx]) - 128;
@@ -2589,7 +3303,10 @@ struct YUV422toRGBA8888Invoker : ParallelLoopBody
         {
             uchar* row = dst->ptr<uchar>(j);
 
-            for (int i = 0; i < 2 * width; i += 4, row += 8)
+            int i = cvtYUV422toRGBRow_SIMD<bIdx, uIdx, yIdx, 4>(yuv_src, row, width);
+            row += i*4;
+
+            for ( i *= 2; i < 2 * width; i += 4, row += 8)
             {
                 int u = int(yuv_src[i + uidx]) - 128;
                 int v = int(yuv_src[i + vidx]) - 128;
@@ -3349,6 +4066,31 @@ void cv::cvtColor( InputArray _src, OutputArray _dst, int code, int dcn )
                 };
             }
             break;
+        case CV_RGB2YUV_NV12: case CV_BGR2YUV_NV12: case CV_RGBA2YUV_NV12: case CV_BGRA2YUV_NV12:
+        case CV_RGB2YUV_NV21: case CV_BGR2YUV_NV21: case CV_RGBA2YUV_NV21: case CV_BGRA2YUV_NV21:
+            {
+                if (dcn <= 0) dcn = 1;
+                const int bIdx = (code == CV_BGR2YUV_NV12 || code == CV_BGRA2YUV_NV12 || code == CV_BGR2YUV_NV21 || code == CV_BGRA2YUV_NV21) ? 0 : 2;
+                const int uIdx = (code == CV_RGB2YUV_NV21 || code == CV_BGR2YUV_NV21 || code == CV_RGBA2YUV_NV21 || code == CV_BGRA2YUV_NV21) ? 1 : 0;
+
+                CV_Assert( (scn == 3 || scn == 4) && depth == CV_8U );
+                CV_Assert( dcn == 1 );
+                CV_Assert( sz.width % 2 == 0 && sz.height % 2 == 0 );
+
+                Size dstSz(sz.width, sz.height / 2 * 3);
+                _dst.create(dstSz, CV_MAKETYPE(depth, dcn));
+                dst = _dst.getMat();
+
+                switch(bIdx + uIdx*10)
+                {
+                    case 0: cvtRGBtoYUV420sp<0, 0>(src, dst); break;
+                    case 2: cvtRGBtoYUV420sp<2, 0>(src, dst); break;
+                    case 10: cvtRGBtoYUV420sp<0, 1>(src, dst); break;
+                    case 12: cvtRGBtoYUV420sp<2, 1>(src, dst); break;
+                    default: CV_Error( CV_StsBadFlag, "Unknown/unsupported color conversion code" ); break;
+                };
+            }
+            break;
         case CV_YUV2RGB_UYVY: case CV_YUV2BGR_UYVY: case CV_YUV2RGBA_UYVY: case CV_YUV2BGRA_UYVY:
         case CV_YUV2RGB_YUY2: case CV_YUV2BGR_YUY2: case CV_YUV2RGB_YVYU: case CV_YUV2BGR_YVYU:
         case CV_YUV2RGBA_YUY2: case CV_YUV2BGRA_YUY2: case CV_YUV2RGBA_YVYU: case CV_YUV2BGRA_YVYU:
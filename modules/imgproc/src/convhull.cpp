@@ -126,34 +126,15 @@ struct CHullCmpPoints
 };
 
 
-void convexHull( InputArray _points, OutputArray _hull, bool clockwise, bool returnPoints )
+void convexHullSort( const Point* data0, int total, bool is_float, Point** pointer,
+                     int& miny_ind, int& maxy_ind )
 {
-    Mat points = _points.getMat();
-    int i, total = points.checkVector(2), depth = points.depth(), nout = 0;
-    int miny_ind = 0, maxy_ind = 0;
-    CV_Assert(total >= 0 && (depth == CV_32F || depth == CV_32S));
-
-    if( total == 0 )
-    {
-        _hull.release();
-        return;
-    }
-
-    returnPoints = !_hull.fixedType() ? returnPoints : _hull.type() != CV_32S;
-
-    bool is_float = depth == CV_32F;
-    AutoBuffer<Point*> _pointer(total);
-    AutoBuffer<int> _stack(total + 2), _hullbuf(total);
-    Point** pointer = _pointer;
+    int i;
     Point2f** pointerf = (Point2f**)pointer;
-    Point* data0 = (Point*)points.data;
-    int* stack = _stack;
-    int* hullbuf = _hullbuf;
-
-    CV_Assert(points.isContinuous());
+    miny_ind = maxy_ind = 0;
 
     for( i = 0; i < total; i++ )
-        pointer[i] = &data0[i];
+        pointer[i] = (Point*)&data0[i];
 
     // sort the point set by x-coordinate, find min and max y
     if( !is_float )
@@ -180,6 +161,14 @@ void convexHull( InputArray _points, OutputArray _hull, bool clockwise, bool ret
                 maxy_ind = i;
         }
     }
+}
+
+
+int convexHullGather( const Point* data0, Point** pointer, int total, bool is_float,
+                      int miny_ind, int maxy_ind, bool clockwise, int* stack, int* hullbuf )
+{
+    int i, nout = 0;
+    Point2f** pointerf = (Point2f**)pointer;
 
     if( pointer[0]->x == pointer[total-1]->x &&
         pointer[0]->y == pointer[total-1]->y )
@@ -249,6 +238,38 @@ void convexHull( InputArray _points, OutputArray _hull, bool clockwise, bool ret
             hullbuf[nout++] = int(pointer[br_stack[i]] - data0);
     }
 
+    return nout;
+}
+
+
+void convexHull( InputArray _points, OutputArray _hull, bool clockwise, bool returnPoints )
+{
+    Mat points = _points.getMat();
+    int i, total = points.checkVector(2), depth = points.depth(), nout = 0;
+    int miny_ind = 0, maxy_ind = 0;
+    CV_Assert(total >= 0 && (depth == CV_32F || depth == CV_32S));
+
+    if( total == 0 )
+    {
+        _hull.release();
+        return;
+    }
+
+    returnPoints = !_hull.fixedType() ? returnPoints : _hull.type() != CV_32S;
+
+    bool is_float = depth == CV_32F;
+    AutoBuffer<Point*> _pointer(total);
+    AutoBuffer<int> _stack(total + 2), _hullbuf(total);
+    Point** pointer = _pointer;
+    Point* data0 = (Point*)points.data;
+    int* stack = _stack;
+    int* hullbuf = _hullbuf;
+
+    CV_Assert(points.isContinuous());
+
+    convexHullSort( data0, total, is_float, pointer, miny_ind, maxy_ind );
+    nout = convexHullGather( data0, pointer, total, is_float, miny_ind, maxy_ind, clockwise, stack, hullbuf );
+
     if( !returnPoints )
         Mat(nout, 1, CV_32S, hullbuf).copyTo(_hull);
     else
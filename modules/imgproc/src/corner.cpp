@@ -242,6 +242,104 @@ calcEigenValsVecs( const Mat& _cov, Mat& _dst )
 enum { MINEIGENVAL=0, HARRIS=1, EIGENVALSVECS=2 };
 
 
+class CornerCovarianceInvoker : public ParallelLoopBody
+{
+public:
+    CornerCovarianceInvoker( const Mat& _Dx, const Mat& _Dy, Mat& _cov )
+        : Dx(_Dx), Dy(_Dy), cov(_cov)
+    {
+    }
+
+    void operator()( const Range& range ) const
+    {
+        int width = cov.cols;
+    #if CV_SSE
+        volatile bool simd = checkHardwareSupport(CV_CPU_SSE);
+    #endif
+
+        for( int i = range.start; i < range.end; i++ )
+        {
+            float* cov_data = (float*)(cov.data + i*cov.step);
+            const float* dxdata = (const float*)(Dx.data + i*Dx.step);
+            const float* dydata = (const float*)(Dy.data + i*Dy.step);
+            int j = 0;
+
+        #if CV_SSE
+            if( simd )
+            {
+                for( ; j <= width - 4; j += 4 )
+                {
+                    __m128 dx = _mm_loadu_ps(dxdata + j);
+                    __m128 dy = _mm_loadu_ps(dydata + j);
+                    __m128 xx = _mm_mul_ps(dx, dx);
+                    __m128 xy = _mm_mul_ps(dx, dy);
+                    __m128 yy = _mm_mul_ps(dy, dy);
+                    __m128 t0 = _mm_unpacklo_ps(xx, xy); // xx0 xy0 xx1 xy1
+                    __m128 t1 = _mm_unpackhi_ps(xx, xy); // xx2 xy2 xx3 xy3
+                    __m128 u, v;
+                    u = _mm_shuffle_ps(yy, t0, _MM_SHUFFLE(2, 2, 0, 0)); // yy0 yy0 xx1 xx1
+                    _mm_storeu_ps(cov_data + j*3, _mm_shuffle_ps(t0, u, _MM_SHUFFLE(2, 0, 1, 0))); // xx0 xy0 yy0 xx1
+                    u = _mm_shuffle_ps(t0, yy, _MM_SHUFFLE(1, 1, 3, 3)); // xy1 xy1 yy1 yy1
+                    _mm_storeu_ps(cov_data + j*3 + 4, _mm_shuffle_ps(u, t1, _MM_SHUFFLE(1, 0, 2, 0))); // xy1 yy1 xx2 xy2
+                    u = _mm_shuffle_ps(yy, t1, _MM_SHUFFLE(2, 2, 2, 2)); // yy2 yy2 xx3 xx3
+                    v = _mm_shuffle_ps(t1, yy, _MM_SHUFFLE(3, 3, 3, 3)); // xy3 xy3 yy3 yy3
+                    _mm_storeu_ps(cov_data + j*3 + 8, _mm_shuffle_ps(u, v, _MM_SHUFFLE(2, 0, 2, 0))); // yy2 xx3 xy3 yy3
+                }
+            }
+        #endif
+
+            for( ; j < width; j++ )
+            {
+                float dx = dxdata[j];
+                float dy = dydata[j];
+
+                cov_data[j*3] = dx*dx;
+                cov_data[j*3+1] = dx*dy;
+                cov_data[j*3+2] = dy*dy;
+            }
+        }
+    }
+
+private:
+    CornerCovarianceInvoker& operator=(const CornerCovarianceInvoker&);
+
+    const Mat& Dx;
+    const Mat& Dy;
+    Mat& cov;
+};
+
+
+class CornerEigenValsInvoker : public ParallelLoopBody
+{
+public:
+    CornerEigenValsInvoker( const Mat& _cov, Mat& _eigenv, int _op_type, double _k )
+        : cov(_cov), eigenv(_eigenv), op_type(_op_type), k(_k)
+    {
+    }
+
+    void operator()( const Range& range ) const
+    {
+        const Mat cov_rows = cov.rowRange(range);
+        Mat eigenv_rows = eigenv.rowRange(range);
+
+        if( op_type == MINEIGENVAL )
+            calcMinEigenVal( cov_rows, eigenv_rows );
+        else if( op_type == HARRIS )
+            calcHarris( cov_rows, eigenv_rows, k );
+        else if( op_type == EIGENVALSVECS )
+            calcEigenValsVecs( cov_rows, eigenv_rows );
+    }
+
+private:
+    CornerEigenValsInvoker& operator=(const CornerEigenValsInvoker&);
+
+    const Mat& cov;
+    Mat& eigenv;
+    int op_type;
+    double k;
+};
+
+
 static void
 cornerEigenValsVecs( const Mat& src, Mat& eigenv, int block_size,
                      int aperture_size, int op_type, double k=0.,
@@ -276,34 +374,15 @@ cornerEigenValsVecs( const Mat& src, Mat& eigenv, int block_size,
 
     Size size = src.size();
     Mat cov( size, CV_32FC3 );
-    int i, j;
-
-    for( i = 0; i < size.height; i++ )
-    {
-        float* cov_data = (float*)(cov.data + i*cov.step);
-        const float* dxdata = (const float*)(Dx.data + i*Dx.step);
-        const float* dydata = (const float*)(Dy.data + i*Dy.step);
 
-        for( j = 0; j < size.width; j++ )
-        {
-            float dx = dxdata[j];
-            float dy = dydata[j];
-
-            cov_data[j*3] = dx*dx;
-            cov_data[j*3+1] = dx*dy;
-            cov_data[j*3+2] = dy*dy;
-        }
-    }
+    parallel_for_( Range(0, size.height), CornerCovarianceInvoker(Dx, Dy, cov),
+                   size.area()/(double)(1<<16) );
 
     boxFilter(cov, cov, cov.depth(), Size(block_size, block_size),
         Point(-1,-1), false, borderType );
 
-    if( op_type == MINEIGENVAL )
-        calcMinEigenVal( cov, eigenv );
-    else if( op_type == HARRIS )
-        calcHarris( cov, eigenv, k );
-    else if( op_type == EIGENVALSVECS )
-        calcEigenValsVecs( cov, eigenv );
+    parallel_for_( Range(0, size.height), CornerEigenValsInvoker(cov, eigenv, op_type, k),
+                   size.area()/(double)(1<<16) );
 }
 
 }
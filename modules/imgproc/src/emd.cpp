@@ -61,6 +61,8 @@
 #define MAX_ITERATIONS 500
 #define CV_EMD_INF   ((float)1e20)
 #define CV_EMD_EPS   ((float)1e-5)
+/* the problems with more cells in the cost matrix are solved by the network simplex */
+#define CV_EMD_NETWORK_MIN_CELLS 4096
 
 /* CvNode1D is used for lists, representing 1D sparse array */
 typedef struct CvNode1D
@@ -110,6 +112,9 @@ typedef struct CvEMDState
 
     float weight, max_cost;
     char *buffer;
+
+    /* the problem is solved by icvSolveEMDNetwork, s & d keep the original supply and demand */
+    int use_network;
 }
 CvEMDState;
 
@@ -140,6 +145,9 @@ static void icvAddBasicVariable( CvEMDState * state,
                                  CvNode1D * prev_v_min_j,
                                  CvNode1D * u_head );
 
+static double icvSolveEMDNetwork( float **cost, const float *supply, const float *demand,
+                                  int ssize, int dsize, float threshold, float **flow );
+
 static float icvDistL2( const float *x, const float *y, void *user_param );
 static float icvDistL1( const float *x, const float *y, void *user_param );
 static float icvDistC( const float *x, const float *y, void *user_param );
@@ -260,6 +268,34 @@ CV_IMPL float cvCalcEMD2( const CvArr* signature_arr1,
 
     eps = CV_EMD_EPS * state.max_cost;
 
+    if( state.use_network )
+    {
+        int i, j;
+        /* the delta matrix is not needed by the solver, so it receives the flow */
+        icvSolveEMDNetwork( state.cost, state.s, state.d, state.ssize, state.dsize, 0, state.delta );
+
+        for( i = 0; i < state.ssize; i++ )
+        {
+            int ci = state.idx1[i];
+            if( ci < 0 )
+                continue;
+
+            for( j = 0; j < state.dsize; j++ )
+            {
+                int cj = state.idx2[j];
+                float val = state.delta[i][j];
+                if( cj < 0 || val == 0 )
+                    continue;
+
+                total_cost += (double)val * state.cost[i][j];
+                if( flow )
+                    ((float*)(flow->data.ptr + flow->step*ci))[cj] = val;
+            }
+        }
+
+        return (float)(total_cost / state.weight);
+    }
+
     /* if ssize = 1 or dsize = 1 then we are done, else ... */
     if( state.ssize > 1 && state.dsize > 1 )
     {
@@ -552,6 +588,12 @@ static int icvInitEMD( const float* signature1, int size1,
 
     assert( buffer <= buffer_end );
 
+    if( ssize * dsize > CV_EMD_NETWORK_MIN_CELLS )
+    {
+        state->use_network = 1;
+        return 0;
+    }
+
     icvRussel( state );
 
     state->enter_x = (state->end_x)++;
@@ -1088,6 +1130,301 @@ icvAddBasicVariable( CvEMDState * state,
 }
 
 
+/****************************************************************************************\
+*                                    network simplex                                     *
+\****************************************************************************************/
+
+/*
+   Solves the transportation problem as the min-cost flow problem by the network simplex
+   method. The basis is a spanning tree rooted at an artificial node; the initial tree
+   consists of the expensive artificial arcs from every source and to every sink. The entering
+   arc is chosen by the block search over the arcs with negative reduced cost, and the leaving
+   arc by the strongly feasible tree rule, so the degenerate pivots do not cycle. After
+   each pivot only the subtree that moved gets its depths and potentials updated.
+   Unlike the iteration-limited transportation simplex the result is always optimal.
+
+   If threshold > 0, the ground distance is min(cost, threshold). Then the arcs with
+   cost >= threshold are replaced by the arcs through the single transshipment node
+   (source -> node costs threshold, node -> sink costs 0), so that the network stays sparse
+   when most of the distances are clipped [Pele & Werman, ICCV 2009].
+
+   The supply and demand sums must be equal. The flow between the sources and the sinks
+   is stored to flow (if not NULL), the flow via the transshipment node is not.
+   The total cost is returned.
+*/
+namespace
+{
+
+class EMDNetworkSimplex
+{
+public:
+    EMDNetworkSimplex( float **cost, const float *supply, const float *demand,
+                       int _ssize, int _dsize, float _threshold )
+        : ssize(_ssize), dsize(_dsize), threshold(_threshold)
+    {
+        int i, j, a;
+        double max_cost = 0;
+
+        use_t = threshold > 0;
+        tnode = ssize + dsize;
+        root = tnode + (use_t ? 1 : 0);
+        nnodes = root + 1;
+
+        /* the real arcs: source -> sink (unless clipped by the threshold),
+           source -> transshipment node and transshipment node -> sink */
+        for( i = 0; i < ssize; i++ )
+            for( j = 0; j < dsize; j++ )
+            {
+                float c = cost[i][j];
+                max_cost = MAX( max_cost, (double)fabs(c) );
+                if( !use_t || c < threshold )
+                    addArc( i, ssize + j, c );
+            }
+        nflow_arcs = (int)src.size();
+
+        if( use_t )
+        {
+            for( i = 0; i < ssize; i++ )
+                addArc( i, tnode, threshold );
+            for( j = 0; j < dsize; j++ )
+                addArc( tnode, ssize + j, 0.f );
+            max_cost = MAX( max_cost, (double)threshold );
+        }
+        nreal_arcs = (int)src.size();
+
+        /* the initial spanning tree consists of the artificial arcs between the root and
+           every node; their cost is high enough to push all the flow to the real arcs */
+        double art_cost = (max_cost + 1) * nnodes;
+        tol = (max_cost + 1) * 1e-9;
+
+        parent.assign(nnodes, -1);
+        pred.assign(nnodes, -1);
+        depth.assign(nnodes, 0);
+        pi.assign(nnodes, 0.);
+        tree_adj.resize(nnodes);
+
+        for( i = 0; i < root; i++ )
+        {
+            double b = i < ssize ? supply[i] : i < tnode ? -demand[i - ssize] : 0.;
+            if( b >= 0 )
+            {
+                a = addArc( i, root, (float)art_cost );
+                flow[a] = b;
+                pi[i] = -art_cost;
+            }
+            else
+            {
+                a = addArc( root, i, (float)art_cost );
+                flow[a] = -b;
+                pi[i] = art_cost;
+            }
+            parent[i] = root;
+            pred[i] = a;
+            depth[i] = 1;
+            intree[a] = 1;
+            tree_adj[i].push_back(a);
+            tree_adj[root].push_back(a);
+        }
+        narcs = (int)src.size();
+    }
+
+    double solve( float** flow_out )
+    {
+        int block = MAX( (int)std::sqrt((double)narcs), 10 ), next = 0;
+
+        for( ;; )
+        {
+            /* block search for the entering arc */
+            int in_arc = -1, cnt = 0, a = next;
+            double min_rc = -tol;
+
+            for( int k = 0; k < narcs; k++ )
+            {
+                if( !intree[a] )
+                {
+                    double rc = cst[a] + pi[src[a]] - pi[trg[a]];
+                    if( rc < min_rc )
+                    {
+                        min_rc = rc;
+                        in_arc = a;
+                    }
+                }
+                if( ++a == narcs )
+                    a = 0;
+                if( ++cnt == block )
+                {
+                    if( in_arc >= 0 )
+                        break;
+                    cnt = 0;
+                }
+            }
+
+            if( in_arc < 0 )
+                break;
+            next = a;
+            pivot( in_arc );
+        }
+
+        double total_cost = 0;
+        if( flow_out )
+            for( int i = 0; i < ssize; i++ )
+                memset( flow_out[i], 0, dsize*sizeof(flow_out[i][0]) );
+
+        for( int a = 0; a < nreal_arcs; a++ )
+        {
+            if( flow[a] <= 0 )
+                continue;
+            total_cost += flow[a] * cst[a];
+            if( flow_out && a < nflow_arcs )
+                flow_out[src[a]][trg[a] - ssize] = (float)flow[a];
+        }
+
+        return total_cost;
+    }
+
+private:
+    int addArc( int u, int v, float c )
+    {
+        src.push_back(u);
+        trg.push_back(v);
+        cst.push_back(c);
+        flow.push_back(0.);
+        intree.push_back(0);
+        return (int)src.size() - 1;
+    }
+
+    // pushes the flow around the cycle formed by the entering arc and the tree,
+    // and replaces the leaving arc with the entering one in the tree
+    void pivot( int in_arc )
+    {
+        int first = src[in_arc], second = trg[in_arc];
+        int u, v, join, u_out = -1, side = 0;
+        double delta = DBL_MAX;
+
+        for( u = first, v = second; u != v; )
+        {
+            if( depth[u] >= depth[v] )
+                u = parent[u];
+            else
+                v = parent[v];
+        }
+        join = u;
+
+        /* the flow goes from join down to first, so the arcs directed up lose it;
+           the strict inequality here and the non-strict one below keep the tree
+           strongly feasible, which prevents cycling on the degenerate pivots */
+        for( u = first; u != join; u = parent[u] )
+        {
+            int e = pred[u];
+            if( src[e] == u && flow[e] < delta )
+            {
+                delta = flow[e];
+                u_out = u;
+                side = 1;
+            }
+        }
+
+        /* the flow goes from second up to join, so the arcs directed down lose it */
+        for( u = second; u != join; u = parent[u] )
+        {
+            int e = pred[u];
+            if( trg[e] == u && flow[e] <= delta )
+            {
+                delta = flow[e];
+                u_out = u;
+                side = 2;
+            }
+        }
+
+        CV_Assert( u_out >= 0 );
+
+        if( delta > 0 )
+        {
+            flow[in_arc] += delta;
+            for( u = first; u != join; u = parent[u] )
+                flow[pred[u]] += src[pred[u]] == u ? -delta : delta;
+            for( u = second; u != join; u = parent[u] )
+                flow[pred[u]] += src[pred[u]] == u ? delta : -delta;
+        }
+
+        /* replace the leaving arc */
+        int out_arc = pred[u_out];
+        removeTreeArc( u_out, out_arc );
+        removeTreeArc( parent[u_out], out_arc );
+        intree[out_arc] = 0;
+        intree[in_arc] = 1;
+        tree_adj[first].push_back(in_arc);
+        tree_adj[second].push_back(in_arc);
+
+        /* the subtree under u_out is now hanging on the entering arc; re-root it */
+        int sub_root = side == 1 ? first : second;
+        int new_parent = side == 1 ? second : first;
+        parent[sub_root] = new_parent;
+        pred[sub_root] = in_arc;
+        stack.clear();
+        stack.push_back(sub_root);
+
+        while( !stack.empty() )
+        {
+            u = stack.back();
+            stack.pop_back();
+
+            int e = pred[u], p = parent[u];
+            depth[u] = depth[p] + 1;
+            pi[u] = src[e] == p ? pi[p] + cst[e] : pi[p] - cst[e];
+
+            const std::vector<int>& ta = tree_adj[u];
+            for( size_t k = 0; k < ta.size(); k++ )
+            {
+                e = ta[k];
+                v = src[e] == u ? trg[e] : src[e];
+                if( v == p )
+                    continue;
+                parent[v] = u;
+                pred[v] = e;
+                stack.push_back(v);
+            }
+        }
+    }
+
+    void removeTreeArc( int u, int e )
+    {
+        std::vector<int>& ta = tree_adj[u];
+        for( size_t k = 0; k < ta.size(); k++ )
+            if( ta[k] == e )
+            {
+                ta[k] = ta.back();
+                ta.pop_back();
+                break;
+            }
+    }
+
+    int ssize, dsize, tnode, root, nnodes;
+    int narcs, nreal_arcs, nflow_arcs;
+    float threshold;
+    bool use_t;
+    double tol;
+
+    std::vector<int> src, trg;
+    std::vector<float> cst;
+    std::vector<double> flow;
+    std::vector<uchar> intree;
+
+    std::vector<int> parent, pred, depth, stack;
+    std::vector<double> pi;
+    std::vector<std::vector<int> > tree_adj;
+};
+
+}
+
+static double icvSolveEMDNetwork( float **cost, const float *supply, const float *demand,
+                                  int ssize, int dsize, float threshold, float **flow )
+{
+    EMDNetworkSimplex solver( cost, supply, demand, ssize, dsize, threshold );
+    return solver.solve( flow );
+}
+
+
 /****************************************************************************************\
 *                                  standard  metrics                                     *
 \****************************************************************************************/
@@ -1159,4 +1496,135 @@ float cv::EMD( InputArray _signature1, InputArray _signature2,
                        _flow.needed() ? &_cflow : 0, lowerBound, 0 );
 }
 
+namespace cv
+{
+
+static float emdNetwork( const Mat& signature1, const Mat& signature2,
+                     CvDistanceFunction dist_func, int dims, float threshold )
+{
+    int i, j, ssize = 0, dsize = 0;
+    int size1 = signature1.rows, size2 = signature2.rows;
+    double s_sum = 0, d_sum = 0, diff;
+    AutoBuffer<float> _sd(size1 + size2 + 2);
+    AutoBuffer<const float*> _pts(size1 + size2 + 2);
+    float *s = _sd, *d = s + size1 + 1;
+    const float **pts1 = _pts, **pts2 = pts1 + size1 + 1;
+
+    for( i = 0; i < size1; i++ )
+    {
+        const float* row = signature1.ptr<float>(i);
+        if( row[0] > 0 )
+        {
+            s_sum += row[0];
+            s[ssize] = row[0];
+            pts1[ssize++] = row + 1;
+        }
+    }
+
+    for( i = 0; i < size2; i++ )
+    {
+        const float* row = signature2.ptr<float>(i);
+        if( row[0] > 0 )
+        {
+            d_sum += row[0];
+            d[dsize] = row[0];
+            pts2[dsize++] = row + 1;
+        }
+    }
+
+    /* if supply different than the demand, add a zero-cost dummy cluster */
+    diff = s_sum - d_sum;
+    if( fabs( diff ) >= CV_EMD_EPS * s_sum )
+    {
+        if( diff < 0 )
+        {
+            s[ssize] = (float)-diff;
+            pts1[ssize++] = 0;
+        }
+        else
+        {
+            d[dsize] = (float)diff;
+            pts2[dsize++] = 0;
+        }
+    }
+
+    Mat _cost(ssize, dsize, CV_32F);
+    AutoBuffer<float*> _rows(ssize);
+    float** cost = _rows;
+
+    for( i = 0; i < ssize; i++ )
+    {
+        cost[i] = _cost.ptr<float>(i);
+        for( j = 0; j < dsize; j++ )
+            cost[i][j] = pts1[i] && pts2[j] ? dist_func( pts1[i], pts2[j], (void*)(size_t)dims ) : 0.f;
+    }
+
+    double total_cost = icvSolveEMDNetwork( cost, s, d, ssize, dsize, threshold, 0 );
+    return (float)(total_cost / MAX( s_sum, d_sum ));
+}
+
+class EMDBatch_Invoker : public ParallelLoopBody
+{
+public:
+    EMDBatch_Invoker( const Mat& _signature1, const std::vector<Mat>& _signatures2,
+                      CvDistanceFunction _dist_func, int _dims, float _threshold, float* _distances )
+        : signature1(_signature1), signatures2(_signatures2), dist_func(_dist_func),
+          dims(_dims), threshold(_threshold), distances(_distances)
+    {
+    }
+
+    void operator()( const Range& range ) const
+    {
+        for( int k = range.start; k < range.end; k++ )
+            distances[k] = emdNetwork( signature1, signatures2[k], dist_func, dims, threshold );
+    }
+
+private:
+    const Mat& signature1;
+    const std::vector<Mat>& signatures2;
+    CvDistanceFunction dist_func;
+    int dims;
+    float threshold;
+    float* distances;
+
+    EMDBatch_Invoker& operator=(const EMDBatch_Invoker&);
+};
+
+}
+
+void cv::EMD( InputArray _signature1, InputArrayOfArrays _signatures2, int distType,
+              std::vector<float>& distances, float maxGroundDist )
+{
+    Mat signature1 = _signature1.getMat();
+    int k, n = (int)_signatures2.total(), dims = signature1.cols - 1;
+    std::vector<Mat> signatures2(n);
+    CvDistanceFunction dist_func = 0;
+
+    CV_Assert( signature1.type() == CV_32FC1 && dims > 0 && maxGroundDist >= 0 );
+
+    if( distType == CV_DIST_L1 )
+        dist_func = icvDistL1;
+    else if( distType == CV_DIST_L2 )
+        dist_func = icvDistL2;
+    else if( distType == CV_DIST_C )
+        dist_func = icvDistC;
+    else
+        CV_Error( CV_StsBadFlag, "Bad or unsupported metric type" );
+
+    CV_Assert( checkRange(signature1.col(0), true, 0, 0, FLT_MAX) && countNonZero(signature1.col(0)) > 0 );
+
+    for( k = 0; k < n; k++ )
+    {
+        signatures2[k] = _signatures2.getMat(k);
+        const Mat& sig = signatures2[k];
+        CV_Assert( sig.type() == CV_32FC1 && sig.cols == dims + 1 );
+        CV_Assert( checkRange(sig.col(0), true, 0, 0, FLT_MAX) && countNonZero(sig.col(0)) > 0 );
+    }
+
+    distances.resize(n);
+    if( n > 0 )
+        parallel_for_(Range(0, n), EMDBatch_Invoker(signature1, signatures2, dist_func,
+                                                     dims, maxGroundDist, &distances[0]));
+}
+
 /* End of file. */
@@ -45,9 +45,63 @@
 namespace cv
 {
 
+// equal values are ordered by their addresses, so that the result of
+// a partial sort does not depend on the number of sorted elements
 template<typename T> struct greaterThanPtr
 {
-    bool operator()(const T* a, const T* b) const { return *a > *b; }
+    bool operator()(const T* a, const T* b) const { return *a > *b || (*a == *b && a < b); }
+};
+
+// sorts the corners starting from 'first' so that the strongest of them go to [first, last)
+static void sortCorners( std::vector<const float*>& corners, size_t first, size_t last )
+{
+    if( last == corners.size() )
+        std::sort( corners.begin() + first, corners.end(), greaterThanPtr<float>() );
+    else
+        std::partial_sort( corners.begin() + first, corners.begin() + last, corners.end(), greaterThanPtr<float>() );
+}
+
+// collects the local maxima of the eigenvalue image, each row stripe into its own vector
+class CornersCollector : public ParallelLoopBody
+{
+public:
+    CornersCollector( const Mat& _eig, const Mat& _tmp, const Mat& _mask, int _nstripes,
+                      std::vector<std::vector<const float*> >& _corners )
+        : eig(_eig), tmp(_tmp), mask(_mask), nstripes(_nstripes), corners(_corners)
+    {
+    }
+
+    void operator()( const Range& range ) const
+    {
+        int height = eig.rows - 2;
+        for( int s = range.start; s < range.end; s++ )
+        {
+            std::vector<const float*>& stripeCorners = corners[s];
+            int y_end = 1 + height*(s + 1)/nstripes;
+            for( int y = 1 + height*s/nstripes; y < y_end; y++ )
+            {
+                const float* eig_data = (const float*)eig.ptr(y);
+                const float* tmp_data = (const float*)tmp.ptr(y);
+                const uchar* mask_data = mask.data ? mask.ptr(y) : 0;
+
+                for( int x = 1; x < eig.cols - 1; x++ )
+                {
+                    float val = eig_data[x];
+                    if( val != 0 && val == tmp_data[x] && (!mask_data || mask_data[x]) )
+                        stripeCorners.push_back(eig_data + x);
+                }
+            }
+        }
+    }
+
+private:
+    CornersCollector& operator=(const CornersCollector&);
+
+    const Mat& eig;
+    const Mat& tmp;
+    const Mat& mask;
+    int nstripes;
+    std::vector<std::vector<const float*> >& corners;
 };
 
 }
@@ -78,24 +132,22 @@ void cv::goodFeaturesToTrack( InputArray _image, OutputArray _corners,
     std::vector<const float*> tmpCorners;
 
     // collect list of pointers to features - put them into temporary image
-    for( int y = 1; y < imgsize.height - 1; y++ )
+    if( imgsize.height > 2 )
     {
-        const float* eig_data = (const float*)eig.ptr(y);
-        const float* tmp_data = (const float*)tmp.ptr(y);
-        const uchar* mask_data = mask.data ? mask.ptr(y) : 0;
-
-        for( int x = 1; x < imgsize.width - 1; x++ )
-        {
-            float val = eig_data[x];
-            if( val != 0 && val == tmp_data[x] && (!mask_data || mask_data[x]) )
-                tmpCorners.push_back(eig_data + x);
-        }
+        int nstripes = std::min(std::max(getNumThreads(), 1), imgsize.height - 2);
+        std::vector<std::vector<const float*> > stripeCorners(nstripes);
+        parallel_for_( Range(0, nstripes), CornersCollector(eig, tmp, mask, nstripes, stripeCorners) );
+        for( int s = 0; s < nstripes; s++ )
+            tmpCorners.insert( tmpCorners.end(), stripeCorners[s].begin(), stripeCorners[s].end() );
     }
 
-    std::sort( tmpCorners.begin(), tmpCorners.end(), greaterThanPtr<float>() );
     std::vector<Point2f> corners;
     size_t i, j, total = tmpCorners.size(), ncorners = 0;
 
+    // only the strongest corners are sorted: maxCorners of them at first, and more,
+    // if some are rejected by the minimal distance check, before they are visited
+    size_t nsorted = 0;
+
     if(minDistance >= 1)
     {
          // Partition the image into larger grids
@@ -112,6 +164,12 @@ void cv::goodFeaturesToTrack( InputArray _image, OutputArray _corners,
 
         for( i = 0; i < total; i++ )
         {
+            if( i == nsorted )
+            {
+                nsorted = maxCorners > 0 ? std::min(total, std::max(nsorted*2, (size_t)maxCorners)) : total;
+                sortCorners( tmpCorners, i, nsorted );
+            }
+
             int ofs = (int)((const uchar*)tmpCorners[i] - eig.data);
             int y = (int)(ofs / eig.step);
             int x = (int)((ofs - y*eig.step)/sizeof(float));
@@ -173,7 +231,10 @@ void cv::goodFeaturesToTrack( InputArray _image, OutputArray _corners,
     }
     else
     {
-        for( i = 0; i < total; i++ )
+        nsorted = maxCorners > 0 ? std::min(total, (size_t)maxCorners) : total;
+        sortCorners( tmpCorners, 0, nsorted );
+
+        for( i = 0; i < nsorted; i++ )
         {
             int ofs = (int)((const uchar*)tmpCorners[i] - eig.data);
             int y = (int)(ofs / eig.step);
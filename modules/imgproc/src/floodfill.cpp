@@ -280,7 +280,8 @@ static void
 floodFillGrad_CnIR( Mat& image, Mat& msk,
                    Point seed, _Tp newVal, _MTp newMaskVal,
                    Diff diff, ConnectedComp* region, int flags,
-                   std::vector<FFillSegment>* buffer )
+                   std::vector<FFillSegment>* buffer,
+                   std::vector<FFillSegment>* spans )
 {
     int step = (int)image.step, maskStep = (int)msk.step;
     uchar* pImage = image.data;
@@ -329,6 +330,10 @@ floodFillGrad_CnIR( Mat& image, Mat& msk,
         int k, YC, PL, PR, dir;
         ICV_POP( YC, L, R, PL, PR, dir );
 
+        // remember the popped segment, it belongs to the filled region
+        if( spans )
+            spans->push_back( *tail );
+
         int data[][3] =
         {
             {-dir, L - _8_connectivity, R + _8_connectivity},
@@ -448,94 +453,30 @@ floodFillGrad_CnIR( Mat& image, Mat& msk,
     }
 }
 
-}
 
-/****************************************************************************************\
-*                                    External Functions                                  *
-\****************************************************************************************/
-
-int cv::floodFill( InputOutputArray _image, InputOutputArray _mask,
-                  Point seedPoint, Scalar newVal, Rect* rect,
-                  Scalar loDiff, Scalar upDiff, int flags )
+static void
+checkFloodFillArgs( const Mat& img, Scalar loDiff, Scalar upDiff, int& flags, bool& is_simple )
 {
-    ConnectedComp comp;
-    std::vector<FFillSegment> buffer;
-
-    if( rect )
-        *rect = Rect();
-
     int i, connectivity = flags & 255;
-    union {
-        uchar b[4];
-        int i[4];
-        float f[4];
-        double _[4];
-    } nv_buf;
-    nv_buf._[0] = nv_buf._[1] = nv_buf._[2] = nv_buf._[3] = 0;
-
-    struct { Vec3b b; Vec3i i; Vec3f f; } ld_buf, ud_buf;
-    Mat img = _image.getMat(), mask;
-    if( !_mask.empty() )
-        mask = _mask.getMat();
-    Size size = img.size();
-
-    int type = img.type();
-    int depth = img.depth();
     int cn = img.channels();
 
     if( connectivity == 0 )
-        connectivity = 4;
+        flags = (flags & ~255) | 4;
     else if( connectivity != 4 && connectivity != 8 )
         CV_Error( CV_StsBadFlag, "Connectivity must be 4, 0(=4) or 8" );
 
-    bool is_simple = mask.empty() && (flags & FLOODFILL_MASK_ONLY) == 0;
-
     for( i = 0; i < cn; i++ )
     {
         if( loDiff[i] < 0 || upDiff[i] < 0 )
             CV_Error( CV_StsBadArg, "lo_diff and up_diff must be non-negative" );
         is_simple = is_simple && fabs(loDiff[i]) < DBL_EPSILON && fabs(upDiff[i]) < DBL_EPSILON;
     }
+}
 
-    if( (unsigned)seedPoint.x >= (unsigned)size.width ||
-       (unsigned)seedPoint.y >= (unsigned)size.height )
-        CV_Error( CV_StsOutOfRange, "Seed point is outside of image" );
-
-    scalarToRawData( newVal, &nv_buf, type, 0);
-    size_t buffer_size = MAX( size.width, size.height ) * 2;
-    buffer.resize( buffer_size );
-
-    if( is_simple )
-    {
-        size_t elem_size = img.elemSize();
-        const uchar* seed_ptr = img.data + img.step*seedPoint.y + elem_size*seedPoint.x;
-
-        size_t k = 0;
-        for(; k < elem_size; k++)
-            if (seed_ptr[k] != nv_buf.b[k])
-                break;
-
-        if( k != elem_size )
-        {
-            if( type == CV_8UC1 )
-                floodFill_CnIR(img, seedPoint, nv_buf.b[0], &comp, flags, &buffer);
-            else if( type == CV_8UC3 )
-                floodFill_CnIR(img, seedPoint, Vec3b(nv_buf.b), &comp, flags, &buffer);
-            else if( type == CV_32SC1 )
-                floodFill_CnIR(img, seedPoint, nv_buf.i[0], &comp, flags, &buffer);
-            else if( type == CV_32FC1 )
-                floodFill_CnIR(img, seedPoint, nv_buf.f[0], &comp, flags, &buffer);
-            else if( type == CV_32SC3 )
-                floodFill_CnIR(img, seedPoint, Vec3i(nv_buf.i), &comp, flags, &buffer);
-            else if( type == CV_32FC3 )
-                floodFill_CnIR(img, seedPoint, Vec3f(nv_buf.f), &comp, flags, &buffer);
-            else
-                CV_Error( CV_StsUnsupportedFormat, "" );
-            if( rect )
-                *rect = comp.rect;
-            return comp.area;
-        }
-    }
+static void
+initFloodFillMask( Mat& mask, Size size )
+{
+    int i;
 
     if( mask.empty() )
     {
@@ -556,6 +497,33 @@ int cv::floodFill( InputOutputArray _image, InputOutputArray _mask,
     {
         mask.at<uchar>(i, 0) = mask.at<uchar>(i, mask.cols-1) = (uchar)1;
     }
+}
+
+static uchar
+floodFillMaskVal( int flags )
+{
+    return (uchar)((flags & ~0xff) == 0 ? 1 : ((flags >> 8) & 255));
+}
+
+static void
+floodFillGrad( Mat& img, Mat& mask, Point seedPoint,
+               Scalar newVal, Scalar loDiff, Scalar upDiff,
+               ConnectedComp* comp, int flags,
+               std::vector<FFillSegment>* buffer,
+               std::vector<FFillSegment>* spans )
+{
+    int i, type = img.type(), depth = img.depth(), cn = img.channels();
+    union {
+        uchar b[4];
+        int i[4];
+        float f[4];
+        double _[4];
+    } nv_buf;
+    nv_buf._[0] = nv_buf._[1] = nv_buf._[2] = nv_buf._[3] = 0;
+
+    struct { Vec3b b; Vec3i i; Vec3f f; } ld_buf, ud_buf;
+
+    scalarToRawData( newVal, &nv_buf, type, 0);
 
     if( depth == CV_8U )
         for( i = 0; i < cn; i++ )
@@ -578,40 +546,172 @@ int cv::floodFill( InputOutputArray _image, InputOutputArray _mask,
     else
         CV_Error( CV_StsUnsupportedFormat, "" );
 
-    uchar newMaskVal = (uchar)((flags & ~0xff) == 0 ? 1 : ((flags >> 8) & 255));
+    uchar newMaskVal = floodFillMaskVal(flags);
 
     if( type == CV_8UC1 )
         floodFillGrad_CnIR<uchar, uchar, int, Diff8uC1>(
                 img, mask, seedPoint, nv_buf.b[0], newMaskVal,
                 Diff8uC1(ld_buf.b[0], ud_buf.b[0]),
-                &comp, flags, &buffer);
+                comp, flags, buffer, spans);
     else if( type == CV_8UC3 )
         floodFillGrad_CnIR<Vec3b, uchar, Vec3i, Diff8uC3>(
                 img, mask, seedPoint, Vec3b(nv_buf.b), newMaskVal,
                 Diff8uC3(ld_buf.b, ud_buf.b),
-                &comp, flags, &buffer);
+                comp, flags, buffer, spans);
     else if( type == CV_32SC1 )
         floodFillGrad_CnIR<int, uchar, int, Diff32sC1>(
                 img, mask, seedPoint, nv_buf.i[0], newMaskVal,
                 Diff32sC1(ld_buf.i[0], ud_buf.i[0]),
-                &comp, flags, &buffer);
+                comp, flags, buffer, spans);
     else if( type == CV_32SC3 )
         floodFillGrad_CnIR<Vec3i, uchar, Vec3i, Diff32sC3>(
                 img, mask, seedPoint, Vec3i(nv_buf.i), newMaskVal,
                 Diff32sC3(ld_buf.i, ud_buf.i),
-                &comp, flags, &buffer);
+                comp, flags, buffer, spans);
     else if( type == CV_32FC1 )
         floodFillGrad_CnIR<float, uchar, float, Diff32fC1>(
                 img, mask, seedPoint, nv_buf.f[0], newMaskVal,
                 Diff32fC1(ld_buf.f[0], ud_buf.f[0]),
-                &comp, flags, &buffer);
+                comp, flags, buffer, spans);
     else if( type == CV_32FC3 )
         floodFillGrad_CnIR<Vec3f, uchar, Vec3f, Diff32fC3>(
                 img, mask, seedPoint, Vec3f(nv_buf.f), newMaskVal,
                 Diff32fC3(ld_buf.f, ud_buf.f),
-                &comp, flags, &buffer);
+                comp, flags, buffer, spans);
     else
         CV_Error(CV_StsUnsupportedFormat, "");
+}
+
+/*
+  Finds the regions of a stripe of seed points independently of each other.
+  Each stripe fills its own copy of the initial mask, which is cleared back
+  after every seed, and reuses the segment stack between the seeds.
+*/
+class FloodFillSeedsInvoker : public ParallelLoopBody
+{
+public:
+    FloodFillSeedsInvoker( const Mat& _img, const Mat& _mask, const std::vector<Point>& _seeds,
+                           Scalar _loDiff, Scalar _upDiff, int _flags, int _nstripes,
+                           std::vector<std::vector<FFillSegment> >& _regions,
+                           std::vector<ConnectedComp>& _comps )
+        : img(_img), mask(_mask), seeds(_seeds), loDiff(_loDiff), upDiff(_upDiff),
+          flags(_flags), nstripes(_nstripes), regions(_regions), comps(_comps)
+    {
+    }
+
+    void operator()( const Range& range ) const
+    {
+        Mat stripeImg = img, stripeMask = mask.clone();
+        std::vector<FFillSegment> buffer( MAX( img.cols, img.rows ) * 2 );
+        int nseeds = (int)seeds.size();
+
+        for( int s = range.start; s < range.end; s++ )
+        {
+            for( int i = nseeds*s/nstripes; i < nseeds*(s + 1)/nstripes; i++ )
+            {
+                std::vector<FFillSegment>& spans = regions[i];
+                floodFillGrad( stripeImg, stripeMask, seeds[i], Scalar(), loDiff, upDiff,
+                               &comps[i], flags | FLOODFILL_MASK_ONLY, &buffer, &spans );
+
+                for( size_t k = 0; k < spans.size(); k++ )
+                {
+                    const FFillSegment& span = spans[k];
+                    memset( stripeMask.ptr(span.y + 1) + span.l + 1, 0, span.r - span.l + 1 );
+                }
+            }
+        }
+    }
+
+private:
+    FloodFillSeedsInvoker& operator=(const FloodFillSeedsInvoker&);
+
+    const Mat& img;
+    const Mat& mask;
+    const std::vector<Point>& seeds;
+    Scalar loDiff;
+    Scalar upDiff;
+    int flags;
+    int nstripes;
+    std::vector<std::vector<FFillSegment> >& regions;
+    std::vector<ConnectedComp>& comps;
+};
+
+}
+
+/****************************************************************************************\
+*                                    External Functions                                  *
+\****************************************************************************************/
+
+int cv::floodFill( InputOutputArray _image, InputOutputArray _mask,
+                  Point seedPoint, Scalar newVal, Rect* rect,
+                  Scalar loDiff, Scalar upDiff, int flags )
+{
+    ConnectedComp comp;
+    std::vector<FFillSegment> buffer;
+
+    if( rect )
+        *rect = Rect();
+
+    union {
+        uchar b[4];
+        int i[4];
+        float f[4];
+        double _[4];
+    } nv_buf;
+    nv_buf._[0] = nv_buf._[1] = nv_buf._[2] = nv_buf._[3] = 0;
+
+    Mat img = _image.getMat(), mask;
+    if( !_mask.empty() )
+        mask = _mask.getMat();
+    Size size = img.size();
+
+    int type = img.type();
+
+    bool is_simple = mask.empty() && (flags & FLOODFILL_MASK_ONLY) == 0;
+    checkFloodFillArgs( img, loDiff, upDiff, flags, is_simple );
+
+    if( (unsigned)seedPoint.x >= (unsigned)size.width ||
+       (unsigned)seedPoint.y >= (unsigned)size.height )
+        CV_Error( CV_StsOutOfRange, "Seed point is outside of image" );
+
+    scalarToRawData( newVal, &nv_buf, type, 0);
+    size_t buffer_size = MAX( size.width, size.height ) * 2;
+    buffer.resize( buffer_size );
+
+    if( is_simple )
+    {
+        size_t elem_size = img.elemSize();
+        const uchar* seed_ptr = img.data + img.step*seedPoint.y + elem_size*seedPoint.x;
+
+        size_t k = 0;
+        for(; k < elem_size; k++)
+            if (seed_ptr[k] != nv_buf.b[k])
+                break;
+
+        if( k != elem_size )
+        {
+            if( type == CV_8UC1 )
+                floodFill_CnIR(img, seedPoint, nv_buf.b[0], &comp, flags, &buffer);
+            else if( type == CV_8UC3 )
+                floodFill_CnIR(img, seedPoint, Vec3b(nv_buf.b), &comp, flags, &buffer);
+            else if( type == CV_32SC1 )
+                floodFill_CnIR(img, seedPoint, nv_buf.i[0], &comp, flags, &buffer);
+            else if( type == CV_32FC1 )
+                floodFill_CnIR(img, seedPoint, nv_buf.f[0], &comp, flags, &buffer);
+            else if( type == CV_32SC3 )
+                floodFill_CnIR(img, seedPoint, Vec3i(nv_buf.i), &comp, flags, &buffer);
+            else if( type == CV_32FC3 )
+                floodFill_CnIR(img, seedPoint, Vec3f(nv_buf.f), &comp, flags, &buffer);
+            else
+                CV_Error( CV_StsUnsupportedFormat, "" );
+            if( rect )
+                *rect = comp.rect;
+            return comp.area;
+        }
+    }
+
+    initFloodFillMask( mask, size );
+    floodFillGrad( img, mask, seedPoint, newVal, loDiff, upDiff, &comp, flags, &buffer, 0 );
 
     if( rect )
         *rect = comp.rect;
@@ -619,6 +719,94 @@ int cv::floodFill( InputOutputArray _image, InputOutputArray _mask,
 }
 
 
+void cv::floodFill( InputOutputArray _image, InputOutputArray _mask,
+                    const std::vector<Point>& seedPoints, Scalar newVal,
+                    std::vector<int>& areas, std::vector<Rect>& rects,
+                    Scalar loDiff, Scalar upDiff, int flags )
+{
+    Mat img = _image.getMat(), mask;
+    if( !_mask.empty() )
+        mask = _mask.getMat();
+    Size size = img.size();
+    int i, nseeds = (int)seedPoints.size();
+
+    bool is_simple = false;
+    checkFloodFillArgs( img, loDiff, upDiff, flags, is_simple );
+
+    for( i = 0; i < nseeds; i++ )
+        if( (unsigned)seedPoints[i].x >= (unsigned)size.width ||
+           (unsigned)seedPoints[i].y >= (unsigned)size.height )
+            CV_Error( CV_StsOutOfRange, "Seed point is outside of image" );
+
+    initFloodFillMask( mask, size );
+
+    areas.assign( nseeds, 0 );
+    rects.assign( nseeds, Rect() );
+    if( nseeds == 0 )
+        return;
+
+    // find the regions of all the seeds in parallel, as if each of them was filled alone
+    int nstripes = std::min( std::max(getNumThreads(), 1), nseeds );
+    std::vector<std::vector<FFillSegment> > regions( nseeds );
+    std::vector<ConnectedComp> comps( nseeds );
+    parallel_for_( Range(0, nstripes),
+                   FloodFillSeedsInvoker(img, mask, seedPoints, loDiff, upDiff, flags, nstripes, regions, comps) );
+
+    // fill the regions in the order of the seeds. A region filled alone is the same as the one
+    // filled after the previous seeds, unless it meets their regions; those seeds are filled again
+    union {
+        uchar b[32];
+        double _[4];
+    } nv_buf;
+    nv_buf._[0] = nv_buf._[1] = nv_buf._[2] = nv_buf._[3] = 0;
+    scalarToRawData( newVal, &nv_buf, img.type(), 0 );
+
+    size_t elem_size = img.elemSize();
+    uchar newMaskVal = floodFillMaskVal(flags);
+    bool fillImage = (flags & FLOODFILL_MASK_ONLY) == 0;
+    std::vector<FFillSegment> buffer( MAX( size.width, size.height ) * 2 );
+
+    for( i = 0; i < nseeds; i++ )
+    {
+        const std::vector<FFillSegment>& spans = regions[i];
+        size_t k, nspans = spans.size();
+
+        for( k = 0; k < nspans; k++ )
+        {
+            const FFillSegment& span = spans[k];
+            const uchar* mask_row = mask.ptr(span.y + 1);
+            int x = span.l;
+            while( x <= span.r && !mask_row[x + 1] )
+                x++;
+            if( x <= span.r )
+                break;
+        }
+
+        if( k < nspans )
+        {
+            ConnectedComp comp;
+            floodFillGrad( img, mask, seedPoints[i], newVal, loDiff, upDiff, &comp, flags, &buffer, 0 );
+            areas[i] = comp.area;
+            rects[i] = comp.rect;
+            continue;
+        }
+
+        for( k = 0; k < nspans; k++ )
+        {
+            const FFillSegment& span = spans[k];
+            memset( mask.ptr(span.y + 1) + span.l + 1, newMaskVal, span.r - span.l + 1 );
+            if( fillImage )
+            {
+                uchar* img_row = img.ptr(span.y) + span.l*elem_size;
+                for( int x = span.l; x <= span.r; x++, img_row += elem_size )
+                    memcpy( img_row, nv_buf.b, elem_size );
+            }
+        }
+        areas[i] = comps[i].area;
+        rects[i] = comps[i].rect;
+    }
+}
+
 int cv::floodFill( InputOutputArray _image, Point seedPoint,
                   Scalar newVal, Rect* rect,
                   Scalar loDiff, Scalar upDiff, int flags )
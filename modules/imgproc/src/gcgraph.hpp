@@ -174,7 +174,12 @@ TWeight GCGraph<TWeight>::maxFlow()
             v->t = v->weight < 0;
         }
         else
+        {
+            // the graph may be re-used after the previous maxFlow() call,
+            // so put the free vertices back to the source segment
             v->parent = 0;
+            v->t = 0;
+        }
     }
     first = first->next;
     last->next = nilNode;
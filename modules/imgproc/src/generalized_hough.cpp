@@ -413,53 +413,98 @@ namespace
         findPosInHist();
     }
 
-    void GeneralizedHoughBallardImpl::calcHist()
+    class BallardHist_Invoker : public ParallelLoopBody
     {
-        CV_Assert( imageEdges_.type() == CV_8UC1 );
-        CV_Assert( imageDx_.type() == CV_32FC1 && imageDx_.size() == imageSize_);
-        CV_Assert( imageDy_.type() == imageDx_.type() && imageDy_.size() == imageSize_);
-        CV_Assert( levels_ > 0 && r_table_.size() == static_cast<size_t>(levels_ + 1) );
-        CV_Assert( dp_ > 0.0 );
-
-        const double thetaScale = levels_ / 360.0;
-        const double idp = 1.0 / dp_;
-
-        hist_.create(cvCeil(imageSize_.height * idp) + 2, cvCeil(imageSize_.width * idp) + 2, CV_32SC1);
-        hist_.setTo(0);
-
-        const int rows = hist_.rows - 2;
-        const int cols = hist_.cols - 2;
+    public:
+        BallardHist_Invoker(const Mat& edges, const Mat& dx, const Mat& dy, const std::vector< std::vector<Point> >& r_table,
+                            double thetaScale, double idp, Mat& hist, Mutex* histLock) :
+            edges_(edges), dx_(dx), dy_(dy), r_table_(r_table), thetaScale_(thetaScale), idp_(idp), hist_(hist), histLock_(histLock)
+        {
+        }
 
-        for (int y = 0; y < imageSize_.height; ++y)
+        void operator()(const Range& range) const
         {
-            const uchar* edgesRow = imageEdges_.ptr(y);
-            const float* dxRow = imageDx_.ptr<float>(y);
-            const float* dyRow = imageDy_.ptr<float>(y);
+            // every stripe votes into its own accumulator unless it covers the whole image
+            const bool whole = range.start == 0 && range.end == edges_.rows;
+            Mat localHist;
+            if (!whole)
+                localHist = Mat::zeros(hist_.size(), CV_32SC1);
+            Mat& hist = whole ? hist_ : localHist;
+
+            const int rows = hist.rows - 2;
+            const int cols = hist.cols - 2;
 
-            for (int x = 0; x < imageSize_.width; ++x)
+            for (int y = range.start; y < range.end; ++y)
             {
-                const Point p(x, y);
+                const uchar* edgesRow = edges_.ptr(y);
+                const float* dxRow = dx_.ptr<float>(y);
+                const float* dyRow = dy_.ptr<float>(y);
 
-                if (edgesRow[x] && (notNull(dyRow[x]) || notNull(dxRow[x])))
+                for (int x = 0; x < edges_.cols; ++x)
                 {
-                    const float theta = fastAtan2(dyRow[x], dxRow[x]);
-                    const int n = cvRound(theta * thetaScale);
+                    const Point p(x, y);
 
-                    const std::vector<Point>& r_row = r_table_[n];
-
-                    for (size_t j = 0; j < r_row.size(); ++j)
+                    if (edgesRow[x] && (notNull(dyRow[x]) || notNull(dxRow[x])))
                     {
-                        Point c = p - r_row[j];
+                        const float theta = fastAtan2(dyRow[x], dxRow[x]);
+                        const int n = cvRound(theta * thetaScale_);
 
-                        c.x = cvRound(c.x * idp);
-                        c.y = cvRound(c.y * idp);
+                        const std::vector<Point>& r_row = r_table_[n];
 
-                        if (c.x >= 0 && c.x < cols && c.y >= 0 && c.y < rows)
-                            ++hist_.at<int>(c.y + 1, c.x + 1);
+                        for (size_t j = 0; j < r_row.size(); ++j)
+                        {
+                            Point c = p - r_row[j];
+
+                            c.x = cvRound(c.x * idp_);
+                            c.y = cvRound(c.y * idp_);
+
+                            if (c.x >= 0 && c.x < cols && c.y >= 0 && c.y < rows)
+                                ++hist.at<int>(c.y + 1, c.x + 1);
+                        }
                     }
                 }
             }
+
+            if (!whole)
+            {
+                AutoLock lock(*histLock_);
+                hist_ += localHist;
+            }
         }
+
+    private:
+        const Mat& edges_;
+        const Mat& dx_;
+        const Mat& dy_;
+        const std::vector< std::vector<Point> >& r_table_;
+        double thetaScale_;
+        double idp_;
+        Mat& hist_;
+        Mutex* histLock_;
+
+        BallardHist_Invoker& operator=(const BallardHist_Invoker&);
+    };
+
+    void GeneralizedHoughBallardImpl::calcHist()
+    {
+        CV_Assert( imageEdges_.type() == CV_8UC1 );
+        CV_Assert( imageDx_.type() == CV_32FC1 && imageDx_.size() == imageSize_);
+        CV_Assert( imageDy_.type() == imageDx_.type() && imageDy_.size() == imageSize_);
+        CV_Assert( levels_ > 0 && r_table_.size() == static_cast<size_t>(levels_ + 1) );
+        CV_Assert( dp_ > 0.0 );
+
+        const double thetaScale = levels_ / 360.0;
+        const double idp = 1.0 / dp_;
+
+        hist_.create(cvCeil(imageSize_.height * idp) + 2, cvCeil(imageSize_.width * idp) + 2, CV_32SC1);
+        hist_.setTo(0);
+
+        // one stripe per thread, since each of them needs its own accumulator of the image size
+        Mutex histLock;
+        const int nstripes = std::min(getNumThreads(), imageSize_.height);
+        parallel_for_(Range(0, imageSize_.height),
+                      BallardHist_Invoker(imageEdges_, imageDx_, imageDy_, r_table_, thetaScale, idp, hist_, &histLock),
+                      std::max(nstripes, 1));
     }
 
     void GeneralizedHoughBallardImpl::findPosInHist()
@@ -498,6 +543,9 @@ Ptr<GeneralizedHoughBallard> cv::createGeneralizedHoughBallard()
 
 namespace
 {
+    class GuilFeatures_Invoker;
+    class GuilHist_Invoker;
+
     class GeneralizedHoughGuilImpl : public GeneralizedHoughGuil, private GeneralizedHoughBase
     {
     public:
@@ -599,15 +647,27 @@ namespace
             Point2d r2;
         };
 
+        friend class GuilFeatures_Invoker;
+        friend class GuilHist_Invoker;
+
         void buildFeatureList(const Mat& edges, const Mat& dx, const Mat& dy, std::vector< std::vector<Feature> >& features, Point2d center = Point2d());
         void getContourPoints(const Mat& edges, const Mat& dx, const Mat& dy, std::vector<ContourPoint>& points);
+        void addPairFeatures(const std::vector<ContourPoint>& points, const std::vector<int>& order, const std::vector<double>& thetas,
+                             const Range& range, double maxDist, Point2d center, std::vector< std::vector<Feature> >& features) const;
+        void sortImageFeatures();
 
         void calcOrientation();
         void calcScale(double angle);
         void calcPosition(double angle, int angleVotes, double scale, int scaleVotes);
 
+        void voteOrientation(const Range& levels, Mat& hist) const;
+        void voteScale(double angle, const Range& levels, Mat& hist) const;
+        void votePosition(double angle, double scale, const Range& levels, Mat& hist) const;
+
         std::vector< std::vector<Feature> > templFeatures_;
         std::vector< std::vector<Feature> > imageFeatures_;
+        // gradient directions of imageFeatures_ in each level, sorted
+        std::vector< std::vector<double> > imageThetas_;
 
         std::vector< std::pair<double, int> > angles_;
         std::vector< std::pair<double, int> > scales_;
@@ -630,6 +690,34 @@ namespace
         return (fabs(clampAngle(a - b)) <= eps);
     }
 
+    // Finds the elements of the sorted array of angles that may be equal to [a, a + width] modulo 360.
+    // The ranges are slightly wider than that, so the caller still checks the exact condition.
+    int angleRanges(const std::vector<double>& angles, double a, double width, Range ranges[2])
+    {
+        const double slack = 1e-3;
+        const int n = static_cast<int>(angles.size());
+
+        if (n == 0 || width + 2 * slack >= 360.0)
+        {
+            ranges[0] = Range(0, n);
+            return 1;
+        }
+
+        const double lo = (a - slack) - 360.0 * std::floor((a - slack) / 360.0);
+        const double hi = lo + std::max(width, 0.0) + 2 * slack;
+        const int start = static_cast<int>(std::lower_bound(angles.begin(), angles.end(), lo) - angles.begin());
+
+        if (hi <= 360.0)
+        {
+            ranges[0] = Range(start, static_cast<int>(std::upper_bound(angles.begin(), angles.end(), hi) - angles.begin()));
+            return 1;
+        }
+
+        ranges[0] = Range(start, n);
+        ranges[1] = Range(0, static_cast<int>(std::upper_bound(angles.begin(), angles.end(), hi - 360.0) - angles.begin()));
+        return 2;
+    }
+
     GeneralizedHoughGuilImpl::GeneralizedHoughGuilImpl()
     {
         maxBufferSize_ = 1000;
@@ -658,6 +746,7 @@ namespace
     void GeneralizedHoughGuilImpl::processImage()
     {
         buildFeatureList(imageEdges_, imageDx_, imageDy_, imageFeatures_);
+        sortImageFeatures();
 
         calcOrientation();
 
@@ -678,28 +767,124 @@ namespace
         }
     }
 
+    class GuilFeatures_Invoker : public ParallelLoopBody
+    {
+    public:
+        typedef GeneralizedHoughGuilImpl::ContourPoint ContourPoint;
+        typedef GeneralizedHoughGuilImpl::Feature Feature;
+
+        GuilFeatures_Invoker(const GeneralizedHoughGuilImpl& impl, const std::vector<ContourPoint>& points,
+                             const std::vector<int>& order, const std::vector<double>& thetas, double maxDist, Point2d center,
+                             std::vector< std::vector< std::vector<Feature> > >& stripeFeatures) :
+            impl_(impl), points_(points), order_(order), thetas_(thetas), maxDist_(maxDist), center_(center), stripeFeatures_(stripeFeatures)
+        {
+        }
+
+        void operator()(const Range& range) const
+        {
+            const int nstripes = static_cast<int>(stripeFeatures_.size());
+            const int npoints = static_cast<int>(points_.size());
+
+            for (int s = range.start; s < range.end; ++s)
+            {
+                const Range pointRange(s * npoints / nstripes, (s + 1) * npoints / nstripes);
+                impl_.addPairFeatures(points_, order_, thetas_, pointRange, maxDist_, center_, stripeFeatures_[s]);
+            }
+        }
+
+    private:
+        const GeneralizedHoughGuilImpl& impl_;
+        const std::vector<ContourPoint>& points_;
+        const std::vector<int>& order_;
+        const std::vector<double>& thetas_;
+        double maxDist_;
+        Point2d center_;
+        std::vector< std::vector< std::vector<Feature> > >& stripeFeatures_;
+
+        GuilFeatures_Invoker& operator=(const GuilFeatures_Invoker&);
+    };
+
+    class ThetaLess
+    {
+    public:
+        ThetaLess(const std::vector<double>& thetas) : thetas_(&thetas[0]) {}
+        bool operator()(int a, int b) const { return thetas_[a] < thetas_[b]; }
+        const double* thetas_;
+    };
+
     void GeneralizedHoughGuilImpl::buildFeatureList(const Mat& edges, const Mat& dx, const Mat& dy, std::vector< std::vector<Feature> >& features, Point2d center)
     {
         CV_Assert( levels_ > 0 );
 
         const double maxDist = sqrt((double) templSize_.width * templSize_.width + templSize_.height * templSize_.height) * maxScale_;
 
-        const double alphaScale = levels_ / 360.0;
-
         std::vector<ContourPoint> points;
         getContourPoints(edges, dx, dy, points);
 
+        const int npoints = static_cast<int>(points.size());
+
+        // the points sorted by the gradient direction, so that the second points of the pairs
+        // are found by a binary search instead of checking all of them
+        std::vector<int> order(npoints);
+        std::vector<double> thetas(npoints);
+        for (int i = 0; i < npoints; ++i)
+        {
+            order[i] = i;
+            thetas[i] = points[i].theta;
+        }
+        if (npoints > 0)
+            std::sort(order.begin(), order.end(), ThetaLess(thetas));
+        for (int i = 0; i < npoints; ++i)
+            thetas[i] = points[order[i]].theta;
+
+        const int nstripes = std::max(std::min(getNumThreads(), npoints), 1);
+        std::vector< std::vector< std::vector<Feature> > > stripeFeatures(nstripes);
+
+        parallel_for_(Range(0, nstripes), GuilFeatures_Invoker(*this, points, order, thetas, maxDist, center, stripeFeatures), nstripes);
+
+        // the stripes are merged in the order of the points, so every level keeps
+        // the same first maxBufferSize_ features as if the pairs were enumerated serially
         features.resize(levels_ + 1);
-        std::for_each(features.begin(), features.end(), std::mem_fun_ref(&std::vector<Feature>::clear));
-        std::for_each(features.begin(), features.end(), std::bind2nd(std::mem_fun_ref(&std::vector<Feature>::reserve), maxBufferSize_));
+        for (int n = 0; n <= levels_; ++n)
+        {
+            std::vector<Feature>& dst = features[n];
+            dst.clear();
 
-        for (size_t i = 0; i < points.size(); ++i)
+            for (int s = 0; s < nstripes && dst.size() < static_cast<size_t>(maxBufferSize_); ++s)
+            {
+                const std::vector<Feature>& src = stripeFeatures[s][n];
+                const size_t count = std::min(src.size(), static_cast<size_t>(maxBufferSize_) - dst.size());
+                dst.insert(dst.end(), src.begin(), src.begin() + count);
+            }
+        }
+    }
+
+    void GeneralizedHoughGuilImpl::addPairFeatures(const std::vector<ContourPoint>& points, const std::vector<int>& order, const std::vector<double>& thetas,
+                                                   const Range& range, double maxDist, Point2d center, std::vector< std::vector<Feature> >& features) const
+    {
+        const double alphaScale = levels_ / 360.0;
+
+        features.resize(levels_ + 1);
+
+        std::vector<int> candidates;
+
+        for (int i = range.start; i < range.end; ++i)
         {
-            ContourPoint p1 = points[i];
+            const ContourPoint& p1 = points[i];
+
+            // angleEq(p1.theta - p2.theta, xi_, angleEpsilon_) holds only for p2.theta in [p1.theta - xi_ - angleEpsilon_, p1.theta - xi_]
+            Range ranges[2];
+            const int nranges = angleRanges(thetas, p1.theta - xi_ - angleEpsilon_, angleEpsilon_, ranges);
+
+            candidates.clear();
+            for (int r = 0; r < nranges; ++r)
+                for (int k = ranges[r].start; k < ranges[r].end; ++k)
+                    candidates.push_back(order[k]);
+            std::sort(candidates.begin(), candidates.end());
 
-            for (size_t j = 0; j < points.size(); ++j)
+            for (size_t k = 0; k < candidates.size(); ++k)
             {
-                ContourPoint p2 = points[j];
+                const ContourPoint& p2 = points[candidates[k]];
 
                 if (angleEq(p1.theta - p2.theta, xi_, angleEpsilon_))
                 {
@@ -728,6 +913,29 @@ namespace
         }
     }
 
+    class FeatureThetaLess
+    {
+    public:
+        template <typename F> bool operator()(const F& a, const F& b) const { return a.p1.theta < b.p1.theta; }
+    };
+
+    void GeneralizedHoughGuilImpl::sortImageFeatures()
+    {
+        // the votes do not depend on the order of the image features,
+        // so they are sorted to find the matching ones by a binary search
+        imageThetas_.resize(imageFeatures_.size());
+
+        for (size_t i = 0; i < imageFeatures_.size(); ++i)
+        {
+            std::vector<Feature>& row = imageFeatures_[i];
+            std::sort(row.begin(), row.end(), FeatureThetaLess());
+
+            imageThetas_[i].resize(row.size());
+            for (size_t k = 0; k < row.size(); ++k)
+                imageThetas_[i][k] = row[k].p1.theta;
+        }
+    }
+
     void GeneralizedHoughGuilImpl::getContourPoints(const Mat& edges, const Mat& dx, const Mat& dy, std::vector<ContourPoint>& points)
     {
         CV_Assert( edges.type() == CV_8UC1 );
@@ -758,6 +966,50 @@ namespace
         }
     }
 
+    class GuilHist_Invoker : public ParallelLoopBody
+    {
+    public:
+        enum { ORIENTATION, SCALE, POSITION };
+
+        GuilHist_Invoker(const GeneralizedHoughGuilImpl& impl, int stage, double angle, double scale, Mat& hist, Mutex* histLock) :
+            impl_(impl), stage_(stage), angle_(angle), scale_(scale), hist_(hist), histLock_(histLock)
+        {
+        }
+
+        void operator()(const Range& range) const
+        {
+            // every stripe votes into its own accumulator unless it covers all the levels
+            const bool whole = range.start == 0 && range.end == impl_.levels_ + 1;
+            Mat localHist;
+            if (!whole)
+                localHist = Mat::zeros(hist_.size(), CV_32SC1);
+            Mat& hist = whole ? hist_ : localHist;
+
+            if (stage_ == ORIENTATION)
+                impl_.voteOrientation(range, hist);
+            else if (stage_ == SCALE)
+                impl_.voteScale(angle_, range, hist);
+            else
+                impl_.votePosition(angle_, scale_, range, hist);
+
+            if (!whole)
+            {
+                AutoLock lock(*histLock_);
+                hist_ += localHist;
+            }
+        }
+
+    private:
+        const GeneralizedHoughGuilImpl& impl_;
+        int stage_;
+        double angle_;
+        double scale_;
+        Mat& hist_;
+        Mutex* histLock_;
+
+        GuilHist_Invoker& operator=(const GuilHist_Invoker&);
+    };
+
     void GeneralizedHoughGuilImpl::calcOrientation()
     {
         CV_Assert( levels_ > 0 );
@@ -770,40 +1022,59 @@ namespace
         const double iAngleStep = 1.0 / angleStep_;
         const int angleRange = cvCeil((maxAngle_ - minAngle_) * iAngleStep);
 
-        std::vector<int> OHist(angleRange + 1, 0);
-        for (int i = 0; i <= levels_; ++i)
+        Mat OHist(1, angleRange + 1, CV_32SC1, Scalar::all(0));
+
+        Mutex histLock;
+        parallel_for_(Range(0, levels_ + 1), GuilHist_Invoker(*this, GuilHist_Invoker::ORIENTATION, 0, 0, OHist, &histLock),
+                      std::min(getNumThreads() * 4, levels_ + 1));
+
+        const int* ohist = OHist.ptr<int>();
+
+        angles_.clear();
+
+        for (int n = 0; n < angleRange; ++n)
+        {
+            if (ohist[n] >= angleThresh_)
+            {
+                const double angle = minAngle_ + n * angleStep_;
+                angles_.push_back(std::make_pair(angle, ohist[n]));
+            }
+        }
+    }
+
+    void GeneralizedHoughGuilImpl::voteOrientation(const Range& levels, Mat& hist) const
+    {
+        const double iAngleStep = 1.0 / angleStep_;
+        int* OHist = hist.ptr<int>();
+
+        for (int i = levels.start; i < levels.end; ++i)
         {
             const std::vector<Feature>& templRow = templFeatures_[i];
             const std::vector<Feature>& imageRow = imageFeatures_[i];
 
             for (size_t j = 0; j < templRow.size(); ++j)
             {
-                Feature templF = templRow[j];
+                const Feature& templF = templRow[j];
 
-                for (size_t k = 0; k < imageRow.size(); ++k)
-                {
-                    Feature imF = imageRow[k];
+                Range ranges[2];
+                const int nranges = angleRanges(imageThetas_[i], templF.p1.theta + minAngle_, maxAngle_ - minAngle_, ranges);
 
-                    const double angle = clampAngle(imF.p1.theta - templF.p1.theta);
-                    if (angle >= minAngle_ && angle <= maxAngle_)
+                for (int r = 0; r < nranges; ++r)
+                {
+                    for (int k = ranges[r].start; k < ranges[r].end; ++k)
                     {
-                        const int n = cvRound((angle - minAngle_) * iAngleStep);
-                        ++OHist[n];
+                        const Feature& imF = imageRow[k];
+
+                        const double angle = clampAngle(imF.p1.theta - templF.p1.theta);
+                        if (angle >= minAngle_ && angle <= maxAngle_)
+                        {
+                            const int n = cvRound((angle - minAngle_) * iAngleStep);
+                            ++OHist[n];
+                        }
                     }
                 }
             }
         }
-
-        angles_.clear();
-
-        for (int n = 0; n < angleRange; ++n)
-        {
-            if (OHist[n] >= angleThresh_)
-            {
-                const double angle = minAngle_ + n * angleStep_;
-                angles_.push_back(std::make_pair(angle, OHist[n]));
-            }
-        }
     }
 
     void GeneralizedHoughGuilImpl::calcScale(double angle)
@@ -818,9 +1089,32 @@ namespace
         const double iScaleStep = 1.0 / scaleStep_;
         const int scaleRange = cvCeil((maxScale_ - minScale_) * iScaleStep);
 
-        std::vector<int> SHist(scaleRange + 1, 0);
+        Mat SHist(1, scaleRange + 1, CV_32SC1, Scalar::all(0));
+
+        Mutex histLock;
+        parallel_for_(Range(0, levels_ + 1), GuilHist_Invoker(*this, GuilHist_Invoker::SCALE, angle, 0, SHist, &histLock),
+                      std::min(getNumThreads() * 4, levels_ + 1));
+
+        const int* shist = SHist.ptr<int>();
+
+        scales_.clear();
+
+        for (int s = 0; s < scaleRange; ++s)
+        {
+            if (shist[s] >= scaleThresh_)
+            {
+                const double scale = minScale_ + s * scaleStep_;
+                scales_.push_back(std::make_pair(scale, shist[s]));
+            }
+        }
+    }
 
-        for (int i = 0; i <= levels_; ++i)
+    void GeneralizedHoughGuilImpl::voteScale(double angle, const Range& levels, Mat& hist) const
+    {
+        const double iScaleStep = 1.0 / scaleStep_;
+        int* SHist = hist.ptr<int>();
+
+        for (int i = levels.start; i < levels.end; ++i)
         {
             const std::vector<Feature>& templRow = templFeatures_[i];
             const std::vector<Feature>& imageRow = imageFeatures_[i];
@@ -831,33 +1125,28 @@ namespace
 
                 templF.p1.theta += angle;
 
-                for (size_t k = 0; k < imageRow.size(); ++k)
-                {
-                    Feature imF = imageRow[k];
+                Range ranges[2];
+                const int nranges = angleRanges(imageThetas_[i], templF.p1.theta, angleEpsilon_, ranges);
 
-                    if (angleEq(imF.p1.theta, templF.p1.theta, angleEpsilon_))
+                for (int r = 0; r < nranges; ++r)
+                {
+                    for (int k = ranges[r].start; k < ranges[r].end; ++k)
                     {
-                        const double scale = imF.d12 / templF.d12;
-                        if (scale >= minScale_ && scale <= maxScale_)
+                        const Feature& imF = imageRow[k];
+
+                        if (angleEq(imF.p1.theta, templF.p1.theta, angleEpsilon_))
                         {
-                            const int s = cvRound((scale - minScale_) * iScaleStep);
-                            ++SHist[s];
+                            const double scale = imF.d12 / templF.d12;
+                            if (scale >= minScale_ && scale <= maxScale_)
+                            {
+                                const int s = cvRound((scale - minScale_) * iScaleStep);
+                                ++SHist[s];
+                            }
                         }
                     }
                 }
             }
         }
-
-        scales_.clear();
-
-        for (int s = 0; s < scaleRange; ++s)
-        {
-            if (SHist[s] >= scaleThresh_)
-            {
-                const double scale = minScale_ + s * scaleStep_;
-                scales_.push_back(std::make_pair(scale, SHist[s]));
-            }
-        }
     }
 
     void GeneralizedHoughGuilImpl::calcPosition(double angle, int angleVotes, double scale, int scaleVotes)
@@ -868,8 +1157,6 @@ namespace
         CV_Assert( dp_ > 0.0 );
         CV_Assert( posThresh_ > 0 );
 
-        const double sinVal = sin(toRad(angle));
-        const double cosVal = cos(toRad(angle));
         const double idp = 1.0 / dp_;
 
         const int histRows = cvCeil(imageSize_.height * idp);
@@ -877,7 +1164,40 @@ namespace
 
         Mat DHist(histRows + 2, histCols + 2, CV_32SC1, Scalar::all(0));
 
-        for (int i = 0; i <= levels_; ++i)
+        // one stripe per thread, since each of them needs its own accumulator of the image size
+        Mutex histLock;
+        parallel_for_(Range(0, levels_ + 1), GuilHist_Invoker(*this, GuilHist_Invoker::POSITION, angle, scale, DHist, &histLock),
+                      std::min(getNumThreads(), levels_ + 1));
+
+        for(int y = 0; y < histRows; ++y)
+        {
+            const int* prevRow = DHist.ptr<int>(y);
+            const int* curRow = DHist.ptr<int>(y + 1);
+            const int* nextRow = DHist.ptr<int>(y + 2);
+
+            for(int x = 0; x < histCols; ++x)
+            {
+                const int votes = curRow[x + 1];
+
+                if (votes > posThresh_ && votes > curRow[x] && votes >= curRow[x + 2] && votes > prevRow[x + 1] && votes >= nextRow[x + 1])
+                {
+                    posOutBuf_.push_back(Vec4f(static_cast<float>(x * dp_), static_cast<float>(y * dp_), static_cast<float>(scale), static_cast<float>(angle)));
+                    voteOutBuf_.push_back(Vec3i(votes, scaleVotes, angleVotes));
+                }
+            }
+        }
+    }
+
+    void GeneralizedHoughGuilImpl::votePosition(double angle, double scale, const Range& levels, Mat& DHist) const
+    {
+        const double sinVal = sin(toRad(angle));
+        const double cosVal = cos(toRad(angle));
+        const double idp = 1.0 / dp_;
+
+        const int histRows = DHist.rows - 2;
+        const int histCols = DHist.cols - 2;
+
+        for (int i = levels.start; i < levels.end; ++i)
         {
             const std::vector<Feature>& templRow = templFeatures_[i];
             const std::vector<Feature>& imageRow = imageFeatures_[i];
@@ -894,44 +1214,32 @@ namespace
                 templF.r1 = Point2d(cosVal * templF.r1.x - sinVal * templF.r1.y, sinVal * templF.r1.x + cosVal * templF.r1.y);
                 templF.r2 = Point2d(cosVal * templF.r2.x - sinVal * templF.r2.y, sinVal * templF.r2.x + cosVal * templF.r2.y);
 
-                for (size_t k = 0; k < imageRow.size(); ++k)
-                {
-                    Feature imF = imageRow[k];
+                Range ranges[2];
+                const int nranges = angleRanges(imageThetas_[i], templF.p1.theta, angleEpsilon_, ranges);
 
-                    if (angleEq(imF.p1.theta, templF.p1.theta, angleEpsilon_))
+                for (int r = 0; r < nranges; ++r)
+                {
+                    for (int k = ranges[r].start; k < ranges[r].end; ++k)
                     {
-                        Point2d c1, c2;
+                        const Feature& imF = imageRow[k];
 
-                        c1 = imF.p1.pos - templF.r1;
-                        c1 *= idp;
+                        if (angleEq(imF.p1.theta, templF.p1.theta, angleEpsilon_))
+                        {
+                            Point2d c1, c2;
 
-                        c2 = imF.p2.pos - templF.r2;
-                        c2 *= idp;
+                            c1 = imF.p1.pos - templF.r1;
+                            c1 *= idp;
 
-                        if (fabs(c1.x - c2.x) > 1 || fabs(c1.y - c2.y) > 1)
-                            continue;
+                            c2 = imF.p2.pos - templF.r2;
+                            c2 *= idp;
 
-                        if (c1.y >= 0 && c1.y < histRows && c1.x >= 0 && c1.x < histCols)
-                            ++DHist.at<int>(cvRound(c1.y) + 1, cvRound(c1.x) + 1);
-                    }
-                }
-            }
-        }
+                            if (fabs(c1.x - c2.x) > 1 || fabs(c1.y - c2.y) > 1)
+                                continue;
 
-        for(int y = 0; y < histRows; ++y)
-        {
-            const int* prevRow = DHist.ptr<int>(y);
-            const int* curRow = DHist.ptr<int>(y + 1);
-            const int* nextRow = DHist.ptr<int>(y + 2);
-
-            for(int x = 0; x < histCols; ++x)
-            {
-                const int votes = curRow[x + 1];
-
-                if (votes > posThresh_ && votes > curRow[x] && votes >= curRow[x + 2] && votes > prevRow[x + 1] && votes >= nextRow[x + 1])
-                {
-                    posOutBuf_.push_back(Vec4f(static_cast<float>(x * dp_), static_cast<float>(y * dp_), static_cast<float>(scale), static_cast<float>(angle)));
-                    voteOutBuf_.push_back(Vec3i(votes, scaleVotes, angleVotes));
+                            if (c1.y >= 0 && c1.y < histRows && c1.x >= 0 && c1.x < histCols)
+                                ++DHist.at<int>(cvRound(c1.y) + 1, cvRound(c1.x) + 1);
+                        }
+                    }
                 }
             }
         }
@@ -66,6 +66,7 @@ public:
 
     void initLearning();
     void addSample( int ci, const Vec3d color );
+    void addSamples( const GMM& gmm );
     void endLearning();
 
 private:
@@ -171,6 +172,21 @@ void GMM::addSample( int ci, const Vec3d color )
     totalSampleCount++;
 }
 
+void GMM::addSamples( const GMM& gmm )
+{
+    for( int ci = 0; ci < componentsCount; ci++ )
+    {
+        for( int i = 0; i < 3; i++ )
+        {
+            sums[ci][i] += gmm.sums[ci][i];
+            for( int j = 0; j < 3; j++ )
+                prods[ci][i][j] += gmm.prods[ci][i][j];
+        }
+        sampleCounts[ci] += gmm.sampleCounts[ci];
+    }
+    totalSampleCount += gmm.totalSampleCount;
+}
+
 void GMM::endLearning()
 {
     const double variance = 0.01;
@@ -398,20 +414,97 @@ static void initGMMs( const Mat& img, const Mat& mask, GMM& bgdGMM, GMM& fgdGMM
 /*
   Assign GMMs components for each pixel.
 */
-static void assignGMMsComponents( const Mat& img, const Mat& mask, const GMM& bgdGMM, const GMM& fgdGMM, Mat& compIdxs )
+class GMMsComponentsAssigner : public ParallelLoopBody
 {
-    Point p;
-    for( p.y = 0; p.y < img.rows; p.y++ )
+public:
+    GMMsComponentsAssigner( const Mat& _img, const Mat& _mask, const GMM& _bgdGMM, const GMM& _fgdGMM, Mat& _compIdxs )
+        : img(_img), mask(_mask), bgdGMM(_bgdGMM), fgdGMM(_fgdGMM), compIdxs(_compIdxs)
     {
-        for( p.x = 0; p.x < img.cols; p.x++ )
+    }
+
+    void operator()( const Range& range ) const
+    {
+        for( int y = range.start; y < range.end; y++ )
         {
-            Vec3d color = img.at<Vec3b>(p);
-            compIdxs.at<int>(p) = mask.at<uchar>(p) == GC_BGD || mask.at<uchar>(p) == GC_PR_BGD ?
-                bgdGMM.whichComponent(color) : fgdGMM.whichComponent(color);
+            const Vec3b* imgRow = img.ptr<Vec3b>(y);
+            const uchar* maskRow = mask.ptr<uchar>(y);
+            int* compIdxsRow = compIdxs.ptr<int>(y);
+            for( int x = 0; x < img.cols; x++ )
+            {
+                Vec3d color = imgRow[x];
+                compIdxsRow[x] = maskRow[x] == GC_BGD || maskRow[x] == GC_PR_BGD ?
+                    bgdGMM.whichComponent(color) : fgdGMM.whichComponent(color);
+            }
         }
     }
+
+private:
+    GMMsComponentsAssigner& operator=(const GMMsComponentsAssigner&);
+
+    const Mat& img;
+    const Mat& mask;
+    const GMM& bgdGMM;
+    const GMM& fgdGMM;
+    Mat& compIdxs;
+};
+
+static void assignGMMsComponents( const Mat& img, const Mat& mask, const GMM& bgdGMM, const GMM& fgdGMM, Mat& compIdxs )
+{
+    parallel_for_( Range(0, img.rows), GMMsComponentsAssigner(img, mask, bgdGMM, fgdGMM, compIdxs),
+                   img.total()/(double)(1<<16) );
 }
 
+/*
+  Collect the GMMs samples of a stripe of rows and add them to the models.
+  The colors are integer, so the accumulated sums do not depend on the order
+  in which the stripes are merged.
+*/
+class GMMsLearner : public ParallelLoopBody
+{
+public:
+    GMMsLearner( const Mat& _img, const Mat& _mask, const Mat& _compIdxs, GMM& _bgdGMM, GMM& _fgdGMM, Mutex* _gmmsLock )
+        : img(_img), mask(_mask), compIdxs(_compIdxs), bgdGMM(_bgdGMM), fgdGMM(_fgdGMM),
+          emptyBgdGMM(_bgdGMM), emptyFgdGMM(_fgdGMM), gmmsLock(_gmmsLock)
+    {
+        emptyBgdGMM.initLearning();
+        emptyFgdGMM.initLearning();
+    }
+
+    void operator()( const Range& range ) const
+    {
+        GMM localBgdGMM = emptyBgdGMM, localFgdGMM = emptyFgdGMM;
+        for( int y = range.start; y < range.end; y++ )
+        {
+            const Vec3b* imgRow = img.ptr<Vec3b>(y);
+            const uchar* maskRow = mask.ptr<uchar>(y);
+            const int* compIdxsRow = compIdxs.ptr<int>(y);
+            for( int x = 0; x < img.cols; x++ )
+            {
+                if( maskRow[x] == GC_BGD || maskRow[x] == GC_PR_BGD )
+                    localBgdGMM.addSample( compIdxsRow[x], imgRow[x] );
+                else
+                    localFgdGMM.addSample( compIdxsRow[x], imgRow[x] );
+            }
+        }
+
+        AutoLock lock(*gmmsLock);
+        bgdGMM.addSamples( localBgdGMM );
+        fgdGMM.addSamples( localFgdGMM );
+    }
+
+private:
+    GMMsLearner& operator=(const GMMsLearner&);
+
+    const Mat& img;
+    const Mat& mask;
+    const Mat& compIdxs;
+    GMM& bgdGMM;
+    GMM& fgdGMM;
+    GMM emptyBgdGMM;
+    GMM emptyFgdGMM;
+    Mutex* gmmsLock;
+};
+
 /*
   Learn GMMs parameters.
 */
@@ -419,31 +512,83 @@ static void learnGMMs( const Mat& img, const Mat& mask, const Mat& compIdxs, GMM
 {
     bgdGMM.initLearning();
     fgdGMM.initLearning();
-    Point p;
-    for( int ci = 0; ci < GMM::componentsCount; ci++ )
+    Mutex gmmsLock;
+    parallel_for_( Range(0, img.rows), GMMsLearner(img, mask, compIdxs, bgdGMM, fgdGMM, &gmmsLock),
+                   img.total()/(double)(1<<16) );
+    bgdGMM.endLearning();
+    fgdGMM.endLearning();
+}
+
+/*
+  Calculate weights of terminal edges of graph.
+  The GMM likelihoods are clamped to keep the weights finite,
+  so that they can be updated incrementally between iterations.
+*/
+class TermWeightsCalculator : public ParallelLoopBody
+{
+public:
+    TermWeightsCalculator( const Mat& _img, const Mat& _mask, const GMM& _bgdGMM, const GMM& _fgdGMM, double _lambda,
+                           Mat& _sourceW, Mat& _sinkW )
+        : img(_img), mask(_mask), bgdGMM(_bgdGMM), fgdGMM(_fgdGMM), lambda(_lambda), sourceW(_sourceW), sinkW(_sinkW)
     {
-        for( p.y = 0; p.y < img.rows; p.y++ )
+    }
+
+    void operator()( const Range& range ) const
+    {
+        const double minProb = std::numeric_limits<double>::min();
+        for( int y = range.start; y < range.end; y++ )
         {
-            for( p.x = 0; p.x < img.cols; p.x++ )
+            const Vec3b* imgRow = img.ptr<Vec3b>(y);
+            const uchar* maskRow = mask.ptr<uchar>(y);
+            double* sourceWRow = sourceW.ptr<double>(y);
+            double* sinkWRow = sinkW.ptr<double>(y);
+            for( int x = 0; x < img.cols; x++ )
             {
-                if( compIdxs.at<int>(p) == ci )
+                if( maskRow[x] == GC_PR_BGD || maskRow[x] == GC_PR_FGD )
+                {
+                    Vec3d color = imgRow[x];
+                    sourceWRow[x] = -log( std::max(bgdGMM(color), minProb) );
+                    sinkWRow[x] = -log( std::max(fgdGMM(color), minProb) );
+                }
+                else if( maskRow[x] == GC_BGD )
                 {
-                    if( mask.at<uchar>(p) == GC_BGD || mask.at<uchar>(p) == GC_PR_BGD )
-                        bgdGMM.addSample( ci, img.at<Vec3b>(p) );
-                    else
-                        fgdGMM.addSample( ci, img.at<Vec3b>(p) );
+                    sourceWRow[x] = 0;
+                    sinkWRow[x] = lambda;
+                }
+                else // GC_FGD
+                {
+                    sourceWRow[x] = lambda;
+                    sinkWRow[x] = 0;
                 }
             }
         }
     }
-    bgdGMM.endLearning();
-    fgdGMM.endLearning();
+
+private:
+    TermWeightsCalculator& operator=(const TermWeightsCalculator&);
+
+    const Mat& img;
+    const Mat& mask;
+    const GMM& bgdGMM;
+    const GMM& fgdGMM;
+    double lambda;
+    Mat& sourceW;
+    Mat& sinkW;
+};
+
+static void calcTermWeights( const Mat& img, const Mat& mask, const GMM& bgdGMM, const GMM& fgdGMM, double lambda,
+                             Mat& sourceW, Mat& sinkW )
+{
+    sourceW.create( img.rows, img.cols, CV_64FC1 );
+    sinkW.create( img.rows, img.cols, CV_64FC1 );
+    parallel_for_( Range(0, img.rows), TermWeightsCalculator(img, mask, bgdGMM, fgdGMM, lambda, sourceW, sinkW),
+                   img.total()/(double)(1<<16) );
 }
 
 /*
   Construct GCGraph
 */
-static void constructGCGraph( const Mat& img, const Mat& mask, const GMM& bgdGMM, const GMM& fgdGMM, double lambda,
+static void constructGCGraph( const Mat& img, const Mat& sourceW, const Mat& sinkW,
                        const Mat& leftW, const Mat& upleftW, const Mat& upW, const Mat& uprightW,
                        GCGraph<double>& graph )
 {
@@ -457,26 +602,9 @@ static void constructGCGraph( const Mat& img, const Mat& mask, const GMM& bgdGMM
         {
             // add node
             int vtxIdx = graph.addVtx();
-            Vec3b color = img.at<Vec3b>(p);
 
             // set t-weights
-            double fromSource, toSink;
-            if( mask.at<uchar>(p) == GC_PR_BGD || mask.at<uchar>(p) == GC_PR_FGD )
-            {
-                fromSource = -log( bgdGMM(color) );
-                toSink = -log( fgdGMM(color) );
-            }
-            else if( mask.at<uchar>(p) == GC_BGD )
-            {
-                fromSource = 0;
-                toSink = lambda;
-            }
-            else // GC_FGD
-            {
-                fromSource = lambda;
-                toSink = 0;
-            }
-            graph.addTermWeights( vtxIdx, fromSource, toSink );
+            graph.addTermWeights( vtxIdx, sourceW.at<double>(p), sinkW.at<double>(p) );
 
             // set n-weights
             if( p.x>0 )
@@ -503,6 +631,35 @@ static void constructGCGraph( const Mat& img, const Mat& mask, const GMM& bgdGMM
     }
 }
 
+/*
+  Update t-weights of GCGraph constructed at the previous iteration.
+  Only the t-weights depend on GMMs, so the n-edges and the flow found so far are kept
+  and the following maxFlow() only has to augment the residual graph.
+  The same value is added to both t-weights of a vertex, when any of them decreases,
+  to keep the residual capacities non-negative; it does not change the minimum cut.
+*/
+static void updateGCGraph( const Mat& prevSourceW, const Mat& prevSinkW, const Mat& sourceW, const Mat& sinkW,
+                           GCGraph<double>& graph )
+{
+    int vtxIdx = 0;
+    for( int y = 0; y < sourceW.rows; y++ )
+    {
+        const double* prevSourceWRow = prevSourceW.ptr<double>(y);
+        const double* prevSinkWRow = prevSinkW.ptr<double>(y);
+        const double* sourceWRow = sourceW.ptr<double>(y);
+        const double* sinkWRow = sinkW.ptr<double>(y);
+        for( int x = 0; x < sourceW.cols; x++, vtxIdx++ )
+        {
+            double dSource = sourceWRow[x] - prevSourceWRow[x];
+            double dSink = sinkWRow[x] - prevSinkWRow[x];
+            if( dSource == 0 && dSink == 0 )
+                continue;
+            double shift = std::max( 0., -std::min(dSource, dSink) );
+            graph.addTermWeights( vtxIdx, dSource + shift, dSink + shift );
+        }
+    }
+}
+
 /*
   Estimate segmentation using MaxFlow algorithm
 */
@@ -564,12 +721,19 @@ void cv::grabCut( InputArray _img, InputOutputArray _mask, Rect rect,
     Mat leftW, upleftW, upW, uprightW;
     calcNWeights( img, leftW, upleftW, upW, uprightW, beta, gamma );
 
+    GCGraph<double> graph;
+    Mat sourceW, sinkW, prevSourceW, prevSinkW;
     for( int i = 0; i < iterCount; i++ )
     {
-        GCGraph<double> graph;
         assignGMMsComponents( img, mask, bgdGMM, fgdGMM, compIdxs );
         learnGMMs( img, mask, compIdxs, bgdGMM, fgdGMM );
-        constructGCGraph(img, mask, bgdGMM, fgdGMM, lambda, leftW, upleftW, upW, uprightW, graph );
+        calcTermWeights( img, mask, bgdGMM, fgdGMM, lambda, sourceW, sinkW );
+        if( i == 0 )
+            constructGCGraph( img, sourceW, sinkW, leftW, upleftW, upW, uprightW, graph );
+        else
+            updateGCGraph( prevSourceW, prevSinkW, sourceW, sinkW, graph );
         estimateSegmentation( graph, mask );
+        std::swap( sourceW, prevSourceW );
+        std::swap( sinkW, prevSinkW );
     }
 }
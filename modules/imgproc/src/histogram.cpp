@@ -3150,8 +3150,9 @@ void cv::equalizeHist( InputArray _src, OutputArray _dst )
     EqualizeHistLut_Invoker      lutBody(src, dst, lut);
     cv::Range heightRange(0, src.rows);
 
+    // one stripe per thread, so that every thread merges its local histogram only once
     if(EqualizeHistCalcHist_Invoker::isWorthParallel(src))
-        parallel_for_(heightRange, calcBody);
+        parallel_for_(heightRange, calcBody, std::max(getNumThreads(), 1));
     else
         calcBody(heightRange);
 
@@ -3175,7 +3176,7 @@ void cv::equalizeHist( InputArray _src, OutputArray _dst )
     }
 
     if(EqualizeHistLut_Invoker::isWorthParallel(src))
-        parallel_for_(heightRange, lutBody);
+        parallel_for_(heightRange, lutBody, src.total()/(double)(1 << 16));
     else
         lutBody(heightRange);
 }
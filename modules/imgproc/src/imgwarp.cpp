@@ -2267,6 +2267,256 @@ void cv::resize( InputArray _src, OutputArray _dst, Size dsize,
 }
 
 
+/****************************************************************************************\
+*                   Fused blob preparation (resize + channel swap + scaling)             *
+\****************************************************************************************/
+
+namespace cv
+{
+
+struct BlobSourceTab
+{
+    Mat src;
+    std::vector<int> xofs;      // pairs of source element offsets, one pair per output element
+    std::vector<float> alpha;   // pairs of horizontal weights
+    std::vector<int> yofs;      // pairs of source rows, one pair per output row
+    std::vector<float> beta;    // pairs of vertical weights
+};
+
+static void computeBlobResizeTab( int ssize, int dsize, bool nearest,
+                                  int* ofs, float* coeffs )
+{
+    // computed the same way as in resize() to get identical source positions
+    double scale = 1./((double)dsize/ssize);
+    for( int d = 0; d < dsize; d++ )
+    {
+        int s0, s1;
+        float f;
+        if( nearest )
+        {
+            s0 = std::min(cvFloor(d*scale), ssize - 1);
+            s1 = s0;
+            f = 0.f;
+        }
+        else
+        {
+            float fs = (float)((d + 0.5)*scale - 0.5);
+            s0 = cvFloor(fs);
+            f = fs - s0;
+            if( s0 < 0 )
+                s0 = 0, f = 0.f;
+            if( s0 >= ssize - 1 )
+                s0 = ssize - 1, f = 0.f;
+            s1 = std::min(s0 + 1, ssize - 1);
+        }
+        ofs[d*2] = s0;
+        ofs[d*2+1] = s1;
+        coeffs[d*2] = 1.f - f;
+        coeffs[d*2+1] = f;
+    }
+}
+
+template<typename T> static void
+blobHResize_( const uchar* _src, float* dst, const int* xofs, const float* alpha, int len )
+{
+    const T* src = (const T*)_src;
+    for( int i = 0; i < len; i++ )
+        dst[i] = src[xofs[i*2]]*alpha[i*2] + src[xofs[i*2+1]]*alpha[i*2+1];
+}
+
+typedef void (*BlobHResizeFunc)( const uchar* src, float* dst, const int* xofs,
+                                 const float* alpha, int len );
+
+static void blobVResize( const float* S0, const float* S1, float* D, const float* shift,
+                         float b0, float b1, int len )
+{
+    int x = 0;
+#if CV_SSE
+    if( checkHardwareSupport(CV_CPU_SSE) )
+    {
+        __m128 v_b0 = _mm_set1_ps(b0), v_b1 = _mm_set1_ps(b1);
+        for( ; x <= len - 8; x += 8 )
+        {
+            __m128 t0 = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(S0 + x), v_b0),
+                                   _mm_mul_ps(_mm_loadu_ps(S1 + x), v_b1));
+            __m128 t1 = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(S0 + x + 4), v_b0),
+                                   _mm_mul_ps(_mm_loadu_ps(S1 + x + 4), v_b1));
+            _mm_storeu_ps(D + x, _mm_add_ps(t0, _mm_loadu_ps(shift + x)));
+            _mm_storeu_ps(D + x + 4, _mm_add_ps(t1, _mm_loadu_ps(shift + x + 4)));
+        }
+    }
+#endif
+    for( ; x < len; x++ )
+        D[x] = S0[x]*b0 + S1[x]*b1 + shift[x];
+}
+
+class BlobFromImages_Invoker :
+    public ParallelLoopBody
+{
+public:
+    BlobFromImages_Invoker( const std::vector<BlobSourceTab>& _tabs, Mat& _blob, Size _dsize,
+                            int _cn, bool _planar, float _scale, const float* _shift ) :
+        ParallelLoopBody(), tabs(&_tabs), blob(&_blob), dsize(_dsize), cn(_cn),
+        planar(_planar), scale(_scale), shift(_shift)
+    {
+    }
+
+    virtual void operator() (const Range& range) const
+    {
+        static BlobHResizeFunc hresizeTab[] =
+        {
+            blobHResize_<uchar>, 0, blobHResize_<ushort>, 0, 0, blobHResize_<float>, 0, 0
+        };
+
+        int width = dsize.width, len = width*cn;
+        size_t planeSize = (size_t)width*dsize.height;
+        AutoBuffer<float> _buf(len*2);
+        float* rows[2] = { _buf, (float*)_buf + len };
+        int prevY[2] = { -1, -1 }, prevImg = -1;
+
+        for( int r = range.start; r < range.end; r++ )
+        {
+            int n = r / dsize.height, dy = r - n*dsize.height;
+            const BlobSourceTab& tab = (*tabs)[n];
+            BlobHResizeFunc hresize = hresizeTab[tab.src.depth()];
+            int sy0 = tab.yofs[dy*2], sy1 = tab.yofs[dy*2+1];
+            float b0 = tab.beta[dy*2]*scale, b1 = tab.beta[dy*2+1]*scale;
+
+            if( n != prevImg )
+            {
+                prevY[0] = prevY[1] = -1;
+                prevImg = n;
+            }
+            // reuse the horizontally interpolated rows from the previous output row if possible
+            if( sy0 != prevY[0] && sy0 == prevY[1] )
+            {
+                std::swap(rows[0], rows[1]);
+                std::swap(prevY[0], prevY[1]);
+            }
+            if( sy0 != prevY[0] )
+            {
+                hresize( tab.src.ptr(sy0), rows[0], &tab.xofs[0], &tab.alpha[0], len );
+                prevY[0] = sy0;
+            }
+            if( sy1 != sy0 && sy1 != prevY[1] )
+            {
+                hresize( tab.src.ptr(sy1), rows[1], &tab.xofs[0], &tab.alpha[0], len );
+                prevY[1] = sy1;
+            }
+            const float* S1 = sy1 != sy0 ? rows[1] : rows[0];
+
+            float* D = (float*)blob->data;
+            if( planar )
+            {
+                for( int c = 0; c < cn; c++ )
+                    blobVResize( rows[0] + c*width, S1 + c*width,
+                                 D + (n*cn + c)*planeSize + (size_t)dy*width,
+                                 shift + c*width, b0, b1, width );
+            }
+            else
+                blobVResize( rows[0], S1, D + (n*planeSize + (size_t)dy*width)*cn,
+                             shift, b0, b1, len );
+        }
+    }
+
+private:
+    const std::vector<BlobSourceTab>* tabs;
+    Mat* blob;
+    Size dsize;
+    int cn;
+    bool planar;
+    float scale;
+    const float* shift;
+
+    BlobFromImages_Invoker& operator=(const BlobFromImages_Invoker&);
+};
+
+static void blobFromImages_( const std::vector<Mat>& images, OutputArray _blob, Size size,
+                             const Scalar& mean, double scale, bool swapRB, bool planar,
+                             int interpolation )
+{
+    CV_Assert( !images.empty() );
+    CV_Assert( interpolation == INTER_LINEAR || interpolation == INTER_NEAREST );
+
+    int i, nimages = (int)images.size(), cn = images[0].channels();
+    if( size.area() == 0 )
+        size = images[0].size();
+    CV_Assert( size.area() > 0 && cn <= 4 );
+    CV_Assert( !swapRB || cn >= 3 );
+
+    int width = size.width, len = width*cn;
+    bool nearest = interpolation == INTER_NEAREST;
+    std::vector<BlobSourceTab> tabs(nimages);
+    AutoBuffer<int> _sofs(len*2);
+    AutoBuffer<float> _coeffs(len*2);
+
+    for( i = 0; i < nimages; i++ )
+    {
+        const Mat& src = images[i];
+        int depth = src.depth();
+        CV_Assert( src.dims <= 2 && src.channels() == cn && !src.empty() );
+        CV_Assert( depth == CV_8U || depth == CV_16U || depth == CV_32F );
+
+        BlobSourceTab& tab = tabs[i];
+        tab.src = src;
+        tab.yofs.resize(size.height*2);
+        tab.beta.resize(size.height*2);
+        computeBlobResizeTab( src.rows, size.height, nearest, &tab.yofs[0], &tab.beta[0] );
+
+        int* sofs = _sofs;
+        float* coeffs = _coeffs;
+        computeBlobResizeTab( src.cols, width, nearest, sofs, coeffs );
+        tab.xofs.resize(len*2);
+        tab.alpha.resize(len*2);
+        for( int dx = 0; dx < width; dx++ )
+            for( int c = 0; c < cn; c++ )
+            {
+                // the channel swap is folded into the source offsets
+                int sc = swapRB && c < 3 ? 2 - c : c;
+                int k = planar ? c*width + dx : dx*cn + c;
+                tab.xofs[k*2] = sofs[dx*2]*cn + sc;
+                tab.xofs[k*2+1] = sofs[dx*2+1]*cn + sc;
+                tab.alpha[k*2] = coeffs[dx*2];
+                tab.alpha[k*2+1] = coeffs[dx*2+1];
+            }
+    }
+
+    AutoBuffer<float> _shift(len);
+    float* shift = _shift;
+    for( int dx = 0; dx < width; dx++ )
+        for( int c = 0; c < cn; c++ )
+            shift[planar ? c*width + dx : dx*cn + c] = (float)(-mean[c]*scale);
+
+    int sz[] = { nimages, planar ? cn : size.height, planar ? size.height : size.width,
+                 planar ? size.width : cn };
+    _blob.create(4, sz, CV_32F);
+    Mat blob = _blob.getMat();
+    CV_Assert( blob.isContinuous() );
+
+    BlobFromImages_Invoker invoker(tabs, blob, size, cn, planar, (float)scale, shift);
+    parallel_for_(Range(0, nimages*size.height), invoker, blob.total()/(double)(1<<16));
+}
+
+}
+
+void cv::blobFromImage( InputArray image, OutputArray blob, Size size,
+                        const Scalar& mean, double scale, bool swapRB,
+                        bool planar, int interpolation )
+{
+    std::vector<Mat> images(1, image.getMat());
+    blobFromImages_( images, blob, size, mean, scale, swapRB, planar, interpolation );
+}
+
+void cv::blobFromImages( InputArrayOfArrays _images, OutputArray blob, Size size,
+                         const Scalar& mean, double scale, bool swapRB,
+                         bool planar, int interpolation )
+{
+    std::vector<Mat> images;
+    _images.getMatVector(images);
+    blobFromImages_( images, blob, size, mean, scale, swapRB, planar, interpolation );
+}
+
+
 /****************************************************************************************\
 *                       General warping (affine, perspective, remap)                     *
 \****************************************************************************************/
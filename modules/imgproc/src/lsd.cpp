@@ -50,6 +50,7 @@
 // LOG_EPS     0.0    - Detection threshold: -log10(NFA) > log_eps
 // DENSITY_TH  0.7    - Minimal density of region points in rectangle.
 // N_BINS      1024   - Number of bins in pseudo-ordering of gradient modulus.
+// TILE_SIZE   0      - Size of the tiles processed in parallel, 0 - the whole image at once.
 
 #define M_3_2_PI    (3 * CV_PI) / 2   // 3/2 pi
 #define M_2__PI     (2 * CV_PI)         // 2 pi
@@ -65,6 +66,8 @@
 
 #define RELATIVE_ERROR_FACTOR 100.0
 
+#define TILE_OVERLAP 16 // Number of pixels by which the tiles are extended to find the segments crossing their borders.
+
 const double DEG_TO_RADS = CV_PI / 180;
 
 #define log_gamma(x) ((x)>15.0?log_gamma_windschitl(x):log_gamma_lanczos(x))
@@ -179,10 +182,12 @@ public:
  * @param _log_eps      Detection threshold: -log10(NFA) > _log_eps
  * @param _density_th   Minimal density of aligned region points in rectangle.
  * @param _n_bins       Number of bins in pseudo-ordering of gradient modulus.
+ * @param _tile_size    Size of the square tiles, in which the lines are searched in parallel.
+ *                      The segments crossing the tile borders are merged. 0 - the whole image is processed at once.
  */
     LineSegmentDetectorImpl(int _refine = LSD_REFINE_STD, double _scale = 0.8,
         double _sigma_scale = 0.6, double _quant = 2.0, double _ang_th = 22.5,
-        double _log_eps = 0, double _density_th = 0.7, int _n_bins = 1024);
+        double _log_eps = 0, double _density_th = 0.7, int _n_bins = 1024, int _tile_size = 0);
 
 /**
  * Detect lines in the input image.
@@ -254,6 +259,7 @@ private:
     const double LOG_EPS;
     const double DENSITY_TH;
     const int N_BINS;
+    const int TILE_SIZE;
 
     struct RegionPoint {
         int x;
@@ -263,13 +269,6 @@ private:
         double modgrad;
     };
 
-
-    struct coorlist
-    {
-        Point2i p;
-        struct coorlist* next;
-    };
-
     struct rect
     {
         double x1, y1, x2, y2;    // first and second point of the line segment
@@ -283,6 +282,8 @@ private:
 
     LineSegmentDetectorImpl& operator= (const LineSegmentDetectorImpl&); // to quiet MSVC
 
+    friend class LSDTileInvoker;
+
 /**
  * Detect lines in the whole input image.
  *
@@ -303,13 +304,34 @@ private:
 
 /**
  * Finds the angles and the gradients of the image. Generates a list of pseudo ordered points.
+ * Both are computed in parallel by row stripes.
  *
  * @param threshold The minimum value of the angle that is considered defined, otherwise NOTDEF
  * @param n_bins    The number of bins with which gradients are ordered by, using bucket sort.
- * @param list      Return: Vector of coordinate points that are pseudo ordered by magnitude.
+ * @param list      Return: Vector of coordinate points with defined angle that are pseudo ordered by magnitude.
  *                  Pixels would be ordered by norm value, up to a precision given by max_grad/n_bins.
  */
-    void ll_angle(const double& threshold, const unsigned int& n_bins, std::vector<coorlist>& list);
+    void ll_angle(const double& threshold, const unsigned int& n_bins, std::vector<Point>& list);
+
+/**
+ * Grows the regions from the pseudo ordered points and finds the line segments approximating them.
+ *
+ * @param list      Vector of pseudo ordered points, the seeds of the regions.
+ * @param recs      Return: The rectangles of the found segments, in the coordinates of the scaled image.
+ * @param log_nfas  Return: The NFA values of the found segments. Calculated only for REFINE_ADV.
+ */
+    void find_segments(const std::vector<Point>& list, std::vector<rect>& recs, std::vector<double>& log_nfas);
+
+/**
+ * Merges the nearly collinear segments found in the different tiles, which overlap near the tile borders.
+ *
+ * @param recs      The rectangles of the segments, replaced by the merged ones.
+ * @param log_nfas  The NFA values of the segments.
+ * @param tiles     The indices of the tiles, where the segments were found.
+ * @param tile_size The size of the tiles in the scaled image.
+ */
+    void merge_segments(std::vector<rect>& recs, std::vector<double>& log_nfas,
+                        std::vector<int>& tiles, int tile_size) const;
 
 /**
  * Grow a region starting from point s with a defined precision,
@@ -388,25 +410,89 @@ private:
 
 /////////////////////////////////////////////////////////////////////////////////////////
 
+// Searches for the line segments of each tile in a separate detector, which sees
+// the gradients of the tile extended by TILE_OVERLAP pixels and grows the regions
+// only from the seeds inside the tile.
+class LSDTileInvoker : public ParallelLoopBody
+{
+public:
+    typedef LineSegmentDetectorImpl::rect rect;
+
+    LSDTileInvoker(const LineSegmentDetectorImpl& _lsd, int _tile_size,
+                   const std::vector<std::vector<Point> >& _lists,
+                   std::vector<std::vector<rect> >& _recs,
+                   std::vector<std::vector<double> >& _log_nfas)
+        : lsd(_lsd), tile_size(_tile_size), lists(_lists), recs(_recs), log_nfas(_log_nfas)
+    {
+    }
+
+    void operator()(const Range& range) const
+    {
+        const int tiles_x = (lsd.img_width + tile_size - 1) / tile_size;
+        for(int t = range.start; t < range.end; ++t)
+        {
+            Rect ext((t % tiles_x) * tile_size - TILE_OVERLAP, (t / tiles_x) * tile_size - TILE_OVERLAP,
+                     tile_size + 2 * TILE_OVERLAP, tile_size + 2 * TILE_OVERLAP);
+            ext &= Rect(0, 0, lsd.img_width, lsd.img_height);
+
+            LineSegmentDetectorImpl tile_lsd(lsd.doRefine, lsd.SCALE, lsd.SIGMA_SCALE, lsd.QUANT,
+                                             lsd.ANG_TH, lsd.LOG_EPS, lsd.DENSITY_TH, lsd.N_BINS);
+            tile_lsd.angles = lsd.angles(ext).clone();
+            tile_lsd.modgrad = lsd.modgrad(ext).clone();
+            tile_lsd.angles_data = tile_lsd.angles.ptr<double>(0);
+            tile_lsd.modgrad_data = tile_lsd.modgrad.ptr<double>(0);
+            tile_lsd.img_width = ext.width;
+            tile_lsd.img_height = ext.height;
+            tile_lsd.LOG_NT = lsd.LOG_NT; // NFA is computed for the whole image
+
+            std::vector<Point> list(lists[t].size());
+            for(size_t i = 0; i < list.size(); ++i)
+                list[i] = lists[t][i] - ext.tl();
+
+            tile_lsd.find_segments(list, recs[t], log_nfas[t]);
+
+            for(size_t i = 0; i < recs[t].size(); ++i)
+            {
+                rect& rec = recs[t][i];
+                rec.x1 += ext.x; rec.y1 += ext.y;
+                rec.x2 += ext.x; rec.y2 += ext.y;
+                rec.x += ext.x; rec.y += ext.y;
+            }
+        }
+    }
+
+private:
+    LSDTileInvoker& operator= (const LSDTileInvoker&); // to quiet MSVC
+
+    const LineSegmentDetectorImpl& lsd;
+    int tile_size;
+    const std::vector<std::vector<Point> >& lists;
+    std::vector<std::vector<rect> >& recs;
+    std::vector<std::vector<double> >& log_nfas;
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////
+
 CV_EXPORTS Ptr<LineSegmentDetector> createLineSegmentDetector(
         int _refine, double _scale, double _sigma_scale, double _quant, double _ang_th,
-        double _log_eps, double _density_th, int _n_bins)
+        double _log_eps, double _density_th, int _n_bins, int _tile_size)
 {
     return makePtr<LineSegmentDetectorImpl>(
             _refine, _scale, _sigma_scale, _quant, _ang_th,
-            _log_eps, _density_th, _n_bins);
+            _log_eps, _density_th, _n_bins, _tile_size);
 }
 
 /////////////////////////////////////////////////////////////////////////////////////////
 
 LineSegmentDetectorImpl::LineSegmentDetectorImpl(int _refine, double _scale, double _sigma_scale, double _quant,
-        double _ang_th, double _log_eps, double _density_th, int _n_bins)
+        double _ang_th, double _log_eps, double _density_th, int _n_bins, int _tile_size)
         :SCALE(_scale), doRefine(_refine), SIGMA_SCALE(_sigma_scale), QUANT(_quant),
-        ANG_TH(_ang_th), LOG_EPS(_log_eps), DENSITY_TH(_density_th), N_BINS(_n_bins)
+        ANG_TH(_ang_th), LOG_EPS(_log_eps), DENSITY_TH(_density_th), N_BINS(_n_bins),
+        TILE_SIZE(_tile_size)
 {
     CV_Assert(_scale > 0 && _sigma_scale > 0 && _quant >= 0 &&
               _ang_th > 0 && _ang_th < 180 && _density_th >= 0 && _density_th < 1 &&
-              _n_bins > 0);
+              _n_bins > 0 && _tile_size >= 0);
 }
 
 void LineSegmentDetectorImpl::detect(InputArray _image, OutputArray _lines,
@@ -441,10 +527,9 @@ void LineSegmentDetectorImpl::flsd(std::vector<Vec4i>& lines,
 {
     // Angle tolerance
     const double prec = CV_PI * ANG_TH / 180;
-    const double p = ANG_TH / 180;
     const double rho = QUANT / sin(prec);    // gradient magnitude threshold
 
-    std::vector<coorlist> list;
+    std::vector<Point> list;
     if(SCALE != 1)
     {
         Mat gaussian_img;
@@ -464,24 +549,88 @@ void LineSegmentDetectorImpl::flsd(std::vector<Vec4i>& lines,
     }
 
     LOG_NT = 5 * (log10(double(img_width)) + log10(double(img_height))) / 2 + log10(11.0);
+
+    // Search for line segments
+    std::vector<rect> recs;
+    std::vector<double> log_nfas;
+    const int tile_size = std::max(cvRound(TILE_SIZE * SCALE), 2 * TILE_OVERLAP);
+    if(TILE_SIZE > 0 && (img_width > tile_size || img_height > tile_size))
+    {
+        // Distribute the seeds between the tiles keeping their order
+        const int tiles_x = (img_width + tile_size - 1) / tile_size;
+        const int tiles_y = (img_height + tile_size - 1) / tile_size;
+        std::vector<std::vector<Point> > tile_lists(tiles_x * tiles_y);
+        for(size_t i = 0, list_size = list.size(); i < list_size; ++i)
+        {
+            const Point& pt = list[i];
+            tile_lists[(pt.y / tile_size) * tiles_x + pt.x / tile_size].push_back(pt);
+        }
+
+        std::vector<std::vector<rect> > tile_recs(tile_lists.size());
+        std::vector<std::vector<double> > tile_log_nfas(tile_lists.size());
+        parallel_for_(Range(0, (int)tile_lists.size()),
+                      LSDTileInvoker(*this, tile_size, tile_lists, tile_recs, tile_log_nfas));
+
+        std::vector<int> tiles;
+        for(size_t t = 0; t < tile_recs.size(); ++t)
+        {
+            recs.insert(recs.end(), tile_recs[t].begin(), tile_recs[t].end());
+            log_nfas.insert(log_nfas.end(), tile_log_nfas[t].begin(), tile_log_nfas[t].end());
+            tiles.insert(tiles.end(), tile_recs[t].size(), (int)t);
+        }
+        merge_segments(recs, log_nfas, tiles, tile_size);
+    }
+    else
+    {
+        find_segments(list, recs, log_nfas);
+    }
+
+    for(size_t i = 0; i < recs.size(); ++i)
+    {
+        rect& rec = recs[i];
+
+        // Add the offset
+        rec.x1 += 0.5; rec.y1 += 0.5;
+        rec.x2 += 0.5; rec.y2 += 0.5;
+
+        // scale the result values if a sub-sampling was performed
+        if(SCALE != 1)
+        {
+            rec.x1 /= SCALE; rec.y1 /= SCALE;
+            rec.x2 /= SCALE; rec.y2 /= SCALE;
+            rec.width /= SCALE;
+        }
+
+        //Store the relevant data
+        lines.push_back(Vec4i(int(rec.x1), int(rec.y1), int(rec.x2), int(rec.y2)));
+        if(w_needed) widths.push_back(rec.width);
+        if(p_needed) precisions.push_back(rec.p);
+        if(n_needed && doRefine >= LSD_REFINE_ADV) nfas.push_back(log_nfas[i]);
+    }
+}
+
+void LineSegmentDetectorImpl::find_segments(const std::vector<Point>& list,
+    std::vector<rect>& recs, std::vector<double>& log_nfas)
+{
+    // Angle tolerance
+    const double prec = CV_PI * ANG_TH / 180;
+    const double p = ANG_TH / 180;
     const int min_reg_size = int(-LOG_NT/log10(p)); // minimal number of points in region that can give a meaningful event
 
     // // Initialize region only when needed
     // Mat region = Mat::zeros(scaled_image.size(), CV_8UC1);
-    used = Mat_<uchar>::zeros(scaled_image.size()); // zeros = NOTUSED
+    used = Mat_<uchar>::zeros(img_height, img_width); // zeros = NOTUSED
     std::vector<RegionPoint> reg(img_width * img_height);
 
     // Search for line segments
-    unsigned int ls_count = 0;
-    unsigned int list_size = list.size();
-    for(unsigned int i = 0; i < list_size; ++i)
+    for(size_t i = 0, list_size = list.size(); i < list_size; ++i)
     {
-        unsigned int adx = list[i].p.x + list[i].p.y * img_width;
+        unsigned int adx = list[i].x + list[i].y * img_width;
         if((used.data[adx] == NOTUSED) && (angles_data[adx] != NOTDEF))
         {
             int reg_size;
             double reg_angle;
-            region_grow(list[i].p, reg, reg_size, reg_angle, prec);
+            region_grow(list[i], reg, reg_size, reg_angle, prec);
 
             // Ignore small regions
             if(reg_size < min_reg_size) { continue; }
@@ -504,39 +653,188 @@ void LineSegmentDetectorImpl::flsd(std::vector<Vec4i>& lines,
                 }
             }
             // Found new line
-            ++ls_count;
+            recs.push_back(rec);
+            log_nfas.push_back(log_nfa);
+        }
+    }
+}
+
+inline bool near_tile_border(const double& x, const double& y, const int& tile_size)
+{
+    const int border = 2 * TILE_OVERLAP;
+    int tx = int(x) % tile_size, ty = int(y) % tile_size;
+    return tx < border || tx >= tile_size - border || ty < border || ty >= tile_size - border;
+}
 
-            // Add the offset
-            rec.x1 += 0.5; rec.y1 += 0.5;
-            rec.x2 += 0.5; rec.y2 += 0.5;
+void LineSegmentDetectorImpl::merge_segments(std::vector<rect>& recs, std::vector<double>& log_nfas,
+                                             std::vector<int>& tiles, int tile_size) const
+{
+    // A tile sees TILE_OVERLAP pixels of its neighbours, so the segments split
+    // between the tiles have their ends near the tile borders
+    std::vector<int> candidates;
+    for(size_t i = 0; i < recs.size(); ++i)
+    {
+        const rect& rec = recs[i];
+        if(near_tile_border(rec.x1, rec.y1, tile_size) || near_tile_border(rec.x2, rec.y2, tile_size))
+            candidates.push_back((int)i);
+    }
+
+    std::vector<uchar> removed(recs.size(), 0);
+    for(size_t ci = 0; ci < candidates.size(); ++ci)
+    {
+        const int i = candidates[ci];
+        if(removed[i]) { continue; }
+        for(size_t cj = ci + 1; cj < candidates.size(); ++cj)
+        {
+            const int j = candidates[cj];
+            if(removed[j] || tiles[i] == tiles[j]) { continue; }
+
+            rect& a = recs[i];
+            const rect& b = recs[j];
+            const double len_a = dist(a.x1, a.y1, a.x2, a.y2);
+            const double len_b = dist(b.x1, b.y1, b.x2, b.y2);
+            if(len_a <= 0 || len_b <= 0) { continue; }
+
+            // The segments must have the same orientation (it follows the gradient direction)
+            const double dx = (a.x2 - a.x1) / len_a, dy = (a.y2 - a.y1) / len_a;
+            if(dx * (b.x2 - b.x1) / len_b + dy * (b.y2 - b.y1) / len_b < std::cos(std::max(a.prec, b.prec))) { continue; }
+
+            // ... lie on the same line
+            const double tol = std::max(a.width, b.width);
+            if(std::fabs((b.x1 - a.x1) * dy - (b.y1 - a.y1) * dx) > tol ||
+               std::fabs((b.x2 - a.x1) * dy - (b.y2 - a.y1) * dx) > tol) { continue; }
+
+            // ... and overlap or touch along it
+            const double t1 = (b.x1 - a.x1) * dx + (b.y1 - a.y1) * dy;
+            const double t2 = (b.x2 - a.x1) * dx + (b.y2 - a.y1) * dy;
+            if(std::min(t1, t2) > len_a + tol || std::max(t1, t2) < -tol) { continue; }
+
+            // Extend the segment to the farthest ends
+            if(t1 < 0) { a.x1 = b.x1; a.y1 = b.y1; }
+            if(t2 > len_a) { a.x2 = b.x2; a.y2 = b.y2; }
+            a.x = (a.x1 + a.x2) / 2;
+            a.y = (a.y1 + a.y2) / 2;
+            a.width = tol;
+            log_nfas[i] = std::max(log_nfas[i], log_nfas[j]);
+            tiles[i] = -1; // can be merged with the segments of any tile now
+            removed[j] = 1;
+
+            // Check the merged segment against the previous candidates again
+            cj = ci;
+        }
+    }
+
+    size_t count = 0;
+    for(size_t i = 0; i < recs.size(); ++i)
+    {
+        if(removed[i]) { continue; }
+        recs[count] = recs[i];
+        log_nfas[count] = log_nfas[i];
+        ++count;
+    }
+    recs.resize(count);
+    log_nfas.resize(count);
+}
+
+class LSDGradientInvoker : public ParallelLoopBody
+{
+public:
+    LSDGradientInvoker(const double* _image, double* _modgrad, double* _angles, double* _row_max,
+                       int _width, double _threshold)
+        : image(_image), modgrad(_modgrad), angles(_angles), row_max(_row_max),
+          width(_width), threshold(_threshold)
+    {
+    }
 
-            // scale the result values if a sub-sampling was performed
-            if(SCALE != 1)
+    void operator()(const Range& range) const
+    {
+        for(int y = range.start; y < range.end; ++y)
+        {
+            double max_grad = -1;
+            for(int addr = y * width, addr_end = addr + width - 1; addr < addr_end; ++addr)
             {
-                rec.x1 /= SCALE; rec.y1 /= SCALE;
-                rec.x2 /= SCALE; rec.y2 /= SCALE;
-                rec.width /= SCALE;
+                double DA = image[addr + width + 1] - image[addr];
+                double BC = image[addr + 1] - image[addr + width];
+                double gx = DA + BC;    // gradient x component
+                double gy = DA - BC;    // gradient y component
+                double norm = std::sqrt((gx * gx + gy * gy) / 4); // gradient norm
+
+                modgrad[addr] = norm;    // store gradient
+
+                if (norm <= threshold)  // norm too small, gradient no defined
+                {
+                    angles[addr] = NOTDEF;
+                }
+                else
+                {
+                    angles[addr] = fastAtan2(float(gx), float(-gy)) * DEG_TO_RADS;  // gradient angle computation
+                    if (norm > max_grad) { max_grad = norm; }
+                }
             }
+            row_max[y] = max_grad;
+        }
+    }
 
-            //Store the relevant data
-            lines.push_back(Vec4i(int(rec.x1), int(rec.y1), int(rec.x2), int(rec.y2)));
-            if(w_needed) widths.push_back(rec.width);
-            if(p_needed) precisions.push_back(rec.p);
-            if(n_needed && doRefine >= LSD_REFINE_ADV) nfas.push_back(log_nfa);
+private:
+    const double* image;
+    double* modgrad;
+    double* angles;
+    double* row_max;
+    int width;
+    double threshold;
+};
 
+// Bucket sort of the points with defined angle by the gradient norm. The image rows are split
+// into stripes, each with its own set of bins. When list is null the points are counted
+// in the bins, otherwise they are put to the list starting from the offsets stored in the bins.
+class LSDPseudoOrderInvoker : public ParallelLoopBody
+{
+public:
+    LSDPseudoOrderInvoker(const double* _modgrad, const double* _angles, int _width, int _height,
+                          int _nstripes, double _bin_coef, int _n_bins, int* _bins, Point* _list)
+        : modgrad(_modgrad), angles(_angles), width(_width), height(_height),
+          nstripes(_nstripes), bin_coef(_bin_coef), n_bins(_n_bins), bins(_bins), list(_list)
+    {
+    }
 
-            // //Add the linesID to the region on the image
-            // for(unsigned int el = 0; el < reg_size; el++)
-            // {
-            //     region.data[reg[i].x + reg[i].y * width] = ls_count;
-            // }
+    void operator()(const Range& range) const
+    {
+        for(int s = range.start; s < range.end; ++s)
+        {
+            int* stripe_bins = bins + s * n_bins;
+            int y_end = (int)((int64)height * (s + 1) / nstripes);
+            for(int y = (int)((int64)height * s / nstripes); y < y_end; ++y)
+            {
+                const double* norm = modgrad + y * width;
+                const double* angle = angles + y * width;
+                for(int x = 0; x < width - 1; ++x)
+                {
+                    if(angle[x] == NOTDEF) { continue; }
+                    int i = int(norm[x] * bin_coef);
+                    if(list)
+                        list[stripe_bins[i]++] = Point(x, y);
+                    else
+                        ++stripe_bins[i];
+                }
+            }
         }
     }
-}
+
+private:
+    const double* modgrad;
+    const double* angles;
+    int width;
+    int height;
+    int nstripes;
+    double bin_coef;
+    int n_bins;
+    int* bins;
+    Point* list;
+};
 
 void LineSegmentDetectorImpl::ll_angle(const double& threshold,
                                    const unsigned int& n_bins,
-                                   std::vector<coorlist>& list)
+                                   std::vector<Point>& list)
 {
     //Initialize data
     angles = Mat_<double>(scaled_image.size());
@@ -558,79 +856,42 @@ void LineSegmentDetectorImpl::ll_angle(const double& threshold,
               modgrad.isContinuous() &&
               angles.isContinuous());   // Accessing image data linearly
 
+    std::vector<double> row_max(img_height);
+    parallel_for_(Range(0, img_height - 1),
+                  LSDGradientInvoker(scaled_image_data, modgrad_data, angles_data, &row_max[0], img_width, threshold),
+                  scaled_image.total()/(double)(1<<16));
+
     double max_grad = -1;
     for(int y = 0; y < img_height - 1; ++y)
-    {
-        for(int addr = y * img_width, addr_end = addr + img_width - 1; addr < addr_end; ++addr)
-        {
-            double DA = scaled_image_data[addr + img_width + 1] - scaled_image_data[addr];
-            double BC = scaled_image_data[addr + 1] - scaled_image_data[addr + img_width];
-            double gx = DA + BC;    // gradient x component
-            double gy = DA - BC;    // gradient y component
-            double norm = std::sqrt((gx * gx + gy * gy) / 4); // gradient norm
-
-            modgrad_data[addr] = norm;    // store gradient
-
-            if (norm <= threshold)  // norm too small, gradient no defined
-            {
-                angles_data[addr] = NOTDEF;
-            }
-            else
-            {
-                angles_data[addr] = fastAtan2(float(gx), float(-gy)) * DEG_TO_RADS;  // gradient angle computation
-                if (norm > max_grad) { max_grad = norm; }
-            }
-
-        }
-    }
+        max_grad = std::max(max_grad, row_max[y]);
 
     // Compute histogram of gradient values
-    list = std::vector<coorlist>(img_width * img_height);
-    std::vector<coorlist*> range_s(n_bins);
-    std::vector<coorlist*> range_e(n_bins);
-    unsigned int count = 0;
+    const int nbins = (int)n_bins;
+    const int nstripes = std::max(std::min(getNumThreads(), img_height - 1), 1);
+    std::vector<int> bins(nstripes * nbins, 0);
     double bin_coef = (max_grad > 0) ? double(n_bins - 1) / max_grad : 0; // If all image is smooth, max_grad <= 0
 
-    for(int y = 0; y < img_height - 1; ++y)
-    {
-        const double* norm = modgrad_data + y * img_width;
-        for(int x = 0; x < img_width - 1; ++x, ++norm)
-        {
-            // Store the point in the right bin according to its norm
-            int i = int((*norm) * bin_coef);
-            if(!range_e[i])
-            {
-                range_e[i] = range_s[i] = &list[count];
-                ++count;
-            }
-            else
-            {
-                range_e[i]->next = &list[count];
-                range_e[i] = &list[count];
-                ++count;
-            }
-            range_e[i]->p = Point(x, y);
-            range_e[i]->next = 0;
-        }
-    }
+    parallel_for_(Range(0, nstripes),
+                  LSDPseudoOrderInvoker(modgrad_data, angles_data, img_width, img_height - 1,
+                                        nstripes, bin_coef, nbins, &bins[0], 0));
 
-    // Sort
-    int idx = n_bins - 1;
-    for(;idx > 0 && !range_s[idx]; --idx);
-    coorlist* start = range_s[idx];
-    coorlist* end = range_e[idx];
-    if(start)
+    // Sort: the bins of larger norms go first, the points of each bin keep the raster order
+    int count = 0;
+    for(int i = nbins - 1; i >= 0; --i)
     {
-        while(idx > 0)
+        for(int s = 0; s < nstripes; ++s)
         {
-            --idx;
-            if(range_s[idx])
-            {
-                end->next = range_s[idx];
-                end = range_e[idx];
-            }
+            int n = bins[s * nbins + i];
+            bins[s * nbins + i] = count;
+            count += n;
         }
     }
+
+    list.resize(count);
+    if(count > 0)
+        parallel_for_(Range(0, nstripes),
+                      LSDPseudoOrderInvoker(modgrad_data, angles_data, img_width, img_height - 1,
+                                            nstripes, bin_coef, nbins, &bins[0], &list[0]));
 }
 
 void LineSegmentDetectorImpl::region_grow(const Point2i& s, std::vector<RegionPoint>& reg,
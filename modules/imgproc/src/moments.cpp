@@ -321,10 +321,381 @@ template<> void momentsInTile<uchar, int, int>( const cv::Mat& img, double* mome
         moments[x] = (double)mom[x];
 }
 
+template<> void momentsInTile<ushort, int, int64>( const cv::Mat& img, double* moments )
+{
+    typedef ushort T;
+    typedef int WT;
+    typedef int64 MT;
+    Size size = img.size();
+    int y;
+    MT mom[10] = {0,0,0,0,0,0,0,0,0,0};
+    bool useSIMD = checkHardwareSupport(CV_CPU_SSE2);
+
+    for( y = 0; y < size.height; y++ )
+    {
+        const T* ptr = img.ptr<T>(y);
+        int x0 = 0, x1 = 0, x2 = 0, x = 0;
+        MT x3 = 0;
+
+        if( useSIMD )
+        {
+            // the tile is at most 32 pixels wide, so x^3 fits 16 bits and all the partial sums
+            // except for the 3rd order one fit 32 bits
+            __m128i qx_init = _mm_setr_epi16(0, 1, 2, 3, 4, 5, 6, 7);
+            __m128i dx = _mm_set1_epi16(8);
+            __m128i z = _mm_setzero_si128(), qx0 = z, qx1 = z, qx2 = z, qx3 = z, qx = qx_init;
+
+            for( ; x <= size.width - 8; x += 8 )
+            {
+                __m128i p = _mm_loadu_si128((const __m128i*)(ptr + x));
+                __m128i sx = _mm_mullo_epi16(qx, qx);
+                __m128i cx = _mm_mullo_epi16(sx, qx);
+                qx0 = _mm_add_epi32(qx0, _mm_add_epi32(_mm_unpacklo_epi16(p, z), _mm_unpackhi_epi16(p, z)));
+
+                __m128i lo = _mm_mullo_epi16(p, qx), hi = _mm_mulhi_epu16(p, qx);
+                qx1 = _mm_add_epi32(qx1, _mm_add_epi32(_mm_unpacklo_epi16(lo, hi), _mm_unpackhi_epi16(lo, hi)));
+                lo = _mm_mullo_epi16(p, sx); hi = _mm_mulhi_epu16(p, sx);
+                qx2 = _mm_add_epi32(qx2, _mm_add_epi32(_mm_unpacklo_epi16(lo, hi), _mm_unpackhi_epi16(lo, hi)));
+
+                // x^3*p may not fit 31 bits, so it is accumulated in 64-bit lanes
+                lo = _mm_mullo_epi16(p, cx); hi = _mm_mulhi_epu16(p, cx);
+                __m128i t0 = _mm_unpacklo_epi16(lo, hi), t1 = _mm_unpackhi_epi16(lo, hi);
+                qx3 = _mm_add_epi64(qx3, _mm_add_epi64(_mm_unpacklo_epi32(t0, z), _mm_unpackhi_epi32(t0, z)));
+                qx3 = _mm_add_epi64(qx3, _mm_add_epi64(_mm_unpacklo_epi32(t1, z), _mm_unpackhi_epi32(t1, z)));
+
+                qx = _mm_add_epi16(qx, dx);
+            }
+            int CV_DECL_ALIGNED(16) buf[4];
+            _mm_store_si128((__m128i*)buf, qx0);
+            x0 = buf[0] + buf[1] + buf[2] + buf[3];
+            _mm_store_si128((__m128i*)buf, qx1);
+            x1 = buf[0] + buf[1] + buf[2] + buf[3];
+            _mm_store_si128((__m128i*)buf, qx2);
+            x2 = buf[0] + buf[1] + buf[2] + buf[3];
+            int64 CV_DECL_ALIGNED(16) buf64[2];
+            _mm_store_si128((__m128i*)buf64, qx3);
+            x3 = buf64[0] + buf64[1];
+        }
+
+        for( ; x < size.width; x++ )
+        {
+            WT p = ptr[x];
+            WT xp = x * p, xxp;
+
+            x0 += p;
+            x1 += xp;
+            xxp = xp * x;
+            x2 += xxp;
+            x3 += xxp * x;
+        }
+
+        WT py = y * x0, sy = y*y;
+
+        mom[9] += ((MT)py) * sy;  // m03
+        mom[8] += ((MT)x1) * sy;  // m12
+        mom[7] += ((MT)x2) * y;  // m21
+        mom[6] += x3;             // m30
+        mom[5] += x0 * sy;        // m02
+        mom[4] += x1 * y;         // m11
+        mom[3] += x2;             // m20
+        mom[2] += py;             // m01
+        mom[1] += x1;             // m10
+        mom[0] += x0;             // m00
+    }
+
+    for(int x = 0; x < 10; x++ )
+        moments[x] = (double)mom[x];
+}
+
+template<> void momentsInTile<float, double, double>( const cv::Mat& img, double* moments )
+{
+    typedef float T;
+    typedef double WT;
+    typedef double MT;
+    Size size = img.size();
+    int y;
+    MT mom[10] = {0,0,0,0,0,0,0,0,0,0};
+    bool useSIMD = checkHardwareSupport(CV_CPU_SSE2);
+
+    for( y = 0; y < size.height; y++ )
+    {
+        const T* ptr = img.ptr<T>(y);
+        WT x0 = 0, x1 = 0, x2 = 0;
+        MT x3 = 0;
+        int x = 0;
+
+        if( useSIMD )
+        {
+            __m128d z = _mm_setzero_pd(), qx0 = z, qx1 = z, qx2 = z, qx3 = z;
+            __m128d qxa = _mm_setr_pd(0, 1), qxb = _mm_setr_pd(2, 3), dx = _mm_set1_pd(4);
+
+            for( ; x <= size.width - 4; x += 4 )
+            {
+                __m128 p = _mm_loadu_ps(ptr + x);
+                __m128d pa = _mm_cvtps_pd(p), pb = _mm_cvtps_pd(_mm_movehl_ps(p, p));
+                __m128d xpa = _mm_mul_pd(pa, qxa), xpb = _mm_mul_pd(pb, qxb);
+                __m128d xxpa = _mm_mul_pd(xpa, qxa), xxpb = _mm_mul_pd(xpb, qxb);
+
+                qx0 = _mm_add_pd(qx0, _mm_add_pd(pa, pb));
+                qx1 = _mm_add_pd(qx1, _mm_add_pd(xpa, xpb));
+                qx2 = _mm_add_pd(qx2, _mm_add_pd(xxpa, xxpb));
+                qx3 = _mm_add_pd(qx3, _mm_add_pd(_mm_mul_pd(xxpa, qxa), _mm_mul_pd(xxpb, qxb)));
+
+                qxa = _mm_add_pd(qxa, dx);
+                qxb = _mm_add_pd(qxb, dx);
+            }
+            double CV_DECL_ALIGNED(16) buf[2];
+            _mm_store_pd(buf, qx0); x0 = buf[0] + buf[1];
+            _mm_store_pd(buf, qx1); x1 = buf[0] + buf[1];
+            _mm_store_pd(buf, qx2); x2 = buf[0] + buf[1];
+            _mm_store_pd(buf, qx3); x3 = buf[0] + buf[1];
+        }
+
+        for( ; x < size.width; x++ )
+        {
+            WT p = ptr[x];
+            WT xp = x * p, xxp;
+
+            x0 += p;
+            x1 += xp;
+            xxp = xp * x;
+            x2 += xxp;
+            x3 += xxp * x;
+        }
+
+        WT py = y * x0, sy = y*y;
+
+        mom[9] += ((MT)py) * sy;  // m03
+        mom[8] += ((MT)x1) * sy;  // m12
+        mom[7] += ((MT)x2) * y;  // m21
+        mom[6] += x3;             // m30
+        mom[5] += x0 * sy;        // m02
+        mom[4] += x1 * y;         // m11
+        mom[3] += x2;             // m20
+        mom[2] += py;             // m01
+        mom[1] += x1;             // m10
+        mom[0] += x0;             // m00
+    }
+
+    for(int x = 0; x < 10; x++ )
+        moments[x] = (double)mom[x];
+}
+
 #endif
 
 typedef void (*MomentsInTileFunc)(const Mat& img, double* moments);
 
+enum { MOMENTS_TILE_SIZE = 32 };
+
+// adds the moments mom[] of a tile with the top-left corner at (x, y) to the spatial moments m[]
+// (m00, m10, m01, m20, m11, m02, m30, m21, m12, m03)
+static void accumulateTileMoments( double* m, const double* mom, int x, int y )
+{
+    double xm = x * mom[0], ym = y * mom[0];
+
+    // + m00 ( = m00' )
+    m[0] += mom[0];
+
+    // + m10 ( = m10' + x*m00' )
+    m[1] += mom[1] + xm;
+
+    // + m01 ( = m01' + y*m00' )
+    m[2] += mom[2] + ym;
+
+    // + m20 ( = m20' + 2*x*m10' + x*x*m00' )
+    m[3] += mom[3] + x * (mom[1] * 2 + xm);
+
+    // + m11 ( = m11' + x*m01' + y*m10' + x*y*m00' )
+    m[4] += mom[4] + x * (mom[2] + ym) + y * mom[1];
+
+    // + m02 ( = m02' + 2*y*m01' + y*y*m00' )
+    m[5] += mom[5] + y * (mom[2] * 2 + ym);
+
+    // + m30 ( = m30' + 3*x*m20' + 3*x*x*m10' + x*x*x*m00' )
+    m[6] += mom[6] + x * (3. * mom[3] + x * (3. * mom[1] + xm));
+
+    // + m21 ( = m21' + x*(2*m11' + 2*y*m10' + x*m01' + x*y*m00') + y*m20')
+    m[7] += mom[7] + x * (2 * (mom[4] + y * mom[1]) + x * (mom[2] + ym)) + y * mom[3];
+
+    // + m12 ( = m12' + y*(2*m11' + 2*x*m01' + y*m10' + x*y*m00') + x*m02')
+    m[8] += mom[8] + y * (2 * (mom[4] + x * mom[2]) + y * (mom[1] + xm)) + x * mom[5];
+
+    // + m03 ( = m03' + 3*y*m02' + 3*y*y*m01' + y*y*y*m00' )
+    m[9] += mom[9] + y * (3. * mom[5] + y * (3. * mom[2] + ym));
+}
+
+// computes the moments of the horizontal bands of tiles; each band gets its own partial sums
+class MomentsInTile_Invoker : public ParallelLoopBody
+{
+public:
+    MomentsInTile_Invoker( const Mat& _src, MomentsInTileFunc _func, bool _binary, double* _partial )
+        : src0(_src), func(_func), binary(_binary), partial(_partial)
+    {
+    }
+
+    void operator()( const Range& range ) const
+    {
+        uchar nzbuf[MOMENTS_TILE_SIZE*MOMENTS_TILE_SIZE];
+        Size size = src0.size();
+
+        for( int b = range.start; b < range.end; b++ )
+        {
+            int y = b*MOMENTS_TILE_SIZE;
+            double* m = partial + b*10;
+            Size tileSize;
+            tileSize.height = std::min((int)MOMENTS_TILE_SIZE, size.height - y);
+
+            for( int k = 0; k < 10; k++ )
+                m[k] = 0;
+
+            for( int x = 0; x < size.width; x += MOMENTS_TILE_SIZE )
+            {
+                tileSize.width = std::min((int)MOMENTS_TILE_SIZE, size.width - x);
+                Mat src(src0, cv::Rect(x, y, tileSize.width, tileSize.height));
+
+                if( binary )
+                {
+                    cv::Mat tmp(tileSize, CV_8U, nzbuf);
+                    cv::compare( src, 0, tmp, CV_CMP_NE );
+                    src = tmp;
+                }
+
+                double mom[10];
+                func( src, mom );
+
+                if(binary)
+                {
+                    double s = 1./255;
+                    for( int k = 0; k < 10; k++ )
+                        mom[k] *= s;
+                }
+
+                accumulateTileMoments( m, mom, x, y );
+            }
+        }
+    }
+
+private:
+    const Mat& src0;
+    MomentsInTileFunc func;
+    bool binary;
+    double* partial;
+
+    MomentsInTile_Invoker& operator=(const MomentsInTile_Invoker&);
+};
+
+
+// accumulates the per-row sums x0..x3 of p, x*p, x^2*p and x^3*p of every label met in the row
+template<typename T> static void
+labelMomentsRow( const int* labels, const T* weights, int width, int nlabels,
+                 double* rowsums, uchar* touched, int* touchedList, int& ntouched )
+{
+    for( int x = 0; x < width; x++ )
+    {
+        int l = labels[x];
+        if( (unsigned)l >= (unsigned)nlabels )
+            continue;
+
+        double p = weights ? (double)weights[x] : 1., xp = x*p, xxp = xp*x;
+        double* s = rowsums + l*4;
+        s[0] += p; s[1] += xp; s[2] += xxp; s[3] += xxp*x;
+        if( !touched[l] )
+        {
+            touched[l] = 1;
+            touchedList[ntouched++] = l;
+        }
+    }
+}
+
+typedef void (*LabelMomentsRowFunc)( const int* labels, const uchar* weights, int width, int nlabels,
+                                     double* rowsums, uchar* touched, int* touchedList, int& ntouched );
+
+// computes the spatial moments of all the labels in a stripe of rows
+class LabelMoments_Invoker : public ParallelLoopBody
+{
+public:
+    LabelMoments_Invoker( const Mat& _labels, const Mat& _img, LabelMomentsRowFunc _func,
+                          int _nlabels, int _nstripes, std::vector<double>* _partial )
+        : labels(_labels), img(_img), func(_func), nlabels(_nlabels), nstripes(_nstripes), partial(_partial)
+    {
+    }
+
+    void operator()( const Range& range ) const
+    {
+        int rows = labels.rows;
+
+        for( int k = range.start; k < range.end; k++ )
+        {
+            int y0 = (int)((int64)rows*k/nstripes), y1 = (int)((int64)rows*(k + 1)/nstripes);
+            std::vector<double>& m = partial[k];
+            std::vector<double> rowsums(nlabels*4, 0.);
+            std::vector<uchar> touched(nlabels, (uchar)0);
+            std::vector<int> touchedList(nlabels);
+            m.assign(nlabels*10, 0.);
+
+            for( int y = y0; y < y1; y++ )
+            {
+                int ntouched = 0;
+                func( labels.ptr<int>(y), img.empty() ? 0 : img.ptr(y), labels.cols, nlabels,
+                      &rowsums[0], &touched[0], &touchedList[0], ntouched );
+
+                double y_ = y, yy = y_*y_, yyy = yy*y_;
+                for( int i = 0; i < ntouched; i++ )
+                {
+                    int l = touchedList[i];
+                    double* s = &rowsums[l*4];
+                    double* ml = &m[l*10];
+
+                    ml[0] += s[0];        // m00
+                    ml[1] += s[1];        // m10
+                    ml[2] += s[0]*y_;     // m01
+                    ml[3] += s[2];        // m20
+                    ml[4] += s[1]*y_;     // m11
+                    ml[5] += s[0]*yy;     // m02
+                    ml[6] += s[3];        // m30
+                    ml[7] += s[2]*y_;     // m21
+                    ml[8] += s[1]*yy;     // m12
+                    ml[9] += s[0]*yyy;    // m03
+
+                    s[0] = s[1] = s[2] = s[3] = 0;
+                    touched[l] = 0;
+                }
+            }
+        }
+    }
+
+private:
+    const Mat& labels;
+    const Mat& img;
+    LabelMomentsRowFunc func;
+    int nlabels, nstripes;
+    std::vector<double>* partial;
+
+    LabelMoments_Invoker& operator=(const LabelMoments_Invoker&);
+};
+
+
+class ContourMoments_Invoker : public ParallelLoopBody
+{
+public:
+    ContourMoments_Invoker( const std::vector<Mat>& _contours, Moments* _mu )
+        : contours(_contours), mu(_mu)
+    {
+    }
+
+    void operator()( const Range& range ) const
+    {
+        for( int i = range.start; i < range.end; i++ )
+            mu[i] = contourMoments(contours[i]);
+    }
+
+private:
+    const std::vector<Mat>& contours;
+    Moments* mu;
+
+    ContourMoments_Invoker& operator=(const ContourMoments_Invoker&);
+};
+
 Moments::Moments()
 {
     m00 = m10 = m01 = m20 = m11 = m02 = m30 = m21 = m12 = m03 =
@@ -367,10 +738,8 @@ Moments::Moments( double _m00, double _m10, double _m01, double _m20, double _m1
 
 cv::Moments cv::moments( InputArray _src, bool binary )
 {
-    const int TILE_SIZE = 32;
     Mat mat = _src.getMat();
     MomentsInTileFunc func = 0;
-    uchar nzbuf[TILE_SIZE*TILE_SIZE];
     Moments m;
     int type = mat.type();
     int depth = CV_MAT_DEPTH( type );
@@ -400,73 +769,90 @@ cv::Moments cv::moments( InputArray _src, bool binary )
     else
         CV_Error( CV_StsUnsupportedFormat, "" );
 
-    Mat src0(mat);
-
-    for( int y = 0; y < size.height; y += TILE_SIZE )
-    {
-        Size tileSize;
-        tileSize.height = std::min(TILE_SIZE, size.height - y);
+    // the bands of tiles are processed in parallel, and their sums are added in a fixed order,
+    // so the result does not depend on the number of threads
+    int nbands = (size.height + MOMENTS_TILE_SIZE - 1)/MOMENTS_TILE_SIZE;
+    AutoBuffer<double> _partial(nbands*10);
+    double* partial = _partial;
 
-        for( int x = 0; x < size.width; x += TILE_SIZE )
-        {
-            tileSize.width = std::min(TILE_SIZE, size.width - x);
-            Mat src(src0, cv::Rect(x, y, tileSize.width, tileSize.height));
+    parallel_for_(Range(0, nbands), MomentsInTile_Invoker(mat, func, binary, partial),
+                  size.area()/(double)(1 << 16));
 
-            if( binary )
-            {
-                cv::Mat tmp(tileSize, CV_8U, nzbuf);
-                cv::compare( src, 0, tmp, CV_CMP_NE );
-                src = tmp;
-            }
+    double* sums = &m.m00;
+    for( int b = 0; b < nbands; b++ )
+        for( int k = 0; k < 10; k++ )
+            sums[k] += partial[b*10 + k];
 
-            double mom[10];
-            func( src, mom );
-
-            if(binary)
-            {
-                double s = 1./255;
-                for( int k = 0; k < 10; k++ )
-                    mom[k] *= s;
-            }
-
-            double xm = x * mom[0], ym = y * mom[0];
+    completeMomentState( &m );
+    return m;
+}
 
-            // accumulate moments computed in each tile
 
-            // + m00 ( = m00' )
-            m.m00 += mom[0];
+void cv::moments( InputArrayOfArrays _contours, std::vector<Moments>& mu )
+{
+    int i, n = (int)_contours.total();
+    std::vector<Mat> contours(n);
 
-            // + m10 ( = m10' + x*m00' )
-            m.m10 += mom[1] + xm;
+    for( i = 0; i < n; i++ )
+    {
+        contours[i] = _contours.getMat(i);
+        CV_Assert( contours[i].checkVector(2) >= 0 &&
+                   (contours[i].depth() == CV_32S || contours[i].depth() == CV_32F) );
+    }
 
-            // + m01 ( = m01' + y*m00' )
-            m.m01 += mom[2] + ym;
+    mu.resize(n);
+    if( n > 0 )
+        parallel_for_(Range(0, n), ContourMoments_Invoker(contours, &mu[0]), n/64.);
+}
 
-            // + m20 ( = m20' + 2*x*m10' + x*x*m00' )
-            m.m20 += mom[3] + x * (mom[1] * 2 + xm);
 
-            // + m11 ( = m11' + x*m01' + y*m10' + x*y*m00' )
-            m.m11 += mom[4] + x * (mom[2] + ym) + y * mom[1];
+void cv::moments( InputArray _labels, int nlabels, std::vector<Moments>& mu, InputArray _img )
+{
+    Mat labels = _labels.getMat(), img = _img.getMat();
+    LabelMomentsRowFunc func = 0;
 
-            // + m02 ( = m02' + 2*y*m01' + y*y*m00' )
-            m.m02 += mom[5] + y * (mom[2] * 2 + ym);
+    CV_Assert( labels.type() == CV_32SC1 && nlabels >= 0 );
+    if( !img.empty() )
+    {
+        int depth = img.depth();
+        CV_Assert( img.size() == labels.size() && img.channels() == 1 );
+
+        if( depth == CV_8U )
+            func = (LabelMomentsRowFunc)labelMomentsRow<uchar>;
+        else if( depth == CV_16U )
+            func = (LabelMomentsRowFunc)labelMomentsRow<ushort>;
+        else if( depth == CV_16S )
+            func = (LabelMomentsRowFunc)labelMomentsRow<short>;
+        else if( depth == CV_32F )
+            func = (LabelMomentsRowFunc)labelMomentsRow<float>;
+        else if( depth == CV_64F )
+            func = (LabelMomentsRowFunc)labelMomentsRow<double>;
+        else
+            CV_Error( CV_StsUnsupportedFormat, "" );
+    }
+    else
+        func = (LabelMomentsRowFunc)labelMomentsRow<uchar>;
 
-            // + m30 ( = m30' + 3*x*m20' + 3*x*x*m10' + x*x*x*m00' )
-            m.m30 += mom[6] + x * (3. * mom[3] + x * (3. * mom[1] + xm));
+    mu.assign(nlabels, Moments());
+    if( nlabels == 0 || labels.empty() )
+        return;
 
-            // + m21 ( = m21' + x*(2*m11' + 2*y*m10' + x*m01' + x*y*m00') + y*m20')
-            m.m21 += mom[7] + x * (2 * (mom[4] + y * mom[1]) + x * (mom[2] + ym)) + y * mom[3];
+    // the number of stripes does not depend on the number of threads, so neither does the result;
+    // the per-stripe sums are limited to about 64Mb
+    int nstripes = std::min(std::min(labels.rows/32, 16), (int)((64 << 20)/((int64)nlabels*10*sizeof(double))));
+    nstripes = std::max(nstripes, 1);
+    std::vector<std::vector<double> > partial(nstripes);
 
-            // + m12 ( = m12' + y*(2*m11' + 2*x*m01' + y*m10' + x*y*m00') + x*m02')
-            m.m12 += mom[8] + y * (2 * (mom[4] + x * mom[2]) + y * (mom[1] + xm)) + x * mom[5];
+    parallel_for_(Range(0, nstripes), LabelMoments_Invoker(labels, img, func, nlabels, nstripes, &partial[0]));
 
-            // + m03 ( = m03' + 3*y*m02' + 3*y*y*m01' + y*y*y*m00' )
-            m.m03 += mom[9] + y * (3. * mom[5] + y * (3. * mom[2] + ym));
-        }
+    for( int l = 0; l < nlabels; l++ )
+    {
+        double m[10] = {0,0,0,0,0,0,0,0,0,0};
+        for( int k = 0; k < nstripes; k++ )
+            for( int j = 0; j < 10; j++ )
+                m[j] += partial[k][l*10 + j];
+        mu[l] = Moments(m[0], m[1], m[2], m[3], m[4], m[5], m[6], m[7], m[8], m[9]);
     }
-
-    completeMomentState( &m );
-    return m;
 }
 
 
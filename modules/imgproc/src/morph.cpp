@@ -844,6 +844,31 @@ template<class Op, class VecOp> struct MorphFilter : BaseFilter
     VecOp vecOp;
 };
 
+// replaces the default border value with the one that does not affect the result
+static Scalar morphologyBorderValue( int op, int type, int rowBorderType, int columnBorderType,
+                                     const Scalar& _borderValue )
+{
+    Scalar borderValue = _borderValue;
+    if( (rowBorderType == BORDER_CONSTANT || columnBorderType == BORDER_CONSTANT) &&
+            borderValue == morphologyDefaultBorderValue() )
+    {
+        int depth = CV_MAT_DEPTH(type);
+        CV_Assert( depth == CV_8U || depth == CV_16U || depth == CV_16S ||
+                   depth == CV_32F || depth == CV_64F );
+        if( op == MORPH_ERODE )
+            borderValue = Scalar::all( depth == CV_8U ? (double)UCHAR_MAX :
+                                       depth == CV_16U ? (double)USHRT_MAX :
+                                       depth == CV_16S ? (double)SHRT_MAX :
+                                       depth == CV_32F ? (double)FLT_MAX : DBL_MAX);
+        else
+            borderValue = Scalar::all( depth == CV_8U || depth == CV_16U ?
+                                           0. :
+                                       depth == CV_16S ? (double)SHRT_MIN :
+                                       depth == CV_32F ? (double)-FLT_MAX : -DBL_MAX);
+    }
+    return borderValue;
+}
+
 }
 
 /////////////////////////////////// External Interface /////////////////////////////////////
@@ -1001,24 +1026,7 @@ cv::Ptr<cv::FilterEngine> cv::createMorphologyFilter( int op, int type, InputArr
     else
         filter2D = getMorphologyFilter(op, type, kernel, anchor);
 
-    Scalar borderValue = _borderValue;
-    if( (_rowBorderType == BORDER_CONSTANT || _columnBorderType == BORDER_CONSTANT) &&
-            borderValue == morphologyDefaultBorderValue() )
-    {
-        int depth = CV_MAT_DEPTH(type);
-        CV_Assert( depth == CV_8U || depth == CV_16U || depth == CV_16S ||
-                   depth == CV_32F || depth == CV_64F );
-        if( op == MORPH_ERODE )
-            borderValue = Scalar::all( depth == CV_8U ? (double)UCHAR_MAX :
-                                       depth == CV_16U ? (double)USHRT_MAX :
-                                       depth == CV_16S ? (double)SHRT_MAX :
-                                       depth == CV_32F ? (double)FLT_MAX : DBL_MAX);
-        else
-            borderValue = Scalar::all( depth == CV_8U || depth == CV_16U ?
-                                           0. :
-                                       depth == CV_16S ? (double)SHRT_MIN :
-                                       depth == CV_32F ? (double)-FLT_MAX : -DBL_MAX);
-    }
+    Scalar borderValue = morphologyBorderValue(op, type, _rowBorderType, _columnBorderType, _borderValue);
 
     return makePtr<FilterEngine>(filter2D, rowFilter, columnFilter,
                                  type, type, type, _rowBorderType, _columnBorderType, borderValue );
@@ -1136,6 +1144,373 @@ private:
     Scalar borderValue;
 };
 
+/*
+  Erosion/dilation by structuring elements that are unions of a few rectangles,
+  computed with the van Herk/Gil-Werman algorithm. For a window of k elements
+  the sequence is split into blocks of k elements, the running minimum (maximum)
+  is computed forward and backward inside every block, and each output value is
+  the minimum (maximum) of one backward and one forward running value, so the
+  cost per pixel does not depend on k. The vertical pass processes whole rows
+  and uses the same SIMD operations as the regular filters.
+*/
+
+// D[i] = op(A[i], B[i]), i = 0 .. len-1
+template<class Op, class VecOp> static inline void
+morphRowsOp( const uchar* A, const uchar* B, uchar* D, int len )
+{
+    typedef typename Op::rtype T;
+    uchar* ptrs[] = { (uchar*)A, (uchar*)B };
+    VecOp vecOp;
+    Op op;
+
+    int i = vecOp(ptrs, 2, D, len);
+    const T* a = (const T*)A;
+    const T* b = (const T*)B;
+    T* d = (T*)D;
+
+    for( ; i < len; i++ )
+        d[i] = op(a[i], b[i]);
+}
+
+template<class Op, class VecOp> class MorphRectsInvoker : public ParallelLoopBody
+{
+public:
+    typedef typename Op::rtype T;
+
+    MorphRectsInvoker( const Mat& _src, Mat& _dst, const std::vector<Rect>& _rects, int _op,
+                       int _nStripes, int _rowVHGWThreshold, int _columnVHGWThreshold )
+        : src(_src), dst(_dst), rects(_rects), opType(_op), nStripes(_nStripes),
+          rowVHGWThreshold(_rowVHGWThreshold), columnVHGWThreshold(_columnVHGWThreshold)
+    {
+    }
+
+    void operator()( const Range& range ) const
+    {
+        int y0 = dst.rows*range.start/nStripes, y1 = dst.rows*range.end/nStripes;
+        int n = y1 - y0;
+        int cn = dst.channels(), esz = (int)dst.elemSize();
+        int width = dst.cols*cn, srcWidth = src.cols*cn;
+        int maxKh = 1;
+        size_t r;
+
+        if( n <= 0 )
+            return;
+
+        for( r = 0; r < rects.size(); r++ )
+            maxKh = std::max(maxKh, rects[r].height);
+
+        // the rows are processed in chunks, so that the buffers stay in cache:
+        // the vertical pass results (also used for the backward running values),
+        // the forward running values of the vertical pass, the forward and backward
+        // running values of the horizontal pass and the current result rows
+        int maxChunk = std::max(maxKh, (int)MIN_CHUNK);
+        AutoBuffer<T> _vbuf((size_t)srcWidth*(maxChunk + 1));
+        AutoBuffer<T> _rbuf((size_t)(srcWidth*2 + width)*ROW_GROUP);
+        AutoBuffer<const uchar*> _ptrs(n + maxKh - 1 + maxChunk*2);
+        T* vbuf = _vbuf;
+        T* gbuf = vbuf + (size_t)srcWidth*maxChunk;
+        T* rg = _rbuf;
+        T* rh = rg + srcWidth*ROW_GROUP;
+        T* rowBuf = rh + srcWidth*ROW_GROUP;
+        const uchar** srows = _ptrs;
+        const uchar** vrows = srows + n + maxKh - 1;
+        const uchar** hrows = vrows + maxChunk;
+
+        for( r = 0; r < rects.size(); r++ )
+        {
+            const Rect& rect = rects[r];
+            int kh = rect.height, kw = rect.width;
+            int len = srcWidth, xofs = rect.x*esz;
+            int chunk = kh >= columnVHGWThreshold ? kh : (int)MIN_CHUNK;
+            int i, t, y, yc;
+
+            // short segments are processed by the regular separable filters
+            Ptr<BaseColumnFilter> columnFilter;
+            Ptr<BaseRowFilter> rowFilter;
+            if( kh > 1 && kh < columnVHGWThreshold )
+                columnFilter = getMorphologyColumnFilter(opType, dst.type(), kh, 0);
+            if( kw > 1 && kw < rowVHGWThreshold )
+                rowFilter = getMorphologyRowFilter(opType, dst.type(), kw, 0);
+
+            for( i = 0; i < n + kh - 1; i++ )
+                srows[i] = src.ptr(y0 + rect.y + i);
+
+            for( yc = 0; yc < n; yc += chunk )
+            {
+                int nc = std::min(chunk, n - yc);
+                const uchar** S = srows + yc;
+
+                if( kh == 1 )
+                {
+                    for( t = 0; t < nc; t++ )
+                        vrows[t] = S[t];
+                }
+                else if( columnFilter )
+                {
+                    (*columnFilter)(S, (uchar*)vbuf, srcWidth*(int)sizeof(T), nc, len);
+                    for( t = 0; t < nc; t++ )
+                        vrows[t] = (const uchar*)(vbuf + (size_t)srcWidth*t);
+                }
+                else
+                {
+                    // the chunk is a block of kh rows: the backward running values inside it
+                    // and the forward running values inside the next block give the results
+                    hrows[kh-1] = S[kh-1];
+                    for( t = kh - 2; t >= 0; t-- )
+                    {
+                        uchar* hrow = (uchar*)(vbuf + (size_t)srcWidth*t);
+                        morphRowsOp<Op, VecOp>(hrows[t+1], S[t], hrow, len);
+                        hrows[t] = hrow;
+                    }
+
+                    const uchar* grow = S[kh];
+                    vrows[0] = hrows[0];
+                    for( t = 1; t < nc; t++ )
+                    {
+                        uchar* vrow = (uchar*)(vbuf + (size_t)srcWidth*t);
+                        morphRowsOp<Op, VecOp>(hrows[t], grow, vrow, len);
+                        vrows[t] = vrow;
+                        if( t + 1 < nc )
+                        {
+                            morphRowsOp<Op, VecOp>(grow, S[kh+t], (uchar*)gbuf, len);
+                            grow = (const uchar*)gbuf;
+                        }
+                    }
+                }
+
+                for( y = 0; y < nc; y += ROW_GROUP )
+                {
+                    int l, m = std::min((int)ROW_GROUP, nc - y);
+                    const T* V[ROW_GROUP];
+                    uchar* res[ROW_GROUP];
+
+                    // the rows are processed in groups to have several independent running min/max
+                    // chains; the missing rows of the last group just repeat its last row
+                    for( l = 0; l < ROW_GROUP; l++ )
+                    {
+                        V[l] = (const T*)(vrows[y + std::min(l, m - 1)] + xofs);
+                        res[l] = r == 0 && l < m ? dst.ptr(y0 + yc + y + l) : (uchar*)(rowBuf + width*l);
+                    }
+
+                    if( kw == 1 )
+                    {
+                        for( l = 0; l < m; l++ )
+                            if( r == 0 )
+                                memcpy(res[l], V[l], width*sizeof(T));
+                            else
+                                res[l] = (uchar*)V[l];
+                    }
+                    else if( rowFilter )
+                    {
+                        for( l = 0; l < m; l++ )
+                            (*rowFilter)((const uchar*)V[l], res[l], dst.cols, cn);
+                    }
+                    else
+                    {
+                        rowsVHGW(V, kw, cn, rg, rh);
+                        for( l = 0; l < m; l++ )
+                            morphRowsOp<Op, VecOp>((const uchar*)(rh + srcWidth*l),
+                                                   (const uchar*)(rg + srcWidth*l + (kw-1)*cn), res[l], width);
+                    }
+
+                    if( r > 0 )
+                        for( l = 0; l < m; l++ )
+                        {
+                            uchar* drow = dst.ptr(y0 + yc + y + l);
+                            morphRowsOp<Op, VecOp>(drow, res[l], drow, width);
+                        }
+                }
+            }
+        }
+    }
+
+private:
+    enum { ROW_GROUP = 4, MIN_CHUNK = 16 };
+
+    // forward and backward running min/max inside the blocks of kw pixels for a group of rows
+    void rowsVHGW( const T** S, int kw, int cn, T* g, T* h ) const
+    {
+        int width = dst.cols*cn, len = (dst.cols + kw - 1)*cn, blockLen = kw*cn;
+        int step = src.cols*cn, i, j, c;
+        const T *S0 = S[0], *S1 = S[1], *S2 = S[2], *S3 = S[3];
+        T *g0 = g, *g1 = g0 + step, *g2 = g1 + step, *g3 = g2 + step;
+        T *h0 = h, *h1 = h0 + step, *h2 = h1 + step, *h3 = h2 + step;
+        Op op;
+
+        for( i = 0; i < len; i += blockLen )
+        {
+            int blockEnd = std::min(i + blockLen, len);
+
+            for( c = i; c < i + cn; c++ )
+            {
+                T m0 = S0[c], m1 = S1[c], m2 = S2[c], m3 = S3[c];
+                g0[c] = m0; g1[c] = m1; g2[c] = m2; g3[c] = m3;
+                for( j = c + cn; j < blockEnd; j += cn )
+                {
+                    m0 = op(m0, S0[j]); m1 = op(m1, S1[j]);
+                    m2 = op(m2, S2[j]); m3 = op(m3, S3[j]);
+                    g0[j] = m0; g1[j] = m1; g2[j] = m2; g3[j] = m3;
+                }
+            }
+
+            // the backward values are only needed for the complete blocks
+            if( i >= width )
+                continue;
+
+            for( c = blockEnd - cn; c < blockEnd; c++ )
+            {
+                T m0 = S0[c], m1 = S1[c], m2 = S2[c], m3 = S3[c];
+                h0[c] = m0; h1[c] = m1; h2[c] = m2; h3[c] = m3;
+                for( j = c - cn; j >= i; j -= cn )
+                {
+                    m0 = op(m0, S0[j]); m1 = op(m1, S1[j]);
+                    m2 = op(m2, S2[j]); m3 = op(m3, S3[j]);
+                    h0[j] = m0; h1[j] = m1; h2[j] = m2; h3[j] = m3;
+                }
+            }
+        }
+    }
+
+    MorphRectsInvoker& operator=(const MorphRectsInvoker&);
+
+    const Mat& src;
+    Mat& dst;
+    const std::vector<Rect>& rects;
+    int opType;
+    int nStripes;
+    int rowVHGWThreshold;
+    int columnVHGWThreshold;
+};
+
+// splits the structuring element into rectangles if every row of it is a single segment
+static bool decomposeMorphKernel( const Mat& kernel, std::vector<Rect>& rects )
+{
+    std::vector<Range> runs(kernel.rows, Range::all());
+    int i, j;
+
+    rects.clear();
+    if( kernel.type() != CV_8U )
+        return false;
+
+    for( i = 0; i < kernel.rows; i++ )
+    {
+        const uchar* krow = kernel.ptr(i);
+        for( j = 0; j < kernel.cols && !krow[j]; j++ )
+            ;
+        int start = j;
+        for( ; j < kernel.cols && krow[j]; j++ )
+            ;
+        runs[i] = Range(start, j);
+        for( ; j < kernel.cols; j++ )
+            if( krow[j] )
+                return false;
+    }
+
+    // for each row segment take the tallest rectangle of such width that fits the kernel
+    for( i = 0; i < kernel.rows; i++ )
+    {
+        Range run = runs[i];
+        if( run.empty() )
+            continue;
+
+        int i0 = i, i1 = i;
+        while( i0 > 0 && runs[i0-1].start <= run.start && run.end <= runs[i0-1].end )
+            i0--;
+        while( i1 < kernel.rows - 1 && runs[i1+1].start <= run.start && run.end <= runs[i1+1].end )
+            i1++;
+
+        Rect rect(run.start, i0, run.size(), i1 - i0 + 1);
+        bool redundant = false;
+
+        for( size_t k = 0; k < rects.size() && !redundant; k++ )
+            redundant = (rects[k] & rect) == rect;
+        if( !redundant )
+            rects.push_back(rect);
+    }
+
+    // drop the rectangles covered by some other one
+    for( size_t k = 0; k < rects.size(); )
+    {
+        size_t l = 0;
+        for( ; l < rects.size(); l++ )
+            if( l != k && (rects[l] & rects[k]) == rects[k] )
+                break;
+        if( l < rects.size() )
+            rects.erase(rects.begin() + k);
+        else
+            k++;
+    }
+
+    return !rects.empty();
+}
+
+static bool morphByRects( int op, const Mat& src, Mat& dst, const Mat& kernel,
+                          Point anchor, int borderType, const Scalar& borderValue )
+{
+    int depth = src.depth(), esz1 = (int)src.elemSize1();
+    std::vector<Rect> rects;
+
+    if( (borderType & BORDER_ISOLATED) != 0 || borderType == BORDER_WRAP ||
+        depth == CV_8S || depth == CV_32S ||
+        !decomposeMorphKernel(kernel, rects) )
+        return false;
+
+    // the running min/max along the rows is scalar, so it pays off only for long segments.
+    // Short ones are left to the regular filters
+    int rowVHGWThreshold = esz1 == 1 ? (src.channels() == 1 ? 64 : 96) : esz1 == 2 ? 24 : esz1 == 4 ? 16 : 10;
+    int columnVHGWThreshold = esz1 <= 2 ? 12 : 16;
+
+    // compare the estimated number of operations per pixel with the one of the separable filter
+    // for a rectangle and of the generic filter otherwise
+    int cost = 0;
+    for( size_t r = 0; r < rects.size(); r++ )
+        cost += std::min(rects[r].width, rowVHGWThreshold) + std::min(rects[r].height, columnVHGWThreshold) + 2;
+    if( rects.size() == 1 ? cost + 2 >= kernel.rows + kernel.cols : cost*2 >= countNonZero(kernel) )
+        return false;
+
+    // the column filters need aligned rows. The padded copy also makes the in-place operation safe
+    Size paddedSize(src.cols + kernel.cols - 1, src.rows + kernel.rows - 1);
+    Mat paddedBuf(paddedSize.height, (int)alignSize(paddedSize.width*src.elemSize(), 16), CV_8U);
+    Mat padded(paddedSize, src.type(), paddedBuf.data, paddedBuf.step);
+    copyMakeBorder(src, padded, anchor.y, kernel.rows - anchor.y - 1,
+                   anchor.x, kernel.cols - anchor.x - 1, borderType,
+                   morphologyBorderValue(op, src.type(), borderType, borderType, borderValue));
+
+    int maxKh = 1;
+    for( size_t r = 0; r < rects.size(); r++ )
+        maxKh = std::max(maxKh, rects[r].height);
+    int nStripes = std::max(std::min(getNumThreads(), dst.rows/std::max(maxKh*2, 32)), 1);
+
+    if( op == MORPH_ERODE )
+    {
+        if( depth == CV_8U )
+            parallel_for_(Range(0, nStripes), MorphRectsInvoker<MinOp<uchar>, ErodeVec8u>(padded, dst, rects, op, nStripes, rowVHGWThreshold, columnVHGWThreshold));
+        else if( depth == CV_16U )
+            parallel_for_(Range(0, nStripes), MorphRectsInvoker<MinOp<ushort>, ErodeVec16u>(padded, dst, rects, op, nStripes, rowVHGWThreshold, columnVHGWThreshold));
+        else if( depth == CV_16S )
+            parallel_for_(Range(0, nStripes), MorphRectsInvoker<MinOp<short>, ErodeVec16s>(padded, dst, rects, op, nStripes, rowVHGWThreshold, columnVHGWThreshold));
+        else if( depth == CV_32F )
+            parallel_for_(Range(0, nStripes), MorphRectsInvoker<MinOp<float>, ErodeVec32f>(padded, dst, rects, op, nStripes, rowVHGWThreshold, columnVHGWThreshold));
+        else
+            parallel_for_(Range(0, nStripes), MorphRectsInvoker<MinOp<double>, ErodeVec64f>(padded, dst, rects, op, nStripes, rowVHGWThreshold, columnVHGWThreshold));
+    }
+    else
+    {
+        if( depth == CV_8U )
+            parallel_for_(Range(0, nStripes), MorphRectsInvoker<MaxOp<uchar>, DilateVec8u>(padded, dst, rects, op, nStripes, rowVHGWThreshold, columnVHGWThreshold));
+        else if( depth == CV_16U )
+            parallel_for_(Range(0, nStripes), MorphRectsInvoker<MaxOp<ushort>, DilateVec16u>(padded, dst, rects, op, nStripes, rowVHGWThreshold, columnVHGWThreshold));
+        else if( depth == CV_16S )
+            parallel_for_(Range(0, nStripes), MorphRectsInvoker<MaxOp<short>, DilateVec16s>(padded, dst, rects, op, nStripes, rowVHGWThreshold, columnVHGWThreshold));
+        else if( depth == CV_32F )
+            parallel_for_(Range(0, nStripes), MorphRectsInvoker<MaxOp<float>, DilateVec32f>(padded, dst, rects, op, nStripes, rowVHGWThreshold, columnVHGWThreshold));
+        else
+            parallel_for_(Range(0, nStripes), MorphRectsInvoker<MaxOp<double>, DilateVec64f>(padded, dst, rects, op, nStripes, rowVHGWThreshold, columnVHGWThreshold));
+    }
+
+    return true;
+}
+
 #if defined (HAVE_IPP) && (IPP_VERSION_MAJOR >= 7)
 static bool IPPMorphReplicate(int op, const Mat &src, Mat &dst, const Mat &kernel,
                               const Size& ksize, const Point &anchor, bool rectKernel)
@@ -1326,6 +1701,9 @@ static void morphOp( int op, InputArray _src, OutputArray _dst,
         iterations = 1;
     }
 
+    if( iterations == 1 && morphByRects(op, src, dst, kernel, anchor, borderType, borderValue) )
+        return;
+
     int nStripes = 1;
 #if defined HAVE_TEGRA_OPTIMIZATION
     if (src.data != dst.data && iterations == 1 &&  //NOTE: threads are not used for inplace processing
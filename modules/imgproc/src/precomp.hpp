@@ -96,6 +96,20 @@ void crossCorr( const Mat& src, const Mat& templ, Mat& dst,
                 Point anchor=Point(0,0), double delta=0,
                 int borderType=BORDER_REFLECT_101 );
 
+// the parts of convexHull(), minAreaRect() and approxPolyDP() that work on caller buffers,
+// so that computeContourDescriptors() does not allocate memory for every contour.
+// convexHullSort() fills pointer (total elements) with the points sorted by x;
+// convexHullGather() needs total + 2 elements in stack and total in hull, it returns the hull size
+void convexHullSort( const Point* data0, int total, bool is_float, Point** pointer,
+                     int& miny_ind, int& maxy_ind );
+int convexHullGather( const Point* data0, Point** pointer, int total, bool is_float,
+                      int miny_ind, int maxy_ind, bool clockwise, int* stack, int* hull );
+// hpoints is a clockwise convex hull, as convexHull(points, hull, true) gives it
+RotatedRect minAreaRectOfHull( const Point2f* hpoints, int n );
+// dst holds as many points as the curve, of the same type; returns the number of the written points
+int approxPolyDPToBuffer( const Mat& curve, void* dst, double epsilon, bool closed,
+                          AutoBuffer<Range>* stack );
+
 }
 
 typedef struct CvPyramid
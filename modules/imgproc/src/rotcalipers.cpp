@@ -340,24 +340,11 @@ static void rotatingCalipers( const Point2f* points, int n, int mode, float* out
 }
 
 
-cv::RotatedRect cv::minAreaRect( InputArray _points )
+cv::RotatedRect cv::minAreaRectOfHull( const Point2f* hpoints, int n )
 {
-    Mat hull;
     Point2f out[3];
     RotatedRect box;
 
-    convexHull(_points, hull, true, true);
-
-    if( hull.depth() != CV_32F )
-    {
-        Mat temp;
-        hull.convertTo(temp, CV_32F);
-        hull = temp;
-    }
-
-    int n = hull.checkVector(2);
-    const Point2f* hpoints = (const Point2f*)hull.data;
-
     if( n > 2 )
     {
         rotatingCalipers( hpoints, n, CALIPERS_MINAREARECT, (float*)out );
@@ -388,6 +375,23 @@ cv::RotatedRect cv::minAreaRect( InputArray _points )
 }
 
 
+cv::RotatedRect cv::minAreaRect( InputArray _points )
+{
+    Mat hull;
+
+    convexHull(_points, hull, true, true);
+
+    if( hull.depth() != CV_32F )
+    {
+        Mat temp;
+        hull.convertTo(temp, CV_32F);
+        hull = temp;
+    }
+
+    return minAreaRectOfHull( (const Point2f*)hull.data, hull.checkVector(2) );
+}
+
+
 CV_IMPL CvBox2D
 cvMinAreaRect2( const CvArr* array, CvMemStorage* /*storage*/ )
 {
@@ -702,6 +702,151 @@ cv::Rect cv::boundingRect(InputArray array)
     return m.depth() <= CV_8U ? maskBoundingRect(m) : pointSetBoundingRect(m);
 }
 
+namespace cv
+{
+
+class ContourDescriptors_Invoker : public ParallelLoopBody
+{
+public:
+    ContourDescriptors_Invoker( const _InputArray& _contours, const std::vector<int>& _ofs,
+                                ContourDescriptors& _desc, Mat* _hulls, Mat* _approx,
+                                int _flags, double _epsilon, bool _closed )
+        : contours(_contours), ofs(_ofs), desc(_desc), hulls(_hulls), approx(_approx),
+          flags(_flags), epsilon(_epsilon), closed(_closed)
+    {
+    }
+
+    void operator()( const Range& range ) const
+    {
+        // the scratch buffers are shared by all the contours of the stripe
+        int i, k, maxn = 0;
+        for( i = range.start; i < range.end; i++ )
+            maxn = std::max(maxn, ofs[i+1] - ofs[i]);
+
+        AutoBuffer<Point*> pointer(maxn);
+        AutoBuffer<int> stack(maxn + 2), hullIdx(maxn);
+        AutoBuffer<Point2f> hullPoints(maxn);
+        AutoBuffer<Range> approxStack(maxn);
+
+        for( i = range.start; i < range.end; i++ )
+        {
+            int n = ofs[i+1] - ofs[i];
+
+            // the descriptors of empty contours are left zero
+            if( n == 0 )
+                continue;
+
+            Mat contour = contours.getMat(i);
+            const Point* data0 = (const Point*)contour.data;
+            int type = contour.depth() == CV_32F;
+
+            if( flags & CONTOUR_AREA )
+                desc.area[i] = contourArea(contour);
+            if( flags & CONTOUR_ARC_LENGTH )
+                desc.arcLength[i] = arcLength(contour, closed);
+            if( flags & CONTOUR_BOUNDING_RECT )
+                desc.boundingRect[i] = pointSetBoundingRect(contour);
+
+            // the points are sorted once for both the clockwise hull of minAreaRect
+            // and the counter-clockwise one of convexHull
+            if( flags & (CONTOUR_CONVEX_HULL | CONTOUR_MIN_AREA_RECT) )
+            {
+                int miny_ind, maxy_ind, nh;
+                convexHullSort(data0, n, type != 0, pointer, miny_ind, maxy_ind);
+
+                if( flags & CONTOUR_MIN_AREA_RECT )
+                {
+                    nh = convexHullGather(data0, pointer, n, type != 0, miny_ind, maxy_ind, true, stack, hullIdx);
+                    for( k = 0; k < nh; k++ )
+                        hullPoints[k] = type ? ((const Point2f*)data0)[hullIdx[k]] : Point2f(data0[hullIdx[k]]);
+                    desc.minAreaRect[i] = minAreaRectOfHull(hullPoints, nh);
+                }
+
+                if( flags & CONTOUR_CONVEX_HULL )
+                {
+                    nh = convexHullGather(data0, pointer, n, type != 0, miny_ind, maxy_ind, false, stack, hullIdx);
+                    Point* dst = hulls[type].ptr<Point>(ofs[i]);
+                    for( k = 0; k < nh; k++ )
+                        dst[k] = data0[hullIdx[k]];
+                    desc.convexHull[i] = hulls[type].rowRange(ofs[i], ofs[i] + nh);
+                }
+            }
+
+            if( (flags & CONTOUR_FIT_ELLIPSE) && n >= 5 )
+                desc.ellipse[i] = fitEllipse(contour);
+            if( flags & CONTOUR_APPROX_POLY )
+            {
+                int na = approxPolyDPToBuffer(contour, approx[type].ptr(ofs[i]), epsilon, closed, &approxStack);
+                desc.approxCurve[i] = approx[type].rowRange(ofs[i], ofs[i] + na);
+            }
+        }
+    }
+
+private:
+    const _InputArray& contours;
+    const std::vector<int>& ofs;
+    ContourDescriptors& desc;
+    Mat* hulls;
+    Mat* approx;
+    int flags;
+    double epsilon;
+    bool closed;
+
+    ContourDescriptors_Invoker& operator=(const ContourDescriptors_Invoker&);
+};
+
+}
+
+void cv::computeContourDescriptors( InputArrayOfArrays _contours, ContourDescriptors& desc,
+                                    int flags, double approxEpsilon, bool closed )
+{
+    CV_Assert( (flags & ~CONTOUR_ALL) == 0 );
+
+    int i, n = (int)_contours.total();
+    // the contour i owns the rows ofs[i] ... ofs[i+1]-1 of the buffers with the hulls and the approximated curves,
+    // which have at most as many points as the contour
+    std::vector<int> ofs(n + 1, 0);
+    bool haveDepth[2] = { false, false };
+
+    for( i = 0; i < n; i++ )
+    {
+        Mat contour = _contours.getMat(i);
+        int npoints = contour.checkVector(2), depth = contour.depth();
+        CV_Assert( contour.empty() ||
+                   (npoints >= 0 && contour.isContinuous() && (depth == CV_32S || depth == CV_32F)) );
+        npoints = std::max(npoints, 0);
+        if( npoints > 0 )
+            haveDepth[depth == CV_32F] = true;
+        ofs[i+1] = ofs[i] + npoints;
+    }
+
+    size_t nout = (size_t)n;
+    desc.area.assign(flags & CONTOUR_AREA ? nout : 0, 0.);
+    desc.arcLength.assign(flags & CONTOUR_ARC_LENGTH ? nout : 0, 0.);
+    desc.boundingRect.assign(flags & CONTOUR_BOUNDING_RECT ? nout : 0, Rect());
+    desc.minAreaRect.assign(flags & CONTOUR_MIN_AREA_RECT ? nout : 0, RotatedRect());
+    // the ellipse is not fitted to the contours with less than 5 points, their elements are left empty
+    desc.ellipse.assign(flags & CONTOUR_FIT_ELLIPSE ? nout : 0, RotatedRect());
+    desc.convexHull.assign(flags & CONTOUR_CONVEX_HULL ? nout : 0, Mat());
+    desc.approxCurve.assign(flags & CONTOUR_APPROX_POLY ? nout : 0, Mat());
+
+    // one buffer per point type (integer and floating-point) for all the hulls and for all the curves
+    Mat hulls[2], approx[2];
+    for( int k = 0; k < 2; k++ )
+    {
+        if( !haveDepth[k] )
+            continue;
+        if( flags & CONTOUR_CONVEX_HULL )
+            hulls[k].create(ofs[n], 1, k ? CV_32FC2 : CV_32SC2);
+        if( flags & CONTOUR_APPROX_POLY )
+            approx[k].create(ofs[n], 1, k ? CV_32FC2 : CV_32SC2);
+    }
+
+    if( n > 0 )
+        parallel_for_(Range(0, n), ContourDescriptors_Invoker(_contours, ofs, desc, hulls, approx,
+                                                              flags, approxEpsilon, closed), n/64.);
+}
+
 ////////////////////////////////////////////// C API ///////////////////////////////////////////
 
 CV_IMPL int
@@ -408,6 +408,11 @@ isPtInCircle3( Point2f pt, Point2f a, Point2f b, Point2f c)
 
 
 int Subdiv2D::insert(Point2f pt)
+{
+    return insertPoint(pt, 0);
+}
+
+int Subdiv2D::insertPoint(Point2f pt, bool* isNew)
 {
     int curr_point = 0, curr_edge = 0, deleted_edge = 0;
     int location = locate( pt, curr_edge, curr_point );
@@ -418,6 +423,9 @@ int Subdiv2D::insert(Point2f pt)
     if( location == PTLOC_OUTSIDE_RECT )
         CV_Error( CV_StsOutOfRange, "" );
 
+    if( isNew )
+        *isNew = location != PTLOC_VERTEX;
+
     if( location == PTLOC_VERTEX )
         return curr_point;
 
@@ -477,10 +485,139 @@ int Subdiv2D::insert(Point2f pt)
     return curr_point;
 }
 
+// position of the point (x, y) on the Hilbert curve that fills the 2^order x 2^order grid
+static int64 hilbertIndex( unsigned x, unsigned y, int order )
+{
+    int64 d = 0;
+    for( unsigned s = 1U << (order - 1); s > 0; s >>= 1 )
+    {
+        unsigned rx = (x & s) != 0, ry = (y & s) != 0;
+        d += (int64)s * s * ((3 * rx) ^ ry);
+        if( ry == 0 )
+        {
+            if( rx == 1 )
+            {
+                x = s - 1 - x;
+                y = s - 1 - y;
+            }
+            std::swap(x, y);
+        }
+    }
+    return d;
+}
+
+struct HilbertIdxLess
+{
+    HilbertIdxLess(const std::vector<int64>& _keys) : keys(&_keys) {}
+    bool operator()(int a, int b) const { return (*keys)[a] < (*keys)[b]; }
+    const std::vector<int64>* keys;
+};
+
+// Biased randomized insertion order (BRIO): the points are shuffled and split into rounds
+// of doubling size, and the points within each round are sorted along the Hilbert curve.
+// The point location then walks only a few triangles from the previously inserted point,
+// while the random rounds keep the triangulation from degenerating on regular inputs.
+static void spatialInsertionOrder( const std::vector<Point2f>& ptvec, Point2f topLeft,
+                                   Point2f bottomRight, std::vector<int>& order )
+{
+    const int hilbertOrder = 16, minRound = 64;
+    int i, n = (int)ptvec.size();
+    std::vector<int64> keys(n);
+    double sx = ((1 << hilbertOrder) - 1)/std::max((double)bottomRight.x - topLeft.x, 1.);
+    double sy = ((1 << hilbertOrder) - 1)/std::max((double)bottomRight.y - topLeft.y, 1.);
+
+    for( i = 0; i < n; i++ )
+    {
+        unsigned x = (unsigned)cvFloor((ptvec[i].x - topLeft.x)*sx);
+        unsigned y = (unsigned)cvFloor((ptvec[i].y - topLeft.y)*sy);
+        keys[i] = hilbertIndex(x, y, hilbertOrder);
+    }
+
+    order.resize(n);
+    for( i = 0; i < n; i++ )
+        order[i] = i;
+
+    // a fixed seed makes the triangulation reproducible
+    RNG rng((uint64)-1);
+    for( i = n - 1; i > 0; i-- )
+        std::swap(order[i], order[rng.uniform(0, i + 1)]);
+
+    int end = n;
+    while( end > 0 )
+    {
+        int start = end > minRound ? end/2 : 0;
+        std::sort(order.begin() + start, order.begin() + end, HilbertIdxLess(keys));
+        end = start;
+    }
+}
+
 void Subdiv2D::insert(const std::vector<Point2f>& ptvec)
 {
-    for( size_t i = 0; i < ptvec.size(); i++ )
-        insert(ptvec[i]);
+    int i, n = (int)ptvec.size();
+
+    if( n == 0 )
+        return;
+
+    if( qedges.size() < (size_t)4 )
+        CV_Error( CV_StsError, "Subdivision is empty" );
+
+    for( i = 0; i < n; i++ )
+    {
+        Point2f pt = ptvec[i];
+        if( pt.x < topLeft.x || pt.y < topLeft.y || pt.x >= bottomRight.x || pt.y >= bottomRight.y )
+            CV_Error( CV_StsOutOfRange, "" );
+    }
+
+    // the points are inserted in the spatially coherent order. Each new point adds 3 edges.
+    vtx.reserve(vtx.size() + n);
+    qedges.reserve(qedges.size() + n*3);
+
+    std::vector<int> ids(n), slots, order;
+    spatialInsertionOrder(ptvec, topLeft, bottomRight, order);
+
+    for( i = 0; i < n; i++ )
+    {
+        int k = order[i];
+        bool isNew = false;
+        ids[k] = insertPoint(ptvec[k], &isNew);
+        if( isNew )
+            slots.push_back(ids[k]);
+    }
+
+    // one-by-one insertion would give the same slots to the new vertices, but in the order of ptvec,
+    // so the vertices are renumbered: a point that duplicates an earlier one (or lies within
+    // FLT_EPSILON from it) takes no slot, and the others take the slots in turn.
+    std::vector<int> remap(vtx.size(), -1);
+    std::vector<uchar> created(vtx.size(), (uchar)0);
+    std::vector<Vertex> newvtx(slots.size());
+    int nslots = (int)slots.size(), j = 0;
+
+    for( i = 0; i < nslots; i++ )
+        created[slots[i]] = 1;
+
+    for( i = 0; i < n; i++ )
+    {
+        int v = ids[i];
+        if( created[v] && remap[v] < 0 )
+        {
+            remap[v] = slots[j];
+            newvtx[j] = vtx[v];
+            newvtx[j].pt = ptvec[i];
+            j++;
+        }
+    }
+    CV_Assert( j == nslots );
+
+    for( i = 0; i < nslots; i++ )
+        vtx[slots[i]] = newvtx[i];
+
+    for( size_t e = 0; e < qedges.size(); e++ )
+        for( int k = 0; k < 4; k += 2 )
+        {
+            int v = qedges[e].pt[k];
+            if( v > 0 && remap[v] >= 0 )
+                qedges[e].pt[k] = remap[v];
+        }
 }
 
 void Subdiv2D::initDelaunay( Rect rect )
@@ -59,6 +59,76 @@ cv::Mat cv::getDefaultNewCameraMatrix( InputArray _cameraMatrix, Size imgsize,
     return newCameraMatrix;
 }
 
+namespace cv
+{
+
+class UndistortMap_Invoker : public ParallelLoopBody
+{
+public:
+    UndistortMap_Invoker( Mat& _map1, Mat& _map2, int _m1type, const double* _ir,
+                          double _fx, double _fy, double _u0, double _v0, const double* _k ) :
+        map1(_map1), map2(_map2), m1type(_m1type), fx(_fx), fy(_fy), u0(_u0), v0(_v0)
+    {
+        memcpy(ir, _ir, sizeof(ir));
+        memcpy(k, _k, sizeof(k));
+    }
+
+    void operator()( const Range& range ) const
+    {
+        double k1 = k[0], k2 = k[1], p1 = k[2], p2 = k[3], k3 = k[4], k4 = k[5], k5 = k[6], k6 = k[7];
+        double s1 = k[8], s2 = k[9], s3 = k[10], s4 = k[11];
+
+        for( int i = range.start; i < range.end; i++ )
+        {
+            float* m1f = (float*)(map1.data + map1.step*i);
+            float* m2f = (float*)(map2.data + map2.step*i);
+            short* m1 = (short*)m1f;
+            ushort* m2 = (ushort*)m2f;
+            double _x = i*ir[1] + ir[2], _y = i*ir[4] + ir[5], _w = i*ir[7] + ir[8];
+
+            for( int j = 0; j < map1.cols; j++, _x += ir[0], _y += ir[3], _w += ir[6] )
+            {
+                double w = 1./_w, x = _x*w, y = _y*w;
+                double x2 = x*x, y2 = y*y;
+                double r2 = x2 + y2, _2xy = 2*x*y;
+                double kr = (1 + ((k3*r2 + k2)*r2 + k1)*r2)/(1 + ((k6*r2 + k5)*r2 + k4)*r2);
+                double u = fx*(x*kr + p1*_2xy + p2*(r2 + 2*x2) + s1*r2+s2*r2*r2) + u0;
+                double v = fy*(y*kr + p1*(r2 + 2*y2) + p2*_2xy + s3*r2+s4*r2*r2) + v0;
+                if( m1type == CV_16SC2 )
+                {
+                    int iu = saturate_cast<int>(u*INTER_TAB_SIZE);
+                    int iv = saturate_cast<int>(v*INTER_TAB_SIZE);
+                    m1[j*2] = (short)(iu >> INTER_BITS);
+                    m1[j*2+1] = (short)(iv >> INTER_BITS);
+                    m2[j] = (ushort)((iv & (INTER_TAB_SIZE-1))*INTER_TAB_SIZE + (iu & (INTER_TAB_SIZE-1)));
+                }
+                else if( m1type == CV_32FC1 )
+                {
+                    m1f[j] = (float)u;
+                    m2f[j] = (float)v;
+                }
+                else
+                {
+                    m1f[j*2] = (float)u;
+                    m1f[j*2+1] = (float)v;
+                }
+            }
+        }
+    }
+
+private:
+    Mat& map1;
+    Mat& map2;
+    int m1type;
+    double ir[9];
+    double fx, fy, u0, v0;
+    double k[12];
+
+    UndistortMap_Invoker& operator=(const UndistortMap_Invoker&);
+};
+
+}
+
 void cv::initUndistortRectifyMap( InputArray _cameraMatrix, InputArray _distCoeffs,
                               InputArray _matR, InputArray _newCameraMatrix,
                               Size size, int m1type, OutputArray _map1, OutputArray _map2 )
@@ -127,44 +197,56 @@ void cv::initUndistortRectifyMap( InputArray _cameraMatrix, InputArray _distCoef
     double s3 = distCoeffs.cols + distCoeffs.rows - 1 >= 12 ? ((double*)distCoeffs.data)[10] : 0.;
     double s4 = distCoeffs.cols + distCoeffs.rows - 1 >= 12 ? ((double*)distCoeffs.data)[11] : 0.;
 
-    for( int i = 0; i < size.height; i++ )
+    double k[12] = { k1, k2, p1, p2, k3, k4, k5, k6, s1, s2, s3, s4 };
+    parallel_for_(Range(0, size.height), UndistortMap_Invoker(map1, map2, m1type, ir, fx, fy, u0, v0, k));
+}
+
+
+namespace cv
+{
+
+class Undistort_Invoker : public ParallelLoopBody
+{
+public:
+    Undistort_Invoker( const Mat& _src, Mat& _dst, const Mat_<double>& _A, const Mat& _distCoeffs,
+                       const Mat_<double>& _Ar, int _stripeSize ) :
+        src(_src), dst(_dst), A(_A), distCoeffs(_distCoeffs), Ar0(_Ar), stripeSize(_stripeSize)
+    {
+    }
+
+    void operator()( const Range& range ) const
     {
-        float* m1f = (float*)(map1.data + map1.step*i);
-        float* m2f = (float*)(map2.data + map2.step*i);
-        short* m1 = (short*)m1f;
-        ushort* m2 = (ushort*)m2f;
-        double _x = i*ir[1] + ir[2], _y = i*ir[4] + ir[5], _w = i*ir[7] + ir[8];
+        Mat map1(stripeSize, src.cols, CV_16SC2), map2(stripeSize, src.cols, CV_16UC1);
+        Mat_<double> Ar = Ar0.clone(), I = Mat_<double>::eye(3,3);
 
-        for( int j = 0; j < size.width; j++, _x += ir[0], _y += ir[3], _w += ir[6] )
+        double v0 = Ar(1, 2);
+        for( int i = range.start; i < range.end; i++ )
         {
-            double w = 1./_w, x = _x*w, y = _y*w;
-            double x2 = x*x, y2 = y*y;
-            double r2 = x2 + y2, _2xy = 2*x*y;
-            double kr = (1 + ((k3*r2 + k2)*r2 + k1)*r2)/(1 + ((k6*r2 + k5)*r2 + k4)*r2);
-            double u = fx*(x*kr + p1*_2xy + p2*(r2 + 2*x2) + s1*r2+s2*r2*r2) + u0;
-            double v = fy*(y*kr + p1*(r2 + 2*y2) + p2*_2xy + s3*r2+s4*r2*r2) + v0;
-            if( m1type == CV_16SC2 )
-            {
-                int iu = saturate_cast<int>(u*INTER_TAB_SIZE);
-                int iv = saturate_cast<int>(v*INTER_TAB_SIZE);
-                m1[j*2] = (short)(iu >> INTER_BITS);
-                m1[j*2+1] = (short)(iv >> INTER_BITS);
-                m2[j] = (ushort)((iv & (INTER_TAB_SIZE-1))*INTER_TAB_SIZE + (iu & (INTER_TAB_SIZE-1)));
-            }
-            else if( m1type == CV_32FC1 )
-            {
-                m1f[j] = (float)u;
-                m2f[j] = (float)v;
-            }
-            else
-            {
-                m1f[j*2] = (float)u;
-                m1f[j*2+1] = (float)v;
-            }
+            int y = i*stripeSize;
+            int stripe_size = std::min( stripeSize, src.rows - y );
+            Ar(1, 2) = v0 - y;
+            Mat map1_part = map1.rowRange(0, stripe_size),
+                map2_part = map2.rowRange(0, stripe_size),
+                dst_part = dst.rowRange(y, y + stripe_size);
+
+            initUndistortRectifyMap( A, distCoeffs, I, Ar, Size(src.cols, stripe_size),
+                                     map1_part.type(), map1_part, map2_part );
+            remap( src, dst_part, map1_part, map2_part, INTER_LINEAR, BORDER_CONSTANT );
         }
     }
-}
 
+private:
+    const Mat& src;
+    Mat& dst;
+    const Mat_<double>& A;
+    const Mat& distCoeffs;
+    const Mat_<double>& Ar0;
+    int stripeSize;
+
+    Undistort_Invoker& operator=(const Undistort_Invoker&);
+};
+
+}
 
 void cv::undistort( InputArray _src, OutputArray _dst, InputArray _cameraMatrix,
                     InputArray _distCoeffs, InputArray _newCameraMatrix )
@@ -178,9 +260,8 @@ void cv::undistort( InputArray _src, OutputArray _dst, InputArray _cameraMatrix,
     CV_Assert( dst.data != src.data );
 
     int stripe_size0 = std::min(std::max(1, (1 << 12) / std::max(src.cols, 1)), src.rows);
-    Mat map1(stripe_size0, src.cols, CV_16SC2), map2(stripe_size0, src.cols, CV_16UC1);
 
-    Mat_<double> A, Ar, I = Mat_<double>::eye(3,3);
+    Mat_<double> A, Ar;
 
     cameraMatrix.convertTo(A, CV_64F);
     if( distCoeffs.data )
@@ -196,19 +277,9 @@ void cv::undistort( InputArray _src, OutputArray _dst, InputArray _cameraMatrix,
     else
         A.copyTo(Ar);
 
-    double v0 = Ar(1, 2);
-    for( int y = 0; y < src.rows; y += stripe_size0 )
-    {
-        int stripe_size = std::min( stripe_size0, src.rows - y );
-        Ar(1, 2) = v0 - y;
-        Mat map1_part = map1.rowRange(0, stripe_size),
-            map2_part = map2.rowRange(0, stripe_size),
-            dst_part = dst.rowRange(y, y + stripe_size);
-
-        initUndistortRectifyMap( A, distCoeffs, I, Ar, Size(src.cols, stripe_size),
-                                 map1_part.type(), map1_part, map2_part );
-        remap( src, dst_part, map1_part, map2_part, INTER_LINEAR, BORDER_CONSTANT );
-    }
+    // the map is computed by small stripes that stay in cache, the stripes are processed in parallel
+    int nstripes = stripe_size0 > 0 ? (src.rows + stripe_size0 - 1) / stripe_size0 : 0;
+    parallel_for_(Range(0, nstripes), Undistort_Invoker(src, dst, A, distCoeffs, Ar, stripe_size0));
 }
 
 
@@ -413,6 +484,232 @@ void cv::undistortPoints( InputArray _src, OutputArray _dst,
     cvUndistortPoints(&_csrc, &_cdst, &_ccameraMatrix, pD, pR, pP);
 }
 
+namespace
+{
+
+class UndistorterImpl : public cv::Undistorter
+{
+public:
+    // the inverse distortion is tabulated in the nodes of a grid with this step (in pixels)
+    enum { GRID_STEP = 8 };
+
+    UndistorterImpl( const cv::Mat& cameraMatrix, const cv::Mat& distCoeffs, cv::Size imageSize,
+                     const cv::Mat& R, const cv::Mat& newCameraMatrix,
+                     int interpolation, int borderMode, const cv::Scalar& borderValue );
+
+    void apply( cv::InputArray src, cv::OutputArray dst );
+    void undistortPoints( cv::InputArray src, cv::OutputArray dst );
+
+    void getMaps( cv::OutputArray map1, cv::OutputArray map2 ) const;
+    cv::Size getImageSize() const { return imageSize_; }
+
+    template<typename T> void undistortPointsRange( const cv::Point_<T>* src, cv::Point_<T>* dst, const cv::Range& range ) const;
+
+private:
+    cv::Point2d compensate( double x0, double y0, double x, double y, int iters ) const;
+
+    cv::Size imageSize_;
+    int interpolation_;
+    int borderMode_;
+    cv::Scalar borderValue_;
+
+    cv::Mat map1_, map2_;
+
+    double k_[12];
+    double fx_, fy_, cx_, cy_;
+    cv::Matx33d RR_;
+    bool distorted_;
+    cv::Mat grid_;
+};
+
+template<typename T> class UndistortPoints_Invoker : public cv::ParallelLoopBody
+{
+public:
+    UndistortPoints_Invoker( const UndistorterImpl& _impl, const cv::Point_<T>* _src, cv::Point_<T>* _dst ) :
+        impl(_impl), src(_src), dst(_dst)
+    {
+    }
+
+    void operator()( const cv::Range& range ) const
+    {
+        impl.undistortPointsRange(src, dst, range);
+    }
+
+private:
+    const UndistorterImpl& impl;
+    const cv::Point_<T>* src;
+    cv::Point_<T>* dst;
+
+    UndistortPoints_Invoker& operator=(const UndistortPoints_Invoker&);
+};
+
+UndistorterImpl::UndistorterImpl( const cv::Mat& cameraMatrix, const cv::Mat& distCoeffs, cv::Size imageSize,
+                                  const cv::Mat& R, const cv::Mat& newCameraMatrix,
+                                  int interpolation, int borderMode, const cv::Scalar& borderValue ) :
+    imageSize_(imageSize), interpolation_(interpolation), borderMode_(borderMode), borderValue_(borderValue)
+{
+    CV_Assert( imageSize.width > 0 && imageSize.height > 0 );
+    CV_Assert( cameraMatrix.size() == cv::Size(3, 3) );
+
+    cv::Mat_<double> A, Ar, RR = cv::Mat_<double>::eye(3, 3);
+    cameraMatrix.convertTo(A, CV_64F);
+    if( newCameraMatrix.data )
+        newCameraMatrix.convertTo(Ar, CV_64F);
+    else
+        A.copyTo(Ar);
+    if( R.data )
+    {
+        CV_Assert( R.size() == cv::Size(3, 3) );
+        R.convertTo(RR, CV_64F);
+    }
+
+    // the same map as undistort() computes stripe by stripe, but in the compact fixed-point form
+    cv::initUndistortRectifyMap( A, distCoeffs, RR, Ar, imageSize, CV_16SC2, map1_, map2_ );
+
+    memset( k_, 0, sizeof(k_) );
+    distorted_ = false;
+    if( distCoeffs.data )
+    {
+        int n = (int)distCoeffs.total();
+        CV_Assert( (distCoeffs.rows == 1 || distCoeffs.cols == 1) && distCoeffs.channels() == 1 &&
+                   (n == 4 || n == 5 || n == 8 || n == 12) );
+        cv::Mat k(distCoeffs.size(), CV_64F, k_);
+        distCoeffs.convertTo(k, CV_64F);
+        distorted_ = true;
+    }
+
+    fx_ = A(0, 0);
+    fy_ = A(1, 1);
+    cx_ = A(0, 2);
+    cy_ = A(1, 2);
+    cv::Mat_<double> P = Ar.colRange(0, 3)*RR;
+    RR_ = cv::Matx33d(P.ptr<double>());
+
+    if( distorted_ )
+    {
+        // the nodes cover the whole image; they are computed with more iterations than
+        // cvUndistortPoints does, so that the interpolated value is already close to the solution
+        grid_.create( (imageSize.height - 1)/GRID_STEP + 2, (imageSize.width - 1)/GRID_STEP + 2, CV_64FC2 );
+        for( int i = 0; i < grid_.rows; i++ )
+        {
+            cv::Point2d* g = grid_.ptr<cv::Point2d>(i);
+            for( int j = 0; j < grid_.cols; j++ )
+            {
+                double x0 = (j*GRID_STEP - cx_)/fx_, y0 = (i*GRID_STEP - cy_)/fy_;
+                g[j] = compensate( x0, y0, x0, y0, 20 );
+            }
+        }
+    }
+}
+
+// the same iterative distortion compensation as in cvUndistortPoints, started from (x, y)
+cv::Point2d UndistorterImpl::compensate( double x0, double y0, double x, double y, int iters ) const
+{
+    const double* k = k_;
+    for( int j = 0; j < iters; j++ )
+    {
+        double r2 = x*x + y*y;
+        double icdist = (1 + ((k[7]*r2 + k[6])*r2 + k[5])*r2)/(1 + ((k[4]*r2 + k[1])*r2 + k[0])*r2);
+        double deltaX = 2*k[2]*x*y + k[3]*(r2 + 2*x*x)+ k[8]*r2+k[9]*r2*r2;
+        double deltaY = k[2]*(r2 + 2*y*y) + 2*k[3]*x*y+ k[10]*r2+k[11]*r2*r2;
+        x = (x0 - deltaX)*icdist;
+        y = (y0 - deltaY)*icdist;
+    }
+    return cv::Point2d(x, y);
+}
+
+template<typename T> void
+UndistorterImpl::undistortPointsRange( const cv::Point_<T>* src, cv::Point_<T>* dst, const cv::Range& range ) const
+{
+    const double ifx = 1./fx_, ify = 1./fy_, igrid = 1./GRID_STEP;
+    const int gcols = grid_.cols - 1, grows = grid_.rows - 1;
+    const cv::Matx33d& RR = RR_;
+
+    for( int i = range.start; i < range.end; i++ )
+    {
+        double u = src[i].x, v = src[i].y;
+        double x0 = (u - cx_)*ifx, y0 = (v - cy_)*ify;
+        cv::Point2d p(x0, y0);
+
+        if( distorted_ )
+        {
+            double gx = u*igrid, gy = v*igrid;
+
+            if( gx >= 0 && gy >= 0 && gx < gcols && gy < grows )
+            {
+                // bilinear interpolation of the tabulated solution and one refining iteration
+                int ix = (int)gx, iy = (int)gy;
+                double ax = gx - ix, ay = gy - iy;
+                const cv::Point2d* g0 = grid_.ptr<cv::Point2d>(iy) + ix;
+                const cv::Point2d* g1 = grid_.ptr<cv::Point2d>(iy + 1) + ix;
+                double x = (g0[0].x*(1 - ax) + g0[1].x*ax)*(1 - ay) + (g1[0].x*(1 - ax) + g1[1].x*ax)*ay;
+                double y = (g0[0].y*(1 - ax) + g0[1].y*ax)*(1 - ay) + (g1[0].y*(1 - ax) + g1[1].y*ax)*ay;
+                p = compensate( x0, y0, x, y, 1 );
+            }
+            else
+                p = compensate( x0, y0, x0, y0, 5 );
+        }
+
+        double xx = RR(0, 0)*p.x + RR(0, 1)*p.y + RR(0, 2);
+        double yy = RR(1, 0)*p.x + RR(1, 1)*p.y + RR(1, 2);
+        double ww = 1./(RR(2, 0)*p.x + RR(2, 1)*p.y + RR(2, 2));
+        dst[i] = cv::Point_<T>((T)(xx*ww), (T)(yy*ww));
+    }
+}
+
+void UndistorterImpl::apply( cv::InputArray _src, cv::OutputArray _dst )
+{
+    cv::Mat src = _src.getMat();
+    CV_Assert( src.size() == imageSize_ );
+
+    _dst.create( src.size(), src.type() );
+    cv::Mat dst = _dst.getMat();
+    CV_Assert( dst.data != src.data );
+
+    cv::remap( src, dst, map1_, map2_, interpolation_, borderMode_, borderValue_ );
+}
+
+void UndistorterImpl::undistortPoints( cv::InputArray _src, cv::OutputArray _dst )
+{
+    cv::Mat src = _src.getMat();
+
+    CV_Assert( src.isContinuous() && (src.depth() == CV_32F || src.depth() == CV_64F) &&
+              ((src.rows == 1 && src.channels() == 2) || src.cols*src.channels() == 2));
+
+    _dst.create(src.size(), src.type(), -1, true);
+    cv::Mat dst = _dst.getMat();
+    CV_Assert( dst.isContinuous() );
+
+    int n = (int)(src.total()*src.channels()/2);
+    if( n == 0 )
+        return;
+
+    // a thousand points per stripe is enough to make the threading overhead negligible
+    double nstripes = (n + 1023)/1024;
+    if( src.depth() == CV_32F )
+        cv::parallel_for_(cv::Range(0, n), UndistortPoints_Invoker<float>(*this, src.ptr<cv::Point2f>(),
+                          dst.ptr<cv::Point2f>()), nstripes);
+    else
+        cv::parallel_for_(cv::Range(0, n), UndistortPoints_Invoker<double>(*this, src.ptr<cv::Point2d>(),
+                          dst.ptr<cv::Point2d>()), nstripes);
+}
+
+void UndistorterImpl::getMaps( cv::OutputArray map1, cv::OutputArray map2 ) const
+{
+    map1_.copyTo(map1);
+    map2_.copyTo(map2);
+}
+
+}
+
+cv::Ptr<cv::Undistorter> cv::createUndistorter( InputArray cameraMatrix, InputArray distCoeffs, Size imageSize,
+                                                InputArray R, InputArray newCameraMatrix,
+                                                int interpolation, int borderMode, const Scalar& borderValue )
+{
+    return makePtr<UndistorterImpl>( cameraMatrix.getMat(), distCoeffs.getMat(), imageSize, R.getMat(),
+                                     newCameraMatrix.getMat(), interpolation, borderMode, borderValue );
+}
+
 namespace cv
 {
 
@@ -2188,3 +2188,51 @@ TEST(ImgProc_Bayer2RGBA, accuracy)
         }
     }
 }
+
+// the SSE2 HSV and Luv conversions must give exactly the results of the scalar code
+TEST(Imgproc_ColorHSVLuv, simd_bitexact)
+{
+    const int codes[] = { COLOR_BGR2HSV, COLOR_RGB2HSV_FULL, COLOR_BGR2Luv, COLOR_LRGB2Luv, COLOR_BGR2HLS };
+    const char* names[] = { "BGR2HSV", "RGB2HSV_FULL", "BGR2Luv", "LRGB2Luv", "BGR2HLS" };
+
+    // all the 8-bit colors
+    Mat colors(4096, 4096, CV_8UC3);
+    for (int y = 0; y < colors.rows; ++y)
+    {
+        uchar* row = colors.ptr<uchar>(y);
+        for (int x = 0; x < colors.cols; ++x)
+        {
+            int c = y*colors.cols + x;
+            row[x*3] = (uchar)c;
+            row[x*3 + 1] = (uchar)(c >> 8);
+            row[x*3 + 2] = (uchar)(c >> 16);
+        }
+    }
+
+    // floating-point colors, among them the 8-bit ones, 0 and 1; the width leaves a tail for the scalar code
+    Mat fcolors(512, 1027, CV_32FC3);
+    theRNG().fill(fcolors, RNG::UNIFORM, 0.f, 1.f);
+    colors.reshape(3, 16384).rowRange(0, 100).colRange(0, 1024).convertTo(fcolors(Rect(0, 0, 1024, 100)), CV_32F, 1/255.);
+    fcolors.row(100).setTo(Scalar::all(0));
+    fcolors.row(101).setTo(Scalar::all(1));
+
+    bool useOptimized = cv::useOptimized();
+    for (int k = 0; k < 4; ++k)
+    {
+        Mat src = k % 2 == 0 ? colors : fcolors;
+        if (k >= 2)
+            cvtColor(src, src, COLOR_BGR2BGRA);
+
+        for (size_t i = 0; i < sizeof(codes)/sizeof(codes[0]); ++i)
+        {
+            Mat dst, dstScalar;
+            cv::setUseOptimized(false);
+            cvtColor(src, dstScalar, codes[i]);
+            cv::setUseOptimized(true);
+            cvtColor(src, dst, codes[i]);
+            EXPECT_EQ(0, cvtest::norm(dstScalar, dst, NORM_INF))
+                << names[i] << ", depth " << src.depth() << ", channels " << src.channels();
+        }
+    }
+    cv::setUseOptimized(useOptimized);
+}
@@ -1869,4 +1869,130 @@ TEST(Imgproc_ContourMoments, accuracy) { CV_ContourMomentsTest test; test.safe_r
 TEST(Imgproc_ContourPerimeterSlice, accuracy) { CV_PerimeterAreaSliceTest test; test.safe_run(); }
 TEST(Imgproc_FitEllipse, small) { CV_FitEllipseSmallTest test; test.safe_run(); }
 
+TEST(Imgproc_ContourDescriptors, accuracy)
+{
+    RNG& rng = theRNG();
+    vector<vector<Point> > contours(500);
+
+    for( size_t i = 0; i < contours.size(); i++ )
+    {
+        int n = rng.uniform(0, 30), kind = rng.uniform(0, 8);
+        for( int j = 0; j < n; j++ )
+        {
+            // a few degenerate contours: repeated and collinear points
+            if( kind == 0 )
+                contours[i].push_back(Point(5, 7));
+            else if( kind == 1 )
+                contours[i].push_back(Point(10 + j*3, 20 + j*2));
+            else
+                contours[i].push_back(Point(rng.uniform(0, 64), rng.uniform(0, 48))*(kind == 2 ? 1 : 10));
+        }
+    }
+
+    // float contours mixed with the integer ones
+    vector<Mat> mixed(contours.size());
+    for( size_t i = 0; i < contours.size(); i++ )
+    {
+        Mat(contours[i]).copyTo(mixed[i]);
+        if( i % 3 == 0 && !contours[i].empty() )
+            mixed[i].convertTo(mixed[i], CV_32F, 0.25);
+    }
+
+    const int flagSets[] = { CONTOUR_ALL, CONTOUR_MIN_AREA_RECT, CONTOUR_CONVEX_HULL | CONTOUR_APPROX_POLY };
+
+    for( int iter = 0; iter < 6; iter++ )
+    {
+        int flags = flagSets[iter % 3];
+        ContourDescriptors desc;
+        if( iter < 3 )
+            computeContourDescriptors(contours, desc, flags, 3, true);
+        else
+            computeContourDescriptors(mixed, desc, flags, 3, true);
+
+        if( flags & CONTOUR_AREA )
+        {
+            ASSERT_EQ( contours.size(), desc.area.size() );
+        }
+        if( flags & CONTOUR_MIN_AREA_RECT )
+        {
+            ASSERT_EQ( contours.size(), desc.minAreaRect.size() );
+        }
+        if( flags & CONTOUR_CONVEX_HULL )
+        {
+            ASSERT_EQ( contours.size(), desc.convexHull.size() );
+        }
+        if( flags & CONTOUR_APPROX_POLY )
+        {
+            ASSERT_EQ( contours.size(), desc.approxCurve.size() );
+        }
+
+        for( size_t i = 0; i < contours.size(); i++ )
+        {
+            Mat c = iter < 3 ? Mat(contours[i]) : mixed[i];
+            if( c.empty() )
+            {
+                if( flags & CONTOUR_AREA )
+                {
+                    EXPECT_EQ( 0, desc.area[i] );
+                }
+                if( flags & CONTOUR_CONVEX_HULL )
+                {
+                    EXPECT_TRUE( desc.convexHull[i].empty() );
+                }
+                continue;
+            }
+
+            if( flags & CONTOUR_AREA )
+            {
+                EXPECT_EQ( contourArea(c), desc.area[i] );
+                EXPECT_EQ( arcLength(c, true), desc.arcLength[i] );
+                EXPECT_EQ( boundingRect(c), desc.boundingRect[i] );
+            }
+
+            if( flags & CONTOUR_MIN_AREA_RECT )
+            {
+                RotatedRect r = minAreaRect(c);
+                EXPECT_EQ( r.center, desc.minAreaRect[i].center ) << "contour " << i;
+                EXPECT_EQ( r.size, desc.minAreaRect[i].size ) << "contour " << i;
+                EXPECT_EQ( r.angle, desc.minAreaRect[i].angle ) << "contour " << i;
+            }
+
+            if( flags & CONTOUR_FIT_ELLIPSE )
+            {
+                if( c.checkVector(2) >= 5 )
+                {
+                    RotatedRect e = fitEllipse(c);
+                    EXPECT_EQ( e.center, desc.ellipse[i].center );
+                    EXPECT_EQ( e.size, desc.ellipse[i].size );
+                }
+                else
+                {
+                    EXPECT_EQ( Size2f(), desc.ellipse[i].size );
+                }
+            }
+
+            if( flags & CONTOUR_CONVEX_HULL )
+            {
+                Mat hull;
+                convexHull(c, hull);
+                ASSERT_EQ( hull.type(), desc.convexHull[i].type() );
+                EXPECT_EQ( 0, cvtest::norm(hull, desc.convexHull[i], NORM_INF) ) << "contour " << i;
+            }
+
+            if( flags & CONTOUR_APPROX_POLY )
+            {
+                Mat approx;
+                approxPolyDP(c, approx, 3, true);
+                ASSERT_EQ( approx.type(), desc.approxCurve[i].type() );
+                EXPECT_EQ( 0, cvtest::norm(approx, desc.approxCurve[i], NORM_INF) ) << "contour " << i;
+            }
+        }
+
+        if( !(flags & CONTOUR_AREA) )
+        {
+            EXPECT_TRUE( desc.area.empty() && desc.arcLength.empty() );
+        }
+    }
+}
+
 /* End of file. */
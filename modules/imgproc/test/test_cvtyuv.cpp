@@ -160,6 +160,42 @@ class I420Writer: public YUV420pWriter
     }
 };
 
+class YUV420spWriter: public YUVwriter
+{
+    int channels() { return 1; }
+    Size size(Size imgSize) { return Size(imgSize.width, imgSize.height + imgSize.height/2); }
+};
+
+class NV12Writer: public YUV420spWriter
+{
+    void write(Mat& yuv, int row, int col, const YUV& val)
+    {
+        int h = yuv.rows * 2 / 3;
+
+        yuv.ptr<uchar>(row)[col] = val[0];
+        if( row % 2 == 0 && col % 2 == 0 )
+        {
+            yuv.ptr<uchar>(h + row/2)[col] = val[1];
+            yuv.ptr<uchar>(h + row/2)[col + 1] = val[2];
+        }
+    }
+};
+
+class NV21Writer: public YUV420spWriter
+{
+    void write(Mat& yuv, int row, int col, const YUV& val)
+    {
+        int h = yuv.rows * 2 / 3;
+
+        yuv.ptr<uchar>(row)[col] = val[0];
+        if( row % 2 == 0 && col % 2 == 0 )
+        {
+            yuv.ptr<uchar>(h + row/2)[col] = val[2];
+            yuv.ptr<uchar>(h + row/2)[col + 1] = val[1];
+        }
+    }
+};
+
 class YUV420Reader: public YUVreader
 {
     int channels() { return 1; }
@@ -422,15 +458,23 @@ RGBreader* RGBreader::getReader(int code)
     {
     case CV_RGB2YUV_YV12:
     case CV_RGB2YUV_I420:
+    case CV_RGB2YUV_NV12:
+    case CV_RGB2YUV_NV21:
         return new RGB888Reader();
     case CV_BGR2YUV_YV12:
     case CV_BGR2YUV_I420:
+    case CV_BGR2YUV_NV12:
+    case CV_BGR2YUV_NV21:
         return new BGR888Reader();
     case CV_RGBA2YUV_I420:
     case CV_RGBA2YUV_YV12:
+    case CV_RGBA2YUV_NV12:
+    case CV_RGBA2YUV_NV21:
         return new RGBA8888Reader();
     case CV_BGRA2YUV_YV12:
     case CV_BGRA2YUV_I420:
+    case CV_BGRA2YUV_NV12:
+    case CV_BGRA2YUV_NV21:
         return new BGRA8888Reader();
     default:
         return 0;
@@ -511,6 +555,16 @@ YUVwriter* YUVwriter::getWriter(int code)
     case CV_RGBA2YUV_I420:
     case CV_BGRA2YUV_I420:
         return new I420Writer();
+    case CV_RGB2YUV_NV12:
+    case CV_BGR2YUV_NV12:
+    case CV_RGBA2YUV_NV12:
+    case CV_BGRA2YUV_NV12:
+        return new NV12Writer();
+    case CV_RGB2YUV_NV21:
+    case CV_BGR2YUV_NV21:
+    case CV_RGBA2YUV_NV21:
+    case CV_BGRA2YUV_NV21:
+        return new NV21Writer();
     default:
         return 0;
     };
@@ -603,7 +657,9 @@ CV_ENUM(YUVCVTS, CV_YUV2RGB_NV12, CV_YUV2BGR_NV12, CV_YUV2RGB_NV21, CV_YUV2BGR_N
                  CV_YUV2RGBA_YUY2, CV_YUV2BGRA_YUY2, CV_YUV2RGBA_YVYU, CV_YUV2BGRA_YVYU,
                  CV_YUV2GRAY_420, CV_YUV2GRAY_UYVY, CV_YUV2GRAY_YUY2,
                  CV_YUV2BGR, CV_YUV2RGB, CV_RGB2YUV_YV12, CV_BGR2YUV_YV12, CV_RGBA2YUV_YV12,
-                 CV_BGRA2YUV_YV12, CV_RGB2YUV_I420, CV_BGR2YUV_I420, CV_RGBA2YUV_I420, CV_BGRA2YUV_I420);
+                 CV_BGRA2YUV_YV12, CV_RGB2YUV_I420, CV_BGR2YUV_I420, CV_RGBA2YUV_I420, CV_BGRA2YUV_I420,
+                 CV_RGB2YUV_NV12, CV_BGR2YUV_NV12, CV_RGBA2YUV_NV12, CV_BGRA2YUV_NV12,
+                 CV_RGB2YUV_NV21, CV_BGR2YUV_NV21, CV_RGBA2YUV_NV21, CV_BGRA2YUV_NV21);
 
 typedef ::testing::TestWithParam<YUVCVTS> Imgproc_ColorYUV;
 
@@ -692,6 +748,37 @@ TEST_P(Imgproc_ColorYUV, roi_accuracy)
     }
 }
 
+TEST_P(Imgproc_ColorYUV, simd_bitexact)
+{
+    int code = GetParam();
+    RNG& random = theRNG();
+
+    ConversionYUV cvt(code);
+
+    const int scn = cvt.getScn();
+    bool useOptimized = cv::useOptimized();
+    for(int iter = 0; iter < 10; ++iter)
+    {
+        // widths around the multiples of 16 exercise both the vector loops and their scalar tails
+        Size sz(random.uniform(1, 9) * 16 + random.uniform(-2, 3), random.uniform(1, 65));
+
+        if(cvt.requiresEvenWidth())  sz.width  += sz.width % 2;
+        if(cvt.requiresEvenHeight()) sz.height += sz.height % 2;
+
+        Size srcSize = cvt.getSrcSize(sz);
+        Mat src(srcSize, CV_8UC(scn)), dst, dstScalar;
+        random.fill(src, RNG::UNIFORM, 0, 256);
+
+        cv::setUseOptimized(false);
+        cv::cvtColor(src, dstScalar, code, -1);
+        cv::setUseOptimized(true);
+        cv::cvtColor(src, dst, code, -1);
+
+        EXPECT_EQ(0, cvtest::norm(dstScalar, dst, NORM_INF)) << "size " << sz;
+    }
+    cv::setUseOptimized(useOptimized);
+}
+
 INSTANTIATE_TEST_CASE_P(cvt420, Imgproc_ColorYUV,
     ::testing::Values((int)CV_YUV2RGB_NV12, (int)CV_YUV2BGR_NV12, (int)CV_YUV2RGB_NV21, (int)CV_YUV2BGR_NV21,
                       (int)CV_YUV2RGBA_NV12, (int)CV_YUV2BGRA_NV12, (int)CV_YUV2RGBA_NV21, (int)CV_YUV2BGRA_NV21,
@@ -699,7 +786,9 @@ INSTANTIATE_TEST_CASE_P(cvt420, Imgproc_ColorYUV,
                       (int)CV_YUV2RGBA_YV12, (int)CV_YUV2BGRA_YV12, (int)CV_YUV2RGBA_IYUV, (int)CV_YUV2BGRA_IYUV,
                       (int)CV_YUV2GRAY_420, (int)CV_RGB2YUV_YV12, (int)CV_BGR2YUV_YV12, (int)CV_RGBA2YUV_YV12,
                       (int)CV_BGRA2YUV_YV12, (int)CV_RGB2YUV_I420, (int)CV_BGR2YUV_I420, (int)CV_RGBA2YUV_I420,
-                      (int)CV_BGRA2YUV_I420));
+                      (int)CV_BGRA2YUV_I420, (int)CV_RGB2YUV_NV12, (int)CV_BGR2YUV_NV12, (int)CV_RGBA2YUV_NV12,
+                      (int)CV_BGRA2YUV_NV12, (int)CV_RGB2YUV_NV21, (int)CV_BGR2YUV_NV21, (int)CV_RGBA2YUV_NV21,
+                      (int)CV_BGRA2YUV_NV21));
 
 INSTANTIATE_TEST_CASE_P(cvt422, Imgproc_ColorYUV,
     ::testing::Values((int)CV_YUV2RGB_UYVY, (int)CV_YUV2BGR_UYVY, (int)CV_YUV2RGBA_UYVY, (int)CV_YUV2BGRA_UYVY,
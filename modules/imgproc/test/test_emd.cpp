@@ -92,4 +92,67 @@ void CV_EMDTest::run( int )
 
 TEST(Imgproc_EMD, regression) { CV_EMDTest test; test.safe_run(); }
 
+static Mat makeSignature( RNG& rng, int n, int dims )
+{
+    Mat sig(n, dims + 1, CV_32F);
+    rng.fill(sig.col(0), RNG::UNIFORM, 1, 10);
+    rng.fill(sig.colRange(1, dims + 1), RNG::UNIFORM, 0, 100);
+    return sig;
+}
+
+TEST(Imgproc_EMD, batch)
+{
+    RNG& rng = theRNG();
+    const int dims = 3;
+
+    Mat sig1 = makeSignature(rng, 40, dims);
+    vector<Mat> sigs2;
+    for( int i = 0; i < 10; i++ )
+        sigs2.push_back(makeSignature(rng, 20 + i*5, dims));
+    // unequal weights and a problem large enough for the network simplex in the pairwise call
+    sigs2.push_back(makeSignature(rng, 150, dims));
+
+    vector<float> distances;
+    EMD(sig1, sigs2, DIST_L2, distances);
+    ASSERT_EQ(sigs2.size(), distances.size());
+
+    for( size_t i = 0; i < sigs2.size(); i++ )
+    {
+        float expected = EMD(sig1, sigs2[i], DIST_L2);
+        EXPECT_NEAR(expected, distances[i], 1e-4*expected);
+    }
+}
+
+TEST(Imgproc_EMD, batch_threshold)
+{
+    RNG& rng = theRNG();
+    const int dims = 3;
+    const float threshold = 30;
+
+    Mat sig1 = makeSignature(rng, 60, dims);
+    vector<Mat> sigs2;
+    for( int i = 0; i < 5; i++ )
+        sigs2.push_back(makeSignature(rng, 50 + i*10, dims));
+
+    vector<float> distances, full_distances;
+    EMD(sig1, sigs2, DIST_L2, distances, threshold);
+    EMD(sig1, sigs2, DIST_L2, full_distances);
+    ASSERT_EQ(sigs2.size(), distances.size());
+
+    Mat w1 = sig1.col(0).clone();
+    for( size_t k = 0; k < sigs2.size(); k++ )
+    {
+        const Mat& sig2 = sigs2[k];
+        Mat cost(sig1.rows, sig2.rows, CV_32F);
+        for( int i = 0; i < sig1.rows; i++ )
+            for( int j = 0; j < sig2.rows; j++ )
+                cost.at<float>(i, j) = std::min((float)norm(sig1.row(i).colRange(1, dims + 1),
+                                                            sig2.row(j).colRange(1, dims + 1)), threshold);
+
+        float expected = EMD(w1, sig2.col(0).clone(), -1, cost);
+        EXPECT_NEAR(expected, distances[k], 1e-4*expected);
+        EXPECT_LE(distances[k], full_distances[k]*(1 + 1e-5f));
+    }
+}
+
 /* End of file. */
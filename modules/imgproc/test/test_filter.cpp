@@ -1886,3 +1886,84 @@ protected:
 };
 
 TEST(Imgproc_Filtering, supportedFormats) { CV_FilterSupportedFormatsTest test; test.safe_run(); }
+
+static void bruteForceMorph(int op, const Mat& src, Mat& dst, const Mat& kernel, Point anchor,
+                            int borderType, const Scalar& borderValue)
+{
+    Mat padded;
+    copyMakeBorder(src, padded, anchor.y, kernel.rows - anchor.y - 1,
+                   anchor.x, kernel.cols - anchor.x - 1, borderType, borderValue);
+    dst.release();
+    for( int i = 0; i < kernel.rows; i++ )
+        for( int j = 0; j < kernel.cols; j++ )
+        {
+            if( !kernel.at<uchar>(i, j) )
+                continue;
+            Mat part = padded(Rect(j, i, src.cols, src.rows));
+            if( dst.empty() )
+                part.copyTo(dst);
+            else if( op == MORPH_ERODE )
+                cv::min(dst, part, dst);
+            else
+                cv::max(dst, part, dst);
+        }
+}
+
+TEST(Imgproc_Morphology, largeKernels)
+{
+    const int depths[] = { CV_8U, CV_16U, CV_16S, CV_32F, CV_64F };
+    const int shapes[] = { MORPH_RECT, MORPH_CROSS, MORPH_ELLIPSE };
+    const int borders[] = { BORDER_CONSTANT, BORDER_REPLICATE, BORDER_REFLECT_101 };
+    RNG& rng = theRNG();
+
+    for( int iter = 0; iter < 100; iter++ )
+    {
+        int depth = depths[rng.uniform(0, 5)];
+        int cn = rng.uniform(1, 5);
+        int shape = shapes[rng.uniform(0, 3)];
+        int border = borders[rng.uniform(0, 3)];
+        int op = iter % 2 == 0 ? MORPH_ERODE : MORPH_DILATE;
+        Size ksize(rng.uniform(1, 62), rng.uniform(1, 62));
+        int line = rng.uniform(0, 5);
+        if( line == 0 )
+            ksize.height = 1;
+        else if( line == 1 )
+            ksize.width = 1;
+        Point anchor(rng.uniform(0, ksize.width), rng.uniform(0, ksize.height));
+        Mat kernel = getStructuringElement(shape, ksize);
+
+        // the source is a ROI, so the border is partly made of the real neighbours
+        Size size(rng.uniform(ksize.width, 200), rng.uniform(ksize.height, 200));
+        Rect roi(rng.uniform(0, 20), rng.uniform(0, 20), size.width, size.height);
+        Mat parent(size.height + 20, size.width + 20, CV_MAKETYPE(depth, cn));
+        rng.fill(parent, RNG::UNIFORM, Scalar::all(0), Scalar::all(depth == CV_8U ? 256 : 1000));
+        Mat src = parent(roi);
+
+        Scalar borderValue = Scalar::all(depth == CV_8U ? 128 : 500), refBorderValue = borderValue;
+        if( border == BORDER_CONSTANT && rng.uniform(0, 3) == 0 )
+        {
+            // the default value is the neutral element of the operation, i.e. the limits of the type
+            borderValue = morphologyDefaultBorderValue();
+            double maxVal = depth == CV_8U ? UCHAR_MAX : depth == CV_16U ? USHRT_MAX :
+                            depth == CV_16S ? SHRT_MAX : depth == CV_32F ? FLT_MAX : DBL_MAX;
+            double minVal = depth == CV_8U || depth == CV_16U ? 0. :
+                            depth == CV_16S ? SHRT_MIN : depth == CV_32F ? -FLT_MAX : -DBL_MAX;
+            refBorderValue = Scalar::all(op == MORPH_ERODE ? maxVal : minVal);
+        }
+
+        Mat dst, ref;
+        morphologyEx(src, dst, op, kernel, anchor, 1, border, borderValue);
+        bruteForceMorph(op, src, ref, kernel, anchor, border, refBorderValue);
+
+        ASSERT_EQ(0, cvtest::norm(dst, ref, NORM_INF))
+            << "iter=" << iter << " type=" << src.type() << " op=" << op << " shape=" << shape
+            << " ksize=" << ksize << " anchor=" << anchor << " border=" << border;
+
+        Mat inplace = parent.clone()(roi);
+        morphologyEx(inplace, inplace, op, kernel, anchor, 1, border, borderValue);
+
+        ASSERT_EQ(0, cvtest::norm(inplace, ref, NORM_INF))
+            << "in-place, iter=" << iter << " type=" << src.type() << " op=" << op << " shape=" << shape
+            << " ksize=" << ksize << " anchor=" << anchor << " border=" << border;
+    }
+}
@@ -526,4 +526,49 @@ void CV_FloodFillTest::prepare_to_validation( int /*test_case_idx*/ )
 
 TEST(Imgproc_FloodFill, accuracy) { CV_FloodFillTest test; test.safe_run(); }
 
+TEST(Imgproc_FloodFill, multipleSeeds)
+{
+    RNG& rng = theRNG();
+    const int types[] = { CV_8UC1, CV_8UC3, CV_32SC1, CV_32FC3 };
+
+    for( int iter = 0; iter < 100; iter++ )
+    {
+        int type = types[iter % 4];
+        Size sz(rng.uniform(20, 200), rng.uniform(20, 200));
+
+        // piecewise constant image with some noise on top of it
+        Mat blocks(sz.height/8 + 1, sz.width/8 + 1, type), noise(sz, type), img;
+        rng.fill(blocks, RNG::UNIFORM, 0, 6);
+        rng.fill(noise, RNG::UNIFORM, 0, 2);
+        resize(blocks, img, sz, 0, 0, INTER_NEAREST);
+        img += noise;
+
+        int flags = (rng.uniform(0, 2) ? 4 : 8) | (rng.uniform(1, 255) << 8) |
+                    (rng.uniform(0, 2) ? FLOODFILL_FIXED_RANGE : 0) |
+                    (rng.uniform(0, 2) ? FLOODFILL_MASK_ONLY : 0);
+        Scalar loDiff = Scalar::all(rng.uniform(0, 3)), upDiff = Scalar::all(rng.uniform(0, 3));
+
+        Mat mask0 = Mat::zeros(sz.height + 2, sz.width + 2, CV_8UC1), edges(mask0.size(), CV_8UC1);
+        rng.fill(edges, RNG::UNIFORM, 0, 30);
+        mask0.setTo(Scalar::all(1), edges == 0);
+
+        vector<Point> seeds(rng.uniform(1, 60));
+        for( size_t i = 0; i < seeds.size(); i++ )
+            seeds[i] = Point(rng.uniform(0, sz.width), rng.uniform(0, sz.height));
+
+        Mat img0 = img.clone(), mask = mask0.clone();
+        vector<int> areas0(seeds.size()), areas;
+        vector<Rect> rects0(seeds.size()), rects;
+        for( size_t i = 0; i < seeds.size(); i++ )
+            areas0[i] = floodFill(img0, mask0, seeds[i], Scalar(100, 50, 20), &rects0[i], loDiff, upDiff, flags);
+
+        floodFill(img, mask, seeds, Scalar(100, 50, 20), areas, rects, loDiff, upDiff, flags);
+
+        ASSERT_EQ(0, norm(img0, img, NORM_INF)) << "iteration " << iter;
+        ASSERT_EQ(0, norm(mask0, mask, NORM_INF)) << "iteration " << iter;
+        ASSERT_TRUE(areas0 == areas) << "iteration " << iter;
+        ASSERT_TRUE(rects0 == rects) << "iteration " << iter;
+    }
+}
+
 /* End of file. */
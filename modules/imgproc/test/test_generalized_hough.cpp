@@ -0,0 +1,149 @@
+/*M///////////////////////////////////////////////////////////////////////////////////////
+//
+//  IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING.
+//
+//  By downloading, copying, installing or using the software you agree to this license.
+//  If you do not agree to this license, do not download, install,
+//  copy or use the software.
+//
+//
+//                        Intel License Agreement
+//                For Open Source Computer Vision Library
+//
+// Copyright (C) 2000, Intel Corporation, all rights reserved.
+// Third party copyrights are property of their respective owners.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+//   * Redistribution's of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//   * Redistribution's in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//   * The name of Intel Corporation may not be used to endorse or promote products
+//     derived from this software without specific prior written permission.
+//
+// This software is provided by the copyright holders and contributors "as is" and
+// any express or implied warranties, including, but not limited to, the implied
+// warranties of merchantability and fitness for a particular purpose are disclaimed.
+// In no event shall the Intel Corporation or contributors be liable for any direct,
+// indirect, incidental, special, exemplary, or consequential damages
+// (including, but not limited to, procurement of substitute goods or services;
+// loss of use, data, or profits; or business interruption) however caused
+// and on any theory of liability, whether in contract, strict liability,
+// or tort (including negligence or otherwise) arising in any way out of
+// the use of this software, even if advised of the possibility of such damage.
+//
+//M*/
+#include "test_precomp.hpp"
+
+using namespace cv;
+using namespace std;
+
+static Mat makeHoughTemplate()
+{
+    Mat templ(64, 64, CV_8UC1, Scalar::all(0));
+    rectangle(templ, Point(10, 12), Point(50, 40), Scalar::all(255), -1);
+    circle(templ, Point(40, 44), 12, Scalar::all(160), -1);
+    return templ;
+}
+
+// puts the template rotated by angle at the given places, the template center goes to the given point
+static Mat makeHoughScene(const Mat& templ, const vector<Point>& centers, double angle)
+{
+    Mat image(480, 640, CV_8UC1, Scalar::all(0)), obj;
+    warpAffine(templ, obj, getRotationMatrix2D(Point2f(templ.cols / 2.f, templ.rows / 2.f), angle, 1.0), templ.size());
+
+    for (size_t i = 0; i < centers.size(); ++i)
+    {
+        Mat roi = image(Rect(centers[i] - Point(templ.cols / 2, templ.rows / 2), templ.size()));
+        max(roi, obj, roi);
+    }
+
+    return image;
+}
+
+static bool hasPosition(const Mat& positions, Point center, double angle, double maxDist)
+{
+    for (int i = 0; i < positions.cols; ++i)
+    {
+        const Vec4f pos = positions.at<Vec4f>(i);
+        if (norm(Point2f(pos[0], pos[1]) - Point2f(center)) <= maxDist && fabs(pos[3] - angle) <= 2.0)
+            return true;
+    }
+    return false;
+}
+
+TEST(Imgproc_GeneralizedHough, Ballard)
+{
+    const Mat templ = makeHoughTemplate();
+
+    vector<Point> centers;
+    centers.push_back(Point(120, 100));
+    centers.push_back(Point(400, 300));
+    const Mat image = makeHoughScene(templ, centers, 0);
+
+    Ptr<GeneralizedHoughBallard> alg = createGeneralizedHoughBallard();
+    alg->setMinDist(20);
+    alg->setVotesThreshold(100);
+    alg->setTemplate(templ);
+
+    Mat positions, votes;
+    alg->detect(image, positions, votes);
+
+    ASSERT_EQ(CV_32FC4, positions.type());
+    for (size_t i = 0; i < centers.size(); ++i)
+        EXPECT_TRUE(hasPosition(positions, centers[i], 0, 2.0)) << centers[i];
+
+    // the voting is split between the threads, the result must not depend on it
+    const int nthreads = getNumThreads();
+    setNumThreads(1);
+    Mat positions1, votes1;
+    alg->detect(image, positions1, votes1);
+    setNumThreads(nthreads);
+
+    EXPECT_EQ(0, cvtest::norm(positions, positions1, NORM_INF));
+    EXPECT_EQ(0, cvtest::norm(votes, votes1, NORM_INF));
+}
+
+TEST(Imgproc_GeneralizedHough, Guil)
+{
+    const Mat templ = makeHoughTemplate();
+
+    vector<Point> centers;
+    centers.push_back(Point(200, 150));
+    centers.push_back(Point(450, 320));
+    // getRotationMatrix2D turns counter-clockwise on the screen, while the detector angles go the other way
+    const Mat image = makeHoughScene(templ, centers, -90);
+
+    Ptr<GeneralizedHoughGuil> alg = createGeneralizedHoughGuil();
+    alg->setMinDist(20);
+    alg->setMinAngle(0);
+    alg->setMaxAngle(180);
+    alg->setAngleStep(2);
+    alg->setMinScale(0.9);
+    alg->setMaxScale(1.1);
+    alg->setAngleThresh(500);
+    alg->setScaleThresh(100);
+    alg->setPosThresh(20);
+    alg->setTemplate(templ);
+
+    Mat positions, votes;
+    alg->detect(image, positions, votes);
+
+    ASSERT_EQ(CV_32FC4, positions.type());
+    for (size_t i = 0; i < centers.size(); ++i)
+        EXPECT_TRUE(hasPosition(positions, centers[i], 90, 3.0)) << centers[i];
+
+    const int nthreads = getNumThreads();
+    setNumThreads(1);
+    Mat positions1, votes1;
+    alg->detect(image, positions1, votes1);
+    setNumThreads(nthreads);
+
+    EXPECT_EQ(0, cvtest::norm(positions, positions1, NORM_INF));
+    EXPECT_EQ(0, cvtest::norm(votes, votes1, NORM_INF));
+}
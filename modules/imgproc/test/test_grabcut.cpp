@@ -170,3 +170,37 @@ TEST(Imgproc_GrabCut, repeatability)
     EXPECT_EQ(0, countNonZero(mask_1 != mask_3));
     EXPECT_EQ(0, countNonZero(mask_2 != mask_3));
 }
+
+TEST(Imgproc_GrabCut, synthetic_iterations)
+{
+    // a reddish ellipse on a bluish background, both noisy
+    Mat image(120, 160, CV_8UC3), truth(image.size(), CV_8UC1, Scalar::all(0)), noise(image.size(), CV_16SC3);
+    image.setTo(Scalar(170, 90, 60));
+    ellipse(truth, Point(80, 60), Size(40, 28), 20, 0, 360, Scalar::all(255), -1);
+    image.setTo(Scalar(50, 80, 190), truth);
+    cv::RNG rng(0x12345);
+    rng.fill(noise, RNG::NORMAL, 0, 45);
+    add(image, noise, image, noArray(), CV_8U);
+    Rect rect(25, 15, 110, 90);
+
+    const int iterations = 6;
+    Mat mask_once, mask_steps, bgdModel, fgdModel;
+
+    // all the iterations in one call, where the graph is updated between them...
+    theRNG().state = 12378213;
+    grabCut(image, mask_once, rect, bgdModel, fgdModel, 0, GC_INIT_WITH_RECT);
+    grabCut(image, mask_once, rect, bgdModel, fgdModel, iterations, GC_EVAL);
+
+    // ...and one call per iteration, each building its graph anew
+    theRNG().state = 12378213;
+    grabCut(image, mask_steps, rect, bgdModel, fgdModel, 0, GC_INIT_WITH_RECT);
+    for( int i = 0; i < iterations; i++ )
+        grabCut(image, mask_steps, rect, bgdModel, fgdModel, 1, GC_EVAL);
+
+    // the reused graph may only differ by rounding or by ties of the minimum cut
+    int differences = countNonZero((mask_once & 1) != (mask_steps & 1));
+    EXPECT_LE(differences, rect.area() / 1000);
+
+    int errors = countNonZero((mask_once & 1) * 255 != truth);
+    EXPECT_LT(errors, countNonZero(truth) / 100);
+}
@@ -1844,4 +1844,31 @@ TEST(Imgproc_Hist_CalcBackProject, accuracy) { CV_CalcBackProjectTest test; test
 TEST(Imgproc_Hist_CalcBackProjectPatch, accuracy) { CV_CalcBackProjectPatchTest test; test.safe_run(); }
 TEST(Imgproc_Hist_BayesianProb, accuracy) { CV_BayesianProbTest test; test.safe_run(); }
 
+// Without clipping, the LUTs of a 16-bit image made of the 8-bit levels times 257
+// are the 8-bit LUTs times 257, so the results must agree up to the 8-bit rounding.
+TEST(Imgproc_CLAHE, accuracy_16u)
+{
+    RNG& rng = theRNG();
+    const Size sizes[] = { Size(256, 256), Size(333, 217) };
+    const Size grids[] = { Size(8, 8), Size(3, 5) };
+
+    for( int k = 0; k < 4; k++ )
+    {
+        Size sz = sizes[k / 2], grid = grids[k % 2];
+        Mat src8(sz, CV_8UC1), src16, dst8, dst16;
+        rng.fill(src8, RNG::NORMAL, Scalar::all(100), Scalar::all(30));
+        GaussianBlur(src8, src8, Size(5, 5), 0);
+        src8.convertTo(src16, CV_16U, 257);
+
+        Ptr<CLAHE> clahe = createCLAHE(0, grid);
+        clahe->apply(src8, dst8);
+        clahe->apply(src16, dst16);
+        ASSERT_EQ(CV_16UC1, dst16.type());
+
+        Mat ref16;
+        dst8.convertTo(ref16, CV_16U, 257);
+        EXPECT_LE(cvtest::norm(dst16, ref16, NORM_INF), 257) << "size " << sz << ", grid " << grid;
+    }
+}
+
 /* End Of File */
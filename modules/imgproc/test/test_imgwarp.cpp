@@ -1533,6 +1533,60 @@ TEST(Imgproc_resize_area, regression)
     ASSERT_EQ(norm(one_channel_diff, cv::NORM_INF), 0);
 }
 
+TEST(Imgproc_Undistorter, accuracy)
+{
+    const Size sz(640, 480);
+    const double fx = 600, fy = 620, cx = 320, cy = 240;
+    const double k1 = -0.25, k2 = 0.08, p1 = 0.001, p2 = -0.0007, k3 = -0.01;
+    Mat A = (Mat_<double>(3, 3) << fx, 0, cx, 0, fy, cy, 0, 0, 1);
+    Mat D = (Mat_<double>(1, 5) << k1, k2, p1, p2, k3);
+    Mat newA = (Mat_<double>(3, 3) << 0.8*fx, 0, cx + 3, 0, 0.8*fy, cy - 2, 0, 0, 1);
+
+    Mat src(sz, CV_8UC3);
+    randu(src, Scalar::all(0), Scalar::all(255));
+
+    Ptr<Undistorter> undistorter = createUndistorter(A, D, sz, noArray(), newA);
+    ASSERT_EQ(sz, undistorter->getImageSize());
+
+    // the cached map must give exactly the same result as undistort()
+    Mat expected, actual;
+    undistort(src, expected, A, D, newA);
+    undistorter->apply(src, actual);
+    EXPECT_EQ(0, cvtest::norm(expected, actual, NORM_INF));
+
+    Mat map1, map2;
+    undistorter->getMaps(map1, map2);
+    EXPECT_EQ(CV_16SC2, map1.type());
+    EXPECT_EQ(CV_16UC1, map2.type());
+
+    // the corrected points must go back to the observed ones under the distortion model
+    RNG& rng = theRNG();
+    Mat pts(1, 5000, CV_64FC2), upts;
+    rng.fill(pts, RNG::UNIFORM, Scalar::all(-20), Scalar(sz.width + 20, sz.height + 20));
+    undistorter->undistortPoints(pts, upts);
+    ASSERT_EQ(pts.size(), upts.size());
+    ASSERT_EQ(pts.type(), upts.type());
+
+    double maxErr = 0;
+    for (int i = 0; i < pts.cols; i++)
+    {
+        Point2d q = upts.at<Point2d>(i);
+        double x = (q.x - newA.at<double>(0, 2))/newA.at<double>(0, 0);
+        double y = (q.y - newA.at<double>(1, 2))/newA.at<double>(1, 1);
+        double r2 = x*x + y*y, kr = 1 + ((k3*r2 + k2)*r2 + k1)*r2;
+        double xd = x*kr + 2*p1*x*y + p2*(r2 + 2*x*x), yd = y*kr + p1*(r2 + 2*y*y) + 2*p2*x*y;
+        maxErr = std::max(maxErr, norm(Point2d(xd*fx + cx, yd*fy + cy) - pts.at<Point2d>(i)));
+    }
+    EXPECT_LT(maxErr, 0.05);
+
+    // and agree with undistortPoints() where its iterations converge
+    Mat pts32f(1, 1000, CV_32FC2), upts32f, ref;
+    rng.fill(pts32f, RNG::UNIFORM, Scalar(cx - 150, cy - 100), Scalar(cx + 150, cy + 100));
+    undistorter->undistortPoints(pts32f, upts32f);
+    undistortPoints(pts32f, ref, A, D, noArray(), newA);
+    EXPECT_LT(cvtest::norm(ref, upts32f, NORM_INF), 1e-2);
+}
+
 
 //////////////////////////////////////////////////////////////////////////
 
@@ -1545,4 +1599,95 @@ TEST(Imgproc_InitUndistortMap, accuracy) { CV_UndistortMapTest test; test.safe_r
 TEST(Imgproc_GetRectSubPix, accuracy) { CV_GetRectSubPixTest test; test.safe_run(); }
 TEST(Imgproc_GetQuadSubPix, accuracy) { CV_GetQuadSubPixTest test; test.safe_run(); }
 
+static void blobFromImageReference( const Mat& src, Mat& blob, Size size, const Scalar& mean,
+                                    double scale, bool swapRB, bool planar, int interpolation )
+{
+    Mat fsrc, resized;
+    src.convertTo(fsrc, CV_32F);
+    resize(fsrc, resized, size, 0, 0, interpolation);
+
+    int cn = src.channels();
+    std::vector<Mat> planes;
+    split(resized, planes);
+    if( swapRB )
+        std::swap(planes[0], planes[2]);
+    for( int c = 0; c < cn; c++ )
+        planes[c] = (planes[c] - mean[c])*scale;
+
+    int sz[] = { 1, planar ? cn : size.height, planar ? size.height : size.width,
+                 planar ? size.width : cn };
+    blob.create(4, sz, CV_32F);
+    if( planar )
+    {
+        for( int c = 0; c < cn; c++ )
+            planes[c].copyTo(Mat(size, CV_32F, blob.ptr<float>() + c*size.area()));
+    }
+    else
+        merge(planes, Mat(size, CV_32FC(cn), blob.ptr<float>()));
+}
+
+TEST(Imgproc_BlobFromImage, accuracy)
+{
+    const int types[] = { CV_8UC1, CV_8UC3, CV_8UC4, CV_16UC3, CV_32FC3 };
+    RNG& rng = theRNG();
+
+    for( int iter = 0; iter < 40; iter++ )
+    {
+        int type = types[iter % (int)(sizeof(types)/sizeof(types[0]))];
+        int cn = CV_MAT_CN(type);
+        Mat big(rng.uniform(2, 300), rng.uniform(2, 300), type);
+        rng.fill(big, RNG::UNIFORM, Scalar::all(0), Scalar::all(256));
+        Rect roi(rng.uniform(0, big.cols/2), rng.uniform(0, big.rows/2), 0, 0);
+        roi.width = rng.uniform(1, big.cols - roi.x + 1);
+        roi.height = rng.uniform(1, big.rows - roi.y + 1);
+        Mat src = big(roi);
+
+        Size size(rng.uniform(1, 250), rng.uniform(1, 250));
+        Scalar mean(rng.uniform(0., 128.), rng.uniform(0., 128.), rng.uniform(0., 128.), rng.uniform(0., 128.));
+        double scale = rng.uniform(0.001, 2.);
+        bool swapRB = cn >= 3 && rng.uniform(0, 2) != 0;
+        bool planar = rng.uniform(0, 2) != 0;
+        int interpolation = rng.uniform(0, 2) ? INTER_LINEAR : INTER_NEAREST;
+
+        Mat blob, ref;
+        blobFromImage(src, blob, size, mean, scale, swapRB, planar, interpolation);
+        blobFromImageReference(src, ref, size, mean, scale, swapRB, planar, interpolation);
+
+        ASSERT_EQ(4, blob.dims);
+        ASSERT_EQ(CV_32F, blob.type());
+        ASSERT_LE(cvtest::norm(blob, ref, NORM_INF), 1e-3*std::max(scale*256, 1.))
+            << "iter=" << iter << " type=" << type << " src=" << src.size() << " size=" << size
+            << " swapRB=" << swapRB << " planar=" << planar << " interpolation=" << interpolation;
+    }
+}
+
+TEST(Imgproc_BlobFromImage, batch)
+{
+    Size size(37, 23);
+    Scalar mean(104, 117, 123);
+    std::vector<Mat> images;
+    images.push_back(Mat(100, 80, CV_8UC3));
+    images.push_back(Mat(10, 200, CV_8UC3));
+    images.push_back(Mat(23, 37, CV_32FC3));
+    for( size_t i = 0; i < images.size(); i++ )
+        randu(images[i], Scalar::all(0), Scalar::all(255));
+
+    for( int planar = 0; planar < 2; planar++ )
+    {
+        Mat blob;
+        blobFromImages(images, blob, size, mean, 1./255, true, planar != 0);
+        ASSERT_EQ((int)images.size(), blob.size[0]);
+
+        size_t imageSize = blob.total()/images.size();
+        for( size_t i = 0; i < images.size(); i++ )
+        {
+            Mat single;
+            blobFromImage(images[i], single, size, mean, 1./255, true, planar != 0);
+            Mat part(1, (int)imageSize, CV_32F, blob.ptr<float>() + i*imageSize);
+            Mat singlePart(1, (int)imageSize, CV_32F, single.ptr<float>());
+            EXPECT_EQ(0, cvtest::norm(part, singlePart, NORM_INF)) << "image " << i;
+        }
+    }
+}
+
 /* End of file. */
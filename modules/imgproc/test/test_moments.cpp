@@ -423,3 +423,92 @@ protected:
 };
 
 TEST(Imgproc_ContourMoment, small) { CV_SmallContourMomentTest test; test.safe_run(); }
+
+static void checkMomentsEqual( const Moments& m, const Moments& ref, double eps )
+{
+    const double* a = &m.m00;
+    const double* b = &ref.m00;
+    for( int k = 0; k < 10; k++ )
+        EXPECT_LE( fabs(a[k] - b[k]), eps*std::max(fabs(b[k]), 1.) ) << "k = " << k;
+}
+
+TEST(Imgproc_Moments, labels)
+{
+    RNG& rng = theRNG();
+    Size sz(157, 93);
+    const int nlabels = 7;
+
+    Mat blocks(sz.height/8 + 1, sz.width/8 + 1, CV_32SC1), labels;
+    rng.fill(blocks, RNG::UNIFORM, -1, nlabels + 1);
+    resize(blocks, labels, sz, 0, 0, INTER_NEAREST);
+
+    Mat img(sz, CV_32FC1);
+    rng.fill(img, RNG::UNIFORM, 0, 100);
+
+    vector<Moments> mu, muw;
+    moments(labels, nlabels, mu);
+    moments(labels, nlabels, muw, img);
+    ASSERT_EQ( nlabels, (int)mu.size() );
+    ASSERT_EQ( nlabels, (int)muw.size() );
+
+    for( int l = 0; l < nlabels; l++ )
+    {
+        Mat mask = labels == l, weighted = Mat::zeros(sz, CV_32FC1);
+        img.copyTo(weighted, mask);
+
+        checkMomentsEqual( mu[l], moments(mask, true), 1e-9 );
+        checkMomentsEqual( muw[l], moments(weighted), 1e-6 );
+    }
+
+    moments(labels, 0, mu);
+    EXPECT_TRUE( mu.empty() );
+}
+
+TEST(Imgproc_Moments, contours)
+{
+    RNG& rng = theRNG();
+    vector<vector<Point> > contours(300);
+
+    for( size_t i = 0; i < contours.size(); i++ )
+    {
+        int n = rng.uniform(1, 20);
+        for( int j = 0; j < n; j++ )
+            contours[i].push_back(Point(rng.uniform(0, 640), rng.uniform(0, 480)));
+    }
+
+    vector<Moments> mu;
+    moments(contours, mu);
+    ASSERT_EQ( contours.size(), mu.size() );
+
+    for( size_t i = 0; i < contours.size(); i++ )
+        checkMomentsEqual( mu[i], moments(contours[i]), 0 );
+}
+
+TEST(Imgproc_Moments, tiles_16u_32f)
+{
+    // compares the tiled (and vectorized) computation with the direct summation
+    RNG& rng = theRNG();
+    Size sz(100, 75);
+    int depths[] = { CV_16U, CV_32F };
+
+    for( int i = 0; i < 2; i++ )
+    {
+        Mat img(sz, depths[i]);
+        rng.fill(img, RNG::UNIFORM, 0, depths[i] == CV_16U ? 65536 : 1000);
+
+        Mat img64;
+        img.convertTo(img64, CV_64F);
+        double m[10] = {0,0,0,0,0,0,0,0,0,0};
+        for( int y = 0; y < sz.height; y++ )
+            for( int x = 0; x < sz.width; x++ )
+            {
+                double p = img64.at<double>(y, x), xp = x*p, yp = y*p;
+                m[0] += p; m[1] += xp; m[2] += yp;
+                m[3] += xp*x; m[4] += xp*y; m[5] += yp*y;
+                m[6] += xp*x*x; m[7] += xp*x*y; m[8] += xp*y*y; m[9] += yp*y*y;
+            }
+
+        Moments ref(m[0], m[1], m[2], m[3], m[4], m[5], m[6], m[7], m[8], m[9]);
+        checkMomentsEqual( moments(img), ref, 1e-10 );
+    }
+}
@@ -0,0 +1,146 @@
+/*M///////////////////////////////////////////////////////////////////////////////////////
+//
+//  IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING.
+//
+//  By downloading, copying, installing or using the software you agree to this license.
+//  If you do not agree to this license, do not download, install,
+//  copy or use the software.
+//
+//
+//                        Intel License Agreement
+//                For Open Source Computer Vision Library
+//
+// Copyright (C) 2000, Intel Corporation, all rights reserved.
+// Third party copyrights are property of their respective owners.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+//   * Redistribution's of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//   * Redistribution's in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//   * The name of Intel Corporation may not be used to endorse or promote products
+//     derived from this software without specific prior written permission.
+//
+// This software is provided by the copyright holders and contributors "as is" and
+// any express or implied warranties, including, but not limited to, the implied
+// warranties of merchantability and fitness for a particular purpose are disclaimed.
+// In no event shall the Intel Corporation or contributors be liable for any direct,
+// indirect, incidental, special, exemplary, or consequential damages
+// (including, but not limited to, procurement of substitute goods or services;
+// loss of use, data, or profits; or business interruption) however caused
+// and on any theory of liability, whether in contract, strict liability,
+// or tort (including negligence or otherwise) arising in any way out of
+// the use of this software, even if advised of the possibility of such damage.
+//
+//M*/
+#include "test_precomp.hpp"
+
+using namespace cv;
+using namespace std;
+
+static bool lessThanTriangle( const Vec6f& a, const Vec6f& b )
+{
+    for( int i = 0; i < 6; i++ )
+        if( a[i] != b[i] )
+            return a[i] < b[i];
+    return false;
+}
+
+static void getSortedTriangles( const Subdiv2D& subdiv, vector<Vec6f>& triangles )
+{
+    subdiv.getTriangleList(triangles);
+
+    // brings each triangle to the canonical form: the vertices are rotated so that
+    // the lexicographically smallest one goes first
+    for( size_t i = 0; i < triangles.size(); i++ )
+    {
+        Vec6f& t = triangles[i];
+        int k = 0;
+        for( int j = 1; j < 3; j++ )
+            if( t[j*2] < t[k*2] || (t[j*2] == t[k*2] && t[j*2+1] < t[k*2+1]) )
+                k = j;
+        Vec6f r;
+        for( int j = 0; j < 6; j++ )
+            r[j] = t[(k*2 + j) % 6];
+        t = r;
+    }
+
+    sort(triangles.begin(), triangles.end(), lessThanTriangle);
+}
+
+TEST(Imgproc_Subdiv2D, bulkInsert)
+{
+    RNG& rng = theRNG();
+    Rect rect(0, 0, 640, 480);
+    vector<Point2f> points(2000);
+
+    for( size_t i = 0; i < points.size(); i++ )
+        points[i] = Point2f(rng.uniform(0.f, 640.f), rng.uniform(0.f, 480.f));
+    // duplicates
+    points[10] = points[5];
+    points[1500] = points[700];
+
+    Subdiv2D seq(rect), bulk(rect);
+    vector<int> ids(points.size());
+    for( size_t i = 0; i < points.size(); i++ )
+        ids[i] = seq.insert(points[i]);
+    bulk.insert(points);
+
+    vector<Vec6f> t0, t1;
+    getSortedTriangles(seq, t0);
+    getSortedTriangles(bulk, t1);
+
+    ASSERT_EQ( t0.size(), t1.size() );
+    for( size_t i = 0; i < t0.size(); i++ )
+        EXPECT_EQ( t0[i], t1[i] ) << "i = " << i;
+
+    // the points get the same vertex indices as with one-by-one insertion
+    EXPECT_EQ( ids[5], ids[10] );
+    EXPECT_EQ( ids[700], ids[1500] );
+    for( size_t i = 0; i < points.size(); i++ )
+    {
+        int edge = 0, vertex = 0;
+        ASSERT_EQ( (int)Subdiv2D::PTLOC_VERTEX, bulk.locate(points[i], edge, vertex) ) << "i = " << i;
+        EXPECT_EQ( ids[i], vertex ) << "i = " << i;
+        EXPECT_EQ( seq.getVertex(ids[i]), bulk.getVertex(ids[i]) ) << "i = " << i;
+    }
+
+    // the Voronoi diagram leaves free vertex slots, which are reused in the same way
+    vector<Point2f> morePoints(300);
+    for( size_t i = 0; i < morePoints.size(); i++ )
+        morePoints[i] = Point2f(rng.uniform(0.f, 640.f), rng.uniform(0.f, 480.f));
+    morePoints[100] = points[3];
+    morePoints[200] = morePoints[50];
+
+    vector<vector<Point2f> > facets;
+    vector<Point2f> centers;
+    seq.getVoronoiFacetList(vector<int>(), facets, centers);
+    bulk.getVoronoiFacetList(vector<int>(), facets, centers);
+
+    for( size_t i = 0; i < morePoints.size(); i++ )
+    {
+        int id = seq.insert(morePoints[i]);
+        EXPECT_EQ( morePoints[i], seq.getVertex(id) );
+    }
+    bulk.insert(morePoints);
+
+    for( size_t i = 0; i < morePoints.size(); i++ )
+    {
+        int edge = 0, v0 = 0, v1 = 0;
+        seq.locate(morePoints[i], edge, v0);
+        ASSERT_EQ( (int)Subdiv2D::PTLOC_VERTEX, bulk.locate(morePoints[i], edge, v1) ) << "i = " << i;
+        EXPECT_EQ( v0, v1 ) << "i = " << i;
+    }
+
+    int edge = 0, vertex = 0;
+    EXPECT_EQ( (int)Subdiv2D::PTLOC_VERTEX, bulk.locate(points[1234], edge, vertex) );
+    EXPECT_EQ( points[1234], bulk.getVertex(vertex) );
+
+    vector<Point2f> outside(1, Point2f(700.f, 10.f));
+    EXPECT_THROW( bulk.insert(outside), cv::Exception );
+}